@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+#include "envoy/common/pure.h"
+
+namespace Envoy {
+
+/**
+ * A monotonic memory arena. Memory is carved out of the arena sequentially and is only released,
+ * all at once, when the arena itself is destroyed. There is no way to free an individual
+ * allocation, which makes allocation cheap but means the arena is only suitable for objects whose
+ * lifetime is bounded by the lifetime of the arena's owner.
+ */
+class Arena {
+public:
+  virtual ~Arena() {}
+
+  /**
+   * Allocate memory from the arena.
+   * @param size supplies the number of bytes to allocate.
+   * @param alignment supplies the required alignment. Must be a power of two no larger than
+   *        alignof(std::max_align_t).
+   * @return void* the allocated memory. Never nullptr.
+   */
+  virtual void* allocate(size_t size, size_t alignment) PURE;
+};
+
+} // namespace Envoy
@@ -29,6 +29,21 @@ public:
   virtual void onConfigUpdate(const ResourceVector& resources,
                               const std::string& version_info) PURE;
 
+  /**
+   * Called instead of the above when the subscription delivers incremental updates, i.e. for ADS
+   * when runtime key config.incremental_ads was enabled at startup.
+   * @param added_resources vector of resources added or changed since the last configuration
+   *        update.
+   * @param removed_resources names of resources removed since the last configuration update.
+   * @param system_version_info the version information as supplied by the xDS discovery response.
+   * @throw EnvoyException with reason if the configuration is rejected. Otherwise the configuration
+   *        is accepted. Accepted configurations have their version_info reflected in subsequent
+   *        requests.
+   */
+  virtual void onConfigUpdate(const ResourceVector& added_resources,
+                              const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+                              const std::string& system_version_info) PURE;
+
   /**
    * Called when either the Subscription is unable to fetch a config update or when onConfigUpdate
    * invokes an exception.
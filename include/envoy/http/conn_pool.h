@@ -95,6 +95,13 @@ public:
    */
   virtual void drainConnections() PURE;
 
+  /**
+   * Establish connections ahead of demand, up to the cluster's configured number of warm
+   * connections (@see Upstream::ClusterInfo::warmConnections()). This is a no-op if the pool
+   * already has at least that many connections or if connection limits would be exceeded.
+   */
+  virtual void prefetchConnections() PURE;
+
   /**
    * Create a new stream on the pool.
    * @param response_decoder supplies the decoder events to fire when the response is
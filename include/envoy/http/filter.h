@@ -6,6 +6,7 @@
 #include <string>
 
 #include "envoy/access_log/access_log.h"
+#include "envoy/common/arena.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/http/codec.h"
 #include "envoy/http/header_map.h"
@@ -509,6 +510,14 @@ public:
    * @param handler supplies the handler to add.
    */
   virtual void addAccessLogHandler(AccessLog::InstanceSharedPtr handler) PURE;
+
+  /**
+   * @return Arena& an arena owned by the stream whose memory is released when the stream is
+   *         destroyed. Filter factories may opt into constructing their filters in it (e.g. via
+   *         makeArenaShared()) to avoid per-stream heap allocations. A filter constructed in the
+   *         arena must not be referenced by anything that outlives the stream.
+   */
+  virtual Arena& arena() PURE;
 };
 
 /**
@@ -206,6 +206,20 @@ public:
    */
   virtual void write(Buffer::Instance& data, bool end_stream) PURE;
 
+  /**
+   * Forward all further data read on this connection to peer, and all data read on peer to this
+   * connection, inside the kernel (e.g. with splice(2)) rather than through the read filters. Read
+   * filters still see end_stream, with an empty buffer. Bytes forwarded this way are reported to
+   * the receiving connection's bytes sent callbacks, and its write buffer watermark callbacks fire
+   * as they would for buffered data. If either connection closes, the other one goes back to
+   * delivering its data to its read filters.
+   * @param peer supplies the connection to forward to and from.
+   * @return bool whether forwarding started. It does not start unless both connections are
+   *         plaintext, open, have no write filters and at most one read filter, and neither has
+   *         undelivered read data.
+   */
+  virtual bool startSplice(Connection& peer) PURE;
+
   /**
    * Set a soft limit on the size of buffers for the connection.
    * For the read buffer, this limits the bytes read prior to flushing to further stages in the
@@ -60,6 +60,18 @@ public:
    */
   virtual uint32_t concurrency() const PURE;
 
+  /**
+   * @return the number of threads TLS server handshakes hand their private key operations to, or
+   *         0 to perform them inline on the worker threads.
+   */
+  virtual uint32_t privateKeyThreads() const PURE;
+
+  /**
+   * @return the number of threads active health check sessions run on, or 0 to run them on the
+   *         main thread.
+   */
+  virtual uint32_t healthCheckThreads() const PURE;
+
   /**
    * @return the number of seconds that envoy will perform draining during a hot restart.
    */
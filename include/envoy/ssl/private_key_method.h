@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/common/pure.h"
+#include "envoy/event/dispatcher.h"
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * Callbacks of a connection waiting on an asynchronous private key operation.
+ */
+class PrivateKeyConnectionCallbacks {
+public:
+  virtual ~PrivateKeyConnectionCallbacks() {}
+
+  /**
+   * Called on the connection's dispatcher thread once the pending private key operation has
+   * completed (successfully or not). The connection should resume its handshake, which will pick
+   * up the result.
+   */
+  virtual void onPrivateKeyMethodComplete() PURE;
+};
+
+/**
+ * Performs the private key operations of TLS handshakes on behalf of server contexts, e.g. on a
+ * dedicated thread pool or a hardware accelerator, so that they do not run inline on the worker
+ * event loops.
+ */
+class PrivateKeyMethodProvider {
+public:
+  virtual ~PrivateKeyMethodProvider() {}
+
+  /**
+   * Register a connection with the provider before its handshake starts.
+   * @param ssl supplies the connection's SSL instance.
+   * @param callbacks supplies the callbacks to invoke when an operation completes. They must stay
+   *        valid until unregisterPrivateKeyMethod() is called.
+   * @param dispatcher supplies the dispatcher of the thread the connection runs on.
+   */
+  virtual void registerPrivateKeyMethod(SSL* ssl, PrivateKeyConnectionCallbacks& callbacks,
+                                        Event::Dispatcher& dispatcher) PURE;
+
+  /**
+   * Unregister a connection. Any pending operation is abandoned and its callbacks are not invoked.
+   * @param ssl supplies the connection's SSL instance.
+   */
+  virtual void unregisterPrivateKeyMethod(SSL* ssl) PURE;
+
+  /**
+   * @return const SSL_PRIVATE_KEY_METHOD* the BoringSSL method to install in server contexts.
+   */
+  virtual const SSL_PRIVATE_KEY_METHOD* getBoringSslPrivateKeyMethod() const PURE;
+};
+
+typedef std::shared_ptr<PrivateKeyMethodProvider> PrivateKeyMethodProviderSharedPtr;
+
+} // namespace Ssl
+} // namespace Envoy
@@ -6,6 +6,7 @@
 #include "envoy/buffer/buffer.h"
 #include "envoy/common/pure.h"
 #include "envoy/event/deferred_deletable.h"
+#include "envoy/network/connection.h"
 #include "envoy/upstream/upstream.h"
 
 namespace Envoy {
@@ -32,13 +33,17 @@ enum class PoolFailureReason {
   // A resource overflowed and policy prevented a new stream from being created.
   Overflow,
   // A connection failure took place and the stream could not be bound.
-  ConnectionFailure
+  ConnectionFailure,
+  // The connection attempt did not complete within the cluster's connect timeout.
+  Timeout
 };
 
 /*
- * UpstreamCallbacks for connection pool upstream connection callbacks.
+ * UpstreamCallbacks for connection pool upstream connection callbacks. Connection events and write
+ * buffer watermark callbacks are also delivered while the connection is owned by a
+ * ConnectionPool::Instance caller.
  */
-class UpstreamCallbacks {
+class UpstreamCallbacks : public Network::ConnectionCallbacks {
 public:
   virtual ~UpstreamCallbacks() {}
 
@@ -146,6 +151,18 @@ public:
    *                      should be done by resetting the connection.
    */
   virtual Cancellable* newConnection(Callbacks& callbacks) PURE;
+
+  /**
+   * Open connections ahead of demand so that later newConnection() calls can be served without
+   * waiting for a connect. Connections are opened until the ready and connecting connections not
+   * already spoken for by pending requests number at least count, as long as the connections in
+   * use and the pool's spare connections together stay within the cluster's connection limit.
+   * Spare connections only count against that limit once they are handed out, so that idle ones
+   * never keep a new connection from being served.
+   * Connections that fail or close are not replaced until the next call.
+   * @param count supplies the number of spare connections to keep.
+   */
+  virtual void preconnect(uint32_t count) PURE;
 };
 
 typedef std::unique_ptr<Instance> InstancePtr;
@@ -40,6 +40,12 @@ public:
    */
   template <class T> T& getTyped() { return *std::dynamic_pointer_cast<T>(get()); }
 
+  /**
+   * Also set data and run callbacks on threads registered via
+   * Instance::registerRestrictedThread(). Must be called before set().
+   */
+  virtual void includeRestrictedThreads() PURE;
+
   /**
    * Run a callback on all registered threads.
    * @param cb supplies the callback to run.
@@ -96,6 +102,14 @@ public:
    */
   virtual void registerThread(Event::Dispatcher& dispatcher, bool main_thread) PURE;
 
+  /**
+   * Register a helper thread that only receives thread local data of the slots that opted in via
+   * Slot::includeRestrictedThreads(). Threads such as the health check threads need runtime and
+   * stats, but should not build the per thread state (cluster managers, caches, ...) of workers.
+   * @param dispatcher supplies the thread's dispatcher.
+   */
+  virtual void registerRestrictedThread(Event::Dispatcher& dispatcher) PURE;
+
   /**
    * This should be called by the main thread before any worker threads start to exit. This will
    * block TLS removal during slot destruction, given that worker threads are about to call
@@ -41,6 +41,11 @@ public:
    * @return the current maximum allowed number of this resource.
    */
   virtual uint64_t max() PURE;
+
+  /**
+   * @return the current number of this resource.
+   */
+  virtual uint64_t count() PURE;
 };
 
 /**
@@ -73,6 +78,13 @@ public:
    * @return Resource& active retries.
    */
   virtual Resource& retries() PURE;
+
+  /**
+   * @return Resource& active shadow requests. Shadow requests are budgeted separately from
+   *         requests() so that a slow shadow cluster sheds mirrored traffic rather than holding
+   *         memory and connections on behalf of the primary request path.
+   */
+  virtual Resource& shadowRequests() PURE;
 };
 
 } // namespace Upstream
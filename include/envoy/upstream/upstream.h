@@ -314,6 +314,7 @@ public:
   COUNTER  (upstream_cx_idle_timeout)                                                              \
   COUNTER  (upstream_cx_connect_attempts_exceeded)                                                 \
   COUNTER  (upstream_cx_overflow)                                                                  \
+  COUNTER  (upstream_cx_prefetch)                                                                  \
   HISTOGRAM(upstream_cx_connect_ms)                                                                \
   HISTOGRAM(upstream_cx_length_ms)                                                                 \
   COUNTER  (upstream_cx_destroy)                                                                   \
@@ -345,6 +346,7 @@ public:
   COUNTER  (upstream_rq_retry)                                                                     \
   COUNTER  (upstream_rq_retry_success)                                                             \
   COUNTER  (upstream_rq_retry_overflow)                                                            \
+  COUNTER  (upstream_rq_shadow_overflow)                                                           \
   COUNTER  (upstream_flow_control_paused_reading_total)                                            \
   COUNTER  (upstream_flow_control_resumed_reading_total)                                           \
   COUNTER  (upstream_flow_control_backed_up_total)                                                 \
@@ -420,6 +422,18 @@ public:
    */
   virtual const absl::optional<std::chrono::milliseconds> idleTimeout() const PURE;
 
+  /**
+   * @return float the ratio of connections a connection pool keeps established relative to its
+   *         current demand (active plus pending requests). A value of 1.0 disables prefetching.
+   */
+  virtual float prefetchRatio() const PURE;
+
+  /**
+   * @return uint32_t the number of connections each connection pool for this cluster establishes
+   *         ahead of any demand, when a host is added or the cluster finishes warming.
+   */
+  virtual uint32_t warmConnections() const PURE;
+
   /**
    * @return soft limit on size of the cluster's connections read and write buffers.
    */
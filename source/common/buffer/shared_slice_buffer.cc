@@ -0,0 +1,39 @@
+#include "common/buffer/shared_slice_buffer.h"
+
+namespace Envoy {
+namespace Buffer {
+
+void SharedSliceBuffer::add(const Instance& data) {
+  const uint64_t length = data.length();
+  if (length == 0) {
+    return;
+  }
+
+  // Flatten the source into a single allocation so that every later reference is one fragment.
+  std::string slice;
+  slice.reserve(length);
+  uint64_t num_slices = data.getRawSlices(nullptr, 0);
+  RawSlice raw_slices[num_slices];
+  data.getRawSlices(raw_slices, num_slices);
+  for (const RawSlice& raw_slice : raw_slices) {
+    slice.append(static_cast<const char*>(raw_slice.mem_), raw_slice.len_);
+  }
+
+  slices_.emplace_back(std::make_shared<const std::string>(std::move(slice)));
+  length_ += length;
+}
+
+void SharedSliceBuffer::addTo(Instance& buffer) const {
+  for (const SliceSharedPtr& slice : slices_) {
+    // The fragment deletes itself when the buffer is done with it, dropping its slice reference.
+    buffer.addBufferFragment(*new SliceFragment(slice));
+  }
+}
+
+void SharedSliceBuffer::clear() {
+  slices_.clear();
+  length_ = 0;
+}
+
+} // namespace Buffer
+} // namespace Envoy
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Buffer {
+
+/**
+ * An append-only sequence of immutable, reference counted slices. Data is copied in once and the
+ * slices can then be added by reference to any number of buffers without copying the bytes again.
+ * This is used for request bodies that may need to be replayed (retries) or fanned out
+ * (shadowing). A slice stays alive until both this object and every buffer referencing it have
+ * released it.
+ */
+class SharedSliceBuffer : NonCopyable {
+public:
+  /**
+   * Copy the contents of a buffer into a new immutable slice. The source buffer is not modified.
+   * @param data supplies the data to copy.
+   */
+  void add(const Instance& data);
+
+  /**
+   * Add references to all slices to the end of a buffer. No data is copied.
+   * @param buffer supplies the buffer to add the slices to.
+   */
+  void addTo(Instance& buffer) const;
+
+  /**
+   * Release this object's references to all slices. Buffers that already reference a slice keep
+   * it alive.
+   */
+  void clear();
+
+  /**
+   * @return uint64_t the total number of bytes in all slices.
+   */
+  uint64_t length() const { return length_; }
+
+private:
+  typedef std::shared_ptr<const std::string> SliceSharedPtr;
+
+  /**
+   * A buffer fragment that keeps a slice alive for as long as a buffer references it.
+   */
+  class SliceFragment : public BufferFragment {
+  public:
+    SliceFragment(const SliceSharedPtr& slice) : slice_(slice) {}
+
+    // Buffer::BufferFragment
+    const void* data() const override { return slice_->data(); }
+    size_t size() const override { return slice_->size(); }
+    void done() override { delete this; }
+
+  private:
+    const SliceSharedPtr slice_;
+  };
+
+  std::vector<SliceSharedPtr> slices_;
+  uint64_t length_{};
+};
+
+} // namespace Buffer
+} // namespace Envoy
@@ -0,0 +1,45 @@
+#include "common/common/arena_impl.h"
+
+#include <algorithm>
+#include <new>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+
+ArenaImpl::ArenaImpl(char* initial_block, size_t initial_size, size_t block_size)
+    : block_size_(block_size), next_(initial_block), end_(initial_block + initial_size) {
+  ASSERT(reinterpret_cast<uintptr_t>(initial_block) % alignof(std::max_align_t) == 0);
+}
+
+ArenaImpl::~ArenaImpl() {
+  while (blocks_ != nullptr) {
+    Block* next = blocks_->next_;
+    ::operator delete(blocks_);
+    blocks_ = next;
+  }
+}
+
+void* ArenaImpl::allocate(size_t size, size_t alignment) {
+  ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+  ASSERT(alignment <= alignof(std::max_align_t));
+
+  uintptr_t aligned = (reinterpret_cast<uintptr_t>(next_) + alignment - 1) & ~(alignment - 1);
+  if (next_ == nullptr || aligned + size > reinterpret_cast<uintptr_t>(end_)) {
+    // The remainder of the current block is abandoned. Block data directly follows the header and
+    // so is aligned to alignof(std::max_align_t).
+    const size_t data_size = std::max(size, block_size_);
+    Block* block = static_cast<Block*>(::operator new(sizeof(Block) + data_size));
+    block->next_ = blocks_;
+    blocks_ = block;
+    heap_blocks_++;
+    next_ = reinterpret_cast<char*>(block + 1);
+    end_ = next_ + data_size;
+    aligned = reinterpret_cast<uintptr_t>(next_);
+  }
+
+  next_ = reinterpret_cast<char*>(aligned + size);
+  return reinterpret_cast<void*>(aligned);
+}
+
+} // namespace Envoy
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "envoy/common/arena.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+
+/**
+ * Implementation of Arena. Allocations are first carved out of an optional caller supplied
+ * initial block, and then out of heap blocks of at least block_size bytes that are freed when the
+ * arena is destroyed.
+ */
+class ArenaImpl : public Arena, NonCopyable {
+public:
+  /**
+   * @param initial_block supplies storage to allocate from before allocating heap blocks. May be
+   *        nullptr. Must be aligned to alignof(std::max_align_t) and outlive the arena.
+   * @param initial_size supplies the size of initial_block.
+   * @param block_size supplies the minimum size of the heap blocks allocated once the current block
+   *        is exhausted.
+   */
+  ArenaImpl(char* initial_block, size_t initial_size, size_t block_size);
+  ArenaImpl(size_t block_size) : ArenaImpl(nullptr, 0, block_size) {}
+  ~ArenaImpl();
+
+  /**
+   * @return uint64_t the number of heap blocks the arena has allocated.
+   */
+  uint64_t heapBlocks() const { return heap_blocks_; }
+
+  // Arena
+  void* allocate(size_t size, size_t alignment) override;
+
+private:
+  struct alignas(std::max_align_t) Block {
+    Block* next_;
+  };
+
+  const size_t block_size_;
+  char* next_;
+  char* end_;
+  Block* blocks_{};
+  uint64_t heap_blocks_{};
+};
+
+/**
+ * ArenaImpl that starts out allocating from InlineSize bytes of storage held inline, so that an
+ * owner with a bounded number of small allocations does not need to allocate from the heap at all.
+ */
+template <size_t InlineSize> class InlineArenaImpl : public ArenaImpl {
+public:
+  InlineArenaImpl(size_t block_size) : ArenaImpl(inline_block_, InlineSize, block_size) {}
+
+private:
+  alignas(std::max_align_t) char inline_block_[InlineSize];
+};
+
+/**
+ * Standard allocator that allocates from an Arena. Deallocation is a no-op; the memory is released
+ * when the arena is destroyed.
+ */
+template <class T> class ArenaAllocator {
+public:
+  typedef T value_type;
+
+  ArenaAllocator(Arena& arena) : arena_(arena) {}
+  template <class U> ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_) {}
+
+  T* allocate(size_t n) { return static_cast<T*>(arena_.allocate(n * sizeof(T), alignof(T))); }
+  void deallocate(T*, size_t) {}
+
+  template <class U> bool operator==(const ArenaAllocator<U>& other) const {
+    return &arena_ == &other.arena_;
+  }
+  template <class U> bool operator!=(const ArenaAllocator<U>& other) const {
+    return !(*this == other);
+  }
+
+private:
+  Arena& arena_;
+
+  template <class U> friend class ArenaAllocator;
+};
+
+/**
+ * Construct a shared object, and its reference count, in an arena. The object is destroyed when
+ * its last reference goes away as usual, but its memory is only released when the arena is
+ * destroyed. Hence no reference may outlive the arena.
+ */
+template <class T, class... Args> std::shared_ptr<T> makeArenaShared(Arena& arena, Args&&... args) {
+  return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+}
+
+} // namespace Envoy
@@ -0,0 +1,206 @@
+#include "common/common/concurrent_token_bucket_impl.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+
+namespace {
+
+// Keeps the sums of the times of the bucket far from overflowing.
+constexpr int64_t MaxCapacityNs = std::numeric_limits<int64_t>::max() / 4;
+
+int64_t tokenNs(double fill_rate) {
+  if (fill_rate == 0) {
+    // A bucket that never fills does not measure time, and counts its tokens in nanoseconds.
+    return 1;
+  }
+  return std::max<int64_t>(1, std::llround(1e9 / fill_rate));
+}
+
+} // namespace
+
+ConcurrentTokenBucketImpl::ConcurrentTokenBucketImpl(uint64_t max_tokens, double fill_rate,
+                                                     MonotonicTimeSource& time_source)
+    : max_tokens_(std::min<uint64_t>(max_tokens, MaxCapacityNs / tokenNs(std::abs(fill_rate)))),
+      fills_(fill_rate != 0), token_ns_(tokenNs(std::abs(fill_rate))),
+      capacity_ns_(max_tokens_ * token_ns_), time_source_(time_source),
+      epoch_(time_source.currentTime()), empty_at_(-capacity_ns_) {}
+
+int64_t ConcurrentTokenBucketImpl::now() {
+  if (!fills_) {
+    return 0;
+  }
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(time_source_.currentTime() - epoch_)
+      .count();
+}
+
+bool ConcurrentTokenBucketImpl::consume(uint64_t tokens) {
+  if (tokens > max_tokens_) {
+    return false;
+  }
+
+  const int64_t time_now = now();
+  const int64_t cost = tokens * token_ns_;
+  int64_t empty_at = empty_at_.load(std::memory_order_relaxed);
+  int64_t next;
+  do {
+    next = std::max(empty_at, time_now - capacity_ns_) + cost;
+    if (next > time_now) {
+      return false;
+    }
+  } while (!empty_at_.compare_exchange_weak(empty_at, next, std::memory_order_relaxed));
+  return true;
+}
+
+uint64_t ConcurrentTokenBucketImpl::tokens() {
+  const int64_t time_now = now();
+  const int64_t empty_at =
+      std::max(empty_at_.load(std::memory_order_relaxed), time_now - capacity_ns_);
+  // Another thread may have seen a later time.
+  return std::max<int64_t>(0, time_now - empty_at) / token_ns_;
+}
+
+uint64_t ConcurrentTokenBucketImpl::take(uint64_t tokens) {
+  const int64_t time_now = now();
+  int64_t empty_at = empty_at_.load(std::memory_order_relaxed);
+  uint64_t taken;
+  int64_t next;
+  do {
+    const int64_t start = std::max(empty_at, time_now - capacity_ns_);
+    taken = std::min<uint64_t>(tokens, std::max<int64_t>(0, time_now - start) / token_ns_);
+    if (taken == 0) {
+      return 0;
+    }
+    next = start + static_cast<int64_t>(taken) * token_ns_;
+  } while (!empty_at_.compare_exchange_weak(empty_at, next, std::memory_order_relaxed));
+  return taken;
+}
+
+uint64_t ConcurrentTokenBucketImpl::give(uint64_t tokens) {
+  const int64_t time_now = now();
+  const int64_t full_at = time_now - capacity_ns_;
+  int64_t empty_at = empty_at_.load(std::memory_order_relaxed);
+  uint64_t given;
+  int64_t next;
+  do {
+    const int64_t start = std::max(empty_at, full_at);
+    given = std::min<uint64_t>(tokens, (start - full_at) / token_ns_);
+    if (given == 0) {
+      return 0;
+    }
+    next = start - static_cast<int64_t>(given) * token_ns_;
+  } while (!empty_at_.compare_exchange_weak(empty_at, next, std::memory_order_relaxed));
+  return given;
+}
+
+constexpr std::chrono::milliseconds ShardedTokenBucketImpl::DefaultRebalanceInterval;
+
+ShardedTokenBucketImpl::ShardedTokenBucketImpl(uint64_t max_tokens, double fill_rate,
+                                               uint32_t shards,
+                                               std::chrono::milliseconds rebalance_interval,
+                                               MonotonicTimeSource& time_source)
+    : rebalance_interval_(rebalance_interval), time_source_(time_source) {
+  ASSERT(shards > 0);
+  for (uint32_t i = 0; i < shards; ++i) {
+    // The shards split the tokens as evenly as they can, and fill in proportion to their size.
+    const uint64_t shard_tokens = max_tokens / shards + (i < max_tokens % shards ? 1 : 0);
+    const double shard_fill_rate =
+        max_tokens == 0 ? fill_rate / shards : fill_rate * shard_tokens / max_tokens;
+    shards_.emplace_back(new Shard(shard_tokens, shard_fill_rate, time_source));
+  }
+}
+
+uint32_t ShardedTokenBucketImpl::threadIndex() {
+  // Every thread that consumes from a sharded bucket takes the next index, workers or not.
+  static std::atomic<uint32_t> next_thread_index{0};
+  static thread_local const uint32_t thread_index = next_thread_index++;
+  return thread_index;
+}
+
+bool ShardedTokenBucketImpl::consume(uint64_t tokens) { return consume(tokens, threadIndex()); }
+
+bool ShardedTokenBucketImpl::consume(uint64_t tokens, uint32_t shard) {
+  const uint32_t index = shard % shards_.size();
+  if (shards_[index]->bucket_.consume(tokens)) {
+    return true;
+  }
+
+  maybeRebalance();
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    if (shards_[(index + i) % shards_.size()]->bucket_.consume(tokens)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ShardedTokenBucketImpl::maybeRebalance() {
+  if (shards_.size() == 1) {
+    return;
+  }
+
+  const MonotonicTime::rep time_now = time_source_.currentTime().time_since_epoch().count();
+  MonotonicTime::rep next_rebalance = next_rebalance_.load(std::memory_order_relaxed);
+  if (time_now < next_rebalance) {
+    return;
+  }
+  // A single thread rebalances the shards in each interval.
+  if (next_rebalance_.compare_exchange_strong(next_rebalance,
+                                              time_now + rebalance_interval_.count(),
+                                              std::memory_order_relaxed)) {
+    rebalance();
+  }
+}
+
+void ShardedTokenBucketImpl::rebalance() {
+  std::vector<uint64_t> tokens;
+  tokens.reserve(shards_.size());
+  uint64_t total = 0;
+  for (const auto& shard : shards_) {
+    tokens.push_back(shard->bucket_.tokens());
+    total += tokens.back();
+  }
+  const uint64_t share = total / shards_.size();
+
+  // Other threads keep consuming meanwhile, so the tokens moved are only as many as the shards
+  // still hold, and any that do not fit where they are short go back wherever there is room.
+  uint64_t surplus = 0;
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    if (tokens[i] > share) {
+      surplus += shards_[i]->bucket_.take(tokens[i] - share);
+    }
+  }
+  for (size_t i = 0; i < shards_.size() && surplus > 0; ++i) {
+    if (tokens[i] < share) {
+      surplus -= shards_[i]->bucket_.give(std::min(surplus, share - tokens[i]));
+    }
+  }
+  for (size_t i = 0; i < shards_.size() && surplus > 0; ++i) {
+    surplus -= shards_[i]->bucket_.give(surplus);
+  }
+}
+
+uint64_t ShardedTokenBucketImpl::cap(uint64_t tokens) {
+  uint64_t total = 0;
+  for (const auto& shard : shards_) {
+    total += shard->bucket_.tokens();
+  }
+  if (total <= tokens) {
+    return 0;
+  }
+
+  // The shards that run short later take back their share on the next rebalance.
+  uint64_t excess = total - tokens;
+  uint64_t taken = 0;
+  for (size_t i = 0; i < shards_.size() && taken < excess; ++i) {
+    taken += shards_[i]->bucket_.take(excess - taken);
+  }
+  return taken;
+}
+
+} // namespace Envoy
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/common/token_bucket.h"
+
+#include "common/common/utility.h"
+
+namespace Envoy {
+
+/**
+ * A token bucket that may be consumed from any thread without a lock. The whole state of the
+ * bucket is packed into a single atomic word: the time at which the bucket was (or will be) empty.
+ * The tokens in the bucket follow from it, as the bucket fills at a steady rate since then, so a
+ * consume() is a single compare-and-swap of that time.
+ */
+class ConcurrentTokenBucketImpl : public TokenBucket {
+public:
+  /**
+   * @param max_tokens supplies the maximum number of tokens in the bucket.
+   * @param fill_rate supplies the number of tokens that will return to the bucket on each second,
+   *        at most one per nanosecond. The default is 1.
+   * @param time_source supplies the time source, which must be safe to use from any thread. The
+   *        default is ProdMonotonicTimeSource.
+   */
+  explicit ConcurrentTokenBucketImpl(
+      uint64_t max_tokens, double fill_rate = 1,
+      MonotonicTimeSource& time_source = ProdMonotonicTimeSource::instance_);
+
+  bool consume(uint64_t tokens = 1) override;
+
+  /**
+   * @return the number of whole tokens in the bucket, which other threads may change at any time.
+   */
+  uint64_t tokens();
+
+  /**
+   * Consumes as many of the given number of tokens as the bucket holds.
+   * @return the number of tokens consumed.
+   */
+  uint64_t take(uint64_t tokens);
+
+  /**
+   * Returns tokens to the bucket, as far as it has room for them.
+   * @return the number of tokens returned.
+   */
+  uint64_t give(uint64_t tokens);
+
+private:
+  int64_t now();
+
+  const uint64_t max_tokens_;
+  const bool fills_;
+  // The time it takes to fill one token.
+  const int64_t token_ns_;
+  // The time it takes to fill the bucket from empty.
+  const int64_t capacity_ns_;
+  MonotonicTimeSource& time_source_;
+  const MonotonicTime epoch_;
+  // The time since epoch_ at which the bucket was empty, in nanoseconds. It is never earlier than
+  // capacity_ns_ before the current time once updated, as the bucket does not fill beyond
+  // max_tokens_.
+  std::atomic<int64_t> empty_at_;
+};
+
+/**
+ * A token bucket for limits that are consumed from many threads at high rates. The tokens are
+ * split over independent ConcurrentTokenBucketImpl shards, and each consume() starts at a shard
+ * picked by the caller, typically one per worker, so that threads do not contend on the same cache
+ * line. A consume() whose shard runs out first evens out the tokens between the shards, at most
+ * once per rebalance interval, and then falls back to the other shards, so that the limit holds for
+ * all the threads together. A single consume() cannot take more tokens than a shard holds.
+ */
+class ShardedTokenBucketImpl : public TokenBucket {
+public:
+  /**
+   * @param max_tokens supplies the maximum number of tokens in all the shards together.
+   * @param fill_rate supplies the number of tokens that will return to the shards on each second.
+   * @param shards supplies the number of shards, typically the number of workers.
+   * @param rebalance_interval supplies the minimum time between two rebalances of the shards.
+   * @param time_source supplies the time source, which must be safe to use from any thread.
+   */
+  ShardedTokenBucketImpl(uint64_t max_tokens, double fill_rate, uint32_t shards,
+                         std::chrono::milliseconds rebalance_interval = DefaultRebalanceInterval,
+                         MonotonicTimeSource& time_source = ProdMonotonicTimeSource::instance_);
+
+  /**
+   * Consumes from the shard of the calling thread. Threads take shards in the order in which they
+   * first consume from any sharded bucket, whether they are workers or not, so two workers may
+   * share a shard. Callers that know their worker should use the overload that takes a shard.
+   */
+  bool consume(uint64_t tokens = 1) override;
+
+  /**
+   * Consumes starting at a given shard.
+   * @param tokens supplies the number of tokens to consume.
+   * @param shard supplies the shard to start at. Taken modulo the number of shards.
+   * @return whether the tokens were consumed.
+   */
+  bool consume(uint64_t tokens, uint32_t shard);
+
+  /**
+   * Evens out the tokens between the shards.
+   */
+  void rebalance();
+
+  /**
+   * Takes tokens out of the shards until they hold at most the given number together. The bucket
+   * keeps filling at its rate afterwards.
+   * @param tokens supplies the number of tokens the shards may keep.
+   * @return the number of tokens taken.
+   */
+  uint64_t cap(uint64_t tokens);
+
+  static constexpr std::chrono::milliseconds DefaultRebalanceInterval{100};
+
+private:
+  // The size of the cache lines of the CPUs the shards are kept apart for.
+  static constexpr size_t CacheLineSize = 64;
+
+  struct Shard {
+    Shard(uint64_t max_tokens, double fill_rate, MonotonicTimeSource& time_source)
+        : bucket_(max_tokens, fill_rate, time_source) {}
+
+    ConcurrentTokenBucketImpl bucket_;
+    // Keeps the state of the next shard, which is allocated separately, off this cache line.
+    char padding_[CacheLineSize];
+  };
+
+  static uint32_t threadIndex();
+  void maybeRebalance();
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+  const MonotonicTime::duration rebalance_interval_;
+  MonotonicTimeSource& time_source_;
+  // The earliest time of the next rebalance, since the epoch of the time source.
+  std::atomic<MonotonicTime::rep> next_rebalance_{};
+};
+
+} // namespace Envoy
@@ -6,7 +6,11 @@
 #include <pthread.h>
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <functional>
+#include <vector>
 
 #include "common/common/assert.h"
 #include "common/common/macros.h"
@@ -42,5 +46,46 @@ void Thread::join() {
   RELEASE_ASSERT(rc == 0, "");
 }
 
+void parallelFor(size_t count, uint32_t concurrency, const std::function<void(size_t)>& callback) {
+  const size_t num_threads = std::min<size_t>(concurrency, count);
+  if (num_threads <= 1) {
+    for (size_t i = 0; i < count; i++) {
+      callback(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next_index{0};
+  std::atomic<bool> failed{false};
+  absl::Mutex exception_lock;
+  std::exception_ptr exception;
+  const auto run = [&]() -> void {
+    try {
+      for (size_t i = next_index++; i < count && !failed; i = next_index++) {
+        callback(i);
+      }
+    } catch (...) {
+      absl::MutexLock lock(&exception_lock);
+      if (!exception) {
+        exception = std::current_exception();
+      }
+      failed = true;
+    }
+  };
+
+  std::vector<ThreadPtr> threads;
+  for (size_t i = 1; i < num_threads; i++) {
+    threads.emplace_back(new Thread(run));
+  }
+  run();
+  for (auto& thread : threads) {
+    thread->join();
+  }
+
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
 } // namespace Thread
 } // namespace Envoy
@@ -37,6 +37,20 @@ private:
 
 typedef std::unique_ptr<Thread> ThreadPtr;
 
+/**
+ * Run a callback for each index in [0, count), spread over the calling thread and up to
+ * concurrency - 1 threads started for the purpose, and wait for all of them to finish. The
+ * callbacks must therefore be independent of each other and safe to run on any thread. If a
+ * callback throws, the remaining indexes are skipped and the exception is rethrown on the calling
+ * thread once all threads have finished. If several callbacks throw, which exception is rethrown
+ * is unspecified.
+ * @param count supplies the number of indexes.
+ * @param concurrency supplies the maximum number of threads to run callbacks on, including the
+ *        calling thread. With 0 or 1 all callbacks run on the calling thread, in order.
+ * @param callback supplies the callback to run for each index.
+ */
+void parallelFor(size_t count, uint32_t concurrency, const std::function<void(size_t)>& callback);
+
 /**
  * Implementation of BasicLockable
  */
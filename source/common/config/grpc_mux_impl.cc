@@ -2,6 +2,7 @@
 
 #include <unordered_set>
 
+#include "common/common/hash.h"
 #include "common/common/token_bucket_impl.h"
 #include "common/config/utility.h"
 #include "common/protobuf/protobuf.h"
@@ -12,9 +13,10 @@ namespace Config {
 GrpcMuxImpl::GrpcMuxImpl(const envoy::api::v2::core::Node& node, Grpc::AsyncClientPtr async_client,
                          Event::Dispatcher& dispatcher,
                          const Protobuf::MethodDescriptor& service_method,
-                         Runtime::RandomGenerator& random, MonotonicTimeSource& time_source)
+                         Runtime::RandomGenerator& random, MonotonicTimeSource& time_source,
+                         bool incremental)
     : node_(node), async_client_(std::move(async_client)), service_method_(service_method),
-      random_(random), time_source_(time_source) {
+      random_(random), time_source_(time_source), incremental_(incremental) {
   retry_timer_ = dispatcher.createTimer([this]() -> void { establishNewStream(); });
   backoff_strategy_ = std::make_unique<JitteredBackOffStrategy>(RETRY_INITIAL_DELAY_MS,
                                                                 RETRY_MAX_DELAY_MS, random_);
@@ -188,36 +190,38 @@ void GrpcMuxImpl::onReceiveMessage(std::unique_ptr<envoy::api::v2::DiscoveryResp
     return;
   }
   try {
-    // To avoid O(n^2) explosion (e.g. when we have 1000s of EDS watches), we
-    // build a map here from resource name to resource and then walk watches_.
-    // We have to walk all watches (and need an efficient map as a result) to
-    // ensure we deliver empty config updates when a resource is dropped.
-    std::unordered_map<std::string, ProtobufWkt::Any> resources;
-    GrpcMuxCallbacks& callbacks = api_state_[type_url].watches_.front()->callbacks_;
-    for (const auto& resource : message->resources()) {
-      if (type_url != resource.type_url()) {
-        throw EnvoyException(fmt::format("{} does not match {} type URL is DiscoveryResponse {}",
-                                         resource.type_url(), type_url, message->DebugString()));
-      }
-      const std::string resource_name = callbacks.resourceName(resource);
-      resources.emplace(resource_name, resource);
-    }
-    for (auto watch : api_state_[type_url].watches_) {
-      if (watch->resources_.empty()) {
-        watch->callbacks_.onConfigUpdate(message->resources(), message->version_info());
-        continue;
+    if (incremental_) {
+      deliverIncrementalUpdate(*message);
+    } else {
+      // To avoid O(n^2) explosion (e.g. when we have 1000s of EDS watches), we
+      // build a map here from resource name to resource and then walk watches_.
+      // We have to walk all watches (and need an efficient map as a result) to
+      // ensure we deliver empty config updates when a resource is dropped.
+      std::unordered_map<std::string, ProtobufWkt::Any> resources;
+      GrpcMuxCallbacks& callbacks = api_state_[type_url].watches_.front()->callbacks_;
+      for (const auto& resource : message->resources()) {
+        if (type_url != resource.type_url()) {
+          throw EnvoyException(fmt::format("{} does not match {} type URL is DiscoveryResponse {}",
+                                           resource.type_url(), type_url, message->DebugString()));
+        }
+        const std::string resource_name = callbacks.resourceName(resource);
+        resources.emplace(resource_name, resource);
       }
-      Protobuf::RepeatedPtrField<ProtobufWkt::Any> found_resources;
-      for (auto watched_resource_name : watch->resources_) {
-        auto it = resources.find(watched_resource_name);
-        if (it != resources.end()) {
-          found_resources.Add()->MergeFrom(it->second);
+      for (auto watch : api_state_[type_url].watches_) {
+        if (watch->resources_.empty()) {
+          watch->callbacks_.onConfigUpdate(message->resources(), message->version_info());
+          continue;
+        }
+        Protobuf::RepeatedPtrField<ProtobufWkt::Any> found_resources;
+        for (auto watched_resource_name : watch->resources_) {
+          auto it = resources.find(watched_resource_name);
+          if (it != resources.end()) {
+            found_resources.Add()->MergeFrom(it->second);
+          }
         }
+        watch->callbacks_.onConfigUpdate(found_resources, message->version_info());
       }
-      watch->callbacks_.onConfigUpdate(found_resources, message->version_info());
     }
-    // TODO(mattklein123): In the future if we start tracking per-resource versions, we would do
-    // that tracking here.
     api_state_[type_url].request_.set_version_info(message->version_info());
   } catch (const EnvoyException& e) {
     ENVOY_LOG(warn, "gRPC config for {} update rejected: {}", message->type_url(), e.what());
@@ -232,6 +236,72 @@ void GrpcMuxImpl::onReceiveMessage(std::unique_ptr<envoy::api::v2::DiscoveryResp
   sendDiscoveryRequest(type_url);
 }
 
+void GrpcMuxImpl::deliverIncrementalUpdate(const envoy::api::v2::DiscoveryResponse& message) {
+  ApiState& api_state = api_state_[message.type_url()];
+  // Resources that did not change since the last response have the same version, by which their
+  // name is known without parsing them.
+  std::unordered_map<std::string, std::pair<const ProtobufWkt::Any*, uint64_t>> resources;
+  std::unordered_map<uint64_t, std::string> resource_names;
+  GrpcMuxCallbacks& callbacks = api_state.watches_.front()->callbacks_;
+  for (const auto& resource : message.resources()) {
+    if (message.type_url() != resource.type_url()) {
+      throw EnvoyException(fmt::format("{} does not match {} type URL is DiscoveryResponse {}",
+                                       resource.type_url(), message.type_url(),
+                                       message.DebugString()));
+    }
+    const uint64_t version = HashUtil::xxHash64(resource.value());
+    const auto cached_name = api_state.resource_names_.find(version);
+    const std::string resource_name = cached_name != api_state.resource_names_.end()
+                                          ? cached_name->second
+                                          : callbacks.resourceName(resource);
+    resource_names.emplace(version, resource_name);
+    resources.emplace(resource_name, std::make_pair(&resource, version));
+  }
+  api_state.resource_names_.swap(resource_names);
+
+  for (auto watch : api_state.watches_) {
+    Protobuf::RepeatedPtrField<ProtobufWkt::Any> added_resources;
+    Protobuf::RepeatedPtrField<std::string> removed_resources;
+    std::unordered_map<std::string, uint64_t> resource_versions;
+    const auto add_if_changed = [&watch, &added_resources, &resource_versions](
+                                    const std::string& resource_name,
+                                    const ProtobufWkt::Any& resource, uint64_t version) -> void {
+      if (!resource_versions.emplace(resource_name, version).second) {
+        return;
+      }
+      const auto previous = watch->resource_versions_.find(resource_name);
+      if (previous == watch->resource_versions_.end() || previous->second != version) {
+        added_resources.Add()->MergeFrom(resource);
+      }
+    };
+
+    if (watch->resources_.empty()) {
+      for (const auto& resource : resources) {
+        add_if_changed(resource.first, *resource.second.first, resource.second.second);
+      }
+    } else {
+      for (const std::string& watched_resource_name : watch->resources_) {
+        const auto it = resources.find(watched_resource_name);
+        if (it != resources.end()) {
+          add_if_changed(it->first, *it->second.first, it->second.second);
+        }
+      }
+    }
+    for (const auto& previous : watch->resource_versions_) {
+      if (resource_versions.count(previous.first) == 0) {
+        removed_resources.Add()->assign(previous.first);
+      }
+    }
+
+    if (watch->updated_ && added_resources.empty() && removed_resources.empty()) {
+      continue;
+    }
+    watch->callbacks_.onConfigUpdate(added_resources, removed_resources, message.version_info());
+    watch->resource_versions_.swap(resource_versions);
+    watch->updated_ = true;
+  }
+}
+
 void GrpcMuxImpl::onReceiveTrailingMetadata(Http::HeaderMapPtr&& metadata) {
   UNREFERENCED_PARAMETER(metadata);
 }
@@ -19,6 +19,11 @@ namespace Config {
 
 /**
  * ADS API implementation that fetches via gRPC.
+ *
+ * In incremental mode, the mux tracks a version of each resource, the hash of its serialized
+ * form, and hands watches only the resources that changed since their last update along with the
+ * names of those that are gone. The management server still sends the state of the world, but
+ * unchanged resources are neither parsed nor copied. Watches without changes are not called.
  */
 class GrpcMuxImpl : public GrpcMux,
                     Grpc::TypedAsyncStreamCallbacks<envoy::api::v2::DiscoveryResponse>,
@@ -27,7 +32,8 @@ public:
   GrpcMuxImpl(const envoy::api::v2::core::Node& node, Grpc::AsyncClientPtr async_client,
               Event::Dispatcher& dispatcher, const Protobuf::MethodDescriptor& service_method,
               Runtime::RandomGenerator& random,
-              MonotonicTimeSource& time_source = ProdMonotonicTimeSource::instance_);
+              MonotonicTimeSource& time_source = ProdMonotonicTimeSource::instance_,
+              bool incremental = false);
   ~GrpcMuxImpl();
 
   void start() override;
@@ -52,6 +58,7 @@ private:
   void establishNewStream();
   void sendDiscoveryRequest(const std::string& type_url);
   void handleFailure();
+  void deliverIncrementalUpdate(const envoy::api::v2::DiscoveryResponse& message);
 
   struct GrpcMuxWatchImpl : public GrpcMuxWatch {
     GrpcMuxWatchImpl(const std::vector<std::string>& resources, GrpcMuxCallbacks& callbacks,
@@ -75,6 +82,10 @@ private:
     GrpcMuxImpl& parent_;
     std::list<GrpcMuxWatchImpl*>::iterator entry_;
     bool inserted_;
+    // In incremental mode, the version of each resource in the last update delivered to the watch.
+    std::unordered_map<std::string, uint64_t> resource_versions_;
+    // In incremental mode, whether the watch was delivered an update yet.
+    bool updated_{};
   };
 
   // Per muxed API state.
@@ -93,6 +104,8 @@ private:
     TokenBucketPtr limit_request_;
     // Limits warning messages when too many requests is detected.
     TokenBucketPtr limit_log_;
+    // In incremental mode, the name of each resource of the last response by its version.
+    std::unordered_map<uint64_t, std::string> resource_names_;
   };
 
   envoy::api::v2::core::Node node_;
@@ -106,6 +119,7 @@ private:
   Runtime::RandomGenerator& random_;
   MonotonicTimeSource& time_source_;
   BackOffStrategyPtr backoff_strategy_;
+  const bool incremental_;
 };
 
 class NullGrpcMuxImpl : public GrpcMux {
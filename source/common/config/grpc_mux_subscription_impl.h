@@ -1,11 +1,14 @@
 #pragma once
 
+#include <algorithm>
+
 #include "envoy/api/v2/discovery.pb.h"
 #include "envoy/config/grpc_mux.h"
 #include "envoy/config/subscription.h"
 
 #include "common/common/assert.h"
 #include "common/common/logger.h"
+#include "common/common/thread.h"
 #include "common/grpc/common.h"
 #include "common/protobuf/protobuf.h"
 #include "common/protobuf/utility.h"
@@ -21,9 +24,17 @@ class GrpcMuxSubscriptionImpl : public Subscription<ResourceType>,
                                 GrpcMuxCallbacks,
                                 Logger::Loggable<Logger::Id::config> {
 public:
-  GrpcMuxSubscriptionImpl(GrpcMux& grpc_mux, SubscriptionStats stats)
+  /**
+   * @param grpc_mux supplies the mux to subscribe through.
+   * @param stats supplies the subscription stats.
+   * @param parse_threads supplies the maximum number of threads, including the main thread, that
+   *        the resources of an update are decoded on. Only updates with enough resources to keep
+   *        the threads busy are decoded on more than one.
+   */
+  GrpcMuxSubscriptionImpl(GrpcMux& grpc_mux, SubscriptionStats stats, uint32_t parse_threads = 1)
       : grpc_mux_(grpc_mux), stats_(stats),
-        type_url_(Grpc::Common::typeUrl(ResourceType().GetDescriptor()->full_name())) {}
+        type_url_(Grpc::Common::typeUrl(ResourceType().GetDescriptor()->full_name())),
+        parse_threads_(parse_threads) {}
 
   // Config::Subscription
   void start(const std::vector<std::string>& resources,
@@ -45,9 +56,7 @@ public:
   void onConfigUpdate(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
                       const std::string& version_info) override {
     Protobuf::RepeatedPtrField<ResourceType> typed_resources;
-    std::transform(resources.cbegin(), resources.cend(),
-                   Protobuf::RepeatedPtrFieldBackInserter(&typed_resources),
-                   MessageUtil::anyConvert<ResourceType>);
+    convertResources(resources, typed_resources);
     // TODO(mattklein123): In the future if we start tracking per-resource versions, we need to
     // supply those versions to onConfigUpdate() along with the xDS response ("system")
     // version_info. This way, both types of versions can be tracked and exposed for debugging by
@@ -60,6 +69,20 @@ public:
               resources.size(), RepeatedPtrUtil::debugString(typed_resources));
   }
 
+  void onConfigUpdate(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& added_resources,
+                      const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+                      const std::string& version_info) override {
+    Protobuf::RepeatedPtrField<ResourceType> typed_resources;
+    convertResources(added_resources, typed_resources);
+    callbacks_->onConfigUpdate(typed_resources, removed_resources, version_info);
+    stats_.update_success_.inc();
+    stats_.update_attempt_.inc();
+    stats_.version_.set(HashUtil::xxHash64(version_info));
+    ENVOY_LOG(debug, "gRPC config for {} accepted with {} added and {} removed resources: {}",
+              type_url_, added_resources.size(), removed_resources.size(),
+              RepeatedPtrUtil::debugString(typed_resources));
+  }
+
   void onConfigUpdateFailed(const EnvoyException* e) override {
     // TODO(htuch): Less fragile signal that this is failure vs. reject.
     if (e == nullptr) {
@@ -78,9 +101,29 @@ public:
   }
 
 private:
+  void convertResources(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
+                        Protobuf::RepeatedPtrField<ResourceType>& typed_resources) {
+    typed_resources.Reserve(resources.size());
+    for (int i = 0; i < resources.size(); i++) {
+      typed_resources.Add();
+    }
+    // Resources are independent of each other, so that large updates can be decoded in parallel.
+    const uint32_t concurrency = std::max<uint32_t>(
+        1, std::min<uint32_t>(parse_threads_, resources.size() / MIN_RESOURCES_PER_PARSE_THREAD));
+    Thread::parallelFor(resources.size(), concurrency,
+                        [&resources, &typed_resources](size_t i) -> void {
+                          *typed_resources.Mutable(i) =
+                              MessageUtil::anyConvert<ResourceType>(resources[i]);
+                        });
+  }
+
+  // Below this many resources per thread, starting a thread costs more than it saves.
+  static constexpr uint32_t MIN_RESOURCES_PER_PARSE_THREAD = 64;
+
   GrpcMux& grpc_mux_;
   SubscriptionStats stats_;
   const std::string type_url_;
+  const uint32_t parse_threads_;
   SubscriptionCallbacks<ResourceType>* callbacks_{};
   GrpcMuxWatchPtr watch_{};
 };
@@ -33,13 +33,16 @@ public:
    *        description).
    * @param grpc_method fully qualified name of v2 gRPC API bidi streaming method (as per protobuf
    *        service description).
+   * @param parse_threads maximum number of threads that resources received over gRPC (including
+   *        ADS) are decoded on.
    */
   template <class ResourceType>
   static std::unique_ptr<Subscription<ResourceType>> subscriptionFromConfigSource(
       const envoy::api::v2::core::ConfigSource& config, const envoy::api::v2::core::Node& node,
       Event::Dispatcher& dispatcher, Upstream::ClusterManager& cm, Runtime::RandomGenerator& random,
       Stats::Scope& scope, std::function<Subscription<ResourceType>*()> rest_legacy_constructor,
-      const std::string& rest_method, const std::string& grpc_method) {
+      const std::string& rest_method, const std::string& grpc_method,
+      uint32_t parse_threads = 1) {
     std::unique_ptr<Subscription<ResourceType>> result;
     SubscriptionStats stats = Utility::generateStats(scope);
     switch (config.config_source_specifier_case()) {
@@ -69,7 +72,8 @@ public:
                                                            config.api_config_source(), scope)
                 ->create(),
             dispatcher, random,
-            *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(grpc_method), stats));
+            *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(grpc_method), stats,
+            parse_threads));
         break;
       }
       default:
@@ -78,7 +82,7 @@ public:
       break;
     }
     case envoy::api::v2::core::ConfigSource::kAds: {
-      result.reset(new GrpcMuxSubscriptionImpl<ResourceType>(cm.adsMux(), stats));
+      result.reset(new GrpcMuxSubscriptionImpl<ResourceType>(cm.adsMux(), stats, parse_threads));
       break;
     }
     default:
@@ -61,6 +61,8 @@ class MetadataFilterValues {
 public:
   // Filter namespace for built-in load balancer.
   const std::string ENVOY_LB = "envoy.lb";
+  // Filter namespace for upstream connection pool tuning on cluster metadata.
+  const std::string ENVOY_CONN_POOL = "envoy.conn_pool";
 };
 
 typedef ConstSingleton<MetadataFilterValues> MetadataFilters;
@@ -76,6 +78,21 @@ public:
 
 typedef ConstSingleton<MetadataEnvoyLbKeyValues> MetadataEnvoyLbKeys;
 
+/**
+ * Keys for MetadataFilterValues::ENVOY_CONN_POOL metadata.
+ */
+class MetadataEnvoyConnPoolKeyValues {
+public:
+  // Key in envoy.conn_pool filter namespace for the number value of connections kept established
+  // per unit of demand. Must be >= 1.0.
+  const std::string PREFETCH_RATIO = "prefetch_ratio";
+  // Key in envoy.conn_pool filter namespace for the number value of connections established per
+  // host ahead of demand.
+  const std::string WARM_CONNECTIONS = "warm_connections";
+};
+
+typedef ConstSingleton<MetadataEnvoyConnPoolKeyValues> MetadataEnvoyConnPoolKeys;
+
 /**
  * Well known tags values and a mapping from these names to the regexes they
  * represent. Note: when names are added to the list, they also must be added to
@@ -24,6 +24,7 @@
 #include "envoy/upstream/upstream.h"
 
 #include "common/buffer/watermark_buffer.h"
+#include "common/common/arena_impl.h"
 #include "common/common/linked_object.h"
 #include "common/grpc/common.h"
 #include "common/http/conn_manager_config.h"
@@ -92,6 +93,14 @@ private:
         : parent_(parent), headers_continued_(false), continue_headers_continued_(false),
           stopped_(false), dual_filter_(dual_filter) {}
 
+    // Wrappers are always constructed in the owning stream's arena, which releases their memory
+    // when the stream is destroyed. Deleting a wrapper only runs its destructor.
+    static void* operator new(size_t size, Arena& arena) {
+      return arena.allocate(size, alignof(std::max_align_t));
+    }
+    static void operator delete(void*, Arena&) {}
+    static void operator delete(void*) {}
+
     bool commonHandleAfter100ContinueHeadersCallback(FilterHeadersStatus status);
     bool commonHandleAfterHeadersCallback(FilterHeadersStatus status);
     void commonHandleBufferData(Buffer::Instance& provided_data);
@@ -304,6 +313,7 @@ private:
       addStreamEncoderFilterWorker(filter, true);
     }
     void addAccessLogHandler(AccessLog::InstanceSharedPtr handler) override;
+    Arena& arena() override { return arena_; }
 
     // Http::WebSocketProxyCallbacks
     void sendHeadersOnlyResponse(HeaderMap& headers) override {
@@ -364,6 +374,9 @@ private:
     bool createFilterChain();
 
     ConnectionManagerImpl& connection_manager_;
+    // Holds the filter wrappers and any filters that opt into it. Declared first so that it is
+    // destroyed after everything that may reference memory in it.
+    InlineArenaImpl<1024> arena_{4096};
     Router::ConfigConstSharedPtr snapped_route_config_;
     Tracing::SpanPtr active_span_;
     const uint64_t stream_id_;
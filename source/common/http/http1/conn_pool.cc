@@ -1,5 +1,6 @@
 #include "common/http/http1/conn_pool.h"
 
+#include <cmath>
 #include <cstdint>
 #include <list>
 
@@ -81,12 +82,45 @@ void ConnPoolImpl::createNewConnection() {
   client->moveIntoList(std::move(client), busy_clients_);
 }
 
+void ConnPoolImpl::maybePrefetch() {
+  const float ratio = host_->cluster().prefetchRatio();
+  if (ratio <= 1.0) {
+    return;
+  }
+
+  // Demand is every request that is either bound to a connection or waiting for one. Connections
+  // that are still connecting count as supply so that a burst does not overshoot the ratio.
+  const uint64_t demand = active_streams_ + pending_requests_.size();
+  const uint64_t target = static_cast<uint64_t>(std::ceil(ratio * demand));
+  while (ready_clients_.size() + busy_clients_.size() < target &&
+         host_->cluster().resourceManager(priority_).connections().canCreate()) {
+    ENVOY_LOG(debug, "prefetching a new connection");
+    createNewConnection();
+    host_->cluster().stats().upstream_cx_prefetch_.inc();
+  }
+}
+
+void ConnPoolImpl::prefetchConnections() {
+  const uint32_t warm_connections = host_->cluster().warmConnections();
+  while (drained_callbacks_.empty() &&
+         ready_clients_.size() + busy_clients_.size() < warm_connections &&
+         host_->cluster().resourceManager(priority_).connections().canCreate()) {
+    ENVOY_LOG(debug, "prefetching a new connection");
+    createNewConnection();
+    host_->cluster().stats().upstream_cx_prefetch_.inc();
+  }
+}
+
 ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_decoder,
                                                      ConnectionPool::Callbacks& callbacks) {
   if (!ready_clients_.empty()) {
+    // Idle clients are pushed onto the front of the ready list, so the front is the most recently
+    // used connection. Reusing it lets the least recently used connections at the back age out
+    // via the cluster idle timeout instead of being kept warm by round-robin reuse.
     ready_clients_.front()->moveBetweenLists(ready_clients_, busy_clients_);
     ENVOY_CONN_LOG(debug, "using existing connection", *busy_clients_.front()->codec_client_);
     attachRequestToClient(*busy_clients_.front(), response_decoder, callbacks);
+    maybePrefetch();
     return nullptr;
   }
 
@@ -105,7 +139,9 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_dec
     ENVOY_LOG(debug, "queueing request due to no available connections");
     PendingRequestPtr pending_request(new PendingRequest(*this, response_decoder, callbacks));
     pending_request->moveIntoList(std::move(pending_request), pending_requests_);
-    return pending_requests_.front().get();
+    ConnectionPool::Cancellable* handle = pending_requests_.front().get();
+    maybePrefetch();
+    return handle;
   } else {
     ENVOY_LOG(debug, "max pending requests overflow");
     callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, nullptr);
@@ -265,6 +301,7 @@ ConnPoolImpl::StreamWrapper::StreamWrapper(StreamDecoder& response_decoder, Acti
       StreamDecoderWrapper(response_decoder), parent_(parent) {
 
   StreamEncoderWrapper::inner_.getStream().addCallbacks(*this);
+  parent_.parent_.active_streams_++;
   parent_.parent_.host_->cluster().stats().upstream_rq_total_.inc();
   parent_.parent_.host_->cluster().stats().upstream_rq_active_.inc();
   parent_.parent_.host_->stats().rq_total_.inc();
@@ -272,6 +309,8 @@ ConnPoolImpl::StreamWrapper::StreamWrapper(StreamDecoder& response_decoder, Acti
 }
 
 ConnPoolImpl::StreamWrapper::~StreamWrapper() {
+  ASSERT(parent_.parent_.active_streams_ > 0);
+  parent_.parent_.active_streams_--;
   parent_.parent_.host_->cluster().stats().upstream_rq_active_.dec();
   parent_.parent_.host_->stats().rq_active_.dec();
 }
@@ -38,6 +38,16 @@ void ConnPoolImpl::ConnPoolImpl::drainConnections() {
   }
 }
 
+void ConnPoolImpl::prefetchConnections() {
+  // All streams are multiplexed over the primary client, so warming the pool means establishing
+  // the primary client ahead of the first request.
+  if (host_->cluster().warmConnections() > 0 && !primary_client_ && drained_callbacks_.empty()) {
+    ENVOY_LOG(debug, "prefetching a new connection");
+    primary_client_.reset(new ActiveClient(*this));
+    host_->cluster().stats().upstream_cx_prefetch_.inc();
+  }
+}
+
 void ConnPoolImpl::addDrainedCallback(DrainedCb cb) {
   drained_callbacks_.push_back(cb);
   checkForDrained();
@@ -0,0 +1,74 @@
+#include "common/network/cidr_set.h"
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+
+namespace Envoy {
+namespace Network {
+namespace Address {
+
+namespace {
+
+std::vector<CidrRange> parseSubnets(const std::vector<std::string>& subnets) {
+  std::vector<CidrRange> ranges;
+  ranges.reserve(subnets.size());
+  for (const std::string& entry : subnets) {
+    CidrRange range = CidrRange::create(entry);
+    if (!range.isValid()) {
+      throw EnvoyException(
+          fmt::format("invalid ip/mask combo '{}' (format is <ip>/<# mask bits>)", entry));
+    }
+    ranges.push_back(range);
+  }
+  return ranges;
+}
+
+std::vector<CidrRange>
+parseCidrs(const Protobuf::RepeatedPtrField<envoy::api::v2::core::CidrRange>& cidrs) {
+  std::vector<CidrRange> ranges;
+  ranges.reserve(cidrs.size());
+  for (const envoy::api::v2::core::CidrRange& entry : cidrs) {
+    CidrRange range = CidrRange::create(entry);
+    if (!range.isValid()) {
+      throw EnvoyException(
+          fmt::format("invalid ip/mask combo '{}/{}' (format is <ip>/<# mask bits>)",
+                      entry.address_prefix(), entry.prefix_len().value()));
+    }
+    ranges.push_back(range);
+  }
+  return ranges;
+}
+
+} // namespace
+
+CidrSet::CidrSet(const std::vector<CidrRange>& ranges) {
+  for (const CidrRange& range : ranges) {
+    ASSERT(range.isValid());
+  }
+  if (!ranges.empty()) {
+    trie_ = std::make_unique<const LcTrie::LcTrie<bool>>(
+        std::vector<std::pair<bool, std::vector<CidrRange>>>{{true, ranges}});
+  }
+}
+
+CidrSet::CidrSet(const std::vector<std::string>& subnets) : CidrSet(parseSubnets(subnets)) {}
+
+CidrSet::CidrSet(const Json::Object& config, const std::string& member_name)
+    : CidrSet(config.hasObject(member_name) ? config.getStringArray(member_name)
+                                            : std::vector<std::string>()) {}
+
+CidrSet::CidrSet(const Protobuf::RepeatedPtrField<envoy::api::v2::core::CidrRange>& cidrs)
+    : CidrSet(parseCidrs(cidrs)) {}
+
+bool CidrSet::contains(const Instance& address) const {
+  if (trie_ == nullptr || address.type() != Type::Ip) {
+    return false;
+  }
+  return trie_->contains(*address.ip());
+}
+
+} // namespace Address
+} // namespace Network
+} // namespace Envoy
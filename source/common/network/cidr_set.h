@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/api/v2/core/address.pb.h"
+#include "envoy/json/json_object.h"
+#include "envoy/network/address.h"
+
+#include "common/network/cidr_range.h"
+#include "common/network/lc_trie.h"
+#include "common/protobuf/protobuf.h"
+
+namespace Envoy {
+namespace Network {
+namespace Address {
+
+/**
+ * An immutable set of CIDR ranges, compiled into a Level Compressed Trie when it is constructed
+ * (i.e. at config load), so that checking whether an address is in any of the ranges takes a
+ * handful of steps however many ranges there are. Unlike IpList, which checks each range in turn,
+ * this is meant for lists that can hold thousands of ranges.
+ */
+class CidrSet {
+public:
+  /**
+   * @param ranges supplies the CIDR ranges, which must all be valid.
+   */
+  CidrSet(const std::vector<CidrRange>& ranges);
+
+  /**
+   * @throw EnvoyException if a range is not valid.
+   */
+  CidrSet(const std::vector<std::string>& subnets);
+  CidrSet(const Json::Object& config, const std::string& member_name);
+  CidrSet(const Protobuf::RepeatedPtrField<envoy::api::v2::core::CidrRange>& cidrs);
+  CidrSet() {}
+
+  /**
+   * @param address supplies the address to look up.
+   * @return true if address is an IP address that is in one of the ranges.
+   */
+  bool contains(const Instance& address) const;
+
+  /**
+   * @return true if there are no ranges in the set.
+   */
+  bool empty() const { return trie_ == nullptr; }
+
+private:
+  std::unique_ptr<const LcTrie::LcTrie<bool>> trie_;
+};
+
+} // namespace Address
+} // namespace Network
+} // namespace Envoy
@@ -94,14 +94,21 @@ void ConnectionImpl::close(ConnectionCloseType type) {
     return;
   }
 
-  uint64_t data_to_write = write_buffer_->length();
+  uint64_t data_to_write = write_buffer_->length() + spliceWriteLength();
   ENVOY_CONN_LOG(debug, "closing data_to_write={} type={}", *this, data_to_write, enumToInt(type));
   if (data_to_write == 0 || type == ConnectionCloseType::NoFlush ||
       !transport_socket_->canFlushClose()) {
     if (data_to_write > 0) {
       // We aren't going to wait to flush, but try to write as much as we can if there is pending
       // data.
-      transport_socket_->doWrite(*write_buffer_, true);
+      if (splice_write_pipe_ != nullptr) {
+        transport_socket_->doWrite(*write_buffer_, false);
+        if (write_buffer_->length() == 0) {
+          splice_write_pipe_->writeTo(fd());
+        }
+      } else {
+        transport_socket_->doWrite(*write_buffer_, true);
+      }
     }
 
     closeSocket(ConnectionEvent::LocalClose);
@@ -132,6 +139,7 @@ void ConnectionImpl::closeSocket(ConnectionEvent close_type) {
 
   ENVOY_CONN_LOG(debug, "closing socket: {}", *this, static_cast<uint32_t>(close_type));
   transport_socket_->closeSocket(close_type);
+  stopSplice();
 
   // Drain input and output buffers.
   updateReadBufferStats(0, 0);
@@ -341,6 +349,114 @@ void ConnectionImpl::write(Buffer::Instance& data, bool end_stream) {
   }
 }
 
+bool ConnectionImpl::startSplice(Connection& peer) {
+  ConnectionImpl* peer_impl = dynamic_cast<ConnectionImpl*>(&peer);
+  if (peer_impl == nullptr || peer_impl == this || !canSplice() || !peer_impl->canSplice()) {
+    return false;
+  }
+
+  // Each pipe stands in for the write buffer of the connection it drains to, so it is sized by
+  // that connection's limit.
+  SplicePipeSharedPtr to_peer = SplicePipe::create(peer_impl->read_buffer_limit_);
+  SplicePipeSharedPtr from_peer = SplicePipe::create(read_buffer_limit_);
+  if (to_peer == nullptr || from_peer == nullptr) {
+    return false;
+  }
+
+  ENVOY_CONN_LOG(debug, "splicing with connection {}", *this, peer_impl->id());
+  splice_peer_ = peer_impl;
+  peer_impl->splice_peer_ = this;
+  splice_read_pipe_ = peer_impl->splice_write_pipe_ = to_peer;
+  splice_write_pipe_ = peer_impl->splice_read_pipe_ = from_peer;
+  return true;
+}
+
+bool ConnectionImpl::canSplice() const {
+  // Spliced bytes bypass the transport socket and every filter. A single read filter is the one
+  // asking to splice; it only sees end_stream from then on.
+  return state() == State::Open && !connecting_ && splice_peer_ == nullptr &&
+         splice_write_pipe_ == nullptr &&
+         dynamic_cast<const RawBufferSocket*>(transport_socket_.get()) != nullptr &&
+         filter_manager_.numReadFilters() <= 1 && filter_manager_.numWriteFilters() == 0 &&
+         read_buffer_.length() == 0 && !read_end_stream_ && !write_end_stream_;
+}
+
+IoResult ConnectionImpl::doSpliceRead() {
+  // The peer activates read events as it drains the pipe, which may race with readDisable().
+  if (!read_enabled_) {
+    return {PostIoAction::KeepOpen, 0, false};
+  }
+
+  SplicePipe& pipe = *splice_read_pipe_;
+  ConnectionImpl& peer = *splice_peer_;
+  IoResult result = pipe.readFrom(fd());
+  if (result.bytes_processed_ > 0) {
+    peer.updateWriteBufferStats(0, peer.write_buffer_->length() + pipe.length());
+    peer.file_event_->activate(Event::FileReadyType::Write);
+  }
+  if (pipe.aboveHighWatermark() && !peer.above_high_watermark_) {
+    peer.onHighWatermark();
+  }
+  return result;
+}
+
+IoResult ConnectionImpl::doSpliceWrite() {
+  // Hold a reference: watermark callbacks may close either connection.
+  SplicePipeSharedPtr pipe = splice_write_pipe_;
+
+  // Anything written before splicing started goes ahead of the spliced bytes. Once splicing, the
+  // only thing written is end_stream, which must follow them.
+  IoResult result{PostIoAction::KeepOpen, 0, false};
+  if (write_buffer_->length() > 0) {
+    result = transport_socket_->doWrite(*write_buffer_, false);
+    if (result.action_ != PostIoAction::KeepOpen || write_buffer_->length() > 0) {
+      return result;
+    }
+  }
+
+  const IoResult spliced = pipe->writeTo(fd());
+  result.action_ = spliced.action_;
+  result.bytes_processed_ += spliced.bytes_processed_;
+  if (spliced.bytes_processed_ > 0) {
+    if (above_high_watermark_ && pipe->belowLowWatermark()) {
+      onLowWatermark();
+    }
+    // Data the peer left in its socket because the pipe was full raises no new read event.
+    if (splice_peer_ != nullptr && splice_peer_->read_enabled_) {
+      splice_peer_->file_event_->activate(Event::FileReadyType::Read);
+    }
+  }
+
+  if (fd() != -1 && result.action_ == PostIoAction::KeepOpen && pipe->length() == 0) {
+    if (splice_peer_ == nullptr) {
+      splice_write_pipe_.reset();
+    }
+    if (write_end_stream_) {
+      result.action_ = transport_socket_->doWrite(*write_buffer_, true).action_;
+    }
+  }
+  return result;
+}
+
+void ConnectionImpl::stopSplice() {
+  if (splice_peer_ == nullptr) {
+    splice_write_pipe_.reset();
+    return;
+  }
+
+  // Bytes this connection read are still owed to the peer, which keeps draining its write pipe.
+  // Bytes the peer reads from now on go through its read filters again.
+  ConnectionImpl& peer = *splice_peer_;
+  splice_peer_ = nullptr;
+  peer.splice_peer_ = nullptr;
+  splice_read_pipe_.reset();
+  splice_write_pipe_.reset();
+  peer.splice_read_pipe_.reset();
+  if (peer.read_enabled_) {
+    peer.file_event_->activate(Event::FileReadyType::Read);
+  }
+}
+
 void ConnectionImpl::setBufferLimits(uint32_t limit) {
   read_buffer_limit_ = limit;
 
@@ -428,7 +544,8 @@ void ConnectionImpl::onReadReady() {
 
   ASSERT(!connecting_);
 
-  IoResult result = transport_socket_->doRead(read_buffer_);
+  IoResult result = splice_read_pipe_ != nullptr ? doSpliceRead()
+                                                 : transport_socket_->doRead(read_buffer_);
   uint64_t new_buffer_size = read_buffer_.length();
   updateReadBufferStats(result.bytes_processed_, new_buffer_size);
 
@@ -478,9 +595,11 @@ void ConnectionImpl::onWriteReady() {
     }
   }
 
-  IoResult result = transport_socket_->doWrite(*write_buffer_, write_end_stream_);
+  IoResult result = splice_write_pipe_ != nullptr
+                        ? doSpliceWrite()
+                        : transport_socket_->doWrite(*write_buffer_, write_end_stream_);
   ASSERT(!result.end_stream_read_); // The interface guarantees that only read operations set this.
-  uint64_t new_buffer_size = write_buffer_->length();
+  uint64_t new_buffer_size = write_buffer_->length() + spliceWriteLength();
   updateWriteBufferStats(result.bytes_processed_, new_buffer_size);
 
   if (result.action_ == PostIoAction::Close) {
@@ -530,7 +649,8 @@ void ConnectionImpl::updateWriteBufferStats(uint64_t num_written, uint64_t new_s
 
 bool ConnectionImpl::bothSidesHalfClosed() {
   // If the write_buffer_ is not empty, then the end_stream has not been sent to the transport yet.
-  return read_end_stream_ && write_end_stream_ && write_buffer_->length() == 0;
+  return read_end_stream_ && write_end_stream_ && write_buffer_->length() == 0 &&
+         spliceWriteLength() == 0;
 }
 
 ClientConnectionImpl::ClientConnectionImpl(
@@ -14,6 +14,7 @@
 #include "common/common/logger.h"
 #include "common/event/libevent.h"
 #include "common/network/filter_manager_impl.h"
+#include "common/network/splice_pipe.h"
 #include "common/ssl/ssl_socket.h"
 
 #include "absl/types/optional.h"
@@ -82,6 +83,7 @@ public:
   const Ssl::Connection* ssl() const override { return transport_socket_->ssl(); }
   State state() const override;
   void write(Buffer::Instance& data, bool end_stream) override;
+  bool startSplice(Connection& peer) override;
   void setBufferLimits(uint32_t limit) override;
   uint32_t bufferLimit() const override { return read_buffer_limit_; }
   bool localAddressRestored() const override { return socket_->localAddressRestored(); }
@@ -143,6 +145,13 @@ private:
   void onWriteReady();
   void updateReadBufferStats(uint64_t num_read, uint64_t new_size);
   void updateWriteBufferStats(uint64_t num_written, uint64_t new_size);
+  bool canSplice() const;
+  IoResult doSpliceRead();
+  IoResult doSpliceWrite();
+  void stopSplice();
+  uint64_t spliceWriteLength() const {
+    return splice_write_pipe_ != nullptr ? splice_write_pipe_->length() : 0;
+  }
 
   // Returns true iff end of stream has been both written and read.
   bool bothSidesHalfClosed();
@@ -170,6 +179,12 @@ private:
   // readDisabled(true) this allows the connection to only resume reads when readDisabled(false)
   // has been called N times.
   uint32_t read_disable_count_{0};
+  // Set while data is spliced between this connection and splice_peer_. The read pipe is filled
+  // from this connection's socket and drained by the peer; the write pipe is the reverse. The
+  // write pipe outlives the peer until the bytes it holds have been written.
+  ConnectionImpl* splice_peer_{};
+  SplicePipeSharedPtr splice_read_pipe_;
+  SplicePipeSharedPtr splice_write_pipe_;
 };
 
 /**
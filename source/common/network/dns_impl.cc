@@ -1,9 +1,12 @@
 #include "common/network/dns_impl.h"
 
+#include <arpa/inet.h>
+#include <arpa/nameser.h>
 #include <netdb.h>
 #include <netinet/ip.h>
 #include <sys/socket.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <list>
@@ -22,8 +25,9 @@ namespace Network {
 
 DnsResolverImpl::DnsResolverImpl(
     Event::Dispatcher& dispatcher,
-    const std::vector<Network::Address::InstanceConstSharedPtr>& resolvers)
-    : dispatcher_(dispatcher),
+    const std::vector<Network::Address::InstanceConstSharedPtr>& resolvers,
+    MonotonicTimeSource& time_source)
+    : dispatcher_(dispatcher), time_source_(time_source),
       timer_(dispatcher.createTimer([this] { onEventCallback(ARES_SOCKET_BAD, 0); })) {
   // This is also done in main(), to satisfy the requirement that c-ares is
   // initialized prior to threading. The additional call to ares_library_init()
@@ -74,67 +78,155 @@ void DnsResolverImpl::initializeChannel(ares_options* options, int optmask) {
   ares_init_options(&channel_, options, optmask | ARES_OPT_SOCK_STATE_CB);
 }
 
-void DnsResolverImpl::PendingResolution::onAresHostCallback(int status, int timeouts,
-                                                            hostent* hostent) {
-  // We receive ARES_EDESTRUCTION when destructing with pending queries.
+namespace {
+
+// A cached answer that is used within the last 1/PrefetchDivisor of its TTL gets refreshed.
+const int PrefetchDivisor = 10;
+
+// Upper bound on the number of answer TTLs looked at per response.
+const int MaxAddrTtls = 64;
+
+Address::InstanceConstSharedPtr addressFromBytes(int family, const void* bytes) {
+  if (family == AF_INET) {
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = 0;
+    address.sin_addr = *static_cast<const in_addr*>(bytes);
+    return std::make_shared<Address::Ipv4Instance>(&address);
+  }
+  ASSERT(family == AF_INET6);
+  sockaddr_in6 address;
+  memset(&address, 0, sizeof(address));
+  address.sin6_family = AF_INET6;
+  address.sin6_port = 0;
+  address.sin6_addr = *static_cast<const in6_addr*>(bytes);
+  return std::make_shared<Address::Ipv6Instance>(address);
+}
+
+std::list<Address::InstanceConstSharedPtr> addressListFromHostent(const hostent& hostent) {
+  std::list<Address::InstanceConstSharedPtr> address_list;
+  if (hostent.h_addrtype == AF_INET || hostent.h_addrtype == AF_INET6) {
+    ASSERT(static_cast<size_t>(hostent.h_length) ==
+           (hostent.h_addrtype == AF_INET ? sizeof(in_addr) : sizeof(in6_addr)));
+    for (int i = 0; hostent.h_addr_list[i] != nullptr; ++i) {
+      address_list.emplace_back(addressFromBytes(hostent.h_addrtype, hostent.h_addr_list[i]));
+    }
+  }
+  return address_list;
+}
+
+// Parse an A or AAAA response. The TTL of the answer is the smallest TTL of its records.
+std::chrono::seconds parseReply(int family, const unsigned char* abuf, int alen,
+                                std::list<Address::InstanceConstSharedPtr>& address_list) {
+  hostent* hostent = nullptr;
+  int naddrttls = MaxAddrTtls;
+  int ttl = 0;
+  if (family == AF_INET) {
+    ares_addrttl addrttls[MaxAddrTtls];
+    if (ares_parse_a_reply(abuf, alen, &hostent, addrttls, &naddrttls) != ARES_SUCCESS) {
+      return std::chrono::seconds(0);
+    }
+    for (int i = 0; i < naddrttls; ++i) {
+      ttl = i == 0 ? addrttls[i].ttl : std::min(ttl, addrttls[i].ttl);
+    }
+  } else {
+    ares_addr6ttl addrttls[MaxAddrTtls];
+    if (ares_parse_aaaa_reply(abuf, alen, &hostent, addrttls, &naddrttls) != ARES_SUCCESS) {
+      return std::chrono::seconds(0);
+    }
+    for (int i = 0; i < naddrttls; ++i) {
+      ttl = i == 0 ? addrttls[i].ttl : std::min(ttl, addrttls[i].ttl);
+    }
+  }
+
+  address_list = addressListFromHostent(*hostent);
+  ares_free_hostent(hostent);
+  return std::chrono::seconds(std::max(ttl, 0));
+}
+
+std::string cacheKey(const std::string& dns_name, DnsLookupFamily dns_lookup_family) {
+  std::string key;
+  key.reserve(dns_name.size() + 1);
+  key.push_back('0' + static_cast<int>(dns_lookup_family));
+  key.append(dns_name);
+  return key;
+}
+
+} // namespace
+
+void DnsResolverImpl::Lookup::onAresSearchCallback(int status, int timeouts, unsigned char* abuf,
+                                                   int alen) {
+  // We receive ARES_EDESTRUCTION when destructing with pending queries. The lookup is freed
+  // along with lookups_.
   if (status == ARES_EDESTRUCTION) {
     ASSERT(owned_);
-    delete this;
     return;
   }
-  if (!fallback_if_failed_) {
-    completed_ = true;
-  }
 
   std::list<Address::InstanceConstSharedPtr> address_list;
+  std::chrono::seconds ttl(0);
   if (status == ARES_SUCCESS) {
-    if (hostent->h_addrtype == AF_INET) {
-      for (int i = 0; hostent->h_addr_list[i] != nullptr; ++i) {
-        ASSERT(hostent->h_length == sizeof(in_addr));
-        sockaddr_in address;
-        memset(&address, 0, sizeof(address));
-        address.sin_family = AF_INET;
-        address.sin_port = 0;
-        address.sin_addr = *reinterpret_cast<in_addr*>(hostent->h_addr_list[i]);
-        address_list.emplace_back(new Address::Ipv4Instance(&address));
-      }
-    } else if (hostent->h_addrtype == AF_INET6) {
-      for (int i = 0; hostent->h_addr_list[i] != nullptr; ++i) {
-        ASSERT(hostent->h_length == sizeof(in6_addr));
-        sockaddr_in6 address;
-        memset(&address, 0, sizeof(address));
-        address.sin6_family = AF_INET6;
-        address.sin6_port = 0;
-        address.sin6_addr = *reinterpret_cast<in6_addr*>(hostent->h_addr_list[i]);
-        address_list.emplace_back(new Address::Ipv6Instance(address));
-      }
-    }
-    if (!address_list.empty()) {
-      completed_ = true;
-    }
+    ttl = parseReply(family_, abuf, alen, address_list);
   }
 
   if (timeouts > 0) {
     ENVOY_LOG(debug, "DNS request timed out {} times", timeouts);
   }
 
-  if (completed_) {
-    if (!cancelled_) {
-      callback_(std::move(address_list));
+  if (address_list.empty() && fallback_if_failed_) {
+    fallback_if_failed_ = false;
+    search(AF_INET);
+    // Note: Nothing can follow this call to search due to deletion of this
+    // object upon synchronous resolution.
+    return;
+  }
+
+  completed_ = true;
+  parent_.onLookupComplete(*this, std::move(address_list), ttl);
+}
+
+void DnsResolverImpl::onLookupComplete(Lookup& lookup,
+                                       std::list<Address::InstanceConstSharedPtr>&& address_list,
+                                       std::chrono::seconds ttl) {
+  if (!address_list.empty() && ttl.count() > 0) {
+    const MonotonicTime now = time_source_.currentTime();
+    // Expired entries are otherwise only dropped on a miss for their own name. They are the first
+    // ones in cache_expiries_, so only those are visited.
+    while (!cache_expiries_.empty() && cache_expiries_.begin()->first <= now) {
+      eraseCacheEntry(cache_.find(cache_expiries_.begin()->second));
     }
-    if (owned_) {
-      delete this;
-      return;
+    auto cached = cache_.find(lookup.key_);
+    if (cached != cache_.end()) {
+      eraseCacheEntry(cached);
     }
+    const MonotonicTime expiry = now + ttl;
+    cache_[lookup.key_] = {address_list, expiry, ttl,
+                           cache_expiries_.emplace(expiry, lookup.key_)};
   }
 
-  if (!completed_ && fallback_if_failed_) {
-    fallback_if_failed_ = false;
-    getHostByName(AF_INET);
-    // Note: Nothing can follow this call to getHostByName due to deletion of this
-    // object upon synchronous resolution.
-    return;
+  // Take the lookup out of lookups_ before running any callback, so that a callback resolving the
+  // same name again does not wait on a query that has already completed.
+  LookupPtr owned_lookup;
+  if (lookup.owned_) {
+    auto it = lookups_.find(lookup.key_);
+    ASSERT(it != lookups_.end() && it->second.get() == &lookup);
+    owned_lookup = std::move(it->second);
+    lookups_.erase(it);
   }
+
+  for (const PendingResolutionPtr& waiter : lookup.waiters_) {
+    if (!waiter->cancelled_) {
+      std::list<Address::InstanceConstSharedPtr> results = address_list;
+      waiter->callback_(std::move(results));
+    }
+  }
+}
+
+void DnsResolverImpl::eraseCacheEntry(std::unordered_map<std::string, CacheEntry>::iterator it) {
+  ASSERT(it != cache_.end());
+  cache_expiries_.erase(it->second.expiry_it_);
+  cache_.erase(it);
 }
 
 void DnsResolverImpl::updateAresTimer() {
@@ -181,43 +273,105 @@ void DnsResolverImpl::onAresSocketStateChange(int fd, int read, int write) {
 
 ActiveDnsQuery* DnsResolverImpl::resolve(const std::string& dns_name,
                                          DnsLookupFamily dns_lookup_family, ResolveCb callback) {
-  // TODO(hennna): Add DNS caching which will allow testing the edge case of a
-  // failed intial call to getHostbyName followed by a synchronous IPv4
-  // resolution.
-  std::unique_ptr<PendingResolution> pending_resolution(
-      new PendingResolution(callback, channel_, dns_name));
+  const std::string key = cacheKey(dns_name, dns_lookup_family);
+  auto cached = cache_.find(key);
+  if (cached != cache_.end()) {
+    const MonotonicTime now = time_source_.currentTime();
+    if (now < cached->second.expiry_) {
+      std::list<Address::InstanceConstSharedPtr> address_list = cached->second.address_list_;
+      // Refresh an entry that is still in use shortly before it expires, so that its users do not
+      // have to wait on a query once it is gone.
+      if (cached->second.expiry_ - now <=
+              std::chrono::duration_cast<std::chrono::milliseconds>(cached->second.ttl_) /
+                  PrefetchDivisor &&
+          lookups_.find(key) == lookups_.end()) {
+        ENVOY_LOG(debug, "refreshing DNS cache entry for {}", dns_name);
+        startLookup(key, dns_name, dns_lookup_family, nullptr);
+      }
+      callback(std::move(address_list));
+      return nullptr;
+    }
+    eraseCacheEntry(cached);
+  }
+
+  auto in_flight = lookups_.find(key);
+  if (in_flight != lookups_.end()) {
+    in_flight->second->waiters_.emplace_back(new PendingResolution(callback));
+    return in_flight->second->waiters_.back().get();
+  }
+
+  // Resolution does not need asynchronous behavior or network events for IP address literals and
+  // names in the hosts file. For example, localhost lookup.
+  std::list<Address::InstanceConstSharedPtr> address_list;
+  if ((dns_lookup_family != DnsLookupFamily::V4Only &&
+       resolveLocally(dns_name, AF_INET6, address_list)) ||
+      (dns_lookup_family != DnsLookupFamily::V6Only &&
+       resolveLocally(dns_name, AF_INET, address_list))) {
+    callback(std::move(address_list));
+    return nullptr;
+  }
+
+  return startLookup(key, dns_name, dns_lookup_family, callback);
+}
+
+bool DnsResolverImpl::resolveLocally(const std::string& dns_name, int family,
+                                     std::list<Address::InstanceConstSharedPtr>& address_list) {
+  in6_addr literal;
+  if (inet_pton(family, dns_name.c_str(), &literal) == 1) {
+    address_list.emplace_back(addressFromBytes(family, &literal));
+    return true;
+  }
+
+  hostent* hostent = nullptr;
+  if (ares_gethostbyname_file(channel_, dns_name.c_str(), family, &hostent) != ARES_SUCCESS) {
+    return false;
+  }
+  address_list = addressListFromHostent(*hostent);
+  ares_free_hostent(hostent);
+  return !address_list.empty();
+}
+
+ActiveDnsQuery* DnsResolverImpl::startLookup(const std::string& key, const std::string& dns_name,
+                                             DnsLookupFamily dns_lookup_family,
+                                             ResolveCb callback) {
+  LookupPtr lookup(new Lookup(*this, key, dns_name));
+  PendingResolution* pending_resolution = nullptr;
+  if (callback) {
+    lookup->waiters_.emplace_back(new PendingResolution(callback));
+    pending_resolution = lookup->waiters_.back().get();
+  }
   if (dns_lookup_family == DnsLookupFamily::Auto) {
-    pending_resolution->fallback_if_failed_ = true;
+    lookup->fallback_if_failed_ = true;
   }
 
   if (dns_lookup_family == DnsLookupFamily::V4Only) {
-    pending_resolution->getHostByName(AF_INET);
+    lookup->search(AF_INET);
   } else {
-    pending_resolution->getHostByName(AF_INET6);
+    lookup->search(AF_INET6);
   }
 
-  if (pending_resolution->completed_) {
-    // Resolution does not need asynchronous behavior or network events. For
-    // example, localhost lookup.
+  if (lookup->completed_) {
+    // c-ares failed the query without any network events, and the callback has already run.
     return nullptr;
   } else {
     // Enable timer to wake us up if the request times out.
     updateAresTimer();
 
-    // The PendingResolution will self-delete when the request completes
-    // (including if cancelled or if ~DnsResolverImpl() happens).
-    pending_resolution->owned_ = true;
-    return pending_resolution.release();
+    // The Lookup is removed from lookups_ when the query completes (including
+    // if ~DnsResolverImpl() happens).
+    lookup->owned_ = true;
+    lookups_.emplace(key, std::move(lookup));
+    return pending_resolution;
   }
 }
 
-void DnsResolverImpl::PendingResolution::getHostByName(int family) {
-  ares_gethostbyname(channel_, dns_name_.c_str(), family,
-                     [](void* arg, int status, int timeouts, hostent* hostent) {
-                       static_cast<PendingResolution*>(arg)->onAresHostCallback(status, timeouts,
-                                                                                hostent);
-                     },
-                     this);
+void DnsResolverImpl::Lookup::search(int family) {
+  family_ = family;
+  ares_search(parent_.channel_, dns_name_.c_str(), ns_c_in, family == AF_INET ? ns_t_a : ns_t_aaaa,
+              [](void* arg, int status, int timeouts, unsigned char* abuf, int alen) {
+                static_cast<Lookup*>(arg)->onAresSearchCallback(status, timeouts, abuf, alen);
+              },
+              this);
 }
 
 } // namespace Network
@@ -2,10 +2,15 @@
 
 #include <netdb.h>
 
+#include <chrono>
 #include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
+#include "envoy/common/time.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/event/file_event.h"
 #include "envoy/network/dns.h"
@@ -24,11 +29,16 @@ class DnsResolverImplPeer;
 /**
  * Implementation of DnsResolver that uses c-ares. All calls and callbacks are assumed to
  * happen on the thread that owns the creating dispatcher.
+ *
+ * Answers are cached per name and lookup family for as long as their TTL allows. Concurrent
+ * resolutions of a name share one query, and a cached answer that is used shortly before it
+ * expires is refreshed in the background so that its users keep hitting the cache.
  */
 class DnsResolverImpl : public DnsResolver, protected Logger::Loggable<Logger::Id::upstream> {
 public:
   DnsResolverImpl(Event::Dispatcher& dispatcher,
-                  const std::vector<Network::Address::InstanceConstSharedPtr>& resolvers);
+                  const std::vector<Network::Address::InstanceConstSharedPtr>& resolvers,
+                  MonotonicTimeSource& time_source);
   ~DnsResolverImpl() override;
 
   // Network::DnsResolver
@@ -38,43 +48,72 @@ public:
 private:
   friend class DnsResolverImplPeer;
   struct PendingResolution : public ActiveDnsQuery {
-    // Network::ActiveDnsQuery
-    PendingResolution(ResolveCb callback, ares_channel channel, const std::string& dns_name)
-        : callback_(callback), channel_(channel), dns_name_(dns_name) {}
+    PendingResolution(ResolveCb callback) : callback_(callback) {}
 
+    // Network::ActiveDnsQuery
     void cancel() override {
       // c-ares only supports channel-wide cancellation, so we just allow the
       // network events to continue but don't invoke the callback on completion.
       cancelled_ = true;
     }
 
+    // Caller supplied callback to invoke on query completion or error.
+    const ResolveCb callback_;
+    // Was the query cancelled via cancel()?
+    bool cancelled_ = false;
+  };
+
+  typedef std::unique_ptr<PendingResolution> PendingResolutionPtr;
+
+  /**
+   * A query for one name and lookup family. Every resolve() of the name that comes in while the
+   * query is in flight waits on it.
+   */
+  struct Lookup {
+    Lookup(DnsResolverImpl& parent, const std::string& key, const std::string& dns_name)
+        : parent_(parent), key_(key), dns_name_(dns_name) {}
+
     /**
-     * c-ares ares_gethostbyname() query callback.
-     * @param status return status of call to ares_gethostbyname.
+     * c-ares ares_search() query callback.
+     * @param status return status of call to ares_search.
      * @param timeouts the number of times the request timed out.
-     * @param hostent structure that stores information about a given host.
+     * @param abuf the DNS response.
+     * @param alen the length of the DNS response.
      */
-    void onAresHostCallback(int status, int timeouts, hostent* hostent);
+    void onAresSearchCallback(int status, int timeouts, unsigned char* abuf, int alen);
     /**
-     * wrapper function of call to ares_gethostbyname.
+     * wrapper function of call to ares_search.
      * @param family currently AF_INET and AF_INET6 are supported.
      */
-    void getHostByName(int family);
+    void search(int family);
 
-    // Caller supplied callback to invoke on query completion or error.
-    const ResolveCb callback_;
-    // Does the object own itself? Resource reclamation occurs via self-deleting
-    // on query completion or error.
+    DnsResolverImpl& parent_;
+    const std::string key_;
+    const std::string dns_name_;
+    // The callers waiting on the query. Empty for a background refresh.
+    std::list<PendingResolutionPtr> waiters_;
+    // The family of the record type being queried.
+    int family_ = AF_UNSPEC;
+    // Is the object owned by lookups_? Resource reclamation occurs via removal
+    // from lookups_ on query completion.
     bool owned_ = false;
     // Has the query completed? Only meaningful if !owned_;
     bool completed_ = false;
-    // Was the query cancelled via cancel()?
-    bool cancelled_ = false;
     // If dns_lookup_family is "fallback", fallback to v4 address if v6
     // resolution failed.
     bool fallback_if_failed_ = false;
-    const ares_channel channel_;
-    const std::string dns_name_;
+  };
+
+  typedef std::unique_ptr<Lookup> LookupPtr;
+
+  // Cache keys by expiry, so that expired entries are found without a scan of the cache.
+  typedef std::multimap<MonotonicTime, std::string> CacheExpiries;
+
+  struct CacheEntry {
+    std::list<Address::InstanceConstSharedPtr> address_list_;
+    MonotonicTime expiry_;
+    std::chrono::seconds ttl_;
+    CacheExpiries::iterator expiry_it_;
   };
 
   // Callback for events on sockets tracked in events_.
@@ -86,11 +125,28 @@ private:
   void initializeChannel(ares_options* options, int optmask);
   // Update timer for c-ares timeouts.
   void updateAresTimer();
+  // Resolve an IP address literal or a name in the hosts file without a query.
+  bool resolveLocally(const std::string& dns_name, int family,
+                      std::list<Address::InstanceConstSharedPtr>& address_list);
+  // Start a query. A null callback refreshes the cache without a waiter.
+  ActiveDnsQuery* startLookup(const std::string& key, const std::string& dns_name,
+                              DnsLookupFamily dns_lookup_family, ResolveCb callback);
+  // Cache the answer of a completed query and hand it to the waiters.
+  void onLookupComplete(Lookup& lookup, std::list<Address::InstanceConstSharedPtr>&& address_list,
+                        std::chrono::seconds ttl);
+  // Remove an entry from cache_ and cache_expiries_.
+  void eraseCacheEntry(std::unordered_map<std::string, CacheEntry>::iterator it);
 
   Event::Dispatcher& dispatcher_;
+  MonotonicTimeSource& time_source_;
   Event::TimerPtr timer_;
   ares_channel channel_;
   std::unordered_map<int, Event::FileEventPtr> events_;
+  // In flight queries, keyed like cache_.
+  std::unordered_map<std::string, LookupPtr> lookups_;
+  // Answers with a non-zero TTL, keyed by lookup family and name.
+  std::unordered_map<std::string, CacheEntry> cache_;
+  CacheExpiries cache_expiries_;
 };
 
 } // namespace Network
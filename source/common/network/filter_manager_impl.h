@@ -47,6 +47,8 @@ public:
   bool initializeReadFilters();
   void onRead();
   FilterStatus onWrite();
+  size_t numReadFilters() const { return upstream_filters_.size(); }
+  size_t numWriteFilters() const { return downstream_filters_.size(); }
 
 private:
   struct ActiveReadFilter : public ReadFilterCallbacks, LinkedObject<ActiveReadFilter> {
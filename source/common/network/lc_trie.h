@@ -190,6 +190,20 @@ public:
     }
   }
 
+  /**
+   * Check whether any CIDR range contains `ip_address`, without copying the data associated with
+   * the ranges. Both IPv4 and IPv6 addresses are supported.
+   * @param ip_address supplies the IP address.
+   * @return true if a CIDR range contains ip_address, i.e. if getData() would return data.
+   */
+  bool contains(const Network::Address::Ip& ip_address) const {
+    if (ip_address.version() == Address::IpVersion::v4) {
+      return ipv4_trie_->findData(ntohl(ip_address.ipv4()->address())) != nullptr;
+    } else {
+      return ipv6_trie_->findData(Utility::Ip6ntohl(ip_address.ipv6()->address())) != nullptr;
+    }
+  }
+
 private:
   /**
    * Extract n bits from input starting at position p.
@@ -432,6 +446,13 @@ private:
      */
     std::vector<T> getData(const IpType& ip_address) const;
 
+    /**
+     * Find the data associated with the CIDR range that contains `ip_address`.
+     * @param  ip_address supplies the IP address in host byte order.
+     * @return the data, or nullptr if no CIDR range encompasses the input.
+     */
+    const DataSet* findData(const IpType& ip_address) const;
+
   private:
     /**
      * Builds the Level Compresesed Trie, by first sorting the data, removing duplicated
@@ -716,9 +737,19 @@ template <class T>
 template <class IpType, uint32_t address_size>
 std::vector<T>
 LcTrie<T>::LcTrieInternal<IpType, address_size>::getData(const IpType& ip_address) const {
-  std::vector<T> return_vector;
+  const DataSet* data = findData(ip_address);
+  if (data == nullptr) {
+    return std::vector<T>();
+  }
+  return std::vector<T>(data->begin(), data->end());
+}
+
+template <class T>
+template <class IpType, uint32_t address_size>
+const typename LcTrie<T>::DataSet*
+LcTrie<T>::LcTrieInternal<IpType, address_size>::findData(const IpType& ip_address) const {
   if (trie_.empty()) {
-    return return_vector;
+    return nullptr;
   }
 
   LcNode node = trie_[0];
@@ -741,10 +772,10 @@ LcTrie<T>::LcTrieInternal<IpType, address_size>::getData(const IpType& ip_addres
   // so it is necessary to check whether the the matched prefix really contains the
   // ip_address.
   const auto& prefix = ip_prefixes_[address];
-  if (prefix.contains(ip_address)) {
-    return std::vector<T>(prefix.data_.begin(), prefix.data_.end());
+  if (prefix.contains(ip_address) && !prefix.data_.empty()) {
+    return &prefix.data_;
   }
-  return std::vector<T>();
+  return nullptr;
 }
 
 } // namespace LcTrie
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common/utility.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Trie for associating data with server names, as requested through SNI. Each node of the trie is
+ * a label of a name, starting from the top-level domain, so that a lookup walks the requested name
+ * once from right to left, without building any strings, no matter how many exact names and
+ * wildcard domains were added.
+ *
+ * An exact name has precedence over a wildcard domain, and a longer wildcard domain has precedence
+ * over a shorter one, i.e. "www.example.com" is matched by "www.example.com", then by
+ * "*.example.com" and then by "*.com".
+ */
+template <class T> class ServerNameTrie {
+public:
+  /**
+   * @param server_name supplies an exact name (e.g. "www.example.com"), a wildcard domain
+   *        (e.g. "*.example.com") or an empty name, which matches any server name (including the
+   *        empty one) that nothing more specific matches.
+   * @return T& the data for server_name, default constructed if it wasn't added before.
+   */
+  T& operator[](absl::string_view server_name);
+
+  /**
+   * @param server_name supplies the requested server name.
+   * @return const T* the data of the best match for server_name, or nullptr if nothing matches.
+   */
+  const T* find(absl::string_view server_name) const;
+
+private:
+  struct Node {
+    // Keys point into the label of the child node.
+    std::unordered_map<absl::string_view, std::unique_ptr<Node>, StringViewHash> children_;
+    std::string label_;
+    std::unique_ptr<T> exact_;
+    std::unique_ptr<T> wildcard_;
+  };
+
+  Node root_;
+  std::unique_ptr<T> any_;
+};
+
+template <class T> T& ServerNameTrie<T>::operator[](absl::string_view server_name) {
+  std::unique_ptr<T>* data = &any_;
+  if (!server_name.empty()) {
+    const bool wildcard = absl::StartsWith(server_name, "*.");
+    const std::vector<absl::string_view> labels =
+        absl::StrSplit(wildcard ? server_name.substr(2) : server_name, '.');
+
+    Node* node = &root_;
+    for (auto label = labels.rbegin(); label != labels.rend(); ++label) {
+      auto child = node->children_.find(*label);
+      if (child == node->children_.end()) {
+        auto new_node = std::make_unique<Node>();
+        new_node->label_ = std::string(*label);
+        const absl::string_view key = new_node->label_;
+        child = node->children_.emplace(key, std::move(new_node)).first;
+      }
+      node = child->second.get();
+    }
+    data = wildcard ? &node->wildcard_ : &node->exact_;
+  }
+
+  if (*data == nullptr) {
+    *data = std::make_unique<T>();
+  }
+  return **data;
+}
+
+template <class T> const T* ServerNameTrie<T>::find(absl::string_view server_name) const {
+  const T* wildcard_match = nullptr;
+  if (!server_name.empty()) {
+    const Node* node = &root_;
+    size_t end = server_name.size();
+    while (true) {
+      const size_t dot = end > 0 ? server_name.rfind('.', end - 1) : absl::string_view::npos;
+      const size_t start = dot == absl::string_view::npos ? 0 : dot + 1;
+      const auto child = node->children_.find(server_name.substr(start, end - start));
+      if (child == node->children_.end()) {
+        break;
+      }
+      node = child->second.get();
+
+      if (dot == absl::string_view::npos) {
+        if (node->exact_ != nullptr) {
+          return node->exact_.get();
+        }
+        break;
+      }
+
+      // A wildcard domain only matches names with at least one more character in front of it,
+      // i.e. "*.example.com" matches "www.example.com", but neither ".example.com" nor
+      // "example.com".
+      if (node->wildcard_ != nullptr && dot > 0 && dot < server_name.size() - 1) {
+        wildcard_match = node->wildcard_.get();
+      }
+      end = dot;
+    }
+  }
+
+  if (wildcard_match != nullptr) {
+    return wildcard_match;
+  }
+  return any_.get();
+}
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,106 @@
+#include "common/network/splice_pipe.h"
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Network {
+
+SplicePipe::~SplicePipe() {
+  ::close(read_fd_);
+  ::close(write_fd_);
+}
+
+#ifdef __linux__
+
+SplicePipeSharedPtr SplicePipe::create(uint32_t buffer_limit) {
+  int fds[2];
+  if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+    return nullptr;
+  }
+  // Growing a pipe past /proc/sys/fs/pipe-max-size fails for unprivileged processes, in which case
+  // the pipe keeps its default size and the smaller capacity is what gets reported.
+  if (buffer_limit > 0) {
+    ::fcntl(fds[1], F_SETPIPE_SZ, buffer_limit);
+  }
+  const int capacity = ::fcntl(fds[1], F_GETPIPE_SZ);
+  if (capacity <= 0) {
+    ::close(fds[0]);
+    ::close(fds[1]);
+    return nullptr;
+  }
+  return SplicePipeSharedPtr{new SplicePipe(fds[0], fds[1], capacity)};
+}
+
+IoResult SplicePipe::readFrom(int fd) {
+  PostIoAction action = PostIoAction::KeepOpen;
+  uint64_t bytes_read = 0;
+  bool end_stream = false;
+  full_ = false;
+  while (true) {
+    if (length_ >= capacity_) {
+      full_ = true;
+      break;
+    }
+    const ssize_t rc = ::splice(fd, nullptr, write_fd_, nullptr, capacity_ - length_,
+                                SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (rc == 0) {
+      // Remote close.
+      end_stream = true;
+      break;
+    } else if (rc == -1) {
+      // EAGAIN means either that the socket has no data or that the pipe is full. Only a pipe
+      // that holds something can be full.
+      if (errno != EAGAIN) {
+        action = PostIoAction::Close;
+      } else if (length_ > 0) {
+        int queued = 0;
+        full_ = ::ioctl(fd, FIONREAD, &queued) == 0 && queued > 0;
+      }
+      break;
+    }
+    bytes_read += rc;
+    length_ += rc;
+  }
+
+  return {action, bytes_read, end_stream};
+}
+
+IoResult SplicePipe::writeTo(int fd) {
+  PostIoAction action = PostIoAction::KeepOpen;
+  uint64_t bytes_written = 0;
+  while (length_ > 0) {
+    const ssize_t rc =
+        ::splice(read_fd_, nullptr, fd, nullptr, length_, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (rc == -1) {
+      if (errno != EAGAIN) {
+        action = PostIoAction::Close;
+      }
+      break;
+    }
+    ASSERT(static_cast<uint64_t>(rc) <= length_);
+    bytes_written += rc;
+    length_ -= rc;
+    full_ = false;
+  }
+
+  return {action, bytes_written, false};
+}
+
+#else
+
+SplicePipeSharedPtr SplicePipe::create(uint32_t) { return nullptr; }
+
+IoResult SplicePipe::readFrom(int) { NOT_REACHED; }
+
+IoResult SplicePipe::writeTo(int) { NOT_REACHED; }
+
+#endif
+
+} // namespace Network
+} // namespace Envoy
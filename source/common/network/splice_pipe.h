@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/network/transport_socket.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Network {
+
+class SplicePipe;
+typedef std::shared_ptr<SplicePipe> SplicePipeSharedPtr;
+
+/**
+ * A kernel pipe used to move bytes from one plaintext TCP socket to another with splice(2), so
+ * that proxied data never has to be copied into user space. One connection splices what it reads
+ * into the pipe and its peer splices the pipe out to its own socket. The pipe takes the place of
+ * the peer's write buffer: its capacity is the peer's buffer limit, and the bytes it holds are
+ * reported as buffered for write.
+ */
+class SplicePipe : NonCopyable {
+public:
+  ~SplicePipe();
+
+  /**
+   * Create a pipe.
+   * @param buffer_limit supplies the buffer limit of the connection the pipe is drained to. The
+   *        pipe is sized to hold that many bytes where the kernel allows it. 0 keeps the default
+   *        pipe size.
+   * @return SplicePipeSharedPtr the new pipe, or nullptr if splicing is not available.
+   */
+  static SplicePipeSharedPtr create(uint32_t buffer_limit);
+
+  /**
+   * Move bytes from a socket into the pipe until the socket has nothing more to read or the pipe
+   * is full.
+   * @param fd supplies the socket to read from.
+   * @return IoResult the bytes spliced, with end_stream_read_ set on end of stream and a close
+   *         action on a socket error.
+   */
+  IoResult readFrom(int fd);
+
+  /**
+   * Move bytes from the pipe to a socket until the pipe is empty or the socket would block.
+   * @param fd supplies the socket to write to.
+   * @return IoResult the bytes spliced, with a close action on a socket error.
+   */
+  IoResult writeTo(int fd);
+
+  /**
+   * @return uint64_t the number of bytes in the pipe.
+   */
+  uint64_t length() const { return length_; }
+
+  /**
+   * @return uint64_t the number of bytes the pipe can hold.
+   */
+  uint64_t capacity() const { return capacity_; }
+
+  /**
+   * @return bool whether the last readFrom() stopped because the pipe was full, which the
+   *         draining connection reports as being above its write buffer high watermark. The
+   *         kernel can consider a pipe full before it holds its capacity in bytes, as every page
+   *         fragment takes up a slot.
+   */
+  bool aboveHighWatermark() const { return full_; }
+
+  /**
+   * @return bool whether the pipe has drained to half its capacity, which the draining connection
+   *         reports as being below its write buffer low watermark.
+   */
+  bool belowLowWatermark() const { return length_ <= capacity_ / 2; }
+
+private:
+  SplicePipe(int read_fd, int write_fd, uint64_t capacity)
+      : read_fd_(read_fd), write_fd_(write_fd), capacity_(capacity) {}
+
+  const int read_fd_;
+  const int write_fd_;
+  const uint64_t capacity_;
+  uint64_t length_{};
+  bool full_{};
+};
+
+} // namespace Network
+} // namespace Envoy
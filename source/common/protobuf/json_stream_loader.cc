@@ -0,0 +1,758 @@
+#include "common/protobuf/json_stream_loader.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/common/base64.h"
+#include "common/common/fmt.h"
+#include "common/common/macros.h"
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/string_view.h"
+
+// Do not let RapidJson leak outside of this file.
+#include "rapidjson/error/en.h"
+#include "rapidjson/reader.h"
+#include "rapidjson/stream.h"
+
+namespace Envoy {
+namespace {
+
+/**
+ * Thrown while loading when the JSON uses a part of the mapping that is left to protobuf's own
+ * parser, or that parser may accept something the loader would reject.
+ */
+struct UnsupportedJson {};
+
+/**
+ * Custom stream to allow access to the line number of each event.
+ */
+class LineCountingStringStream : public rapidjson::StringStream {
+  // Ch is typdef in parent class to handle character encoding.
+public:
+  LineCountingStringStream(const Ch* src) : rapidjson::StringStream(src) {}
+  Ch Take() {
+    Ch ret = rapidjson::StringStream::Take();
+    if (ret == '\n') {
+      line_number_++;
+    }
+    return ret;
+  }
+  uint64_t getLineNumber() const { return line_number_; }
+
+private:
+  uint64_t line_number_{1};
+};
+
+/**
+ * Well-known types whose JSON representation differs from that of other messages.
+ */
+enum class WellKnownType {
+  None,
+  Any,
+  Duration,
+  Timestamp,
+  Struct,
+  Value,
+  ListValue,
+  Wrapper,
+  // Left to protobuf's parser.
+  Other,
+};
+
+WellKnownType wellKnownType(const Protobuf::Descriptor* descriptor) {
+  if (descriptor->file()->package() != "google.protobuf") {
+    return WellKnownType::None;
+  }
+  if (descriptor == ProtobufWkt::Any::descriptor()) {
+    return WellKnownType::Any;
+  }
+  if (descriptor == ProtobufWkt::Duration::descriptor()) {
+    return WellKnownType::Duration;
+  }
+  if (descriptor == ProtobufWkt::Timestamp::descriptor()) {
+    return WellKnownType::Timestamp;
+  }
+  if (descriptor == ProtobufWkt::Struct::descriptor()) {
+    return WellKnownType::Struct;
+  }
+  if (descriptor == ProtobufWkt::Value::descriptor()) {
+    return WellKnownType::Value;
+  }
+  if (descriptor == ProtobufWkt::ListValue::descriptor()) {
+    return WellKnownType::ListValue;
+  }
+  if (descriptor->file() == ProtobufWkt::UInt32Value::descriptor()->file()) {
+    return WellKnownType::Wrapper;
+  }
+  if (descriptor->full_name() == "google.protobuf.FieldMask") {
+    return WellKnownType::Other;
+  }
+  return WellKnownType::None;
+}
+
+/**
+ * @return the field with the given name, either as in the proto file or as in JSON, or nullptr if
+ *         there is none.
+ */
+const Protobuf::FieldDescriptor* findField(const Protobuf::Descriptor& descriptor,
+                                           const std::string& name) {
+  const Protobuf::FieldDescriptor* field = descriptor.FindFieldByName(name);
+  if (field != nullptr) {
+    return field;
+  }
+  // The JSON name is the camel case one, unless the proto file says otherwise.
+  field = descriptor.FindFieldByCamelcaseName(name);
+  if (field != nullptr && field->json_name() == name) {
+    return field;
+  }
+  for (int i = 0; i < descriptor.field_count(); i++) {
+    if (descriptor.field(i)->json_name() == name) {
+      return descriptor.field(i);
+    }
+  }
+  return nullptr;
+}
+
+Protobuf::Message* mutableField(Protobuf::Message& message, int field_number) {
+  return message.GetReflection()->MutableMessage(
+      &message, message.GetDescriptor()->FindFieldByNumber(field_number));
+}
+
+/**
+ * Consume events from SAX callbacks to set the fields of a message.
+ */
+class MessageHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, MessageHandler> {
+public:
+  MessageHandler(LineCountingStringStream& stream, Protobuf::Message& root)
+      : stream_(stream), root_(root) {}
+
+  bool StartObject();
+  bool EndObject(rapidjson::SizeType);
+  bool Key(const char* value, rapidjson::SizeType size, bool);
+  bool StartArray();
+  bool EndArray(rapidjson::SizeType);
+  bool Null();
+  bool Bool(bool value);
+  bool RawNumber(const char* value, rapidjson::SizeType size, bool);
+  bool String(const char* value, rapidjson::SizeType size, bool);
+
+private:
+  /**
+   * An object or array being read.
+   */
+  struct Frame {
+    enum class Type {
+      // An object mapped to a message. field_ is the field of the last key, or nullptr if the key
+      // is unknown.
+      Message,
+      // An array mapped to the repeated field_ of message_.
+      Array,
+      // An object mapped to the map field_ of message_.
+      Map,
+      // The value of an unknown field, which is skipped.
+      Skip,
+    };
+
+    Frame(Type type, Protobuf::Message* message, const Protobuf::FieldDescriptor* field)
+        : type_(type), message_(message), field_(field) {}
+
+    Type type_;
+    Protobuf::Message* message_;
+    const Protobuf::FieldDescriptor* field_;
+    // Map frames: the key of the entry whose value is read next.
+    std::string map_key_;
+    // Skip frames: the number of objects and arrays that are open within the skipped value.
+    uint32_t skip_depth_{};
+    // Message frames for an Any: message_ is the payload once the "@type" key was read, the Any is
+    // only set when the object ends.
+    Protobuf::Message* any_{};
+    std::unique_ptr<Protobuf::Message> payload_;
+    std::string type_url_;
+    bool reading_type_url_{};
+    // Message frames: the oneofs of message_ that a key was read for.
+    std::vector<const Protobuf::OneofDescriptor*> oneofs_;
+  };
+
+  /**
+   * Where the value that is read next goes.
+   */
+  struct Slot {
+    Protobuf::Message* message_;
+    // nullptr if the value is skipped.
+    const Protobuf::FieldDescriptor* field_;
+    // Whether the value is a single element, i.e. the value of a singular field or one that is
+    // added to a repeated field, rather than the array or object of a whole repeated field.
+    bool element_;
+  };
+
+  enum class TokenType { Bool, Number, String };
+
+  /**
+   * A scalar value.
+   */
+  struct Token {
+    TokenType type_;
+    absl::string_view text_;
+    bool bool_value_;
+  };
+
+  Slot nextSlot();
+  bool skipNested(bool start);
+  void pushMessage(Protobuf::Message* message);
+  Protobuf::Message* mutableMessage(const Slot& slot);
+  bool handleValue(const Token& token);
+  void setValue(Protobuf::Message& value, const Token& token);
+  void setScalar(Protobuf::Message& message, const Protobuf::FieldDescriptor& field,
+                 const Token& token, const Protobuf::FieldDescriptor& error_field);
+  void setMapKey(Protobuf::Message& entry, const std::string& key);
+  template <class T> T toInteger(const Protobuf::FieldDescriptor& field, const Token& token);
+  double toDouble(const Protobuf::FieldDescriptor& field, const Token& token);
+  [[noreturn]] void throwTypeError(const Protobuf::FieldDescriptor& field, absl::string_view found);
+
+  LineCountingStringStream& stream_;
+  Protobuf::Message& root_;
+  std::vector<Frame> stack_;
+};
+
+MessageHandler::Slot MessageHandler::nextSlot() {
+  Frame& frame = stack_.back();
+  if (frame.reading_type_url_) {
+    throw UnsupportedJson();
+  }
+  switch (frame.type_) {
+  case Frame::Type::Message:
+    return {frame.message_, frame.field_, frame.field_ == nullptr || !frame.field_->is_repeated()};
+  case Frame::Type::Array:
+    return {frame.message_, frame.field_, true};
+  case Frame::Type::Map: {
+    Protobuf::Message* entry =
+        frame.message_->GetReflection()->AddMessage(frame.message_, frame.field_);
+    setMapKey(*entry, frame.map_key_);
+    return {entry, entry->GetDescriptor()->FindFieldByNumber(2), true};
+  }
+  default:
+    NOT_REACHED;
+  }
+}
+
+bool MessageHandler::skipNested(bool start) {
+  if (stack_.empty() || stack_.back().type_ != Frame::Type::Skip) {
+    return false;
+  }
+  if (start) {
+    stack_.back().skip_depth_++;
+  } else if (--stack_.back().skip_depth_ == 0) {
+    stack_.pop_back();
+  }
+  return true;
+}
+
+void MessageHandler::pushMessage(Protobuf::Message* message) {
+  stack_.emplace_back(Frame::Type::Message, message, nullptr);
+  if (wellKnownType(message->GetDescriptor()) == WellKnownType::Any) {
+    stack_.back().any_ = message;
+    stack_.back().message_ = nullptr;
+  }
+}
+
+Protobuf::Message* MessageHandler::mutableMessage(const Slot& slot) {
+  const Protobuf::Reflection* reflection = slot.message_->GetReflection();
+  return slot.field_->is_repeated() ? reflection->AddMessage(slot.message_, slot.field_)
+                                    : reflection->MutableMessage(slot.message_, slot.field_);
+}
+
+bool MessageHandler::StartObject() {
+  if (stack_.empty()) {
+    pushMessage(&root_);
+    return true;
+  }
+  if (skipNested(true)) {
+    return true;
+  }
+
+  const Slot slot = nextSlot();
+  if (slot.field_ == nullptr) {
+    stack_.emplace_back(Frame::Type::Skip, nullptr, nullptr);
+    stack_.back().skip_depth_ = 1;
+    return true;
+  }
+  if (!slot.element_) {
+    if (!slot.field_->is_map()) {
+      throw UnsupportedJson();
+    }
+    stack_.emplace_back(Frame::Type::Map, slot.message_, slot.field_);
+    return true;
+  }
+  if (slot.field_->cpp_type() != Protobuf::FieldDescriptor::CPPTYPE_MESSAGE) {
+    throwTypeError(*slot.field_, "object");
+  }
+
+  Protobuf::Message* message = mutableMessage(slot);
+  switch (wellKnownType(slot.field_->message_type())) {
+  case WellKnownType::None:
+  case WellKnownType::Any:
+    pushMessage(message);
+    break;
+  case WellKnownType::Value:
+    message = mutableField(*message, ProtobufWkt::Value::kStructValueFieldNumber);
+    FALLTHRU;
+  case WellKnownType::Struct:
+    stack_.emplace_back(
+        Frame::Type::Map, message,
+        message->GetDescriptor()->FindFieldByNumber(ProtobufWkt::Struct::kFieldsFieldNumber));
+    break;
+  case WellKnownType::ListValue:
+    throwTypeError(*slot.field_, "object");
+  default:
+    throw UnsupportedJson();
+  }
+  return true;
+}
+
+bool MessageHandler::EndObject(rapidjson::SizeType) {
+  if (skipNested(false)) {
+    return true;
+  }
+  Frame& frame = stack_.back();
+  if (frame.payload_ != nullptr) {
+    frame.any_->GetReflection()->SetString(
+        frame.any_,
+        frame.any_->GetDescriptor()->FindFieldByNumber(ProtobufWkt::Any::kTypeUrlFieldNumber),
+        frame.type_url_);
+    frame.any_->GetReflection()->SetString(
+        frame.any_,
+        frame.any_->GetDescriptor()->FindFieldByNumber(ProtobufWkt::Any::kValueFieldNumber),
+        frame.payload_->SerializeAsString());
+  }
+  stack_.pop_back();
+  return true;
+}
+
+bool MessageHandler::Key(const char* value, rapidjson::SizeType size, bool) {
+  Frame& frame = stack_.back();
+  switch (frame.type_) {
+  case Frame::Type::Message:
+    if (frame.message_ == nullptr) {
+      // An Any, which is only read as it is written by Protobuf::util::MessageToJsonString(), i.e.
+      // with the type first.
+      if (absl::string_view(value, size) != "@type") {
+        throw UnsupportedJson();
+      }
+      frame.reading_type_url_ = true;
+      break;
+    }
+    frame.field_ = findField(*frame.message_->GetDescriptor(), std::string(value, size));
+    if (frame.field_ != nullptr && frame.field_->containing_oneof() != nullptr) {
+      const Protobuf::OneofDescriptor* oneof = frame.field_->containing_oneof();
+      if (std::find(frame.oneofs_.begin(), frame.oneofs_.end(), oneof) != frame.oneofs_.end()) {
+        throw EnvoyException(fmt::format("Unable to parse JSON as proto (line {}): multiple "
+                                         "values for oneof '{}'",
+                                         stream_.getLineNumber(), oneof->full_name()));
+      }
+      frame.oneofs_.push_back(oneof);
+    }
+    break;
+  case Frame::Type::Map:
+    frame.map_key_.assign(value, size);
+    break;
+  case Frame::Type::Skip:
+    break;
+  default:
+    NOT_REACHED;
+  }
+  return true;
+}
+
+bool MessageHandler::StartArray() {
+  if (stack_.empty()) {
+    throw UnsupportedJson();
+  }
+  if (skipNested(true)) {
+    return true;
+  }
+
+  const Slot slot = nextSlot();
+  if (slot.field_ == nullptr) {
+    stack_.emplace_back(Frame::Type::Skip, nullptr, nullptr);
+    stack_.back().skip_depth_ = 1;
+    return true;
+  }
+  if (!slot.element_) {
+    if (slot.field_->is_map()) {
+      throw UnsupportedJson();
+    }
+    stack_.emplace_back(Frame::Type::Array, slot.message_, slot.field_);
+    return true;
+  }
+  if (slot.field_->cpp_type() != Protobuf::FieldDescriptor::CPPTYPE_MESSAGE) {
+    throwTypeError(*slot.field_, "array");
+  }
+
+  Protobuf::Message* message = mutableMessage(slot);
+  switch (wellKnownType(slot.field_->message_type())) {
+  case WellKnownType::Value:
+    message = mutableField(*message, ProtobufWkt::Value::kListValueFieldNumber);
+    FALLTHRU;
+  case WellKnownType::ListValue:
+    stack_.emplace_back(
+        Frame::Type::Array, message,
+        message->GetDescriptor()->FindFieldByNumber(ProtobufWkt::ListValue::kValuesFieldNumber));
+    break;
+  case WellKnownType::None:
+  case WellKnownType::Any:
+  case WellKnownType::Struct:
+    throwTypeError(*slot.field_, "array");
+  default:
+    throw UnsupportedJson();
+  }
+  return true;
+}
+
+bool MessageHandler::EndArray(rapidjson::SizeType) {
+  if (skipNested(false)) {
+    return true;
+  }
+  stack_.pop_back();
+  return true;
+}
+
+bool MessageHandler::Null() {
+  if (stack_.empty()) {
+    throw UnsupportedJson();
+  }
+  if (stack_.back().type_ == Frame::Type::Skip) {
+    return true;
+  }
+
+  const Slot slot = nextSlot();
+  if (slot.field_ == nullptr) {
+    return true;
+  }
+  if (slot.element_ && slot.field_->cpp_type() == Protobuf::FieldDescriptor::CPPTYPE_MESSAGE &&
+      wellKnownType(slot.field_->message_type()) == WellKnownType::Value) {
+    Protobuf::Message* value = mutableMessage(slot);
+    const Protobuf::FieldDescriptor* null_value =
+        value->GetDescriptor()->FindFieldByNumber(ProtobufWkt::Value::kNullValueFieldNumber);
+    value->GetReflection()->SetEnum(value, null_value, null_value->enum_type()->value(0));
+    return true;
+  }
+  // A null leaves a singular field unset. Anything else is left to protobuf's parser.
+  if (!slot.element_ || slot.field_->is_repeated() || stack_.back().type_ == Frame::Type::Map ||
+      slot.field_->cpp_type() == Protobuf::FieldDescriptor::CPPTYPE_ENUM) {
+    throw UnsupportedJson();
+  }
+  return true;
+}
+
+bool MessageHandler::Bool(bool value) {
+  return handleValue({TokenType::Bool, absl::string_view(), value});
+}
+
+bool MessageHandler::RawNumber(const char* value, rapidjson::SizeType size, bool) {
+  return handleValue({TokenType::Number, absl::string_view(value, size), false});
+}
+
+bool MessageHandler::String(const char* value, rapidjson::SizeType size, bool) {
+  if (!stack_.empty() && stack_.back().reading_type_url_) {
+    Frame& frame = stack_.back();
+    frame.reading_type_url_ = false;
+    frame.type_url_.assign(value, size);
+    const size_t slash = frame.type_url_.rfind('/');
+    const Protobuf::Descriptor* descriptor =
+        Protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName(
+            slash == std::string::npos ? frame.type_url_ : frame.type_url_.substr(slash + 1));
+    // The JSON of an Any holding a well-known type has its value under a "value" key.
+    if (descriptor == nullptr || wellKnownType(descriptor) != WellKnownType::None) {
+      throw UnsupportedJson();
+    }
+    frame.payload_.reset(
+        Protobuf::MessageFactory::generated_factory()->GetPrototype(descriptor)->New());
+    frame.message_ = frame.payload_.get();
+    return true;
+  }
+  return handleValue({TokenType::String, absl::string_view(value, size), false});
+}
+
+bool MessageHandler::handleValue(const Token& token) {
+  if (stack_.empty()) {
+    throw UnsupportedJson();
+  }
+  if (stack_.back().type_ == Frame::Type::Skip) {
+    return true;
+  }
+
+  const Slot slot = nextSlot();
+  if (slot.field_ == nullptr) {
+    return true;
+  }
+  if (!slot.element_) {
+    throw UnsupportedJson();
+  }
+  if (slot.field_->cpp_type() != Protobuf::FieldDescriptor::CPPTYPE_MESSAGE) {
+    setScalar(*slot.message_, *slot.field_, token, *slot.field_);
+    return true;
+  }
+
+  switch (wellKnownType(slot.field_->message_type())) {
+  case WellKnownType::Value:
+    setValue(*mutableMessage(slot), token);
+    break;
+  case WellKnownType::Wrapper: {
+    Protobuf::Message* wrapper = mutableMessage(slot);
+    setScalar(*wrapper, *wrapper->GetDescriptor()->FindFieldByNumber(1), token, *slot.field_);
+    break;
+  }
+  case WellKnownType::Duration:
+  case WellKnownType::Timestamp: {
+    if (token.type_ != TokenType::String) {
+      throw UnsupportedJson();
+    }
+    const std::string text(token.text_);
+    Protobuf::Message* message = mutableMessage(slot);
+    const bool parsed =
+        wellKnownType(slot.field_->message_type()) == WellKnownType::Duration
+            ? Protobuf::util::TimeUtil::FromString(text,
+                                                   dynamic_cast<ProtobufWkt::Duration*>(message))
+            : Protobuf::util::TimeUtil::FromString(text,
+                                                   dynamic_cast<ProtobufWkt::Timestamp*>(message));
+    if (!parsed) {
+      throw UnsupportedJson();
+    }
+    break;
+  }
+  case WellKnownType::Other:
+    throw UnsupportedJson();
+  default:
+    throwTypeError(*slot.field_, token.type_ == TokenType::String ? "string" : "scalar");
+  }
+  return true;
+}
+
+void MessageHandler::setValue(Protobuf::Message& value, const Token& token) {
+  const Protobuf::Reflection* reflection = value.GetReflection();
+  const Protobuf::Descriptor* descriptor = value.GetDescriptor();
+  switch (token.type_) {
+  case TokenType::Bool:
+    reflection->SetBool(&value,
+                        descriptor->FindFieldByNumber(ProtobufWkt::Value::kBoolValueFieldNumber),
+                        token.bool_value_);
+    break;
+  case TokenType::Number: {
+    const Protobuf::FieldDescriptor& number_value =
+        *descriptor->FindFieldByNumber(ProtobufWkt::Value::kNumberValueFieldNumber);
+    setScalar(value, number_value, token, number_value);
+    break;
+  }
+  case TokenType::String:
+    reflection->SetString(
+        &value, descriptor->FindFieldByNumber(ProtobufWkt::Value::kStringValueFieldNumber),
+        std::string(token.text_));
+    break;
+  }
+}
+
+void MessageHandler::setScalar(Protobuf::Message& message, const Protobuf::FieldDescriptor& field,
+                               const Token& token,
+                               const Protobuf::FieldDescriptor& error_field) {
+  const Protobuf::Reflection* reflection = message.GetReflection();
+  const bool add = field.is_repeated();
+  switch (field.cpp_type()) {
+  case Protobuf::FieldDescriptor::CPPTYPE_INT32: {
+    const int32_t value = toInteger<int32_t>(error_field, token);
+    add ? reflection->AddInt32(&message, &field, value)
+        : reflection->SetInt32(&message, &field, value);
+    break;
+  }
+  case Protobuf::FieldDescriptor::CPPTYPE_INT64: {
+    const int64_t value = toInteger<int64_t>(error_field, token);
+    add ? reflection->AddInt64(&message, &field, value)
+        : reflection->SetInt64(&message, &field, value);
+    break;
+  }
+  case Protobuf::FieldDescriptor::CPPTYPE_UINT32: {
+    const uint32_t value = toInteger<uint32_t>(error_field, token);
+    add ? reflection->AddUInt32(&message, &field, value)
+        : reflection->SetUInt32(&message, &field, value);
+    break;
+  }
+  case Protobuf::FieldDescriptor::CPPTYPE_UINT64: {
+    const uint64_t value = toInteger<uint64_t>(error_field, token);
+    add ? reflection->AddUInt64(&message, &field, value)
+        : reflection->SetUInt64(&message, &field, value);
+    break;
+  }
+  case Protobuf::FieldDescriptor::CPPTYPE_DOUBLE: {
+    const double value = toDouble(error_field, token);
+    add ? reflection->AddDouble(&message, &field, value)
+        : reflection->SetDouble(&message, &field, value);
+    break;
+  }
+  case Protobuf::FieldDescriptor::CPPTYPE_FLOAT: {
+    const double value = toDouble(error_field, token);
+    if (std::isfinite(value) && std::fabs(value) > FLT_MAX) {
+      throwTypeError(error_field, "out of range number");
+    }
+    add ? reflection->AddFloat(&message, &field, value)
+        : reflection->SetFloat(&message, &field, value);
+    break;
+  }
+  case Protobuf::FieldDescriptor::CPPTYPE_BOOL:
+    if (token.type_ != TokenType::Bool) {
+      throw UnsupportedJson();
+    }
+    add ? reflection->AddBool(&message, &field, token.bool_value_)
+        : reflection->SetBool(&message, &field, token.bool_value_);
+    break;
+  case Protobuf::FieldDescriptor::CPPTYPE_STRING: {
+    if (token.type_ != TokenType::String) {
+      throw UnsupportedJson();
+    }
+    std::string value(token.text_);
+    if (field.type() == Protobuf::FieldDescriptor::TYPE_BYTES && !value.empty()) {
+      // Unpadded and URL safe base64 are left to protobuf's parser.
+      value = Base64::decode(value);
+      if (value.empty()) {
+        throw UnsupportedJson();
+      }
+    }
+    add ? reflection->AddString(&message, &field, std::move(value))
+        : reflection->SetString(&message, &field, std::move(value));
+    break;
+  }
+  case Protobuf::FieldDescriptor::CPPTYPE_ENUM: {
+    const Protobuf::EnumValueDescriptor* value = nullptr;
+    if (token.type_ == TokenType::String) {
+      value = field.enum_type()->FindValueByName(std::string(token.text_));
+    } else if (token.type_ == TokenType::Number) {
+      value = field.enum_type()->FindValueByNumber(toInteger<int32_t>(error_field, token));
+    } else {
+      throwTypeError(error_field, "boolean");
+    }
+    if (value == nullptr) {
+      throw UnsupportedJson();
+    }
+    add ? reflection->AddEnum(&message, &field, value)
+        : reflection->SetEnum(&message, &field, value);
+    break;
+  }
+  default:
+    NOT_REACHED;
+  }
+}
+
+void MessageHandler::setMapKey(Protobuf::Message& entry, const std::string& key) {
+  const Protobuf::FieldDescriptor& field = *entry.GetDescriptor()->FindFieldByNumber(1);
+  if (field.cpp_type() == Protobuf::FieldDescriptor::CPPTYPE_BOOL) {
+    if (key != "true" && key != "false") {
+      throwTypeError(field, "map key");
+    }
+    entry.GetReflection()->SetBool(&entry, &field, key == "true");
+    return;
+  }
+  setScalar(entry, field, {TokenType::String, key, false}, field);
+}
+
+template <class T>
+T MessageHandler::toInteger(const Protobuf::FieldDescriptor& field, const Token& token) {
+  if (token.type_ == TokenType::Bool) {
+    throwTypeError(field, "boolean");
+  }
+  T value;
+  if (absl::SimpleAtoi(token.text_, &value)) {
+    return value;
+  }
+  // Integers may also be written in exponent or decimal notation, as long as they are integral.
+  double double_value;
+  if (absl::SimpleAtod(token.text_, &double_value) && std::floor(double_value) == double_value &&
+      double_value >= static_cast<double>(std::numeric_limits<T>::min()) &&
+      double_value < static_cast<double>(std::numeric_limits<T>::max()) + 1.0) {
+    return static_cast<T>(double_value);
+  }
+  throwTypeError(field, fmt::format("'{}'", token.text_));
+}
+
+double MessageHandler::toDouble(const Protobuf::FieldDescriptor& field, const Token& token) {
+  if (token.type_ == TokenType::Bool) {
+    throwTypeError(field, "boolean");
+  }
+  if (token.type_ == TokenType::String) {
+    if (token.text_ == "NaN") {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (token.text_ == "Infinity") {
+      return std::numeric_limits<double>::infinity();
+    }
+    if (token.text_ == "-Infinity") {
+      return -std::numeric_limits<double>::infinity();
+    }
+  }
+  double value;
+  if (!absl::SimpleAtod(token.text_, &value) || !std::isfinite(value)) {
+    throwTypeError(field, fmt::format("'{}'", token.text_));
+  }
+  return value;
+}
+
+void MessageHandler::throwTypeError(const Protobuf::FieldDescriptor& field,
+                                    absl::string_view found) {
+  throw EnvoyException(fmt::format("Unable to parse JSON as proto (line {}): unexpected {} for "
+                                   "field '{}'",
+                                   stream_.getLineNumber(), found, field.full_name()));
+}
+
+} // namespace
+
+void JsonStreamLoader::load(const std::string& json, Protobuf::Message& message) {
+  message.Clear();
+  const auto load_with_protobuf = [&json, &message]() {
+    message.Clear();
+    Protobuf::util::JsonParseOptions options;
+    options.ignore_unknown_fields = true;
+    return Protobuf::util::JsonStringToMessage(json, &message, options);
+  };
+
+  // The well-known types with a special representation only appear within other messages in
+  // configs.
+  if (wellKnownType(message.GetDescriptor()) == WellKnownType::None) {
+    LineCountingStringStream json_stream(json.c_str());
+    MessageHandler handler(json_stream, message);
+    rapidjson::Reader reader;
+    bool unsupported = false;
+    try {
+      reader.Parse<rapidjson::kParseNumbersAsStringsFlag | rapidjson::kParseValidateEncodingFlag>(
+          json_stream, handler);
+    } catch (const UnsupportedJson&) {
+      unsupported = true;
+    }
+    if (!unsupported && !reader.HasParseError()) {
+      return;
+    }
+
+    // Protobuf's parser accepts some JSON that RapidJson does not, e.g. single quoted strings, so
+    // it has the last word on syntax errors. The error found by RapidJson is reported when both
+    // reject the JSON, as it comes with a line number.
+    if (!unsupported) {
+      if (!load_with_protobuf().ok()) {
+        throw EnvoyException(fmt::format("Unable to parse JSON as proto (line {}): {}",
+                                         json_stream.getLineNumber(),
+                                         GetParseError_En(reader.GetParseErrorCode())));
+      }
+      return;
+    }
+  }
+
+  const auto status = load_with_protobuf();
+  if (!status.ok()) {
+    throw EnvoyException("Unable to parse JSON as proto (" + status.ToString() + "): " + json);
+  }
+}
+
+} // namespace Envoy
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+
+#include "envoy/common/exception.h"
+
+#include "common/protobuf/protobuf.h"
+
+namespace Envoy {
+
+/**
+ * Loads JSON into protobuf messages following the proto3 JSON mapping, in a single pass over the
+ * JSON that sets the fields of the message as they are read. Unlike Protobuf::util::
+ * JsonStringToMessage(), no type description of the message or binary copy of it is built along
+ * the way, and errors report the line they were found on.
+ *
+ * Parts of the mapping that configs have no use for (e.g. a google.protobuf.FieldMask, or an Any
+ * holding a well-known type) are left to Protobuf::util::JsonStringToMessage(), which then parses
+ * the whole JSON again.
+ */
+class JsonStreamLoader {
+public:
+  /**
+   * Load JSON into a message, replacing its contents. Unknown fields are ignored.
+   * @param json supplies the JSON.
+   * @param message supplies the message to load into.
+   * @throw EnvoyException if the JSON is not valid or does not match the message.
+   */
+  static void load(const std::string& json, Protobuf::Message& message);
+};
+
+} // namespace Envoy
@@ -1,11 +1,17 @@
+// Exposes XXH64_state_t, so that the hashing state can live on the stack.
+#define XXH_STATIC_LINKING_ONLY
+
 #include "common/protobuf/utility.h"
 
 #include "common/common/assert.h"
 #include "common/common/fmt.h"
 #include "common/filesystem/filesystem_impl.h"
 #include "common/json/json_loader.h"
+#include "common/protobuf/json_stream_loader.h"
 #include "common/protobuf/protobuf.h"
 
+#include "xxhash.h"
+
 namespace Envoy {
 namespace ProtobufPercentHelper {
 
@@ -36,6 +42,64 @@ uint64_t fractionalPercentDenominatorToInt(const envoy::type::FractionalPercent&
 
 } // namespace ProtobufPercentHelper
 
+namespace ProtobufHashHelper {
+namespace {
+
+/**
+ * Output stream that feeds the bytes written to it into an xxHash64 state, through a fixed buffer.
+ */
+class HashingOutputStream : public Protobuf::io::ZeroCopyOutputStream {
+public:
+  HashingOutputStream() { XXH64_reset(&state_, 0); }
+
+  uint64_t digest() {
+    flush();
+    return XXH64_digest(&state_);
+  }
+
+  // Protobuf::io::ZeroCopyOutputStream
+  bool Next(void** data, int* size) override {
+    flush();
+    *data = buffer_;
+    *size = sizeof(buffer_);
+    buffered_ = sizeof(buffer_);
+    return true;
+  }
+  void BackUp(int count) override {
+    ASSERT(count >= 0 && count <= buffered_);
+    buffered_ -= count;
+  }
+  Protobuf::int64 ByteCount() const override { return flushed_ + buffered_; }
+
+private:
+  void flush() {
+    XXH64_update(&state_, buffer_, buffered_);
+    flushed_ += buffered_;
+    buffered_ = 0;
+  }
+
+  XXH64_state_t state_;
+  uint8_t buffer_[4096];
+  int buffered_{};
+  Protobuf::int64 flushed_{};
+};
+
+} // namespace
+
+uint64_t hashSerialized(const std::function<void(Protobuf::io::CodedOutputStream&)>& serialize) {
+  HashingOutputStream hashing_stream;
+  {
+    // The CodedOutputStream hands back the part of the buffer it didn't use when it is destroyed,
+    // which needs to happen before the hash is computed.
+    Protobuf::io::CodedOutputStream coded_stream(&hashing_stream);
+    coded_stream.SetSerializationDeterministic(true);
+    serialize(coded_stream);
+  }
+  return hashing_stream.digest();
+}
+
+} // namespace ProtobufHashHelper
+
 MissingFieldException::MissingFieldException(const std::string& field_name,
                                              const Protobuf::Message& message)
     : EnvoyException(
@@ -49,12 +113,7 @@ ProtoValidationException::ProtoValidationException(const std::string& validation
 }
 
 void MessageUtil::loadFromJson(const std::string& json, Protobuf::Message& message) {
-  Protobuf::util::JsonParseOptions options;
-  options.ignore_unknown_fields = true;
-  const auto status = Protobuf::util::JsonStringToMessage(json, &message, options);
-  if (!status.ok()) {
-    throw EnvoyException("Unable to parse JSON as proto (" + status.ToString() + "): " + json);
-  }
+  JsonStreamLoader::load(json, message);
 }
 
 void MessageUtil::loadFromYaml(const std::string& yaml, Protobuf::Message& message) {
@@ -132,6 +191,35 @@ ProtobufWkt::Struct MessageUtil::keyValueStruct(const std::string& key, const st
   return struct_obj;
 }
 
+namespace {
+
+std::string serializeDeterministically(const Protobuf::Message& message) {
+  std::string bytes;
+  {
+    Protobuf::io::StringOutputStream string_stream(&bytes);
+    Protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    coded_stream.SetSerializationDeterministic(true);
+    message.SerializeToCodedStream(&coded_stream);
+  }
+  return bytes;
+}
+
+} // namespace
+
+bool MessageUtil::equal(const Protobuf::Message& lhs, const Protobuf::Message& rhs) {
+  if (&lhs == &rhs) {
+    return true;
+  }
+  // Serializing is much cheaper than comparing through reflection, and only equivalent messages
+  // of the same type serialize to the same bytes. Different bytes may still be equivalent though,
+  // e.g. if a field is explicitly set to its default value.
+  if (lhs.GetDescriptor() == rhs.GetDescriptor() &&
+      serializeDeterministically(lhs) == serializeDeterministically(rhs)) {
+    return true;
+  }
+  return Protobuf::util::MessageDifferencer::Equivalent(lhs, rhs);
+}
+
 bool ValueUtil::equal(const ProtobufWkt::Value& v1, const ProtobufWkt::Value& v2) {
   ProtobufWkt::Value::KindCase kind = v1.kind_case();
   if (kind != v2.kind_case()) {
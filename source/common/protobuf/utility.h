@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <numeric>
 
 #include "envoy/common/exception.h"
@@ -64,6 +65,19 @@ uint64_t convertPercent(double percent, uint64_t max_value);
 uint64_t fractionalPercentDenominatorToInt(const envoy::type::FractionalPercent& percent);
 
 } // namespace ProtobufPercentHelper
+
+namespace ProtobufHashHelper {
+
+/**
+ * Hash the bytes a callback serializes, as if they had been serialized into a string and hashed
+ * with HashUtil::xxHash64(), but without buffering them. The stream handed to the callback has
+ * deterministic serialization enabled, so that the same message doesn't hash to different values.
+ * @param serialize supplies the callback that writes to the stream.
+ * @return uint64_t the hash of everything written to the stream.
+ */
+uint64_t hashSerialized(const std::function<void(Protobuf::io::CodedOutputStream&)>& serialize);
+
+} // namespace ProtobufHashHelper
 } // namespace Envoy
 
 // Convert an envoy::api::v2::core::Percent to a rounded integer or a default.
@@ -106,20 +120,12 @@ public:
   // Based on MessageUtil::hash() defined below.
   template <class ProtoType>
   static std::size_t hash(const Protobuf::RepeatedPtrField<ProtoType>& source) {
-    // Use Protobuf::io::CodedOutputStream to force deterministic serialization, so that the same
-    // message doesn't hash to different values.
-    ProtobufTypes::String text;
-    {
-      // For memory safety, the StringOutputStream needs to be destroyed before
-      // we read the string.
-      Protobuf::io::StringOutputStream string_stream(&text);
-      Protobuf::io::CodedOutputStream coded_stream(&string_stream);
-      coded_stream.SetSerializationDeterministic(true);
-      for (const auto& message : source) {
-        message.SerializeToCodedStream(&coded_stream);
-      }
-    }
-    return HashUtil::xxHash64(text);
+    return ProtobufHashHelper::hashSerialized(
+        [&source](Protobuf::io::CodedOutputStream& coded_stream) -> void {
+          for (const auto& message : source) {
+            message.SerializeToCodedStream(&coded_stream);
+          }
+        });
   }
 };
 
@@ -135,24 +141,26 @@ public:
 
   // std::equals_to
   bool operator()(const Protobuf::Message& lhs, const Protobuf::Message& rhs) const {
-    return Protobuf::util::MessageDifferencer::Equivalent(lhs, rhs);
+    return equal(lhs, rhs);
   }
 
   static std::size_t hash(const Protobuf::Message& message) {
-    // Use Protobuf::io::CodedOutputStream to force deterministic serialization, so that the same
-    // message doesn't hash to different values.
-    ProtobufTypes::String text;
-    {
-      // For memory safety, the StringOutputStream needs to be destroyed before
-      // we read the string.
-      Protobuf::io::StringOutputStream string_stream(&text);
-      Protobuf::io::CodedOutputStream coded_stream(&string_stream);
-      coded_stream.SetSerializationDeterministic(true);
-      message.SerializeToCodedStream(&coded_stream);
-    }
-    return HashUtil::xxHash64(text);
+    return ProtobufHashHelper::hashSerialized(
+        [&message](Protobuf::io::CodedOutputStream& coded_stream) -> void {
+          message.SerializeToCodedStream(&coded_stream);
+        });
   }
 
+  /**
+   * Compare two messages the way Protobuf::util::MessageDifferencer::Equivalent() does. Messages
+   * of the same type are first compared by their serialized bytes, so that the field by field
+   * comparison only runs for messages that changed.
+   * @param lhs supplies the first message.
+   * @param rhs supplies the second message.
+   * @return true if the messages are equivalent.
+   */
+  static bool equal(const Protobuf::Message& lhs, const Protobuf::Message& rhs);
+
   static void loadFromJson(const std::string& json, Protobuf::Message& message);
   static void loadFromYaml(const std::string& yaml, Protobuf::Message& message);
   static void loadFromFile(const std::string& path, Protobuf::Message& message);
@@ -0,0 +1,212 @@
+#include "common/ratelimit/local_quota_impl.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/tracing/http_tracer_impl.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace RateLimit {
+
+absl::optional<LocalQuotaSettings> LocalQuotaSettings::fromRuntime(Runtime::Loader& runtime) {
+  const Runtime::Snapshot& snapshot = runtime.snapshot();
+  const uint64_t max_tokens = snapshot.getInteger("ratelimit.local_quota.max_tokens", 0);
+  if (max_tokens == 0) {
+    return absl::nullopt;
+  }
+
+  LocalQuotaSettings settings;
+  settings.max_tokens_ = max_tokens;
+  settings.tokens_per_second_ =
+      snapshot.getInteger("ratelimit.local_quota.tokens_per_second", max_tokens);
+  settings.report_interval_ = std::chrono::milliseconds(
+      snapshot.getInteger("ratelimit.local_quota.report_interval_ms", 1000));
+  return settings;
+}
+
+ThreadLocalQuotas::SharedState::SharedState(const LocalQuotaSettings& settings,
+                                            Grpc::AsyncClientFactoryPtr&& factory,
+                                            Stats::Scope& scope, uint32_t concurrency,
+                                            MonotonicTimeSource& time_source)
+    : settings_(settings), factory_(std::move(factory)),
+      service_method_(*Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
+          "envoy.service.ratelimit.v2.RateLimitService.ShouldRateLimit")),
+      stats_{ALL_LOCAL_QUOTA_STATS(POOL_COUNTER_PREFIX(scope, "ratelimit.local_quota."))},
+      concurrency_(concurrency), time_source_(time_source) {}
+
+std::shared_ptr<ShardedTokenBucketImpl>
+ThreadLocalQuotas::SharedState::bucket(const std::string& key) {
+  Thread::LockGuard lock(buckets_lock_);
+  std::shared_ptr<ShardedTokenBucketImpl>& bucket = buckets_[key];
+  if (bucket == nullptr) {
+    bucket = std::make_shared<ShardedTokenBucketImpl>(
+        settings_.max_tokens_, settings_.tokens_per_second_, concurrency_,
+        ShardedTokenBucketImpl::DefaultRebalanceInterval, time_source_);
+  }
+  return bucket;
+}
+
+void ThreadLocalQuotas::SharedState::releaseBucket(const std::string& key) {
+  Thread::LockGuard lock(buckets_lock_);
+  const auto it = buckets_.find(key);
+  if (it != buckets_.end() && it->second.use_count() == 1) {
+    buckets_.erase(it);
+  }
+}
+
+ThreadLocalQuotas::Quota::Quota(ThreadLocalQuotas& parent, const std::string& key,
+                                const std::string& domain,
+                                const std::vector<Descriptor>& descriptors)
+    : parent_(parent), domain_(domain), descriptors_(descriptors),
+      bucket_(parent.shared_state_->bucket(key)) {}
+
+ThreadLocalQuotas::Quota::~Quota() {
+  if (request_ != nullptr) {
+    request_->cancel();
+  }
+}
+
+void ThreadLocalQuotas::Quota::onSuccess(
+    std::unique_ptr<envoy::service::ratelimit::v2::RateLimitResponse>&& response, Tracing::Span&) {
+  request_ = nullptr;
+  ASSERT(response->overall_code() != envoy::service::ratelimit::v2::RateLimitResponse_Code_UNKNOWN);
+  over_limit_ = response->overall_code() ==
+                envoy::service::ratelimit::v2::RateLimitResponse_Code_OVER_LIMIT;
+  if (over_limit_) {
+    parent_.shared_state_->stats_.report_over_limit_.inc();
+  } else {
+    parent_.shared_state_->stats_.report_ok_.inc();
+  }
+
+  // The bucket may hold no more than the strictest limit of the descriptors has left. Descriptors
+  // that the service has no limit for come without a current limit, and do not count.
+  absl::optional<uint32_t> limit_remaining;
+  for (const auto& status : response->statuses()) {
+    if (status.has_current_limit()) {
+      limit_remaining = std::min(limit_remaining.value_or(status.limit_remaining()),
+                                 status.limit_remaining());
+    }
+  }
+  if (limit_remaining) {
+    bucket_->cap(limit_remaining.value());
+  }
+}
+
+void ThreadLocalQuotas::Quota::onFailure(Grpc::Status::GrpcStatus status, const std::string&,
+                                         Tracing::Span&) {
+  ASSERT(status != Grpc::Status::GrpcStatus::Ok);
+  // The quota keeps the last verdict of the service until the next report gets one.
+  request_ = nullptr;
+  parent_.shared_state_->stats_.report_error_.inc();
+}
+
+ThreadLocalQuotas::ThreadLocalQuotas(const SharedStateSharedPtr& shared_state,
+                                     Event::Dispatcher& dispatcher)
+    : shared_state_(shared_state), client_(shared_state->factory_->create()) {
+  report_timer_ = dispatcher.createTimer([this]() -> void {
+    report();
+    report_timer_->enableTimer(shared_state_->settings_.report_interval_);
+  });
+  report_timer_->enableTimer(shared_state_->settings_.report_interval_);
+}
+
+std::string ThreadLocalQuotas::key(const std::string& domain,
+                                   const std::vector<Descriptor>& descriptors) {
+  // The length and count prefixes keep the boundaries of the values unambiguous.
+  std::string key = absl::StrCat(domain.size(), ":", domain);
+  for (const Descriptor& descriptor : descriptors) {
+    absl::StrAppend(&key, descriptor.entries_.size(), ";");
+    for (const DescriptorEntry& entry : descriptor.entries_) {
+      absl::StrAppend(&key, entry.key_.size(), ":", entry.key_, entry.value_.size(), ":",
+                      entry.value_);
+    }
+  }
+  return key;
+}
+
+LimitStatus ThreadLocalQuotas::admit(const std::string& domain,
+                                     const std::vector<Descriptor>& descriptors) {
+  if (!shard_) {
+    shard_ = shared_state_->next_shard_++;
+  }
+  const std::string quota_key = key(domain, descriptors);
+  QuotaPtr& quota = quotas_[quota_key];
+  if (quota == nullptr) {
+    quota = std::make_unique<Quota>(*this, quota_key, domain, descriptors);
+  }
+
+  // Rejected requests are reported too, as the service counts every request when it is asked for
+  // each of them.
+  ++quota->unreported_hits_;
+  if (quota->over_limit_ || !quota->bucket_->consume(1, shard_.value())) {
+    return LimitStatus::OverLimit;
+  }
+  return LimitStatus::OK;
+}
+
+void ThreadLocalQuotas::report() {
+  for (auto it = quotas_.begin(); it != quotas_.end();) {
+    Quota& quota = *it->second;
+    if (quota.request_ != nullptr) {
+      // The hits are sent with the next report once the service answered this one.
+      ++it;
+      continue;
+    }
+    if (quota.unreported_hits_ == 0) {
+      // An idle quota starts over with the verdict of its next report if it is used again. Its
+      // bucket goes once no worker uses it.
+      const std::string quota_key = it->first;
+      it = quotas_.erase(it);
+      shared_state_->releaseBucket(quota_key);
+      continue;
+    }
+
+    envoy::service::ratelimit::v2::RateLimitRequest request;
+    GrpcClientImpl::createRequest(request, quota.domain_, quota.descriptors_);
+    request.set_hits_addend(quota.unreported_hits_);
+    quota.unreported_hits_ = 0;
+    quota.request_ =
+        client_->send(shared_state_->service_method_, request, quota, Tracing::NullSpan::instance(),
+                      shared_state_->settings_.report_interval_);
+    ++it;
+  }
+}
+
+LocalQuotaFactoryImpl::LocalQuotaFactoryImpl(
+    const envoy::config::ratelimit::v2::RateLimitServiceConfig& config,
+    const LocalQuotaSettings& settings, Grpc::AsyncClientManager& async_client_manager,
+    Stats::Scope& scope, ThreadLocal::SlotAllocator& tls, uint32_t concurrency,
+    MonotonicTimeSource& time_source)
+    : tls_(tls.allocateSlot()) {
+  // The legacy proto has no hits_addend, so each report would count as a single request.
+  if (!config.use_data_plane_proto()) {
+    throw EnvoyException(
+        "ratelimit: local quotas require the data-plane-api defined rate limit service");
+  }
+
+  ThreadLocalQuotas::SharedStateSharedPtr shared_state =
+      std::make_shared<ThreadLocalQuotas::SharedState>(
+          settings,
+          async_client_manager.factoryForGrpcService(GrpcFactoryImpl::grpcService(config), scope,
+                                                     false),
+          scope, concurrency, time_source);
+  tls_->set([shared_state](Event::Dispatcher& dispatcher) {
+    return ThreadLocal::ThreadLocalObjectSharedPtr{new ThreadLocalQuotas(shared_state, dispatcher)};
+  });
+}
+
+ClientPtr LocalQuotaFactoryImpl::create(const absl::optional<std::chrono::milliseconds>&) {
+  return std::make_unique<LocalQuotaClientImpl>(tls_->getTyped<ThreadLocalQuotas>());
+}
+
+} // namespace RateLimit
+} // namespace Envoy
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/config/ratelimit/v2/rls.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/grpc/async_client.h"
+#include "envoy/grpc/async_client_manager.h"
+#include "envoy/ratelimit/ratelimit.h"
+#include "envoy/runtime/runtime.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/concurrent_token_bucket_impl.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+#include "common/common/utility.h"
+#include "common/ratelimit/ratelimit_impl.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace RateLimit {
+
+/**
+ * All local quota stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_LOCAL_QUOTA_STATS(COUNTER)                                                             \
+  COUNTER(report_ok)                                                                               \
+  COUNTER(report_over_limit)                                                                       \
+  COUNTER(report_error)
+// clang-format on
+
+/**
+ * Struct definition for all local quota stats. @see stats_macros.h
+ */
+struct LocalQuotaStats {
+  ALL_LOCAL_QUOTA_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Settings of the local quotas.
+ */
+struct LocalQuotaSettings {
+  /**
+   * Reads the settings from the runtime keys ratelimit.local_quota.max_tokens,
+   * ratelimit.local_quota.tokens_per_second and ratelimit.local_quota.report_interval_ms.
+   * @return the settings, or an empty optional if max_tokens is 0 (the default), which leaves
+   *         every request to the rate limit service.
+   */
+  static absl::optional<LocalQuotaSettings> fromRuntime(Runtime::Loader& runtime);
+
+  // The size of the token bucket that the workers share for each set of descriptors.
+  uint64_t max_tokens_;
+  // The rate at which the token buckets are refilled.
+  double tokens_per_second_;
+  // The interval at which each worker reports the usage of its quotas.
+  std::chrono::milliseconds report_interval_;
+};
+
+/**
+ * Per worker quotas, which admit requests without waiting for the rate limit service. Each set of
+ * descriptors gets a token bucket that is shared by the quotas of all workers, and sharded by
+ * worker: each worker's quotas start at a shard of their own. The requests that were made against
+ * the quota since its last report are periodically sent to the service as the hits_addend of a
+ * single request, and the verdict of the service adjusts the quota: while the service reports the
+ * limit as exceeded, the worker rejects the requests of the quota whatever its bucket holds, and
+ * otherwise the bucket is capped at the smallest limit_remaining of the descriptors. Between
+ * verdicts the bucket refills at the LocalQuotaSettings rate. Quotas that saw no request since the
+ * last report are forgotten.
+ */
+class ThreadLocalQuotas : public ThreadLocal::ThreadLocalObject {
+public:
+  /**
+   * State shared by the quotas of all workers.
+   */
+  struct SharedState {
+    SharedState(const LocalQuotaSettings& settings, Grpc::AsyncClientFactoryPtr&& factory,
+                Stats::Scope& scope, uint32_t concurrency, MonotonicTimeSource& time_source);
+
+    /**
+     * @return the token bucket of a set of descriptors, which is created by the first worker that
+     *         asks for it.
+     */
+    std::shared_ptr<ShardedTokenBucketImpl> bucket(const std::string& key);
+
+    /**
+     * Drops the token bucket of a set of descriptors once no worker has a quota for it.
+     */
+    void releaseBucket(const std::string& key);
+
+    const LocalQuotaSettings settings_;
+    const Grpc::AsyncClientFactoryPtr factory_;
+    const Protobuf::MethodDescriptor& service_method_;
+    LocalQuotaStats stats_;
+    const uint32_t concurrency_;
+    // The shard of the next worker that admits a request.
+    std::atomic<uint32_t> next_shard_{};
+    MonotonicTimeSource& time_source_;
+    Thread::MutexBasicLockable buckets_lock_;
+    // Buckets are only copied with the lock held, so one that is only referenced by the map stays
+    // that way while the lock is held.
+    std::unordered_map<std::string, std::shared_ptr<ShardedTokenBucketImpl>>
+        buckets_ GUARDED_BY(buckets_lock_);
+  };
+
+  typedef std::shared_ptr<SharedState> SharedStateSharedPtr;
+
+  ThreadLocalQuotas(const SharedStateSharedPtr& shared_state, Event::Dispatcher& dispatcher);
+
+  /**
+   * Admits a request against the quota of its descriptors.
+   */
+  LimitStatus admit(const std::string& domain, const std::vector<Descriptor>& descriptors);
+
+  /**
+   * Reports the usage of the quotas since the last report. Called by a timer on each interval.
+   */
+  void report();
+
+  size_t size() const { return quotas_.size(); }
+
+private:
+  struct Quota : public RateLimitAsyncCallbacks {
+    Quota(ThreadLocalQuotas& parent, const std::string& key, const std::string& domain,
+          const std::vector<Descriptor>& descriptors);
+    ~Quota();
+
+    // Grpc::AsyncRequestCallbacks
+    void onCreateInitialMetadata(Http::HeaderMap&) override {}
+    void onSuccess(std::unique_ptr<envoy::service::ratelimit::v2::RateLimitResponse>&& response,
+                   Tracing::Span& span) override;
+    void onFailure(Grpc::Status::GrpcStatus status, const std::string& message,
+                   Tracing::Span& span) override;
+
+    ThreadLocalQuotas& parent_;
+    const std::string domain_;
+    const std::vector<Descriptor> descriptors_;
+    const std::shared_ptr<ShardedTokenBucketImpl> bucket_;
+    // Requests made against the quota since its last report.
+    uint32_t unreported_hits_{};
+    // Set while the last verdict of the service was OVER_LIMIT.
+    bool over_limit_{};
+    Grpc::AsyncRequest* request_{};
+  };
+
+  typedef std::unique_ptr<Quota> QuotaPtr;
+
+  static std::string key(const std::string& domain, const std::vector<Descriptor>& descriptors);
+
+  const SharedStateSharedPtr shared_state_;
+  // The shard of the shared buckets that this thread consumes from first. Taken on the first
+  // admit(), so that only workers take shards and not the main thread.
+  absl::optional<uint32_t> shard_;
+  Grpc::AsyncClientPtr client_;
+  Event::TimerPtr report_timer_;
+  // Destroyed before the client, which their reports in flight are cancelled on.
+  std::unordered_map<std::string, QuotaPtr> quotas_;
+};
+
+/**
+ * Client that admits requests against the quotas of the worker it is used on. It completes each
+ * limit() call within the call.
+ */
+class LocalQuotaClientImpl : public Client {
+public:
+  LocalQuotaClientImpl(ThreadLocalQuotas& quotas) : quotas_(quotas) {}
+
+  // RateLimit::Client
+  void cancel() override {}
+  void limit(RequestCallbacks& callbacks, const std::string& domain,
+             const std::vector<Descriptor>& descriptors, Tracing::Span&) override {
+    callbacks.complete(quotas_.admit(domain, descriptors));
+  }
+
+private:
+  ThreadLocalQuotas& quotas_;
+};
+
+/**
+ * Creates the clients of the local quotas of each worker, which report to the rate limit service.
+ */
+class LocalQuotaFactoryImpl : public ClientFactory {
+public:
+  LocalQuotaFactoryImpl(const envoy::config::ratelimit::v2::RateLimitServiceConfig& config,
+                        const LocalQuotaSettings& settings,
+                        Grpc::AsyncClientManager& async_client_manager, Stats::Scope& scope,
+                        ThreadLocal::SlotAllocator& tls, uint32_t concurrency,
+                        MonotonicTimeSource& time_source = ProdMonotonicTimeSource::instance_);
+
+  // RateLimit::ClientFactory
+  ClientPtr create(const absl::optional<std::chrono::milliseconds>& timeout) override;
+
+private:
+  ThreadLocal::SlotPtr tls_;
+};
+
+} // namespace RateLimit
+} // namespace Envoy
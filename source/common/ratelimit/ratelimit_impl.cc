@@ -81,6 +81,18 @@ GrpcFactoryImpl::GrpcFactoryImpl(const envoy::config::ratelimit::v2::RateLimitSe
                                  Grpc::AsyncClientManager& async_client_manager,
                                  Stats::Scope& scope)
     : use_data_plane_proto_(config.use_data_plane_proto()) {
+  async_client_factory_ =
+      async_client_manager.factoryForGrpcService(grpcService(config), scope, false);
+
+  // TODO(junr03): legacy rate limit is deprecated. Remove this warning after 1.8.0.
+  if (!use_data_plane_proto_) {
+    ENVOY_LOG_MISC(warn, "legacy rate limit client is deprecated, update your service to support "
+                         "the data-plane-api defined rate limit service");
+  }
+}
+
+envoy::api::v2::core::GrpcService
+GrpcFactoryImpl::grpcService(const envoy::config::ratelimit::v2::RateLimitServiceConfig& config) {
   envoy::api::v2::core::GrpcService grpc_service;
   grpc_service.MergeFrom(config.grpc_service());
   // TODO(htuch): cluster_name is deprecated, remove after 1.6.0.
@@ -88,13 +100,7 @@ GrpcFactoryImpl::GrpcFactoryImpl(const envoy::config::ratelimit::v2::RateLimitSe
       envoy::config::ratelimit::v2::RateLimitServiceConfig::kClusterName) {
     grpc_service.mutable_envoy_grpc()->set_cluster_name(config.cluster_name());
   }
-  async_client_factory_ = async_client_manager.factoryForGrpcService(grpc_service, scope, false);
-
-  // TODO(junr03): legacy rate limit is deprecated. Remove this warning after 1.8.0.
-  if (!use_data_plane_proto_) {
-    ENVOY_LOG_MISC(warn, "legacy rate limit client is deprecated, update your service to support "
-                         "the data-plane-api defined rate limit service");
-  }
+  return grpc_service;
 }
 
 ClientPtr GrpcFactoryImpl::create(const absl::optional<std::chrono::milliseconds>& timeout) {
@@ -72,6 +72,12 @@ public:
   GrpcFactoryImpl(const envoy::config::ratelimit::v2::RateLimitServiceConfig& config,
                   Grpc::AsyncClientManager& async_client_manager, Stats::Scope& scope);
 
+  /**
+   * @return the gRPC service that the rate limit service config points to.
+   */
+  static envoy::api::v2::core::GrpcService
+  grpcService(const envoy::config::ratelimit::v2::RateLimitServiceConfig& config);
+
   // RateLimit::ClientFactory
   ClientPtr create(const absl::optional<std::chrono::milliseconds>& timeout) override;
 
@@ -129,6 +129,14 @@ void RdsRouteConfigProviderImpl::onConfigUpdate(const ResourceVector& resources,
   runInitializeCallbackIfAny();
 }
 
+void RdsRouteConfigProviderImpl::onConfigUpdate(
+    const ResourceVector& added_resources, const Protobuf::RepeatedPtrField<std::string>&,
+    const std::string& system_version_info) {
+  // Only the route configuration of this provider is watched. An incremental update either carries
+  // a new configuration or its removal, which is handled like a response without it.
+  onConfigUpdate(added_resources, system_version_info);
+}
+
 void RdsRouteConfigProviderImpl::onConfigUpdateFailed(const EnvoyException*) {
   // We need to allow server startup to continue, even if we have a bad
   // config.
@@ -30,9 +30,6 @@
 
 namespace Envoy {
 namespace Router {
-namespace {
-uint32_t getLength(const Buffer::Instance* instance) { return instance ? instance->length() : 0; }
-} // namespace
 
 void FilterUtility::setUpstreamScheme(Http::HeaderMap& headers,
                                       const Upstream::ClusterInfo& cluster) {
@@ -336,33 +333,31 @@ void Filter::sendNoHealthyUpstreamResponse() {
 
 Http::FilterDataStatus Filter::decodeData(Buffer::Instance& data, bool end_stream) {
   bool buffering = (retry_state_ && retry_state_->enabled()) || do_shadowing_;
-  if (buffering && buffer_limit_ > 0 &&
-      getLength(callbacks_->decodingBuffer()) + data.length() > buffer_limit_) {
-    // The request is larger than we should buffer. Give up on the retry/shadow
+  if (buffering && buffer_limit_ > 0 && request_body_.length() + data.length() > buffer_limit_) {
+    // The request is larger than we should buffer. Give up on the retry/shadow and release the
+    // body kept so far. The request keeps streaming to the current upstream.
     cluster_->stats().retry_or_shadow_abandoned_.inc();
     retry_state_.reset();
     buffering = false;
     do_shadowing_ = false;
+    request_body_.clear();
   }
 
-  // If we are going to buffer for retries or shadowing, we need to make a copy before encoding
-  // since it's all moves from here on.
+  // If we are potentially going to retry or shadow this request we keep an immutable copy of the
+  // body before encoding, since it's all moves from here on. The connection manager does not need
+  // to buffer as well, so the body is held in memory only once.
   if (buffering) {
-    Buffer::OwnedImpl copy(data);
-    upstream_request_->encodeData(copy, end_stream);
-  } else {
-    upstream_request_->encodeData(data, end_stream);
+    request_body_.add(data);
+    request_body_buffered_ = true;
   }
 
+  upstream_request_->encodeData(data, end_stream);
+
   if (end_stream) {
     onRequestComplete();
   }
 
-  // If we are potentially going to retry or shadow this request we need to buffer.
-  // This will not cause the connection manager to 413 because before we hit the
-  // buffer limit we give up on retries and buffering.
-  return buffering ? Http::FilterDataStatus::StopIterationAndBuffer
-                   : Http::FilterDataStatus::StopIterationNoBuffer;
+  return Http::FilterDataStatus::StopIterationNoBuffer;
 }
 
 Http::FilterTrailersStatus Filter::decodeTrailers(Http::HeaderMap& trailers) {
@@ -397,8 +392,9 @@ void Filter::maybeDoShadowing() {
   ASSERT(!route_entry_->shadowPolicy().cluster().empty());
   Http::MessagePtr request(new Http::RequestMessageImpl(
       Http::HeaderMapPtr{new Http::HeaderMapImpl(*downstream_headers_)}));
-  if (callbacks_->decodingBuffer()) {
-    request->body().reset(new Buffer::OwnedImpl(*callbacks_->decodingBuffer()));
+  if (request_body_buffered_) {
+    request->body().reset(new Buffer::OwnedImpl());
+    request_body_.addTo(*request->body());
   }
   if (downstream_trailers_) {
     request->trailers(Http::HeaderMapPtr{new Http::HeaderMapImpl(*downstream_trailers_)});
@@ -755,13 +751,14 @@ void Filter::doRetry() {
   ASSERT(response_timeout_ || timeout_.global_timeout_.count() == 0);
   ASSERT(!upstream_request_);
   upstream_request_.reset(new UpstreamRequest(*this, *conn_pool));
-  upstream_request_->encodeHeaders(!callbacks_->decodingBuffer() && !downstream_trailers_);
+  upstream_request_->encodeHeaders(!request_body_buffered_ && !downstream_trailers_);
   // It's possible we got immediately reset.
   if (upstream_request_) {
-    if (callbacks_->decodingBuffer()) {
-      // If we are doing a retry we need to make a copy.
-      Buffer::OwnedImpl copy(*callbacks_->decodingBuffer());
-      upstream_request_->encodeData(copy, !downstream_trailers_);
+    if (request_body_buffered_) {
+      // The retry references the kept body, so no copy of the data is made.
+      Buffer::OwnedImpl body;
+      request_body_.addTo(body);
+      upstream_request_->encodeData(body, !downstream_trailers_);
     }
 
     if (downstream_trailers_) {
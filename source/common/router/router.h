@@ -17,6 +17,7 @@
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/access_log/access_log_impl.h"
+#include "common/buffer/shared_slice_buffer.h"
 #include "common/buffer/watermark_buffer.h"
 #include "common/common/hash.h"
 #include "common/common/hex.h"
@@ -141,7 +142,7 @@ class Filter : Logger::Loggable<Logger::Id::router>,
 public:
   Filter(FilterConfig& config)
       : config_(config), downstream_response_started_(false), downstream_end_stream_(false),
-        do_shadowing_(false) {}
+        do_shadowing_(false), request_body_buffered_(false) {}
 
   ~Filter();
 
@@ -361,6 +362,9 @@ private:
   Http::HeaderMap* downstream_trailers_{};
   MonotonicTime downstream_request_complete_time_;
   uint32_t buffer_limit_{0};
+  // Immutable copy of the request body, kept while retries or shadowing are possible. Retries and
+  // shadows reference its slices rather than copying the body again.
+  Buffer::SharedSliceBuffer request_body_;
   bool stream_destroyed_{};
   MetadataMatchCriteriaConstPtr metadata_match_;
 
@@ -370,6 +374,7 @@ private:
   bool downstream_response_started_ : 1;
   bool downstream_end_stream_ : 1;
   bool do_shadowing_ : 1;
+  bool request_body_buffered_ : 1;
 };
 
 class ProdFilter : public Filter {
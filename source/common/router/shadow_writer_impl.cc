@@ -11,8 +11,34 @@
 namespace Envoy {
 namespace Router {
 
+ShadowWriterImpl::ShadowRequest::ShadowRequest(Upstream::ClusterInfoConstSharedPtr cluster)
+    : cluster_(cluster) {
+  cluster_->resourceManager(Upstream::ResourcePriority::Default).shadowRequests().inc();
+}
+
+ShadowWriterImpl::ShadowRequest::~ShadowRequest() {
+  cluster_->resourceManager(Upstream::ResourcePriority::Default).shadowRequests().dec();
+}
+
 void ShadowWriterImpl::shadow(const std::string& cluster, Http::MessagePtr&& request,
                               std::chrono::milliseconds timeout) {
+  // Configuration should guarantee that cluster exists before calling here, but it may have been
+  // removed since via CDS. Shadowing is best effort, so just drop the request.
+  Upstream::ThreadLocalCluster* thread_local_cluster = cm_.get(cluster);
+  if (thread_local_cluster == nullptr) {
+    return;
+  }
+
+  // Shadow requests have their own budget so that a slow shadow cluster sheds mirrored traffic
+  // instead of stalling or growing the primary request path.
+  Upstream::ClusterInfoConstSharedPtr cluster_info = thread_local_cluster->info();
+  if (!cluster_info->resourceManager(Upstream::ResourcePriority::Default)
+           .shadowRequests()
+           .canCreate()) {
+    cluster_info->stats().upstream_rq_shadow_overflow_.inc();
+    return;
+  }
+
   ASSERT(!request->headers().Host()->value().empty());
   // Switch authority to add a shadow postfix. This allows upstream logging to make more sense.
   auto parts = StringUtil::splitToken(request->headers().Host()->value().c_str(), ":");
@@ -20,9 +46,9 @@ void ShadowWriterImpl::shadow(const std::string& cluster, Http::MessagePtr&& req
   request->headers().Host()->value(
       parts.size() == 2 ? absl::StrJoin(parts, "-shadow:")
                         : absl::StrCat(request->headers().Host()->value().c_str(), "-shadow"));
-  // Configuration should guarantee that cluster exists before calling here. This is basically
-  // fire and forget. We don't handle cancelling.
-  cm_.httpAsyncClientForCluster(cluster).send(std::move(request), *this,
+  // This is basically fire and forget. We don't handle cancelling. The ShadowRequest deletes
+  // itself when the request completes, which may happen inline.
+  cm_.httpAsyncClientForCluster(cluster).send(std::move(request), *new ShadowRequest(cluster_info),
                                               absl::optional<std::chrono::milliseconds>(timeout));
 }
 
@@ -11,9 +11,12 @@ namespace Router {
 
 /**
  * Implementation of ShadowWriter that takes incoming requests to shadow and implements "fire and
- * forget" behavior using an async client.
+ * forget" behavior using an async client. The number of in flight shadow requests is bounded by
+ * the shadow cluster's shadow request resource. Requests past that limit are dropped and counted
+ * in upstream_rq_shadow_overflow so that a slow shadow cluster cannot accumulate requests (and
+ * their buffered bodies) on behalf of the primary request path.
  */
-class ShadowWriterImpl : public ShadowWriter, public Http::AsyncClient::Callbacks {
+class ShadowWriterImpl : public ShadowWriter {
 public:
   ShadowWriterImpl(Upstream::ClusterManager& cm) : cm_(cm) {}
 
@@ -21,11 +24,24 @@ public:
   void shadow(const std::string& cluster, Http::MessagePtr&& request,
               std::chrono::milliseconds timeout) override;
 
-  // Http::AsyncClient::Callbacks
-  void onSuccess(Http::MessagePtr&&) override {}
-  void onFailure(Http::AsyncClient::FailureReason) override {}
-
 private:
+  /**
+   * Callbacks for a single in flight shadow request. Holds a unit of the shadow cluster's shadow
+   * request resource until the request completes, and then deletes itself.
+   */
+  class ShadowRequest : public Http::AsyncClient::Callbacks {
+  public:
+    ShadowRequest(Upstream::ClusterInfoConstSharedPtr cluster);
+    ~ShadowRequest();
+
+    // Http::AsyncClient::Callbacks
+    void onSuccess(Http::MessagePtr&&) override { delete this; }
+    void onFailure(Http::AsyncClient::FailureReason) override { delete this; }
+
+  private:
+    const Upstream::ClusterInfoConstSharedPtr cluster_;
+  };
+
   Upstream::ClusterManager& cm_;
 };
 
@@ -306,7 +306,10 @@ LoaderImpl::LoaderImpl(RandomGenerator& generator, Stats::Store& store,
 LoaderImpl::LoaderImpl(DoNotLoadSnapshot /* unused */, RandomGenerator& generator,
                        Stats::Store& store, ThreadLocal::SlotAllocator& tls)
     : generator_(generator), stats_(generateStats(store)), admin_layer_(stats_),
-      tls_(tls.allocateSlot()) {}
+      tls_(tls.allocateSlot()) {
+  // Health check sessions read runtime on the restricted health check threads.
+  tls_->includeRestrictedThreads();
+}
 
 std::unique_ptr<SnapshotImpl> LoaderImpl::createNewSnapshot() {
   std::vector<Snapshot::OverrideLayerConstPtr> layers;
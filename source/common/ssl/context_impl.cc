@@ -21,6 +21,14 @@
 namespace Envoy {
 namespace Ssl {
 
+namespace {
+
+// Upper bound on the number of upstream peers a client context keeps a session for.
+const size_t MaxClientSessions = 1024;
+const size_t SessionCacheShards = 16;
+
+} // namespace
+
 int ContextImpl::sslContextIndex() {
   CONSTRUCT_ON_FIRST_USE(int, []() -> int {
     int ssl_context_index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
@@ -29,6 +37,18 @@ int ContextImpl::sslContextIndex() {
   }());
 }
 
+int ContextImpl::sslPeerIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, []() -> int {
+    int ssl_peer_index = SSL_get_ex_new_index(
+        0, nullptr, nullptr, nullptr,
+        [](void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*) -> void {
+          delete static_cast<std::string*>(ptr);
+        });
+    RELEASE_ASSERT(ssl_peer_index >= 0, "");
+    return ssl_peer_index;
+  }());
+}
+
 ContextImpl::ContextImpl(ContextManagerImpl& parent, Stats::Scope& scope,
                          const ContextConfig& config)
     : parent_(parent), ctx_(SSL_CTX_new(TLS_method())), scope_(scope),
@@ -331,6 +351,14 @@ void ContextImpl::logHandshake(SSL* ssl) const {
   }
 }
 
+bool ContextImpl::ktlsTxEnabled() const {
+  return parent_.runtime().snapshot().featureEnabled("ssl.ktls.tx", 0);
+}
+
+bool ContextImpl::ktlsRxEnabled() const {
+  return parent_.runtime().snapshot().featureEnabled("ssl.ktls.rx", 0);
+}
+
 bool ContextImpl::verifySubjectAltName(X509* cert,
                                        const std::vector<std::string>& subject_alt_names) {
   bssl::UniquePtr<GENERAL_NAMES> san_names(
@@ -464,12 +492,48 @@ std::string ContextImpl::getCertChainInformation() const {
 ClientContextImpl::ClientContextImpl(ContextManagerImpl& parent, Stats::Scope& scope,
                                      const ClientContextConfig& config)
     : ContextImpl(parent, scope, config), server_name_indication_(config.serverNameIndication()),
-      allow_renegotiation_(config.allowRenegotiation()) {
+      allow_renegotiation_(config.allowRenegotiation()),
+      session_cache_(MaxClientSessions, SessionCacheShards) {
   if (!parsed_alpn_protocols_.empty()) {
     int rc = SSL_CTX_set_alpn_protos(ctx_.get(), &parsed_alpn_protocols_[0],
                                      parsed_alpn_protocols_.size());
     RELEASE_ASSERT(rc == 0, "");
   }
+
+  // Keep the sessions established with each upstream peer so that later connections to the same
+  // peer can skip the full handshake. BoringSSL has no internal client session cache, the new
+  // session callback is the only way to get at sessions, including TLS 1.3 post-handshake ones.
+  SSL_CTX_set_session_cache_mode(ctx_.get(), SSL_SESS_CACHE_CLIENT);
+  SSL_CTX_sess_set_new_cb(ctx_.get(), [](SSL* ssl, SSL_SESSION* session) -> int {
+    ContextImpl* context_impl =
+        static_cast<ContextImpl*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), sslContextIndex()));
+    ClientContextImpl* client_context_impl = dynamic_cast<ClientContextImpl*>(context_impl);
+    RELEASE_ASSERT(client_context_impl != nullptr, ""); // for Coverity
+    return client_context_impl->newSessionCallback(ssl, session);
+  });
+}
+
+void ClientContextImpl::resumeSession(SSL* ssl, const std::string& peer) const {
+  bssl::UniquePtr<SSL_SESSION> session = session_cache_.lookup(peer);
+  if (session != nullptr) {
+    int rc = SSL_set_session(ssl, session.get());
+    RELEASE_ASSERT(rc == 1, "");
+  }
+
+  int rc = SSL_set_ex_data(ssl, sslPeerIndex(), new std::string(peer));
+  RELEASE_ASSERT(rc == 1, "");
+}
+
+int ClientContextImpl::newSessionCallback(SSL* ssl, SSL_SESSION* session) {
+  const std::string* peer = static_cast<const std::string*>(SSL_get_ex_data(ssl, sslPeerIndex()));
+  if (peer == nullptr) {
+    // The peer of the connection is not known, so the session could not be found again.
+    return 0;
+  }
+
+  // Returning 1 takes ownership of the reference to the session.
+  session_cache_.insert(*peer, bssl::UniquePtr<SSL_SESSION>(session));
+  return 1;
 }
 
 bssl::UniquePtr<SSL> ClientContextImpl::newSsl() const {
@@ -492,7 +556,40 @@ ServerContextImpl::ServerContextImpl(ContextManagerImpl& parent, Stats::Scope& s
                                      const std::vector<std::string>& server_names,
                                      Runtime::Loader& runtime)
     : ContextImpl(parent, scope, config), runtime_(runtime),
-      session_ticket_keys_(config.sessionTicketKeys()) {
+      session_ticket_keys_(config.sessionTicketKeys()),
+      private_key_method_provider_(parent.privateKeyMethodProvider()) {
+  // Replace BoringSSL's per-context session cache, which is guarded by a single lock, with the
+  // manager's sharded cache. The cache is shared by all server contexts, which is safe as
+  // BoringSSL only resumes sessions whose session ID context matches the context's. Sessions
+  // resumed with tickets are not given a session ID and so never enter the cache.
+  SSL_CTX_set_session_cache_mode(ctx_.get(), SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+  SSL_CTX_sess_set_new_cb(ctx_.get(), [](SSL* ssl, SSL_SESSION* session) -> int {
+    unsigned id_length = 0;
+    const uint8_t* id = SSL_SESSION_get_id(session, &id_length);
+    fromSslCtx(SSL_get_SSL_CTX(ssl))
+        ->parent_.serverSessionCache()
+        .insert(absl::string_view(reinterpret_cast<const char*>(id), id_length),
+                bssl::UniquePtr<SSL_SESSION>(session));
+    return 1;
+  });
+  SSL_CTX_sess_set_get_cb(ctx_.get(),
+                          [](SSL* ssl, const uint8_t* id, int id_length,
+                             int* out_copy) -> SSL_SESSION* {
+                            // The returned reference is handed over to BoringSSL.
+                            *out_copy = 0;
+                            return fromSslCtx(SSL_get_SSL_CTX(ssl))
+                                ->parent_.serverSessionCache()
+                                .lookup(absl::string_view(reinterpret_cast<const char*>(id),
+                                                          id_length))
+                                .release();
+                          });
+  SSL_CTX_sess_set_remove_cb(ctx_.get(), [](SSL_CTX* ctx, SSL_SESSION* session) -> void {
+    unsigned id_length = 0;
+    const uint8_t* id = SSL_SESSION_get_id(session, &id_length);
+    fromSslCtx(ctx)->parent_.serverSessionCache().remove(
+        absl::string_view(reinterpret_cast<const char*>(id), id_length));
+  });
+
   if (config.certChain().empty()) {
     throw EnvoyException("Server TlsCertificates must have a certificate specified");
   }
@@ -566,6 +663,13 @@ ServerContextImpl::ServerContextImpl(ContextManagerImpl& parent, Stats::Scope& s
         });
   }
 
+  if (private_key_method_provider_ != nullptr) {
+    // The key loaded above stays in the context for the provider to use (or ignore); BoringSSL
+    // hands all private key operations of the handshake to the method instead.
+    SSL_CTX_set_private_key_method(ctx_.get(),
+                                   private_key_method_provider_->getBoringSslPrivateKeyMethod());
+  }
+
   uint8_t session_context_buf[EVP_MAX_MD_SIZE] = {};
   unsigned session_context_len = 0;
   EVP_MD_CTX md;
@@ -655,6 +759,14 @@ ServerContextImpl::ServerContextImpl(ContextManagerImpl& parent, Stats::Scope& s
   RELEASE_ASSERT(rc == 1, "");
 }
 
+ServerContextImpl* ServerContextImpl::fromSslCtx(SSL_CTX* ctx) {
+  ContextImpl* context_impl =
+      static_cast<ContextImpl*>(SSL_CTX_get_ex_data(ctx, sslContextIndex()));
+  ServerContextImpl* server_context_impl = dynamic_cast<ServerContextImpl*>(context_impl);
+  RELEASE_ASSERT(server_context_impl != nullptr, ""); // for Coverity
+  return server_context_impl;
+}
+
 int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv,
                                             EVP_CIPHER_CTX* ctx, HMAC_CTX* hmac_ctx, int encrypt) {
   const EVP_MD* hmac = EVP_sha256();
@@ -11,6 +11,7 @@
 
 #include "common/ssl/context_impl.h"
 #include "common/ssl/context_manager_impl.h"
+#include "common/ssl/session_cache_impl.h"
 
 #include "openssl/ssl.h"
 
@@ -30,7 +31,10 @@ namespace Ssl {
   COUNTER(fail_verify_no_cert)                                                                     \
   COUNTER(fail_verify_error)                                                                       \
   COUNTER(fail_verify_san)                                                                         \
-  COUNTER(fail_verify_cert_hash)
+  COUNTER(fail_verify_cert_hash)                                                                   \
+  COUNTER(ktls_tx)                                                                                 \
+  COUNTER(ktls_rx)                                                                                 \
+  COUNTER(ktls_unsupported)
 // clang-format on
 
 /**
@@ -44,6 +48,14 @@ class ContextImpl : public virtual Context {
 public:
   virtual bssl::UniquePtr<SSL> newSsl() const;
 
+  /**
+   * Called once the peer of a new connection is known and before its handshake starts. Client
+   * contexts use this to resume the session they last established with the peer.
+   * @param ssl the connection.
+   * @param peer identifies the peer, e.g. its address.
+   */
+  virtual void resumeSession(SSL*, const std::string&) const {}
+
   /**
    * Logs successful TLS handshake and updates stats.
    * @param ssl the connection to log
@@ -69,6 +81,24 @@ public:
 
   SslStats& stats() { return stats_; }
 
+  /**
+   * @return PrivateKeyMethodProvider* the provider that connections of this context must register
+   *         with before their handshake, or nullptr if private key operations run inline.
+   */
+  virtual PrivateKeyMethodProvider* privateKeyMethodProvider() const { return nullptr; }
+
+  /**
+   * @return true if new connections should hand encryption of the records they send to the kernel
+   *         once their handshake completes. Controlled by the "ssl.ktls.tx" runtime key.
+   */
+  bool ktlsTxEnabled() const;
+
+  /**
+   * @return true if new connections should hand decryption of the records they receive to the
+   *         kernel once their handshake completes. Controlled by the "ssl.ktls.rx" runtime key.
+   */
+  bool ktlsRxEnabled() const;
+
   // Ssl::Context
   size_t daysUntilFirstCertExpires() const override;
   std::string getCaCertInformation() const override;
@@ -84,6 +114,12 @@ protected:
    */
   static int sslContextIndex();
 
+  /**
+   * The global SSL-library index used for storing the peer (as passed to resumeSession()) of a
+   * client connection in the SSL instance, so that its new session can be cached under it.
+   */
+  static int sslPeerIndex();
+
   // A X509_STORE_CTX_verify_cb callback for ignoring cert expiration in X509_verify_cert().
   static int ignoreCertificateExpirationCallback(int ok, X509_STORE_CTX* store_ctx);
 
@@ -144,10 +180,15 @@ public:
                     const ClientContextConfig& config);
 
   bssl::UniquePtr<SSL> newSsl() const override;
+  void resumeSession(SSL* ssl, const std::string& peer) const override;
 
 private:
+  int newSessionCallback(SSL* ssl, SSL_SESSION* session);
+
   const std::string server_name_indication_;
   const bool allow_renegotiation_;
+  // The last session established with each upstream peer. Contexts are shared by all workers.
+  mutable SessionCacheImpl session_cache_;
 };
 
 class ServerContextImpl : public ContextImpl, public ServerContext {
@@ -156,15 +197,22 @@ public:
                     const ServerContextConfig& config, const std::vector<std::string>& server_names,
                     Runtime::Loader& runtime);
 
+  // ContextImpl
+  PrivateKeyMethodProvider* privateKeyMethodProvider() const override {
+    return private_key_method_provider_;
+  }
+
 private:
   int alpnSelectCallback(const unsigned char** out, unsigned char* outlen, const unsigned char* in,
                          unsigned int inlen);
   int sessionTicketProcess(SSL* ssl, uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* ctx,
                            HMAC_CTX* hmac_ctx, int encrypt);
+  static ServerContextImpl* fromSslCtx(SSL_CTX* ctx);
 
   Runtime::Loader& runtime_;
   std::vector<uint8_t> parsed_alt_alpn_protocols_;
   const std::vector<ServerContextConfig::SessionTicketKey> session_ticket_keys_;
+  PrivateKeyMethodProvider* const private_key_method_provider_;
 };
 
 } // namespace Ssl
@@ -6,6 +6,9 @@
 
 #include "envoy/runtime/runtime.h"
 #include "envoy/ssl/context_manager.h"
+#include "envoy/ssl/private_key_method.h"
+
+#include "common/ssl/session_cache_impl.h"
 
 namespace Envoy {
 namespace Ssl {
@@ -19,7 +22,15 @@ namespace Ssl {
  */
 class ContextManagerImpl final : public ContextManager {
 public:
-  ContextManagerImpl(Runtime::Loader& runtime) : runtime_(runtime) {}
+  /**
+   * @param runtime supplies the runtime loader.
+   * @param private_key_method_provider supplies an optional provider that server contexts hand
+   *        their private key operations to, instead of running them inline on the worker.
+   */
+  ContextManagerImpl(Runtime::Loader& runtime,
+                     PrivateKeyMethodProviderSharedPtr private_key_method_provider = nullptr)
+      : runtime_(runtime), private_key_method_provider_(private_key_method_provider),
+        server_session_cache_(MaxServerSessions, ServerSessionCacheShards) {}
   ~ContextManagerImpl();
 
   /**
@@ -29,6 +40,26 @@ public:
    */
   void releaseContext(Context* context);
 
+  /**
+   * @return SessionCacheImpl& the session cache shared by all server contexts, so that a session
+   *         established on one worker (or listener with the same session ID context) can be
+   *         resumed on any other.
+   */
+  SessionCacheImpl& serverSessionCache() { return server_session_cache_; }
+
+  /**
+   * @return PrivateKeyMethodProvider* the provider of private key operations for server contexts,
+   *         or nullptr if they are performed inline.
+   */
+  PrivateKeyMethodProvider* privateKeyMethodProvider() {
+    return private_key_method_provider_.get();
+  }
+
+  /**
+   * @return Runtime::Loader& the runtime loader contexts read their feature flags from.
+   */
+  Runtime::Loader& runtime() { return runtime_; }
+
   // Ssl::ContextManager
   Ssl::ClientContextPtr createSslClientContext(Stats::Scope& scope,
                                                const ClientContextConfig& config) override;
@@ -39,9 +70,15 @@ public:
   void iterateContexts(std::function<void(const Context&)> callback) override;
 
 private:
+  // Matches the default size of BoringSSL's per-context session cache.
+  static const size_t MaxServerSessions = 20 * 1024;
+  static const size_t ServerSessionCacheShards = 16;
+
   Runtime::Loader& runtime_;
+  const PrivateKeyMethodProviderSharedPtr private_key_method_provider_;
   std::list<Context*> contexts_;
   mutable std::shared_timed_mutex contexts_lock_;
+  SessionCacheImpl server_session_cache_;
 };
 
 } // namespace Ssl
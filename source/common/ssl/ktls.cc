@@ -0,0 +1,205 @@
+#include "common/ssl/ktls.h"
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/common/assert.h"
+
+#include "openssl/mem.h"
+#include "openssl/nid.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/tls.h>)
+#include <linux/tls.h>
+#endif
+#endif
+
+// Receive offload and record types other than application data need Linux 4.17 headers.
+#if defined(TLS_TX) && defined(TLS_RX) && defined(TLS_SET_RECORD_TYPE)
+#define ENVOY_SSL_KTLS
+#endif
+
+#ifdef ENVOY_SSL_KTLS
+// Older libc headers do not define these even when the kernel headers know about kTLS.
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#endif
+
+namespace Envoy {
+namespace Ssl {
+namespace Ktls {
+
+#ifdef ENVOY_SSL_KTLS
+
+namespace {
+
+// AES-GCM TLS 1.2 sessions have no MAC keys and a 4 byte implicit IV (the "salt").
+const size_t SaltLength = 4;
+
+size_t keyLength(const SSL* ssl) {
+  if (SSL_version(ssl) != TLS1_2_VERSION) {
+    return 0;
+  }
+  switch (SSL_CIPHER_get_cipher_nid(SSL_get_current_cipher(ssl))) {
+  case NID_aes_128_gcm:
+    return 16;
+#ifdef TLS_CIPHER_AES_GCM_256
+  case NID_aes_256_gcm:
+    return 32;
+#endif
+  default:
+    return 0;
+  }
+}
+
+bool attachUlp(int fd) {
+  static const char ulp[] = "tls";
+  auto& os_syscalls = Api::OsSysCallsSingleton::get();
+  // The ULP is attached once per socket; the second direction finds it already there.
+  return os_syscalls.setsockopt(fd, IPPROTO_TCP, TCP_ULP, ulp, sizeof(ulp)) == 0 ||
+         errno == EEXIST;
+}
+
+template <class CryptoInfo>
+bool setCryptoInfo(int fd, int direction, uint16_t cipher_type, const uint8_t* key,
+                   const uint8_t* salt, uint64_t sequence) {
+  CryptoInfo crypto_info;
+  memset(&crypto_info, 0, sizeof(crypto_info));
+  crypto_info.info.version = TLS_1_2_VERSION;
+  crypto_info.info.cipher_type = cipher_type;
+  static_assert(sizeof(crypto_info.rec_seq) == sizeof(sequence), "unexpected sequence size");
+  for (size_t i = 0; i < sizeof(crypto_info.rec_seq); i++) {
+    crypto_info.rec_seq[i] = static_cast<uint8_t>(sequence >> (8 * (sizeof(sequence) - 1 - i)));
+  }
+  // BoringSSL uses the sequence number as the explicit nonce of AES-GCM records, and the kernel
+  // advances the explicit nonce in step with the sequence number.
+  static_assert(sizeof(crypto_info.iv) == sizeof(crypto_info.rec_seq), "unexpected nonce size");
+  memcpy(crypto_info.iv, crypto_info.rec_seq, sizeof(crypto_info.iv));
+  memcpy(crypto_info.key, key, sizeof(crypto_info.key));
+  static_assert(sizeof(crypto_info.salt) == SaltLength, "unexpected salt size");
+  memcpy(crypto_info.salt, salt, sizeof(crypto_info.salt));
+
+  auto& os_syscalls = Api::OsSysCallsSingleton::get();
+  const int rc = os_syscalls.setsockopt(fd, SOL_TLS, direction, &crypto_info, sizeof(crypto_info));
+  OPENSSL_cleanse(&crypto_info, sizeof(crypto_info));
+  return rc == 0;
+}
+
+bool enable(SSL* ssl, int fd, bool transmit) {
+  const size_t key_length = keyLength(ssl);
+  if (key_length == 0) {
+    return false;
+  }
+
+  // The key block is client_write_key, server_write_key, client_write_IV, server_write_IV.
+  std::vector<uint8_t> key_block(SSL_get_key_block_len(ssl));
+  if (key_block.size() != 2 * (key_length + SaltLength) ||
+      !SSL_generate_key_block(ssl, key_block.data(), key_block.size())) {
+    return false;
+  }
+  // Clients transmit with the client keys and receive with the server keys; servers the reverse.
+  const bool client_keys = SSL_is_server(ssl) != transmit;
+  const uint8_t* key = key_block.data() + (client_keys ? 0 : key_length);
+  const uint8_t* salt = key_block.data() + 2 * key_length + (client_keys ? 0 : SaltLength);
+  const uint64_t sequence = transmit ? SSL_get_write_sequence(ssl) : SSL_get_read_sequence(ssl);
+  const int direction = transmit ? TLS_TX : TLS_RX;
+
+  bool enabled = attachUlp(fd);
+  if (enabled && key_length == 16) {
+    enabled = setCryptoInfo<tls12_crypto_info_aes_gcm_128>(fd, direction, TLS_CIPHER_AES_GCM_128,
+                                                           key, salt, sequence);
+  }
+#ifdef TLS_CIPHER_AES_GCM_256
+  if (enabled && key_length == 32) {
+    enabled = setCryptoInfo<tls12_crypto_info_aes_gcm_256>(fd, direction, TLS_CIPHER_AES_GCM_256,
+                                                           key, salt, sequence);
+  }
+#endif
+  OPENSSL_cleanse(key_block.data(), key_block.size());
+  return enabled;
+}
+
+} // namespace
+
+bool cipherSupported(const SSL* ssl) { return keyLength(ssl) != 0; }
+
+bool enableTx(SSL* ssl, int fd) { return enable(ssl, fd, true); }
+
+bool enableRx(SSL* ssl, int fd) {
+  // Anything BoringSSL has already read off the socket would never reach the kernel, and a client
+  // in False Start has yet to read the server's Finished message.
+  if (SSL_has_pending(ssl) || SSL_in_false_start(ssl)) {
+    return false;
+  }
+  return enable(ssl, fd, false);
+}
+
+ssize_t recvRecord(int fd, const iovec* iov, int iovcnt, uint8_t& record_type) {
+  char control[CMSG_SPACE(sizeof(uint8_t))];
+  msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = const_cast<iovec*>(iov);
+  msg.msg_iovlen = iovcnt;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  const ssize_t rc = ::recvmsg(fd, &msg, 0);
+  if (rc < 0) {
+    return rc;
+  }
+  // The kernel only attaches a record type when it is not application data.
+  record_type = RecordTypeApplicationData;
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  if (cmsg != nullptr && cmsg->cmsg_level == SOL_TLS && cmsg->cmsg_type == TLS_GET_RECORD_TYPE) {
+    record_type = *reinterpret_cast<uint8_t*>(CMSG_DATA(cmsg));
+  }
+  return rc;
+}
+
+ssize_t sendCloseNotify(int fd) {
+  // Alert level warning(1), description close_notify(0).
+  uint8_t alert[2] = {1, 0};
+  iovec iov{alert, sizeof(alert)};
+  char control[CMSG_SPACE(sizeof(uint8_t))];
+  msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_TLS;
+  cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint8_t));
+  *reinterpret_cast<uint8_t*>(CMSG_DATA(cmsg)) = RecordTypeAlert;
+  return ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+}
+
+#else
+
+bool cipherSupported(const SSL*) { return false; }
+
+bool enableTx(SSL*, int) { return false; }
+
+bool enableRx(SSL*, int) { return false; }
+
+ssize_t recvRecord(int, const iovec*, int, uint8_t&) { NOT_REACHED; }
+
+ssize_t sendCloseNotify(int) { NOT_REACHED; }
+
+#endif
+
+} // namespace Ktls
+} // namespace Ssl
+} // namespace Envoy
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <cstdint>
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * Helpers for handing the TLS record layer of an established connection to the Linux kernel
+ * (kTLS). Once transmit is offloaded, plaintext written to the socket is sent as encrypted
+ * application data records, so bodies can be written (and eventually spliced) without passing
+ * through BoringSSL. Once receive is offloaded, reads from the socket return decrypted plaintext.
+ *
+ * Only TLS 1.2 with AES-GCM is supported: BoringSSL exposes the traffic keys of those sessions via
+ * its key block, and the kernel implements those ciphers on every version that has kTLS. Any other
+ * session, or a kernel without the "tls" ULP, makes the enable functions fail without changing the
+ * socket, and the connection keeps using BoringSSL for its records.
+ */
+namespace Ktls {
+
+// TLS record content types (RFC 5246 section 6.2.1).
+const uint8_t RecordTypeAlert = 21;
+const uint8_t RecordTypeApplicationData = 23;
+
+/**
+ * @param ssl supplies a connection whose handshake has completed.
+ * @return true if the negotiated protocol version and cipher can be offloaded to the kernel.
+ */
+bool cipherSupported(const SSL* ssl);
+
+/**
+ * Offload encryption of records sent on fd. On success the caller must write application data
+ * directly to fd, and must no longer call SSL_write() or SSL_shutdown() on ssl.
+ * @param ssl supplies a connection whose handshake has completed and flushed.
+ * @param fd supplies the connection's TCP socket.
+ * @return true on success. On failure records must still be written with SSL_write().
+ */
+bool enableTx(SSL* ssl, int fd);
+
+/**
+ * Offload decryption of records received on fd. On success the caller must read with
+ * recvRecord() and must no longer call SSL_read() on ssl.
+ * @param ssl supplies a connection whose handshake has completed.
+ * @param fd supplies the connection's TCP socket.
+ * @return true on success. On failure, e.g. because BoringSSL already buffered bytes past the
+ *         handshake, records must still be read with SSL_read().
+ */
+bool enableRx(SSL* ssl, int fd);
+
+/**
+ * Read the plaintext of the next records on a socket with receive offloaded. A single call never
+ * returns data of more than one record type.
+ * @param fd supplies the socket.
+ * @param iov supplies the buffers to read into.
+ * @param iovcnt supplies the number of buffers.
+ * @param record_type returns the content type of the record(s) read.
+ * @return ssize_t the number of bytes read, 0 on end of stream or -1 with errno set.
+ */
+ssize_t recvRecord(int fd, const iovec* iov, int iovcnt, uint8_t& record_type);
+
+/**
+ * Send a close_notify alert on a socket with transmit offloaded.
+ * @param fd supplies the socket.
+ * @return ssize_t the number of bytes of the alert sent, or -1 with errno set.
+ */
+ssize_t sendCloseNotify(int fd);
+
+} // namespace Ktls
+} // namespace Ssl
+} // namespace Envoy
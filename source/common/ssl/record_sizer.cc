@@ -0,0 +1,32 @@
+#include "common/ssl/record_sizer.h"
+
+#include <algorithm>
+
+namespace Envoy {
+namespace Ssl {
+
+const uint32_t RecordSizer::SmallRecordSize;
+const uint32_t RecordSizer::LargeRecordSize;
+const uint64_t RecordSizer::SmallRecordBytes;
+const uint64_t RecordSizer::MaxWriteSize;
+
+void RecordSizer::onWriteStart() {
+  const MonotonicTime now = time_source_.currentTime();
+  if (now - last_write_ >= idle_timeout_) {
+    bytes_since_idle_ = 0;
+  }
+  last_write_ = now;
+}
+
+uint64_t RecordSizer::nextWriteSize(Buffer::Instance& buffer) const {
+  const uint64_t record_size = recordSize();
+  Buffer::RawSlice slice;
+  if (buffer.getRawSlices(&slice, 1) == 1 && slice.len_ >= record_size) {
+    const uint64_t max_records = std::max<uint64_t>(1, MaxWriteSize / record_size);
+    return std::min(slice.len_ / record_size, max_records) * record_size;
+  }
+  return std::min(buffer.length(), record_size);
+}
+
+} // namespace Ssl
+} // namespace Envoy
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/common/time.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * Chooses the size of the TLS records a connection writes. A record can only be decrypted once
+ * all of it has arrived, so while the congestion window is small (at the start of a connection and
+ * after it has been idle) records are kept small enough to fit a single TCP segment, letting the
+ * peer start processing the first bytes of a response after one round trip. Once a burst has
+ * written enough to be past slow start, records grow to the TLS maximum to minimize per-record
+ * framing and CPU overhead on bulk transfers.
+ */
+class RecordSizer {
+public:
+  // Payload that fits a 1460 byte MSS along with the record header, explicit nonce and AEAD tag.
+  static const uint32_t SmallRecordSize = 1400;
+  static const uint32_t LargeRecordSize = 16384;
+  // Bytes written in small records before switching to large ones.
+  static const uint64_t SmallRecordBytes = 64 * 1024;
+  // Upper bound on a single write, so that one connection cannot monopolize its worker.
+  static const uint64_t MaxWriteSize = 4 * LargeRecordSize;
+
+  RecordSizer(MonotonicTimeSource& time_source,
+              std::chrono::milliseconds idle_timeout = std::chrono::milliseconds(1000))
+      : time_source_(time_source), idle_timeout_(idle_timeout) {}
+
+  /**
+   * Start a write. Resets to small records if nothing was written for the idle timeout.
+   */
+  void onWriteStart();
+
+  /**
+   * Record that bytes of application data were written.
+   */
+  void onBytesWritten(uint64_t bytes) { bytes_since_idle_ += bytes; }
+
+  /**
+   * @return uint32_t the record size to use for the next write.
+   */
+  uint32_t recordSize() const {
+    return bytes_since_idle_ < SmallRecordBytes ? SmallRecordSize : LargeRecordSize;
+  }
+
+  /**
+   * @return uint64_t how many bytes from the front of buffer to hand to a single SSL_write() call
+   *         with records of recordSize(). If the first slice holds at least a whole record, whole
+   *         records are written straight from the slice. Otherwise the following slices are
+   *         coalesced into one record, which is the only case in which data gets copied.
+   */
+  uint64_t nextWriteSize(Buffer::Instance& buffer) const;
+
+private:
+  MonotonicTimeSource& time_source_;
+  const std::chrono::milliseconds idle_timeout_;
+  MonotonicTime last_write_{};
+  uint64_t bytes_since_idle_{};
+};
+
+} // namespace Ssl
+} // namespace Envoy
@@ -0,0 +1,75 @@
+#include "common/ssl/session_cache_impl.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+#include "common/common/hash.h"
+
+namespace Envoy {
+namespace Ssl {
+
+SessionCacheImpl::SessionCacheImpl(size_t max_sessions, size_t num_shards)
+    : max_sessions_per_shard_(std::max<size_t>(1, max_sessions / num_shards)) {
+  ASSERT(num_shards > 0);
+  for (size_t i = 0; i < num_shards; i++) {
+    shards_.emplace_back(new Shard());
+  }
+}
+
+SessionCacheImpl::Shard& SessionCacheImpl::shardFor(absl::string_view key) {
+  return *shards_[HashUtil::xxHash64(key) % shards_.size()];
+}
+
+void SessionCacheImpl::insert(absl::string_view key, bssl::UniquePtr<SSL_SESSION> session) {
+  Shard& shard = shardFor(key);
+  Thread::LockGuard lock(shard.lock_);
+  auto it = shard.index_.find(std::string(key));
+  if (it != shard.index_.end()) {
+    it->second->second = std::move(session);
+    shard.sessions_.splice(shard.sessions_.begin(), shard.sessions_, it->second);
+    return;
+  }
+
+  if (shard.sessions_.size() >= max_sessions_per_shard_) {
+    shard.index_.erase(shard.sessions_.back().first);
+    shard.sessions_.pop_back();
+  }
+  shard.sessions_.emplace_front(std::string(key), std::move(session));
+  shard.index_.emplace(shard.sessions_.front().first, shard.sessions_.begin());
+}
+
+bssl::UniquePtr<SSL_SESSION> SessionCacheImpl::lookup(absl::string_view key) {
+  Shard& shard = shardFor(key);
+  Thread::LockGuard lock(shard.lock_);
+  auto it = shard.index_.find(std::string(key));
+  if (it == shard.index_.end()) {
+    return nullptr;
+  }
+
+  shard.sessions_.splice(shard.sessions_.begin(), shard.sessions_, it->second);
+  SSL_SESSION* session = it->second->second.get();
+  SSL_SESSION_up_ref(session);
+  return bssl::UniquePtr<SSL_SESSION>(session);
+}
+
+void SessionCacheImpl::remove(absl::string_view key) {
+  Shard& shard = shardFor(key);
+  Thread::LockGuard lock(shard.lock_);
+  auto it = shard.index_.find(std::string(key));
+  if (it != shard.index_.end()) {
+    shard.sessions_.erase(it->second);
+    shard.index_.erase(it);
+  }
+}
+
+size_t SessionCacheImpl::size() {
+  size_t size = 0;
+  for (auto& shard : shards_) {
+    Thread::LockGuard lock(shard->lock_);
+    size += shard->sessions_.size();
+  }
+  return size;
+}
+
+} // namespace Ssl
+} // namespace Envoy
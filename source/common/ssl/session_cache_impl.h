@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/common/lock_guard.h"
+#include "common/common/non_copyable.h"
+#include "common/common/thread.h"
+
+#include "absl/strings/string_view.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * A bounded cache of TLS sessions that may be used from any thread. Entries are spread over a
+ * fixed number of independently locked shards by the hash of their key, so workers handshaking
+ * concurrently rarely contend on the same lock. Each shard evicts its least recently used session
+ * once it holds its share of the capacity.
+ */
+class SessionCacheImpl : NonCopyable {
+public:
+  /**
+   * @param max_sessions supplies the maximum number of sessions held by the cache.
+   * @param num_shards supplies the number of shards to spread sessions over.
+   */
+  SessionCacheImpl(size_t max_sessions, size_t num_shards);
+
+  /**
+   * Insert a session, replacing any existing session with the same key.
+   * @param key supplies the key to store the session under.
+   * @param session supplies the session. The cache takes ownership of the reference.
+   */
+  void insert(absl::string_view key, bssl::UniquePtr<SSL_SESSION> session);
+
+  /**
+   * @param key supplies the key to look up.
+   * @return bssl::UniquePtr<SSL_SESSION> a new reference to the session stored under key, or
+   *         nullptr if there is none.
+   */
+  bssl::UniquePtr<SSL_SESSION> lookup(absl::string_view key);
+
+  /**
+   * Remove the session stored under key, if any.
+   * @param key supplies the key to remove.
+   */
+  void remove(absl::string_view key);
+
+  /**
+   * @return size_t the number of sessions in the cache.
+   */
+  size_t size();
+
+private:
+  typedef std::list<std::pair<std::string, bssl::UniquePtr<SSL_SESSION>>> SessionList;
+
+  struct Shard {
+    Thread::MutexBasicLockable lock_;
+    // Most recently used first.
+    SessionList sessions_ GUARDED_BY(lock_);
+    std::unordered_map<std::string, SessionList::iterator> index_ GUARDED_BY(lock_);
+  };
+
+  Shard& shardFor(absl::string_view key);
+
+  const size_t max_sessions_per_shard_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace Ssl
+} // namespace Envoy
@@ -3,7 +3,9 @@
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/hex.h"
+#include "common/common/utility.h"
 #include "common/http/headers.h"
+#include "common/ssl/ktls.h"
 #include "common/ssl/utility.h"
 
 #include "absl/strings/str_replace.h"
@@ -16,12 +18,20 @@ namespace Envoy {
 namespace Ssl {
 
 SslSocket::SslSocket(Context& ctx, InitialState state)
-    : ctx_(dynamic_cast<Ssl::ContextImpl&>(ctx)), ssl_(ctx_.newSsl()) {
+    : ctx_(dynamic_cast<Ssl::ContextImpl&>(ctx)), ssl_(ctx_.newSsl()),
+      record_sizer_(ProdMonotonicTimeSource::instance_) {
   if (state == InitialState::Client) {
     SSL_set_connect_state(ssl_.get());
   } else {
     ASSERT(state == InitialState::Server);
     SSL_set_accept_state(ssl_.get());
+    private_key_method_provider_ = ctx_.privateKeyMethodProvider();
+  }
+}
+
+SslSocket::~SslSocket() {
+  if (private_key_method_provider_ != nullptr) {
+    private_key_method_provider_->unregisterPrivateKeyMethod(ssl_.get());
   }
 }
 
@@ -31,6 +41,18 @@ void SslSocket::setTransportSocketCallbacks(Network::TransportSocketCallbacks& c
 
   BIO* bio = BIO_new_socket(callbacks_->fd(), 0);
   SSL_set_bio(ssl_.get(), bio, bio);
+
+  if (private_key_method_provider_ != nullptr) {
+    private_key_method_provider_->registerPrivateKeyMethod(ssl_.get(), *this,
+                                                           callbacks_->connection().dispatcher());
+  }
+}
+
+void SslSocket::onPrivateKeyMethodComplete() {
+  ASSERT(!handshake_complete_);
+  // Resume the handshake from the read path, which also picks up any data the peer sent while
+  // the operation was in progress.
+  callbacks_->setReadBufferReady();
 }
 
 Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
@@ -43,6 +65,10 @@ Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
     }
   }
 
+  if (ktls_rx_) {
+    return doKtlsRead(read_buffer);
+  }
+
   bool keep_reading = true;
   bool end_stream = false;
   PostIoAction action = PostIoAction::KeepOpen;
@@ -100,6 +126,7 @@ PostIoAction SslSocket::doHandshake() {
     ENVOY_CONN_LOG(debug, "handshake complete", callbacks_->connection());
     handshake_complete_ = true;
     ctx_.logHandshake(ssl_.get());
+    enableKtls();
     callbacks_->raiseEvent(Network::ConnectionEvent::Connected);
 
     // It's possible that we closed during the handshake callback.
@@ -112,6 +139,8 @@ PostIoAction SslSocket::doHandshake() {
     switch (err) {
     case SSL_ERROR_WANT_READ:
     case SSL_ERROR_WANT_WRITE:
+    // The private key method provider will call onPrivateKeyMethodComplete() when done.
+    case SSL_ERROR_WANT_PRIVATE_KEY_OPERATION:
       return PostIoAction::KeepOpen;
     default:
       drainErrorQueue();
@@ -120,6 +149,97 @@ PostIoAction SslSocket::doHandshake() {
   }
 }
 
+void SslSocket::enableKtls() {
+  const bool tx = ctx_.ktlsTxEnabled();
+  const bool rx = ctx_.ktlsRxEnabled();
+  if (!tx && !rx) {
+    return;
+  }
+  if (!Ktls::cipherSupported(ssl_.get())) {
+    ctx_.stats().ktls_unsupported_.inc();
+    return;
+  }
+
+  // Either direction can fail on its own, e.g. on kernels with transmit but no receive offload.
+  // BoringSSL keeps handling whatever the kernel does not take over.
+  if (tx && Ktls::enableTx(ssl_.get(), callbacks_->fd())) {
+    ktls_tx_ = true;
+    ctx_.stats().ktls_tx_.inc();
+  }
+  if (rx && Ktls::enableRx(ssl_.get(), callbacks_->fd())) {
+    ktls_rx_ = true;
+    ctx_.stats().ktls_rx_.inc();
+  }
+  if ((tx && !ktls_tx_) || (rx && !ktls_rx_)) {
+    ctx_.stats().ktls_unsupported_.inc();
+  }
+  ENVOY_CONN_LOG(debug, "ktls tx={} rx={}", callbacks_->connection(), ktls_tx_, ktls_rx_);
+}
+
+Network::IoResult SslSocket::doKtlsRead(Buffer::Instance& read_buffer) {
+  PostIoAction action = PostIoAction::KeepOpen;
+  bool end_stream = false;
+  uint64_t bytes_read = 0;
+  while (true) {
+    Buffer::RawSlice slices[2];
+    const uint64_t num_slices = read_buffer.reserve(16384, slices, 2);
+    iovec iov[2];
+    for (uint64_t i = 0; i < num_slices; i++) {
+      iov[i].iov_base = slices[i].mem_;
+      iov[i].iov_len = slices[i].len_;
+    }
+    uint8_t record_type;
+    const ssize_t rc = Ktls::recvRecord(callbacks_->fd(), iov, num_slices, record_type);
+    const int error = errno; // Latch errno before any logging calls can overwrite it.
+    ENVOY_CONN_LOG(trace, "ktls read returns: {}", callbacks_->connection(), rc);
+
+    if (rc == 0) {
+      // Like SSL_read(), treat a close without close_notify as an error: it may be a truncation.
+      action = PostIoAction::Close;
+      break;
+    } else if (rc < 0) {
+      if (error != EAGAIN) {
+        ENVOY_CONN_LOG(debug, "ktls read error: {}", callbacks_->connection(), error);
+        ctx_.stats().connection_error_.inc();
+        action = PostIoAction::Close;
+      }
+      break;
+    } else if (record_type != Ktls::RecordTypeApplicationData) {
+      // The alert description follows the level byte. Anything but close_notify (0), including
+      // renegotiation, which we don't handle, closes the connection.
+      const uint8_t description =
+          slices[0].len_ > 1 ? static_cast<uint8_t*>(slices[0].mem_)[1]
+                             : static_cast<uint8_t*>(slices[1].mem_)[1 - slices[0].len_];
+      if (record_type == Ktls::RecordTypeAlert && rc == 2 && description == 0) {
+        end_stream = true;
+      } else {
+        ENVOY_CONN_LOG(debug, "ktls unexpected record type: {}", callbacks_->connection(),
+                       record_type);
+        ctx_.stats().connection_error_.inc();
+        action = PostIoAction::Close;
+      }
+      break;
+    }
+
+    uint64_t num_slices_to_commit = 0;
+    uint64_t bytes_to_commit = rc;
+    while (bytes_to_commit != 0) {
+      slices[num_slices_to_commit].len_ =
+          std::min(slices[num_slices_to_commit].len_, static_cast<size_t>(bytes_to_commit));
+      bytes_to_commit -= slices[num_slices_to_commit].len_;
+      num_slices_to_commit++;
+    }
+    read_buffer.commit(slices, num_slices_to_commit);
+    bytes_read += rc;
+    if (callbacks_->shouldDrainReadBuffer()) {
+      callbacks_->setReadBufferReady();
+      break;
+    }
+  }
+
+  return {action, bytes_read, end_stream};
+}
+
 void SslSocket::drainErrorQueue() {
   bool saw_error = false;
   bool saw_counted_error = false;
@@ -152,12 +272,17 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
     }
   }
 
+  if (ktls_tx_) {
+    return doKtlsWrite(write_buffer, end_stream);
+  }
+
   uint64_t bytes_to_write;
   if (bytes_to_retry_) {
     bytes_to_write = bytes_to_retry_;
     bytes_to_retry_ = 0;
   } else {
-    bytes_to_write = std::min(write_buffer.length(), static_cast<uint64_t>(16384));
+    record_sizer_.onWriteStart();
+    bytes_to_write = nextWriteSize(write_buffer);
   }
 
   uint64_t total_bytes_written = 0;
@@ -175,7 +300,8 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
       ASSERT(rc == static_cast<int>(bytes_to_write));
       total_bytes_written += rc;
       write_buffer.drain(rc);
-      bytes_to_write = std::min(write_buffer.length(), static_cast<uint64_t>(16384));
+      record_sizer_.onBytesWritten(rc);
+      bytes_to_write = nextWriteSize(write_buffer);
     } else {
       int err = SSL_get_error(ssl_.get(), rc);
       switch (err) {
@@ -200,14 +326,63 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
   return {PostIoAction::KeepOpen, total_bytes_written, false};
 }
 
-void SslSocket::onConnected() { ASSERT(!handshake_complete_); }
+Network::IoResult SslSocket::doKtlsWrite(Buffer::Instance& write_buffer, bool end_stream) {
+  // The kernel frames plaintext written to the socket into full size records itself, so there is
+  // no record sizing or SSL_write() retry state to track here.
+  uint64_t total_bytes_written = 0;
+  while (write_buffer.length() > 0) {
+    int rc = write_buffer.write(callbacks_->fd());
+    const int error = errno; // Latch errno before any logging calls can overwrite it.
+    ENVOY_CONN_LOG(trace, "ktls write returns: {}", callbacks_->connection(), rc);
+    if (rc == -1) {
+      if (error == EAGAIN) {
+        return {PostIoAction::KeepOpen, total_bytes_written, false};
+      }
+      ENVOY_CONN_LOG(debug, "ktls write error: {} ({})", callbacks_->connection(), error,
+                     strerror(error));
+      ctx_.stats().connection_error_.inc();
+      return {PostIoAction::Close, total_bytes_written, false};
+    }
+    total_bytes_written += rc;
+  }
+
+  if (end_stream) {
+    shutdownSsl();
+  }
+
+  return {PostIoAction::KeepOpen, total_bytes_written, false};
+}
+
+uint64_t SslSocket::nextWriteSize(Buffer::Instance& write_buffer) {
+  // SSL_write() splits a write into records of at most the max send fragment, so a single call
+  // can write several whole records straight out of a large slice.
+  const uint32_t record_size = record_sizer_.recordSize();
+  if (record_size != max_send_fragment_) {
+    SSL_set_max_send_fragment(ssl_.get(), record_size);
+    max_send_fragment_ = record_size;
+  }
+  return record_sizer_.nextWriteSize(write_buffer);
+}
+
+void SslSocket::onConnected() {
+  ASSERT(!handshake_complete_);
+  if (!SSL_is_server(ssl_.get())) {
+    ctx_.resumeSession(ssl_.get(), callbacks_->connection().remoteAddress()->asString());
+  }
+}
 
 void SslSocket::shutdownSsl() {
   ASSERT(handshake_complete_);
   if (!shutdown_sent_ && callbacks_->connection().state() != Network::Connection::State::Closed) {
-    int rc = SSL_shutdown(ssl_.get());
-    ENVOY_CONN_LOG(debug, "SSL shutdown: rc={}", callbacks_->connection(), rc);
-    drainErrorQueue();
+    if (ktls_tx_) {
+      // BoringSSL's write state is stale once the kernel took over, so the kernel sends the alert.
+      ssize_t rc = Ktls::sendCloseNotify(callbacks_->fd());
+      ENVOY_CONN_LOG(debug, "ktls shutdown: rc={}", callbacks_->connection(), rc);
+    } else {
+      int rc = SSL_shutdown(ssl_.get());
+      ENVOY_CONN_LOG(debug, "SSL shutdown: rc={}", callbacks_->connection(), rc);
+      drainErrorQueue();
+    }
     shutdown_sent_ = true;
   }
 }
@@ -325,6 +500,11 @@ std::vector<std::string> SslSocket::getDnsSansFromCertificate(X509* cert) {
 }
 
 void SslSocket::closeSocket(Network::ConnectionEvent) {
+  // Abandon any pending private key operation; its completion must not touch a closed connection.
+  if (private_key_method_provider_ != nullptr) {
+    private_key_method_provider_->unregisterPrivateKeyMethod(ssl_.get());
+  }
+
   // Attempt to send a shutdown before closing the socket. It's possible this won't go out if
   // there is no room on the socket. We can extend the state machine to handle this at some point
   // if needed.
@@ -5,9 +5,11 @@
 
 #include "envoy/network/connection.h"
 #include "envoy/network/transport_socket.h"
+#include "envoy/ssl/private_key_method.h"
 
 #include "common/common/logger.h"
 #include "common/ssl/context_impl.h"
+#include "common/ssl/record_sizer.h"
 
 #include "openssl/ssl.h"
 
@@ -18,9 +20,11 @@ enum class InitialState { Client, Server };
 
 class SslSocket : public Network::TransportSocket,
                   public Connection,
+                  public PrivateKeyConnectionCallbacks,
                   protected Logger::Loggable<Logger::Id::connection> {
 public:
   SslSocket(Context& ctx, InitialState state);
+  ~SslSocket();
 
   // Ssl::Connection
   bool peerCertificatePresented() const override;
@@ -45,10 +49,17 @@ public:
   Ssl::Connection* ssl() override { return this; }
   const Ssl::Connection* ssl() const override { return this; }
 
+  // Ssl::PrivateKeyConnectionCallbacks
+  void onPrivateKeyMethodComplete() override;
+
   SSL* rawSslForTest() { return ssl_.get(); }
 
 private:
   Network::PostIoAction doHandshake();
+  void enableKtls();
+  Network::IoResult doKtlsRead(Buffer::Instance& read_buffer);
+  Network::IoResult doKtlsWrite(Buffer::Instance& write_buffer, bool end_stream);
+  uint64_t nextWriteSize(Buffer::Instance& write_buffer);
   void drainErrorQueue();
   void shutdownSsl();
 
@@ -60,7 +71,14 @@ private:
   Network::TransportSocketCallbacks* callbacks_{};
   ContextImpl& ctx_;
   bssl::UniquePtr<SSL> ssl_;
+  // Set for server sockets whose context hands private key operations to a provider.
+  PrivateKeyMethodProvider* private_key_method_provider_{};
+  RecordSizer record_sizer_;
+  uint32_t max_send_fragment_{};
   bool handshake_complete_{};
+  // Set once the kernel encrypts sent records (or decrypts received ones) for this connection.
+  bool ktls_tx_{};
+  bool ktls_rx_{};
   bool shutdown_sent_{};
   uint64_t bytes_to_retry_{};
   mutable std::string cached_sha_256_peer_certificate_digest_;
@@ -0,0 +1,218 @@
+#include "common/ssl/thread_pool_private_key_method.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/macros.h"
+
+#include "openssl/evp.h"
+#include "openssl/rsa.h"
+
+namespace Envoy {
+namespace Ssl {
+
+const SSL_PRIVATE_KEY_METHOD ThreadPoolPrivateKeyMethodProvider::method_ = {
+    ThreadPoolPrivateKeyMethodProvider::sign,
+    ThreadPoolPrivateKeyMethodProvider::decrypt,
+    ThreadPoolPrivateKeyMethodProvider::complete,
+};
+
+ThreadPoolPrivateKeyMethodProvider::Operation::Operation(
+    PrivateKeyConnectionCallbacks& callbacks, Event::Dispatcher& dispatcher, OperationType type,
+    bssl::UniquePtr<EVP_PKEY> key, uint16_t signature_algorithm, const uint8_t* in, size_t in_len)
+    : callbacks_(callbacks), dispatcher_(dispatcher), type_(type), key_(std::move(key)),
+      signature_algorithm_(signature_algorithm), in_(in, in + in_len) {}
+
+void ThreadPoolPrivateKeyMethodProvider::Operation::run() {
+  size_t out_len = 0;
+  if (type_ == OperationType::Sign) {
+    bssl::ScopedEVP_MD_CTX ctx;
+    EVP_PKEY_CTX* pctx;
+    const EVP_MD* md = SSL_get_signature_algorithm_digest(signature_algorithm_);
+    out_.resize(EVP_PKEY_size(key_.get()));
+    out_len = out_.size();
+    succeeded_ = EVP_DigestSignInit(ctx.get(), &pctx, md, nullptr, key_.get()) == 1;
+    if (succeeded_ && SSL_is_signature_algorithm_rsa_pss(signature_algorithm_)) {
+      succeeded_ = EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) == 1 &&
+                   EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1 /* salt length = digest length */);
+    }
+    succeeded_ = succeeded_ &&
+                 EVP_DigestSign(ctx.get(), out_.data(), &out_len, in_.data(), in_.size()) == 1;
+  } else {
+    ASSERT(type_ == OperationType::Decrypt);
+    RSA* rsa = EVP_PKEY_get0_RSA(key_.get());
+    out_.resize(rsa != nullptr ? RSA_size(rsa) : 0);
+    succeeded_ = rsa != nullptr && RSA_decrypt(rsa, &out_len, out_.data(), out_.size(), in_.data(),
+                                               in_.size(), RSA_NO_PADDING) == 1;
+  }
+  out_.resize(succeeded_ ? out_len : 0);
+}
+
+ThreadPoolPrivateKeyMethodProvider::ThreadPoolPrivateKeyMethodProvider(uint32_t num_threads) {
+  ASSERT(num_threads > 0);
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads_.emplace_back(new Thread::Thread([this]() -> void { threadRoutine(); }));
+  }
+}
+
+ThreadPoolPrivateKeyMethodProvider::~ThreadPoolPrivateKeyMethodProvider() {
+  {
+    Thread::LockGuard lock(lock_);
+    shutdown_ = true;
+  }
+  cond_var_.notifyAll();
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+}
+
+void ThreadPoolPrivateKeyMethodProvider::threadRoutine() {
+  while (true) {
+    OperationSharedPtr operation;
+    {
+      Thread::LockGuard lock(lock_);
+      while (queue_.empty() && !shutdown_) {
+        cond_var_.wait(lock_);
+      }
+      if (shutdown_) {
+        return;
+      }
+      operation = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    operation->run();
+
+    // Holding the operation's lock while posting guarantees that once the connection has
+    // cancelled the operation (on its dispatcher thread) nothing more is posted to the dispatcher,
+    // which may be about to go away.
+    Thread::LockGuard lock(operation->lock_);
+    operation->done_ = true;
+    if (!operation->cancelled_) {
+      operation->dispatcher_.post([operation]() -> void {
+        bool cancelled;
+        {
+          Thread::LockGuard lock(operation->lock_);
+          cancelled = operation->cancelled_;
+        }
+        if (!cancelled) {
+          operation->callbacks_.onPrivateKeyMethodComplete();
+        }
+      });
+    }
+  }
+}
+
+int ThreadPoolPrivateKeyMethodProvider::sslConnectionStateIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, []() -> int {
+    int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    RELEASE_ASSERT(index >= 0, "");
+    return index;
+  }());
+}
+
+ThreadPoolPrivateKeyMethodProvider::ConnectionState*
+ThreadPoolPrivateKeyMethodProvider::connectionState(SSL* ssl) {
+  return static_cast<ConnectionState*>(SSL_get_ex_data(ssl, sslConnectionStateIndex()));
+}
+
+void ThreadPoolPrivateKeyMethodProvider::registerPrivateKeyMethod(
+    SSL* ssl, PrivateKeyConnectionCallbacks& callbacks, Event::Dispatcher& dispatcher) {
+  ASSERT(connectionState(ssl) == nullptr);
+  int rc = SSL_set_ex_data(ssl, sslConnectionStateIndex(),
+                           new ConnectionState(*this, callbacks, dispatcher));
+  RELEASE_ASSERT(rc == 1, "");
+}
+
+void ThreadPoolPrivateKeyMethodProvider::unregisterPrivateKeyMethod(SSL* ssl) {
+  std::unique_ptr<ConnectionState> state(connectionState(ssl));
+  if (state == nullptr) {
+    return;
+  }
+  SSL_set_ex_data(ssl, sslConnectionStateIndex(), nullptr);
+
+  if (state->pending_ != nullptr) {
+    Thread::LockGuard lock(state->pending_->lock_);
+    state->pending_->cancelled_ = true;
+  }
+}
+
+const SSL_PRIVATE_KEY_METHOD* ThreadPoolPrivateKeyMethodProvider::getBoringSslPrivateKeyMethod()
+    const {
+  return &method_;
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyMethodProvider::start(SSL* ssl, OperationType type,
+                                                                   uint16_t signature_algorithm,
+                                                                   const uint8_t* in,
+                                                                   size_t in_len) {
+  ConnectionState* state = connectionState(ssl);
+  EVP_PKEY* key = SSL_get_privatekey(ssl);
+  if (state == nullptr || key == nullptr || state->pending_ != nullptr) {
+    return ssl_private_key_failure;
+  }
+
+  EVP_PKEY_up_ref(key);
+  state->pending_ = std::make_shared<Operation>(state->callbacks_, state->dispatcher_, type,
+                                                bssl::UniquePtr<EVP_PKEY>(key),
+                                                signature_algorithm, in, in_len);
+  {
+    Thread::LockGuard lock(lock_);
+    queue_.push_back(state->pending_);
+  }
+  cond_var_.notifyOne();
+  ENVOY_LOG(trace, "queued private key operation");
+  return ssl_private_key_retry;
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyMethodProvider::sign(SSL* ssl, uint8_t*, size_t*,
+                                                                  size_t,
+                                                                  uint16_t signature_algorithm,
+                                                                  const uint8_t* in,
+                                                                  size_t in_len) {
+  ConnectionState* state = connectionState(ssl);
+  if (state == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return state->parent_.start(ssl, OperationType::Sign, signature_algorithm, in, in_len);
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyMethodProvider::decrypt(SSL* ssl, uint8_t*, size_t*,
+                                                                     size_t, const uint8_t* in,
+                                                                     size_t in_len) {
+  ConnectionState* state = connectionState(ssl);
+  if (state == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return state->parent_.start(ssl, OperationType::Decrypt, 0, in, in_len);
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyMethodProvider::complete(SSL* ssl, uint8_t* out,
+                                                                      size_t* out_len,
+                                                                      size_t max_out) {
+  ConnectionState* state = connectionState(ssl);
+  if (state == nullptr || state->pending_ == nullptr) {
+    return ssl_private_key_failure;
+  }
+
+  // The completion is only posted once the operation has finished, but the handshake may be
+  // driven by other socket events in the meantime.
+  {
+    Thread::LockGuard lock(state->pending_->lock_);
+    if (!state->pending_->done_) {
+      return ssl_private_key_retry;
+    }
+  }
+
+  OperationSharedPtr operation = std::move(state->pending_);
+  if (!operation->succeeded_ || operation->out_.size() > max_out) {
+    return ssl_private_key_failure;
+  }
+  std::copy(operation->out_.begin(), operation->out_.end(), out);
+  *out_len = operation->out_.size();
+  return ssl_private_key_success;
+}
+
+} // namespace Ssl
+} // namespace Envoy
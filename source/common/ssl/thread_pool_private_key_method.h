@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "envoy/ssl/private_key_method.h"
+
+#include "common/common/logger.h"
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * A PrivateKeyMethodProvider that performs private key operations in process, with the key loaded
+ * into the context, on a fixed pool of crypto threads. Workers hand an operation to the pool and
+ * return to their event loop; the pool posts the completion back to the worker's dispatcher.
+ */
+class ThreadPoolPrivateKeyMethodProvider : public PrivateKeyMethodProvider,
+                                           Logger::Loggable<Logger::Id::connection> {
+public:
+  /**
+   * @param num_threads supplies the number of crypto threads to start.
+   */
+  ThreadPoolPrivateKeyMethodProvider(uint32_t num_threads);
+  ~ThreadPoolPrivateKeyMethodProvider();
+
+  // Ssl::PrivateKeyMethodProvider
+  void registerPrivateKeyMethod(SSL* ssl, PrivateKeyConnectionCallbacks& callbacks,
+                                Event::Dispatcher& dispatcher) override;
+  void unregisterPrivateKeyMethod(SSL* ssl) override;
+  const SSL_PRIVATE_KEY_METHOD* getBoringSslPrivateKeyMethod() const override;
+
+private:
+  enum class OperationType { Sign, Decrypt };
+
+  /**
+   * A single private key operation. It is shared by the connection and the crypto thread running
+   * it, so that a connection closing mid-operation does not free it under the crypto thread.
+   */
+  struct Operation {
+    Operation(PrivateKeyConnectionCallbacks& callbacks, Event::Dispatcher& dispatcher,
+              OperationType type, bssl::UniquePtr<EVP_PKEY> key, uint16_t signature_algorithm,
+              const uint8_t* in, size_t in_len);
+
+    // Runs the operation on a crypto thread.
+    void run();
+
+    PrivateKeyConnectionCallbacks& callbacks_;
+    Event::Dispatcher& dispatcher_;
+    const OperationType type_;
+    const bssl::UniquePtr<EVP_PKEY> key_;
+    const uint16_t signature_algorithm_;
+    const std::vector<uint8_t> in_;
+    // Written by the crypto thread before it sets done_.
+    std::vector<uint8_t> out_;
+    bool succeeded_{};
+
+    Thread::MutexBasicLockable lock_;
+    bool done_ GUARDED_BY(lock_){};
+    // Set when the connection goes away, after which the completion must not be posted.
+    bool cancelled_ GUARDED_BY(lock_){};
+  };
+  typedef std::shared_ptr<Operation> OperationSharedPtr;
+
+  /**
+   * Per connection state, stored in the connection's SSL instance.
+   */
+  struct ConnectionState {
+    ConnectionState(ThreadPoolPrivateKeyMethodProvider& parent,
+                    PrivateKeyConnectionCallbacks& callbacks, Event::Dispatcher& dispatcher)
+        : parent_(parent), callbacks_(callbacks), dispatcher_(dispatcher) {}
+
+    ThreadPoolPrivateKeyMethodProvider& parent_;
+    PrivateKeyConnectionCallbacks& callbacks_;
+    Event::Dispatcher& dispatcher_;
+    OperationSharedPtr pending_;
+  };
+
+  static int sslConnectionStateIndex();
+  static ConnectionState* connectionState(SSL* ssl);
+
+  static ssl_private_key_result_t sign(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                       uint16_t signature_algorithm, const uint8_t* in,
+                                       size_t in_len);
+  static ssl_private_key_result_t decrypt(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                          const uint8_t* in, size_t in_len);
+  static ssl_private_key_result_t complete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                           size_t max_out);
+
+  ssl_private_key_result_t start(SSL* ssl, OperationType type, uint16_t signature_algorithm,
+                                 const uint8_t* in, size_t in_len);
+  void threadRoutine();
+
+  static const SSL_PRIVATE_KEY_METHOD method_;
+
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar cond_var_;
+  std::list<OperationSharedPtr> queue_ GUARDED_BY(lock_);
+  bool shutdown_ GUARDED_BY(lock_){};
+  std::vector<std::unique_ptr<Thread::Thread>> threads_;
+};
+
+} // namespace Ssl
+} // namespace Envoy
@@ -46,6 +46,13 @@ void ConnPoolImpl::addDrainedCallback(DrainedCb cb) {
 
 void ConnPoolImpl::assignConnection(ActiveConn& conn, ConnectionPool::Callbacks& callbacks) {
   ASSERT(conn.wrapper_ == nullptr);
+  if (!conn.counted_) {
+    // A spare connection counts against the cluster's connection limit once it is in use.
+    host_->cluster().resourceManager(priority_).connections().inc();
+    conn.counted_ = true;
+    ASSERT(spare_count_ > 0);
+    spare_count_--;
+  }
   conn.wrapper_ = std::make_unique<ConnectionWrapper>(conn);
   callbacks.onPoolReady(*conn.wrapper_, conn.real_host_description_);
 }
@@ -62,10 +69,11 @@ void ConnPoolImpl::checkForDrained() {
   }
 }
 
-void ConnPoolImpl::createNewConnection() {
+void ConnPoolImpl::createNewConnection(bool spare) {
   ENVOY_LOG(debug, "creating a new connection");
-  ActiveConnPtr conn(new ActiveConn(*this));
+  ActiveConnPtr conn(new ActiveConn(*this, spare));
   conn->moveIntoList(std::move(conn), busy_conns_);
+  connecting_count_++;
 }
 
 ConnectionPool::Cancellable* ConnPoolImpl::newConnection(ConnectionPool::Callbacks& callbacks) {
@@ -85,7 +93,7 @@ ConnectionPool::Cancellable* ConnPoolImpl::newConnection(ConnectionPool::Callbac
 
     // If we have no connections at all, make one no matter what so we don't starve.
     if ((ready_conns_.size() == 0 && busy_conns_.size() == 0) || can_create_connection) {
-      createNewConnection();
+      createNewConnection(false);
     }
 
     ENVOY_LOG(debug, "queueing request due to no available connections");
@@ -100,10 +108,27 @@ ConnectionPool::Cancellable* ConnPoolImpl::newConnection(ConnectionPool::Callbac
   }
 }
 
+void ConnPoolImpl::preconnect(uint32_t count) {
+  // Pending requests take the first connections to connect, so only what is left over after them
+  // is spare. Spares are not counted against the connection limit until they are used, but the
+  // connections in use together with this pool's spares never exceed it.
+  Upstream::Resource& connections = host_->cluster().resourceManager(priority_).connections();
+  while (ready_conns_.size() + connecting_count_ < count + pending_requests_.size() &&
+         connections.count() + spare_count_ < connections.max()) {
+    ENVOY_LOG(debug, "preconnecting");
+    createNewConnection(true);
+  }
+}
+
 void ConnPoolImpl::onConnectionEvent(ActiveConn& conn, Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
     ENVOY_CONN_LOG(debug, "client disconnected", *conn.conn_);
+    if (conn.wrapper_ != nullptr && conn.wrapper_->callbacks_ != nullptr) {
+      // Let the connection owner see the close before the connection leaves the pool.
+      conn.wrapper_->callbacks_->onEvent(event);
+    }
+
     ActiveConnPtr removed;
     bool check_for_drained = true;
     if (conn.wrapper_ != nullptr) {
@@ -140,8 +165,10 @@ void ConnPoolImpl::onConnectionEvent(ActiveConn& conn, Network::ConnectionEvent
         PendingRequestPtr request =
             pending_requests_to_purge.front()->removeFromList(pending_requests_to_purge);
         host_->cluster().stats().upstream_rq_pending_failure_eject_.inc();
-        request->callbacks_.onPoolFailure(ConnectionPool::PoolFailureReason::ConnectionFailure,
-                                          conn.real_host_description_);
+        request->callbacks_.onPoolFailure(
+            conn.timed_out_ ? ConnectionPool::PoolFailureReason::Timeout
+                            : ConnectionPool::PoolFailureReason::ConnectionFailure,
+            conn.real_host_description_);
       }
     }
 
@@ -149,7 +176,7 @@ void ConnPoolImpl::onConnectionEvent(ActiveConn& conn, Network::ConnectionEvent
 
     // If we have pending requests and we just lost a connection we should make a new one.
     if (pending_requests_.size() > (ready_conns_.size() + busy_conns_.size())) {
-      createNewConnection();
+      createNewConnection(false);
     }
 
     if (check_for_drained) {
@@ -160,6 +187,8 @@ void ConnPoolImpl::onConnectionEvent(ActiveConn& conn, Network::ConnectionEvent
   if (conn.connect_timer_) {
     conn.connect_timer_->disableTimer();
     conn.connect_timer_.reset();
+    ASSERT(connecting_count_ > 0);
+    connecting_count_--;
   }
 
   // Note that the order in this function is important. Concretely, we must destroy the connect
@@ -167,7 +196,7 @@ void ConnPoolImpl::onConnectionEvent(ActiveConn& conn, Network::ConnectionEvent
   // drain/destruction event, we key off of the existence of the connect timer above to determine
   // whether the connection is in the ready list (connected) or the busy list (failed to connect).
   if (event == Network::ConnectionEvent::Connected) {
-    conn_connect_ms_->complete();
+    conn.conn_connect_ms_->complete();
     processIdleConnection(conn, false);
   }
 }
@@ -274,12 +303,12 @@ ConnPoolImpl::PendingRequest::~PendingRequest() {
   parent_.host_->cluster().resourceManager(parent_.priority_).pendingRequests().dec();
 }
 
-ConnPoolImpl::ActiveConn::ActiveConn(ConnPoolImpl& parent)
+ConnPoolImpl::ActiveConn::ActiveConn(ConnPoolImpl& parent, bool spare)
     : parent_(parent),
       connect_timer_(parent_.dispatcher_.createTimer([this]() -> void { onConnectTimeout(); })),
       remaining_requests_(parent_.host_->cluster().maxRequestsPerConnection()) {
 
-  parent_.conn_connect_ms_.reset(
+  conn_connect_ms_.reset(
       new Stats::Timespan(parent_.host_->cluster().stats().upstream_cx_connect_ms_));
 
   Upstream::Host::CreateConnectionData data =
@@ -302,7 +331,12 @@ ConnPoolImpl::ActiveConn::ActiveConn(ConnPoolImpl& parent)
   parent_.host_->stats().cx_active_.inc();
   conn_length_.reset(new Stats::Timespan(parent_.host_->cluster().stats().upstream_cx_length_ms_));
   connect_timer_->enableTimer(parent_.host_->cluster().connectTimeout());
-  parent_.host_->cluster().resourceManager(parent_.priority_).connections().inc();
+  if (spare) {
+    parent_.spare_count_++;
+  } else {
+    parent_.host_->cluster().resourceManager(parent_.priority_).connections().inc();
+    counted_ = true;
+  }
 
   conn_->setConnectionStats({parent_.host_->cluster().stats().upstream_cx_rx_bytes_total_,
                              parent_.host_->cluster().stats().upstream_cx_rx_bytes_buffered_,
@@ -319,7 +353,12 @@ ConnPoolImpl::ActiveConn::~ActiveConn() {
   parent_.host_->cluster().stats().upstream_cx_active_.dec();
   parent_.host_->stats().cx_active_.dec();
   conn_length_->complete();
-  parent_.host_->cluster().resourceManager(parent_.priority_).connections().dec();
+  if (counted_) {
+    parent_.host_->cluster().resourceManager(parent_.priority_).connections().dec();
+  } else {
+    ASSERT(parent_.spare_count_ > 0);
+    parent_.spare_count_--;
+  }
 
   parent_.onConnDestroyed(*this);
 }
@@ -329,9 +368,22 @@ void ConnPoolImpl::ActiveConn::onConnectTimeout() {
   // failure and will fold into all the normal connect failure logic.
   ENVOY_CONN_LOG(debug, "connect timeout", *conn_);
   parent_.host_->cluster().stats().upstream_cx_connect_timeout_.inc();
+  timed_out_ = true;
   conn_->close(Network::ConnectionCloseType::NoFlush);
 }
 
+void ConnPoolImpl::ActiveConn::onAboveWriteBufferHighWatermark() {
+  if (wrapper_ != nullptr && wrapper_->callbacks_ != nullptr) {
+    wrapper_->callbacks_->onAboveWriteBufferHighWatermark();
+  }
+}
+
+void ConnPoolImpl::ActiveConn::onBelowWriteBufferLowWatermark() {
+  if (wrapper_ != nullptr && wrapper_->callbacks_ != nullptr) {
+    wrapper_->callbacks_->onBelowWriteBufferLowWatermark();
+  }
+}
+
 void ConnPoolImpl::ActiveConn::onUpstreamData(Buffer::Instance& data, bool end_stream) {
   if (wrapper_ != nullptr && wrapper_->callbacks_ != nullptr) {
     // Delegate to the connection owner.
@@ -30,6 +30,7 @@ public:
   void addDrainedCallback(DrainedCb cb) override;
   void drainConnections() override;
   ConnectionPool::Cancellable* newConnection(ConnectionPool::Callbacks& callbacks) override;
+  void preconnect(uint32_t count) override;
 
 protected:
   struct ActiveConn;
@@ -65,7 +66,7 @@ protected:
   struct ActiveConn : LinkedObject<ActiveConn>,
                       public Network::ConnectionCallbacks,
                       public Event::DeferredDeletable {
-    ActiveConn(ConnPoolImpl& parent);
+    ActiveConn(ConnPoolImpl& parent, bool spare);
     ~ActiveConn();
 
     void onConnectTimeout();
@@ -75,16 +76,21 @@ protected:
     void onEvent(Network::ConnectionEvent event) override {
       parent_.onConnectionEvent(*this, event);
     }
-    void onAboveWriteBufferHighWatermark() override {}
-    void onBelowWriteBufferLowWatermark() override {}
+    void onAboveWriteBufferHighWatermark() override;
+    void onBelowWriteBufferLowWatermark() override;
 
     ConnPoolImpl& parent_;
     Upstream::HostDescriptionConstSharedPtr real_host_description_;
     ConnectionWrapperPtr wrapper_;
     Network::ClientConnectionPtr conn_;
     Event::TimerPtr connect_timer_;
+    Stats::TimespanPtr conn_connect_ms_;
     Stats::TimespanPtr conn_length_;
     uint64_t remaining_requests_;
+    bool timed_out_{false};
+    // Whether the connection counts against the cluster's connection limit, which spare
+    // connections only do once they are first assigned.
+    bool counted_{false};
   };
 
   typedef std::unique_ptr<ActiveConn> ActiveConnPtr;
@@ -103,7 +109,7 @@ protected:
   typedef std::unique_ptr<PendingRequest> PendingRequestPtr;
 
   void assignConnection(ActiveConn& conn, ConnectionPool::Callbacks& callbacks);
-  void createNewConnection();
+  void createNewConnection(bool spare);
   void onConnectionEvent(ActiveConn& conn, Network::ConnectionEvent event);
   void onPendingRequestCancel(PendingRequest& request);
   virtual void onConnReleased(ActiveConn& conn);
@@ -121,7 +127,11 @@ protected:
   std::list<ActiveConnPtr> busy_conns_;
   std::list<PendingRequestPtr> pending_requests_;
   std::list<DrainedCb> drained_callbacks_;
-  Stats::TimespanPtr conn_connect_ms_;
+  // Connections in busy_conns_ that have not connected yet.
+  uint64_t connecting_count_{};
+  // Spare connections that have not been handed out yet, and so are not counted against the
+  // cluster's connection limit.
+  uint64_t spare_count_{};
   Event::TimerPtr upstream_ready_timer_;
   bool upstream_ready_enabled_{false};
 };
@@ -22,11 +22,13 @@ namespace Envoy {
 namespace TcpProxy {
 
 Config::Route::Route(
-    const envoy::config::filter::network::tcp_proxy::v2::TcpProxy::DeprecatedV1::TCPRoute& config) {
+    const envoy::config::filter::network::tcp_proxy::v2::TcpProxy::DeprecatedV1::TCPRoute& config,
+    const std::string& stat_prefix) {
   cluster_name_ = config.cluster();
+  preconnect_runtime_key_ = fmt::format("tcp_proxy.{}.preconnect.{}", stat_prefix, cluster_name_);
 
-  source_ips_ = Network::Address::IpList(config.source_ip_list());
-  destination_ips_ = Network::Address::IpList(config.destination_ip_list());
+  source_ips_ = Network::Address::CidrSet(config.source_ip_list());
+  destination_ips_ = Network::Address::CidrSet(config.destination_ip_list());
 
   if (!config.source_ports().empty()) {
     Network::Utility::parsePortRangeList(config.source_ports(), source_port_ranges_);
@@ -51,6 +53,7 @@ Config::SharedConfig::SharedConfig(
 Config::Config(const envoy::config::filter::network::tcp_proxy::v2::TcpProxy& config,
                Server::Configuration::FactoryContext& context)
     : max_connect_attempts_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_connect_attempts, 1)),
+      runtime_(context.runtime()),
       upstream_drain_manager_slot_(context.threadLocal().allocateSlot()),
       shared_config_(std::make_shared<SharedConfig>(config, context)) {
 
@@ -61,14 +64,14 @@ Config::Config(const envoy::config::filter::network::tcp_proxy::v2::TcpProxy& co
   if (config.has_deprecated_v1()) {
     for (const envoy::config::filter::network::tcp_proxy::v2::TcpProxy::DeprecatedV1::TCPRoute&
              route_desc : config.deprecated_v1().routes()) {
-      routes_.emplace_back(Route(route_desc));
+      routes_.emplace_back(Route(route_desc, config.stat_prefix()));
     }
   }
 
   if (!config.cluster().empty()) {
     envoy::config::filter::network::tcp_proxy::v2::TcpProxy::DeprecatedV1::TCPRoute default_route;
     default_route.set_cluster(config.cluster());
-    routes_.emplace_back(default_route);
+    routes_.emplace_back(default_route, config.stat_prefix());
   }
 
   if (config.has_metadata_match()) {
@@ -118,6 +121,16 @@ const std::string& Config::getRouteFromEntries(Network::Connection& connection)
   return EMPTY_STRING;
 }
 
+uint32_t Config::preconnectCount(const std::string& cluster_name) {
+  for (const Config::Route& route : routes_) {
+    if (route.cluster_name_ == cluster_name) {
+      return runtime_.snapshot().getInteger(route.preconnect_runtime_key_, 0);
+    }
+  }
+
+  return 0;
+}
+
 UpstreamDrainManager& Config::drainManager() {
   return upstream_drain_manager_slot_->getTyped<UpstreamDrainManager>();
 }
@@ -135,28 +148,21 @@ Filter::~Filter() {
     access_log->log(nullptr, nullptr, nullptr, getRequestInfo());
   }
 
-  if (upstream_connection_) {
-    finalizeUpstreamConnectionStats();
+  if (upstream_handle_ != nullptr) {
+    upstream_handle_->cancel();
   }
-}
 
-TcpProxyStats Config::SharedConfig::generateStats(Stats::Scope& scope) {
-  return {ALL_TCP_PROXY_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope))};
-}
-
-namespace {
-void finalizeConnectionStats(const Upstream::HostDescription& host,
-                             Stats::Timespan connected_timespan) {
-  host.cluster().stats().upstream_cx_destroy_.inc();
-  host.cluster().stats().upstream_cx_active_.dec();
-  host.stats().cx_active_.dec();
-  host.cluster().resourceManager(Upstream::ResourcePriority::Default).connections().dec();
-  connected_timespan.complete();
+  if (upstream_conn_data_ != nullptr) {
+    // The pool owns the connection and would otherwise keep it open. Detach first, as closing it
+    // raises events that must not reach this filter any more.
+    upstream_callbacks_->parent_ = nullptr;
+    read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_destroy_.inc();
+    upstream_conn_data_->connection().close(Network::ConnectionCloseType::NoFlush);
+  }
 }
-} // namespace
 
-void Filter::finalizeUpstreamConnectionStats() {
-  finalizeConnectionStats(*read_callbacks_->upstreamHost(), *connected_timespan_);
+TcpProxyStats Config::SharedConfig::generateStats(Stats::Scope& scope) {
+  return {ALL_TCP_PROXY_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope), POOL_HISTOGRAM(scope))};
 }
 
 void Filter::initializeReadFilterCallbacks(Network::ReadFilterCallbacks& callbacks) {
@@ -188,15 +194,15 @@ void Filter::initialize(Network::ReadFilterCallbacks& callbacks, bool set_connec
 }
 
 void Filter::readDisableUpstream(bool disable) {
-  if (upstream_connection_ == nullptr ||
-      upstream_connection_->state() != Network::Connection::State::Open) {
+  if (upstream_conn_data_ == nullptr ||
+      upstream_conn_data_->connection().state() != Network::Connection::State::Open) {
     // Because we flush write downstream, we can have a case where upstream has already disconnected
     // and we are waiting to flush. If we had a watermark event during this time we should no
     // longer touch the upstream connection.
     return;
   }
 
-  upstream_connection_->readDisable(disable);
+  upstream_conn_data_->connection().readDisable(disable);
   if (disable) {
     read_callbacks_->upstreamHost()
         ->cluster()
@@ -235,9 +241,9 @@ void Filter::DownstreamCallbacks::onBelowWriteBufferLowWatermark() {
 }
 
 void Filter::UpstreamCallbacks::onEvent(Network::ConnectionEvent event) {
-  if (drainer_ == nullptr) {
+  if (parent_ != nullptr) {
     parent_->onUpstreamEvent(event);
-  } else {
+  } else if (drainer_ != nullptr) {
     drainer_->onEvent(event);
   }
 }
@@ -262,13 +268,12 @@ void Filter::UpstreamCallbacks::onBelowWriteBufferLowWatermark() {
   }
 }
 
-Network::FilterStatus Filter::UpstreamCallbacks::onData(Buffer::Instance& data, bool end_stream) {
-  if (parent_) {
+void Filter::UpstreamCallbacks::onUpstreamData(Buffer::Instance& data, bool end_stream) {
+  if (parent_ != nullptr) {
     parent_->onUpstreamData(data, end_stream);
-  } else {
+  } else if (drainer_ != nullptr) {
     drainer_->onData(data, end_stream);
   }
-  return Network::FilterStatus::StopIteration;
 }
 
 void Filter::UpstreamCallbacks::onBytesSent() {
@@ -294,7 +299,7 @@ void Filter::UpstreamCallbacks::drain(Drainer& drainer) {
 }
 
 Network::FilterStatus Filter::initializeUpstreamConnection() {
-  ASSERT(upstream_connection_ == nullptr);
+  ASSERT(upstream_conn_data_ == nullptr);
 
   const std::string& cluster_name = getUpstreamCluster();
 
@@ -311,6 +316,9 @@ Network::FilterStatus Filter::initializeUpstreamConnection() {
   }
 
   Upstream::ClusterInfoConstSharedPtr cluster = thread_local_cluster->info();
+  // Check this here because the TCP conn pool would queue the request waiting for a connection
+  // that is never released. Spare connections the pool opened ahead of time are not counted
+  // until they are handed out, so idle ones do not make this fail.
   if (!cluster->resourceManager(Upstream::ResourcePriority::Default).connections().canCreate()) {
     getRequestInfo().setResponseFlag(RequestInfo::ResponseFlag::UpstreamOverflow);
     cluster->stats().upstream_cx_overflow_.inc();
@@ -325,88 +333,157 @@ Network::FilterStatus Filter::initializeUpstreamConnection() {
     return Network::FilterStatus::StopIteration;
   }
 
-  Upstream::Host::CreateConnectionData conn_info =
-      cluster_manager_.tcpConnForCluster(cluster_name, this);
-
-  upstream_connection_ = std::move(conn_info.connection_);
-  read_callbacks_->upstreamHost(conn_info.host_description_);
-  if (!upstream_connection_) {
-    // tcpConnForCluster() increments cluster->stats().upstream_cx_none_healthy.
+  Tcp::ConnectionPool::Instance* conn_pool = cluster_manager_.tcpConnPoolForCluster(
+      cluster_name, Upstream::ResourcePriority::Default, this);
+  if (!conn_pool) {
+    // tcpConnPoolForCluster() increments cluster->stats().upstream_cx_none_healthy.
     getRequestInfo().setResponseFlag(RequestInfo::ResponseFlag::NoHealthyUpstream);
     onInitFailure(UpstreamFailureReason::NO_HEALTHY_UPSTREAM);
     return Network::FilterStatus::StopIteration;
   }
 
   connect_attempts_++;
-  cluster->resourceManager(Upstream::ResourcePriority::Default).connections().inc();
-  upstream_connection_->addReadFilter(upstream_callbacks_);
-  upstream_connection_->addConnectionCallbacks(*upstream_callbacks_);
-  upstream_connection_->enableHalfClose(true);
-  upstream_connection_->setConnectionStats(
-      {read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_rx_bytes_total_,
-       read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_rx_bytes_buffered_,
-       read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_tx_bytes_total_,
-       read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_tx_bytes_buffered_,
-       &read_callbacks_->upstreamHost()->cluster().stats().bind_errors_});
-  upstream_connection_->connect();
-  upstream_connection_->noDelay(true);
-  getRequestInfo().onUpstreamHostSelected(conn_info.host_description_);
-  getRequestInfo().setUpstreamLocalAddress(upstream_connection_->localAddress());
-
-  ASSERT(connect_timeout_timer_ == nullptr);
-  connect_timeout_timer_ = read_callbacks_->connection().dispatcher().createTimer(
-      [this]() -> void { onConnectTimeout(); });
-  connect_timeout_timer_->enableTimer(cluster->connectTimeout());
-
-  read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_total_.inc();
-  read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_active_.inc();
-  read_callbacks_->upstreamHost()->stats().cx_total_.inc();
-  read_callbacks_->upstreamHost()->stats().cx_active_.inc();
-  connect_timespan_.reset(new Stats::Timespan(
-      read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_connect_ms_));
-  connected_timespan_.reset(new Stats::Timespan(
-      read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_length_ms_));
+  if (connect_timespan_ == nullptr) {
+    // Covers every attempt, as the downstream waits for all of them.
+    connect_timespan_.reset(new Stats::Timespan(config_->stats().upstream_connect_latency_ms_));
+  }
+
+  // The pool calls onPoolReady() inline if it has a connected spare connection, in which case
+  // there is no handle.
+  Tcp::ConnectionPool::Cancellable* handle = conn_pool->newConnection(*this);
+  if (handle != nullptr) {
+    ASSERT(upstream_handle_ == nullptr);
+    upstream_handle_ = handle;
+    config_->stats().upstream_preconnect_miss_.inc();
+  } else if (upstream_conn_data_ != nullptr) {
+    config_->stats().upstream_preconnect_hit_.inc();
+  }
+
+  // Replace the spare connection this one may have used, after newConnection() so that the
+  // request above is accounted for.
+  const uint32_t preconnect_count = config_->preconnectCount(cluster_name);
+  if (preconnect_count > 0) {
+    conn_pool->preconnect(preconnect_count);
+  }
 
   return Network::FilterStatus::Continue;
 }
 
-void Filter::onConnectTimeout() {
-  ENVOY_CONN_LOG(debug, "connect timeout", read_callbacks_->connection());
-  read_callbacks_->upstreamHost()->outlierDetector().putResult(Upstream::Outlier::Result::TIMEOUT);
-  read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_connect_timeout_.inc();
-  getRequestInfo().setResponseFlag(RequestInfo::ResponseFlag::UpstreamConnectionFailure);
+void Filter::onPoolFailure(Tcp::ConnectionPool::PoolFailureReason reason,
+                           Upstream::HostDescriptionConstSharedPtr host) {
+  upstream_handle_ = nullptr;
+
+  switch (reason) {
+  case Tcp::ConnectionPool::PoolFailureReason::Overflow:
+    getRequestInfo().setResponseFlag(RequestInfo::ResponseFlag::UpstreamOverflow);
+    onInitFailure(UpstreamFailureReason::RESOURCE_LIMIT_EXCEEDED);
+    break;
+  case Tcp::ConnectionPool::PoolFailureReason::ConnectionFailure:
+  case Tcp::ConnectionPool::PoolFailureReason::Timeout:
+    read_callbacks_->upstreamHost(host);
+    getRequestInfo().onUpstreamHostSelected(host);
+    getRequestInfo().setResponseFlag(RequestInfo::ResponseFlag::UpstreamConnectionFailure);
+    host->outlierDetector().putResult(reason == Tcp::ConnectionPool::PoolFailureReason::Timeout
+                                          ? Upstream::Outlier::Result::TIMEOUT
+                                          : Upstream::Outlier::Result::CONNECT_FAILED);
+
+    // This retries if needed/configured.
+    initializeUpstreamConnection();
+    break;
+  }
+}
+
+void Filter::onPoolReady(Tcp::ConnectionPool::ConnectionData& conn_data,
+                         Upstream::HostDescriptionConstSharedPtr host) {
+  upstream_handle_ = nullptr;
+  upstream_conn_data_ = &conn_data;
+  Network::ClientConnection& connection = conn_data.connection();
+  ENVOY_CONN_LOG(debug, "using upstream connection {}", read_callbacks_->connection(),
+                 connection.id());
+
+  conn_data.addUpstreamCallbacks(*upstream_callbacks_);
+  connection.enableHalfClose(true);
+  read_callbacks_->upstreamHost(host);
+  getRequestInfo().onUpstreamHostSelected(host);
+  getRequestInfo().setUpstreamLocalAddress(connection.localAddress());
+  connect_timespan_->complete();
+
+  // Re-enable downstream reads now that the upstream connection is established
+  // so we have a place to send downstream data to.
+  read_callbacks_->connection().readDisable(false);
+
+  host->outlierDetector().putResult(Upstream::Outlier::Result::SUCCESS);
+  onConnectionSuccess();
+
+  if (early_data_.length() > 0 || early_end_stream_) {
+    Filter::onData(early_data_, early_end_stream_);
+  }
+
+  if (config_->idleTimeout()) {
+    // The idle_timer_ can be moved to a Drainer, so related callbacks call into
+    // the UpstreamCallbacks, which has the same lifetime as the timer, and can dispatch
+    // the call to either TcpProxy or to Drainer, depending on the current state.
+    idle_timer_ =
+        read_callbacks_->connection().dispatcher().createTimer([upstream_callbacks =
+                                                                    upstream_callbacks_]() {
+          upstream_callbacks->onIdleTimeout();
+        });
+    resetIdleTimer();
+    read_callbacks_->connection().addBytesSentCallback([this](uint64_t) { resetIdleTimer(); });
+    connection.addBytesSentCallback([upstream_callbacks = upstream_callbacks_](uint64_t) {
+      upstream_callbacks->onBytesSent();
+    });
+  }
 
-  // This will cause a LocalClose event to be raised, which will trigger a reconnect if
-  // needed/configured.
-  upstream_connection_->close(Network::ConnectionCloseType::NoFlush);
+  if (config_->runtime().snapshot().featureEnabled("tcp_proxy.splice", 0)) {
+    startSplice();
+  }
 }
 
 Network::FilterStatus Filter::onData(Buffer::Instance& data, bool end_stream) {
   ENVOY_CONN_LOG(trace, "downstream connection received {} bytes, end_stream={}",
                  read_callbacks_->connection(), data.length(), end_stream);
-  getRequestInfo().addBytesReceived(data.length());
-  upstream_connection_->write(data, end_stream);
+  if (upstream_conn_data_ == nullptr) {
+    // A filter ahead of this one can hand over data it held back while the upstream connection
+    // is still being set up. Keep it for onPoolReady().
+    early_data_.move(data);
+    early_end_stream_ = end_stream;
+    return Network::FilterStatus::StopIteration;
+  }
+
+  // Once spliced, the upstream connection reports what it sends, including data written here.
+  if (!spliced_) {
+    getRequestInfo().addBytesReceived(data.length());
+  }
+  upstream_conn_data_->connection().write(data, end_stream);
   ASSERT(0 == data.length());
   resetIdleTimer(); // TODO(ggreenway) PERF: do we need to reset timer on both send and receive?
   return Network::FilterStatus::StopIteration;
 }
 
 void Filter::onDownstreamEvent(Network::ConnectionEvent event) {
-  if (upstream_connection_) {
+  if (upstream_conn_data_) {
     if (event == Network::ConnectionEvent::RemoteClose) {
-      upstream_connection_->close(Network::ConnectionCloseType::FlushWrite);
+      upstream_conn_data_->connection().close(Network::ConnectionCloseType::FlushWrite);
 
-      if (upstream_connection_ != nullptr &&
-          upstream_connection_->state() != Network::Connection::State::Closed) {
-        config_->drainManager().add(config_->sharedConfig(), std::move(upstream_connection_),
+      if (upstream_conn_data_ != nullptr &&
+          upstream_conn_data_->connection().state() != Network::Connection::State::Closed) {
+        config_->drainManager().add(config_->sharedConfig(), *upstream_conn_data_,
                                     std::move(upstream_callbacks_), std::move(idle_timer_),
-                                    read_callbacks_->upstreamHost(),
-                                    std::move(connected_timespan_));
+                                    read_callbacks_->upstreamHost());
+        upstream_conn_data_ = nullptr;
       }
     } else if (event == Network::ConnectionEvent::LocalClose) {
-      upstream_connection_->close(Network::ConnectionCloseType::NoFlush);
+      upstream_conn_data_->connection().close(Network::ConnectionCloseType::NoFlush);
       disableIdleTimer();
     }
+  } else if (upstream_handle_ != nullptr) {
+    if (event == Network::ConnectionEvent::RemoteClose ||
+        event == Network::ConnectionEvent::LocalClose) {
+      // The pool keeps the connection it is opening for this request for the next caller.
+      upstream_handle_->cancel();
+      upstream_handle_ = nullptr;
+    }
   }
 }
 
@@ -420,72 +497,49 @@ void Filter::onUpstreamData(Buffer::Instance& data, bool end_stream) {
 }
 
 void Filter::onUpstreamEvent(Network::ConnectionEvent event) {
-  bool connecting = false;
-
-  // The timer must be cleared before, not after, processing the event because
-  // if initializeUpstreamConnection() is called it will reset the timer, so
-  // clearing after that call will leave the timer unset.
-  if (connect_timeout_timer_) {
-    connecting = true;
-    connect_timeout_timer_->disableTimer();
-    connect_timeout_timer_.reset();
-  }
-
+  // Only close events arrive here. The pool hands out connections once they are connected, and
+  // reports connect failures through onPoolFailure().
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
-    finalizeUpstreamConnectionStats();
-    read_callbacks_->connection().dispatcher().deferredDelete(std::move(upstream_connection_));
+    upstream_conn_data_ = nullptr;
     disableIdleTimer();
 
+    read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_destroy_.inc();
     auto& destroy_ctx_stat =
         (event == Network::ConnectionEvent::RemoteClose)
             ? read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_destroy_remote_
             : read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_destroy_local_;
     destroy_ctx_stat.inc();
 
-    if (connecting) {
-      if (event == Network::ConnectionEvent::RemoteClose) {
-        getRequestInfo().setResponseFlag(RequestInfo::ResponseFlag::UpstreamConnectionFailure);
-        read_callbacks_->upstreamHost()->outlierDetector().putResult(
-            Upstream::Outlier::Result::CONNECT_FAILED);
-        read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_connect_fail_.inc();
-        read_callbacks_->upstreamHost()->stats().cx_connect_fail_.inc();
-      }
-
-      initializeUpstreamConnection();
-    } else {
-      if (read_callbacks_->connection().state() == Network::Connection::State::Open) {
-        read_callbacks_->connection().close(Network::ConnectionCloseType::FlushWrite);
-      }
-    }
-  } else if (event == Network::ConnectionEvent::Connected) {
-    connect_timespan_->complete();
-
-    // Re-enable downstream reads now that the upstream connection is established
-    // so we have a place to send downstream data to.
-    read_callbacks_->connection().readDisable(false);
-
-    read_callbacks_->upstreamHost()->outlierDetector().putResult(
-        Upstream::Outlier::Result::SUCCESS);
-    onConnectionSuccess();
-
-    if (config_->idleTimeout()) {
-      // The idle_timer_ can be moved to a Drainer, so related callbacks call into
-      // the UpstreamCallbacks, which has the same lifetime as the timer, and can dispatch
-      // the call to either TcpProxy or to Drainer, depending on the current state.
-      idle_timer_ =
-          read_callbacks_->connection().dispatcher().createTimer([upstream_callbacks =
-                                                                      upstream_callbacks_]() {
-            upstream_callbacks->onIdleTimeout();
-          });
-      resetIdleTimer();
-      read_callbacks_->connection().addBytesSentCallback([this](uint64_t) { resetIdleTimer(); });
-      upstream_connection_->addBytesSentCallback([upstream_callbacks = upstream_callbacks_](
-          uint64_t) { upstream_callbacks->onBytesSent(); });
+    if (read_callbacks_->connection().state() == Network::Connection::State::Open) {
+      read_callbacks_->connection().close(Network::ConnectionCloseType::FlushWrite);
     }
   }
 }
 
+void Filter::startSplice() {
+  if (!read_callbacks_->connection().startSplice(upstream_conn_data_->connection())) {
+    return;
+  }
+
+  ENVOY_CONN_LOG(debug, "splicing to upstream connection", read_callbacks_->connection());
+  config_->stats().downstream_cx_splice_total_.inc();
+  spliced_ = true;
+  // Spliced bytes never reach onData() and onUpstreamData(), so account for them as the other
+  // connection sends them. Bytes for upstream can still be in flight after the downstream
+  // connection, and this filter, are gone. Splicing starts before anything is written to either
+  // connection, so a connection only reports bytes this filter has not accounted for: early data
+  // is written to upstream afterwards, and onData() leaves it to the upstream callback.
+  read_callbacks_->connection().addBytesSentCallback(
+      [this](uint64_t bytes_sent) { getRequestInfo().addBytesSent(bytes_sent); });
+  upstream_conn_data_->connection().addBytesSentCallback(
+      [upstream_callbacks = upstream_callbacks_](uint64_t bytes_sent) {
+        if (upstream_callbacks->parent_ != nullptr) {
+          upstream_callbacks->parent_->getRequestInfo().addBytesReceived(bytes_sent);
+        }
+      });
+}
+
 void Filter::onIdleTimeout() {
   ENVOY_CONN_LOG(debug, "Session timed out", read_callbacks_->connection());
   config_->stats().idle_timeout_.inc();
@@ -523,14 +577,12 @@ UpstreamDrainManager::~UpstreamDrainManager() {
 }
 
 void UpstreamDrainManager::add(const Config::SharedConfigSharedPtr& config,
-                               Network::ClientConnectionPtr&& upstream_connection,
+                               Tcp::ConnectionPool::ConnectionData& upstream_conn_data,
                                const std::shared_ptr<Filter::UpstreamCallbacks>& callbacks,
                                Event::TimerPtr&& idle_timer,
-                               const Upstream::HostDescriptionConstSharedPtr& upstream_host,
-                               Stats::TimespanPtr&& connected_timespan) {
-  DrainerPtr drainer(new Drainer(*this, config, callbacks, std::move(upstream_connection),
-                                 std::move(idle_timer), upstream_host,
-                                 std::move(connected_timespan)));
+                               const Upstream::HostDescriptionConstSharedPtr& upstream_host) {
+  DrainerPtr drainer(new Drainer(*this, config, callbacks, upstream_conn_data,
+                                 std::move(idle_timer), upstream_host));
   callbacks->drain(*drainer);
 
   // Use temporary to ensure we get the pointer before we move it out of drainer
@@ -547,12 +599,10 @@ void UpstreamDrainManager::remove(Drainer& drainer, Event::Dispatcher& dispatche
 
 Drainer::Drainer(UpstreamDrainManager& parent, const Config::SharedConfigSharedPtr& config,
                  const std::shared_ptr<Filter::UpstreamCallbacks>& callbacks,
-                 Network::ClientConnectionPtr&& connection, Event::TimerPtr&& idle_timer,
-                 const Upstream::HostDescriptionConstSharedPtr& upstream_host,
-                 Stats::TimespanPtr&& connected_timespan)
-    : parent_(parent), callbacks_(callbacks), upstream_connection_(std::move(connection)),
-      timer_(std::move(idle_timer)), connected_timespan_(std::move(connected_timespan)),
-      upstream_host_(upstream_host), config_(config) {
+                 Tcp::ConnectionPool::ConnectionData& conn_data, Event::TimerPtr&& idle_timer,
+                 const Upstream::HostDescriptionConstSharedPtr& upstream_host)
+    : parent_(parent), callbacks_(callbacks), upstream_conn_data_(conn_data),
+      timer_(std::move(idle_timer)), upstream_host_(upstream_host), config_(config) {
   config_->stats().upstream_flush_total_.inc();
   config_->stats().upstream_flush_active_.inc();
 }
@@ -564,8 +614,8 @@ void Drainer::onEvent(Network::ConnectionEvent event) {
       timer_->disableTimer();
     }
     config_->stats().upstream_flush_active_.dec();
-    finalizeConnectionStats(*upstream_host_, *connected_timespan_);
-    parent_.remove(*this, upstream_connection_->dispatcher());
+    upstream_host_->cluster().stats().upstream_cx_destroy_.inc();
+    parent_.remove(*this, upstream_conn_data_.connection().dispatcher());
   }
 }
 
@@ -592,7 +642,7 @@ void Drainer::onBytesSent() {
 
 void Drainer::cancelDrain() {
   // This sends onEvent(LocalClose).
-  upstream_connection_->close(Network::ConnectionCloseType::NoFlush);
+  upstream_conn_data_.connection().close(Network::ConnectionCloseType::NoFlush);
 }
 
 } // namespace TcpProxy
@@ -11,15 +11,17 @@
 #include "envoy/event/timer.h"
 #include "envoy/network/connection.h"
 #include "envoy/network/filter.h"
+#include "envoy/runtime/runtime.h"
 #include "envoy/server/filter_config.h"
 #include "envoy/stats/stats_macros.h"
 #include "envoy/stats/timespan.h"
+#include "envoy/tcp/conn_pool.h"
 #include "envoy/upstream/cluster_manager.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/logger.h"
-#include "common/network/cidr_range.h"
-#include "common/network/filter_impl.h"
+#include "common/network/cidr_set.h"
 #include "common/network/utility.h"
 #include "common/request_info/request_info_impl.h"
 
@@ -30,25 +32,29 @@ namespace TcpProxy {
  * All tcp proxy stats. @see stats_macros.h
  */
 // clang-format off
-#define ALL_TCP_PROXY_STATS(COUNTER, GAUGE)                                                        \
+#define ALL_TCP_PROXY_STATS(COUNTER, GAUGE, HISTOGRAM)                                             \
   COUNTER(downstream_cx_rx_bytes_total)                                                            \
   GAUGE  (downstream_cx_rx_bytes_buffered)                                                         \
   COUNTER(downstream_cx_tx_bytes_total)                                                            \
   GAUGE  (downstream_cx_tx_bytes_buffered)                                                         \
   COUNTER(downstream_cx_total)                                                                     \
   COUNTER(downstream_cx_no_route)                                                                  \
+  COUNTER(downstream_cx_splice_total)                                                              \
   COUNTER(downstream_flow_control_paused_reading_total)                                            \
   COUNTER(downstream_flow_control_resumed_reading_total)                                           \
   COUNTER(idle_timeout)                                                                            \
   COUNTER(upstream_flush_total)                                                                    \
-  GAUGE  (upstream_flush_active)
+  GAUGE  (upstream_flush_active)                                                                   \
+  COUNTER(upstream_preconnect_hit)                                                                 \
+  COUNTER(upstream_preconnect_miss)                                                                \
+  HISTOGRAM(upstream_connect_latency_ms)
 // clang-format on
 
 /**
  * Struct definition for all tcp proxy stats. @see stats_macros.h
  */
 struct TcpProxyStats {
-  ALL_TCP_PROXY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+  ALL_TCP_PROXY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 class Drainer;
@@ -98,9 +104,19 @@ public:
    */
   const std::string& getRouteFromEntries(Network::Connection& connection);
 
+  /**
+   * @param cluster_name supplies the cluster of the route an upstream connection is opened for.
+   * @return the number of spare upstream connections to keep connected ahead of demand, read from
+   *         the runtime key tcp_proxy.<stat_prefix>.preconnect.<cluster_name> of the first route
+   *         to the cluster. 0 disables preconnecting. Spare connections count toward the
+   *         cluster's connection limit.
+   */
+  uint32_t preconnectCount(const std::string& cluster_name);
+
   const TcpProxyStats& stats() { return shared_config_->stats(); }
   const std::vector<AccessLog::InstanceSharedPtr>& accessLogs() { return access_logs_; }
   uint32_t maxConnectAttempts() const { return max_connect_attempts_; }
+  Runtime::Loader& runtime() { return runtime_; }
   const absl::optional<std::chrono::milliseconds>& idleTimeout() {
     return shared_config_->idleTimeout();
   }
@@ -113,18 +129,21 @@ public:
 private:
   struct Route {
     Route(const envoy::config::filter::network::tcp_proxy::v2::TcpProxy::DeprecatedV1::TCPRoute&
-              config);
+              config,
+          const std::string& stat_prefix);
 
-    Network::Address::IpList source_ips_;
+    Network::Address::CidrSet source_ips_;
     Network::PortRangeList source_port_ranges_;
-    Network::Address::IpList destination_ips_;
+    Network::Address::CidrSet destination_ips_;
     Network::PortRangeList destination_port_ranges_;
     std::string cluster_name_;
+    std::string preconnect_runtime_key_;
   };
 
   std::vector<Route> routes_;
   std::vector<AccessLog::InstanceSharedPtr> access_logs_;
   const uint32_t max_connect_attempts_;
+  Runtime::Loader& runtime_;
   ThreadLocal::SlotPtr upstream_drain_manager_slot_;
   SharedConfigSharedPtr shared_config_;
   std::unique_ptr<const Router::MetadataMatchCriteria> cluster_metadata_match_criteria_;
@@ -139,6 +158,7 @@ typedef std::shared_ptr<Config> ConfigSharedPtr;
  */
 class Filter : public Network::ReadFilter,
                Upstream::LoadBalancerContext,
+               Tcp::ConnectionPool::Callbacks,
                protected Logger::Loggable<Logger::Id::filter> {
 public:
   Filter(ConfigSharedPtr config, Upstream::ClusterManager& cluster_manager);
@@ -161,23 +181,28 @@ public:
 
   const Http::HeaderMap* downstreamHeaders() const override { return nullptr; }
 
+  // Tcp::ConnectionPool::Callbacks
+  void onPoolFailure(Tcp::ConnectionPool::PoolFailureReason reason,
+                     Upstream::HostDescriptionConstSharedPtr host) override;
+  void onPoolReady(Tcp::ConnectionPool::ConnectionData& conn_data,
+                   Upstream::HostDescriptionConstSharedPtr host) override;
+
   // These two functions allow enabling/disabling reads on the upstream and downstream connections.
   // They are called by the Downstream/Upstream Watermark callbacks to limit buffering.
   void readDisableUpstream(bool disable);
   void readDisableDownstream(bool disable);
 
-  struct UpstreamCallbacks : public Network::ConnectionCallbacks,
-                             public Network::ReadFilterBaseImpl {
+  struct UpstreamCallbacks : public Tcp::ConnectionPool::UpstreamCallbacks {
     UpstreamCallbacks(Filter* parent) : parent_(parent) {}
 
+    // Tcp::ConnectionPool::UpstreamCallbacks
+    void onUpstreamData(Buffer::Instance& data, bool end_stream) override;
+
     // Network::ConnectionCallbacks
     void onEvent(Network::ConnectionEvent event) override;
     void onAboveWriteBufferHighWatermark() override;
     void onBelowWriteBufferLowWatermark() override;
 
-    // Network::ReadFilter
-    Network::FilterStatus onData(Buffer::Instance& data, bool end_stream) override;
-
     void onBytesSent();
     void onIdleTimeout();
     void drain(Drainer& drainer);
@@ -188,7 +213,8 @@ public:
     //
     // Parent starts out as non-NULL. If the downstream connection is closed while
     // the upstream connection still has buffered data to flush, drainer_ becomes
-    // non-NULL and parent_ is set to NULL.
+    // non-NULL and parent_ is set to NULL. Both are NULL if the filter is destroyed
+    // while it still owns the upstream connection, which it then closes.
     Filter* parent_{};
     Drainer* drainer_{};
 
@@ -230,41 +256,47 @@ protected:
 
   void initialize(Network::ReadFilterCallbacks& callbacks, bool set_connection_stats);
   Network::FilterStatus initializeUpstreamConnection();
-  void onConnectTimeout();
   void onDownstreamEvent(Network::ConnectionEvent event);
   void onUpstreamData(Buffer::Instance& data, bool end_stream);
   void onUpstreamEvent(Network::ConnectionEvent event);
-  void finalizeUpstreamConnectionStats();
   void onIdleTimeout();
   void resetIdleTimer();
   void disableIdleTimer();
+  void startSplice();
 
   const ConfigSharedPtr config_;
   Upstream::ClusterManager& cluster_manager_;
   Network::ReadFilterCallbacks* read_callbacks_{};
-  Network::ClientConnectionPtr upstream_connection_;
+  // The pending request for an upstream connection, until the pool calls back.
+  Tcp::ConnectionPool::Cancellable* upstream_handle_{};
+  // The upstream connection. It is owned by the pool, and is closed rather than released once
+  // the session is over.
+  Tcp::ConnectionPool::ConnectionData* upstream_conn_data_{};
   DownstreamCallbacks downstream_callbacks_;
-  Event::TimerPtr connect_timeout_timer_;
   Event::TimerPtr idle_timer_;
   Stats::TimespanPtr connect_timespan_;
-  Stats::TimespanPtr connected_timespan_;
-  std::shared_ptr<UpstreamCallbacks> upstream_callbacks_; // shared_ptr required for passing as a
-                                                          // read filter.
+  std::shared_ptr<UpstreamCallbacks> upstream_callbacks_; // shared_ptr required as the idle timer
+                                                          // and a Drainer can outlive the filter.
+  // Downstream data handed to onData() before the upstream connection is ready.
+  Buffer::OwnedImpl early_data_;
+  bool early_end_stream_{};
+  // Set once the connections splice. Bytes for upstream are then accounted as it sends them.
+  bool spliced_{};
   RequestInfo::RequestInfoImpl request_info_;
   uint32_t connect_attempts_{};
 };
 
-// This class holds ownership of an upstream connection that needs to finish
-// flushing, when the downstream connection has been closed. The TcpProxy is
-// destroyed when the downstream connection is closed, so moving the upstream
-// connection here allows it to finish draining or timeout.
+// This class takes over an upstream connection that needs to finish flushing,
+// when the downstream connection has been closed. The TcpProxy is destroyed when
+// the downstream connection is closed, so handing the upstream connection over
+// here allows it to finish draining or timeout. The connection pool still owns
+// the connection.
 class Drainer : public Event::DeferredDeletable {
 public:
   Drainer(UpstreamDrainManager& parent, const Config::SharedConfigSharedPtr& config,
           const std::shared_ptr<Filter::UpstreamCallbacks>& callbacks,
-          Network::ClientConnectionPtr&& connection, Event::TimerPtr&& idle_timer,
-          const Upstream::HostDescriptionConstSharedPtr& upstream_host,
-          Stats::TimespanPtr&& connected_timespan);
+          Tcp::ConnectionPool::ConnectionData& conn_data, Event::TimerPtr&& idle_timer,
+          const Upstream::HostDescriptionConstSharedPtr& upstream_host);
 
   void onEvent(Network::ConnectionEvent event);
   void onData(Buffer::Instance& data, bool end_stream);
@@ -275,9 +307,8 @@ public:
 private:
   UpstreamDrainManager& parent_;
   std::shared_ptr<Filter::UpstreamCallbacks> callbacks_;
-  Network::ClientConnectionPtr upstream_connection_;
+  Tcp::ConnectionPool::ConnectionData& upstream_conn_data_;
   Event::TimerPtr timer_;
-  Stats::TimespanPtr connected_timespan_;
   Upstream::HostDescriptionConstSharedPtr upstream_host_;
   Config::SharedConfigSharedPtr config_;
 };
@@ -288,11 +319,10 @@ class UpstreamDrainManager : public ThreadLocal::ThreadLocalObject {
 public:
   ~UpstreamDrainManager();
   void add(const Config::SharedConfigSharedPtr& config,
-           Network::ClientConnectionPtr&& upstream_connection,
+           Tcp::ConnectionPool::ConnectionData& upstream_conn_data,
            const std::shared_ptr<Filter::UpstreamCallbacks>& callbacks,
            Event::TimerPtr&& idle_timer,
-           const Upstream::HostDescriptionConstSharedPtr& upstream_host,
-           Stats::TimespanPtr&& connected_timespan);
+           const Upstream::HostDescriptionConstSharedPtr& upstream_host);
   void remove(Drainer& drainer, Event::Dispatcher& dispatcher);
 
 private:
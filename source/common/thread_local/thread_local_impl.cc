@@ -56,6 +56,24 @@ void InstanceImpl::registerThread(Event::Dispatcher& dispatcher, bool main_threa
   }
 }
 
+void InstanceImpl::registerRestrictedThread(Event::Dispatcher& dispatcher) {
+  ASSERT(std::this_thread::get_id() == main_thread_id_);
+  ASSERT(!shutdown_);
+  ASSERT(!containsReference(restricted_threads_, dispatcher));
+
+  restricted_threads_.push_back(dispatcher);
+  dispatcher.post([&dispatcher] { thread_local_data_.dispatcher_ = &dispatcher; });
+}
+
+std::list<std::reference_wrapper<Event::Dispatcher>>
+InstanceImpl::threads(bool include_restricted) const {
+  std::list<std::reference_wrapper<Event::Dispatcher>> threads = registered_threads_;
+  if (include_restricted) {
+    threads.insert(threads.end(), restricted_threads_.begin(), restricted_threads_.end());
+  }
+  return threads;
+}
+
 void InstanceImpl::removeSlot(SlotImpl& slot) {
   ASSERT(std::this_thread::get_id() == main_thread_id_);
 
@@ -69,21 +87,25 @@ void InstanceImpl::removeSlot(SlotImpl& slot) {
 
   const uint64_t index = slot.index_;
   slots_[index] = nullptr;
-  runOnAllThreads([index]() -> void {
-    // This runs on each thread and clears the slot, making it available for a new allocations.
-    // This is safe even if a new allocation comes in, because everything happens with post() and
-    // will be sequenced after this removal.
-    if (index < thread_local_data_.data_.size()) {
-      thread_local_data_.data_[index] = nullptr;
-    }
-  });
+  // Clear the slot on the restricted threads as well, whether or not this slot included them, so
+  // that a later slot reusing the index never sees stale data there.
+  runOnAllThreads(
+      [index]() -> void {
+        // This runs on each thread and clears the slot, making it available for a new allocations.
+        // This is safe even if a new allocation comes in, because everything happens with post()
+        // and will be sequenced after this removal.
+        if (index < thread_local_data_.data_.size()) {
+          thread_local_data_.data_[index] = nullptr;
+        }
+      },
+      true);
 }
 
-void InstanceImpl::runOnAllThreads(Event::PostCb cb) {
+void InstanceImpl::runOnAllThreads(Event::PostCb cb, bool include_restricted) {
   ASSERT(std::this_thread::get_id() == main_thread_id_);
   ASSERT(!shutdown_);
 
-  for (Event::Dispatcher& dispatcher : registered_threads_) {
+  for (Event::Dispatcher& dispatcher : threads(include_restricted)) {
     dispatcher.post(cb);
   }
 
@@ -91,16 +113,18 @@ void InstanceImpl::runOnAllThreads(Event::PostCb cb) {
   cb();
 }
 
-void InstanceImpl::runOnAllThreads(Event::PostCb cb, Event::PostCb all_threads_complete_cb) {
+void InstanceImpl::runOnAllThreads(Event::PostCb cb, Event::PostCb all_threads_complete_cb,
+                                   bool include_restricted) {
   ASSERT(std::this_thread::get_id() == main_thread_id_);
   ASSERT(!shutdown_);
   // Handle main thread first so that when the last worker thread wins, we could just call the
   // all_threads_complete_cb method. Parallelism of main thread execution is being traded off
   // for programming simplicity here.
   cb();
+  const auto all_threads = threads(include_restricted);
   std::shared_ptr<std::atomic<uint64_t>> worker_count =
-      std::make_shared<std::atomic<uint64_t>>(registered_threads_.size());
-  for (Event::Dispatcher& dispatcher : registered_threads_) {
+      std::make_shared<std::atomic<uint64_t>>(all_threads.size());
+  for (Event::Dispatcher& dispatcher : all_threads) {
     dispatcher.post([this, worker_count, cb, all_threads_complete_cb]() -> void {
       cb();
       if (--*worker_count == 0) {
@@ -114,7 +138,7 @@ void InstanceImpl::SlotImpl::set(InitializeCb cb) {
   ASSERT(std::this_thread::get_id() == parent_.main_thread_id_);
   ASSERT(!parent_.shutdown_);
 
-  for (Event::Dispatcher& dispatcher : parent_.registered_threads_) {
+  for (Event::Dispatcher& dispatcher : parent_.threads(include_restricted_threads_)) {
     const uint32_t index = index_;
     dispatcher.post([index, cb, &dispatcher]() -> void { setThreadLocal(index, cb(dispatcher)); });
   }
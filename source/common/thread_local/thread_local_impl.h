@@ -23,6 +23,7 @@ public:
   // ThreadLocal::Instance
   SlotPtr allocateSlot() override;
   void registerThread(Event::Dispatcher& dispatcher, bool main_thread) override;
+  void registerRestrictedThread(Event::Dispatcher& dispatcher) override;
   void shutdownGlobalThreading() override;
   void shutdownThread() override;
   Event::Dispatcher& dispatcher() override;
@@ -34,14 +35,18 @@ private:
 
     // ThreadLocal::Slot
     ThreadLocalObjectSharedPtr get() override;
-    void runOnAllThreads(Event::PostCb cb) override { parent_.runOnAllThreads(cb); }
+    void includeRestrictedThreads() override { include_restricted_threads_ = true; }
+    void runOnAllThreads(Event::PostCb cb) override {
+      parent_.runOnAllThreads(cb, include_restricted_threads_);
+    }
     void runOnAllThreads(Event::PostCb cb, Event::PostCb main_callback) override {
-      parent_.runOnAllThreads(cb, main_callback);
+      parent_.runOnAllThreads(cb, main_callback, include_restricted_threads_);
     }
     void set(InitializeCb cb) override;
 
     InstanceImpl& parent_;
     const uint64_t index_;
+    bool include_restricted_threads_{};
   };
 
   struct ThreadLocalData {
@@ -50,13 +55,16 @@ private:
   };
 
   void removeSlot(SlotImpl& slot);
-  void runOnAllThreads(Event::PostCb cb);
-  void runOnAllThreads(Event::PostCb cb, Event::PostCb main_callback);
+  std::list<std::reference_wrapper<Event::Dispatcher>> threads(bool include_restricted) const;
+  void runOnAllThreads(Event::PostCb cb, bool include_restricted);
+  void runOnAllThreads(Event::PostCb cb, Event::PostCb main_callback, bool include_restricted);
   static void setThreadLocal(uint32_t index, ThreadLocalObjectSharedPtr object);
 
   static thread_local ThreadLocalData thread_local_data_;
   std::vector<SlotImpl*> slots_;
   std::list<std::reference_wrapper<Event::Dispatcher>> registered_threads_;
+  // Threads that only receive data of slots that called includeRestrictedThreads().
+  std::list<std::reference_wrapper<Event::Dispatcher>> restricted_threads_;
   std::thread::id main_thread_id_;
   Event::Dispatcher* main_thread_dispatcher_{};
   std::atomic<bool> shutdown_{};
@@ -1,11 +1,13 @@
 #include "common/upstream/cds_api_impl.h"
 
+#include <algorithm>
 #include <string>
 
 #include "envoy/api/v2/cds.pb.validate.h"
 #include "envoy/api/v2/cluster/outlier_detection.pb.validate.h"
 
 #include "common/common/cleanup.h"
+#include "common/common/thread.h"
 #include "common/config/resources.h"
 #include "common/config/subscription_factory.h"
 #include "common/config/utility.h"
@@ -14,22 +16,29 @@
 
 namespace Envoy {
 namespace Upstream {
+namespace {
+
+// Below this many clusters per thread, starting a thread costs more than it saves.
+constexpr uint32_t MIN_CLUSTERS_PER_PARSE_THREAD = 64;
+
+} // namespace
 
 CdsApiPtr CdsApiImpl::create(const envoy::api::v2::core::ConfigSource& cds_config,
                              const absl::optional<envoy::api::v2::core::ConfigSource>& eds_config,
                              ClusterManager& cm, Event::Dispatcher& dispatcher,
                              Runtime::RandomGenerator& random,
-                             const LocalInfo::LocalInfo& local_info, Stats::Scope& scope) {
-  return CdsApiPtr{
-      new CdsApiImpl(cds_config, eds_config, cm, dispatcher, random, local_info, scope)};
+                             const LocalInfo::LocalInfo& local_info, Stats::Scope& scope,
+                             uint32_t parse_threads) {
+  return CdsApiPtr{new CdsApiImpl(cds_config, eds_config, cm, dispatcher, random, local_info, scope,
+                                  parse_threads)};
 }
 
 CdsApiImpl::CdsApiImpl(const envoy::api::v2::core::ConfigSource& cds_config,
                        const absl::optional<envoy::api::v2::core::ConfigSource>& eds_config,
                        ClusterManager& cm, Event::Dispatcher& dispatcher,
                        Runtime::RandomGenerator& random, const LocalInfo::LocalInfo& local_info,
-                       Stats::Scope& scope)
-    : cm_(cm), scope_(scope.createScope("cluster_manager.cds.")) {
+                       Stats::Scope& scope, uint32_t parse_threads)
+    : cm_(cm), parse_threads_(parse_threads), scope_(scope.createScope("cluster_manager.cds.")) {
   Config::Utility::checkLocalInfo("cds", local_info);
 
   subscription_ =
@@ -42,15 +51,13 @@ CdsApiImpl::CdsApiImpl(const envoy::api::v2::core::ConfigSource& cds_config,
                                        scope.statsOptions());
           },
           "envoy.api.v2.ClusterDiscoveryService.FetchClusters",
-          "envoy.api.v2.ClusterDiscoveryService.StreamClusters");
+          "envoy.api.v2.ClusterDiscoveryService.StreamClusters", parse_threads_);
 }
 
 void CdsApiImpl::onConfigUpdate(const ResourceVector& resources, const std::string& version_info) {
   cm_.adsMux().pause(Config::TypeUrl::get().ClusterLoadAssignment);
   Cleanup eds_resume([this] { cm_.adsMux().resume(Config::TypeUrl::get().ClusterLoadAssignment); });
-  for (const auto& cluster : resources) {
-    MessageUtil::validate(cluster);
-  }
+  validateClusters(resources);
   // We need to keep track of which clusters we might need to remove.
   ClusterManager::ClusterInfoMap clusters_to_remove = cm_.clusters();
   for (auto& cluster : resources) {
@@ -72,6 +79,36 @@ void CdsApiImpl::onConfigUpdate(const ResourceVector& resources, const std::stri
   runInitializeCallbackIfAny();
 }
 
+void CdsApiImpl::onConfigUpdate(const ResourceVector& added_resources,
+                                const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+                                const std::string& system_version_info) {
+  cm_.adsMux().pause(Config::TypeUrl::get().ClusterLoadAssignment);
+  Cleanup eds_resume([this] { cm_.adsMux().resume(Config::TypeUrl::get().ClusterLoadAssignment); });
+  validateClusters(added_resources);
+  for (const auto& cluster : added_resources) {
+    if (cm_.addOrUpdateCluster(cluster, system_version_info)) {
+      ENVOY_LOG(debug, "cds: add/update cluster '{}'", cluster.name());
+    }
+  }
+  for (const std::string& cluster_name : removed_resources) {
+    if (cm_.removeCluster(cluster_name)) {
+      ENVOY_LOG(debug, "cds: remove cluster '{}'", cluster_name);
+    }
+  }
+
+  version_info_ = system_version_info;
+  runInitializeCallbackIfAny();
+}
+
+void CdsApiImpl::validateClusters(const ResourceVector& clusters) {
+  // Validation doesn't depend on anything but the cluster itself, so that large updates can be
+  // validated in parallel. Only updates with enough clusters to keep the threads busy use them.
+  const uint32_t concurrency = std::max<uint32_t>(
+      1, std::min<uint32_t>(parse_threads_, clusters.size() / MIN_CLUSTERS_PER_PARSE_THREAD));
+  Thread::parallelFor(clusters.size(), concurrency,
+                      [&clusters](size_t i) -> void { MessageUtil::validate(clusters[i]); });
+}
+
 void CdsApiImpl::onConfigUpdateFailed(const EnvoyException*) {
   // We need to allow server startup to continue, even if we have a bad
   // config.
@@ -20,11 +20,16 @@ class CdsApiImpl : public CdsApi,
                    Config::SubscriptionCallbacks<envoy::api::v2::Cluster>,
                    Logger::Loggable<Logger::Id::upstream> {
 public:
+  /**
+   * @param parse_threads supplies the maximum number of threads, including the main thread, that
+   *        clusters received over gRPC are decoded and validated on. Clusters are still added to
+   *        the cluster manager one by one on the main thread.
+   */
   static CdsApiPtr create(const envoy::api::v2::core::ConfigSource& cds_config,
                           const absl::optional<envoy::api::v2::core::ConfigSource>& eds_config,
                           ClusterManager& cm, Event::Dispatcher& dispatcher,
                           Runtime::RandomGenerator& random, const LocalInfo::LocalInfo& local_info,
-                          Stats::Scope& scope);
+                          Stats::Scope& scope, uint32_t parse_threads = 1);
 
   // Upstream::CdsApi
   void initialize() override { subscription_->start({}, *this); }
@@ -35,6 +40,9 @@ public:
 
   // Config::SubscriptionCallbacks
   void onConfigUpdate(const ResourceVector& resources, const std::string& version_info) override;
+  void onConfigUpdate(const ResourceVector& added_resources,
+                      const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+                      const std::string& system_version_info) override;
   void onConfigUpdateFailed(const EnvoyException* e) override;
   std::string resourceName(const ProtobufWkt::Any& resource) override {
     return MessageUtil::anyConvert<envoy::api::v2::Cluster>(resource).name();
@@ -44,10 +52,12 @@ private:
   CdsApiImpl(const envoy::api::v2::core::ConfigSource& cds_config,
              const absl::optional<envoy::api::v2::core::ConfigSource>& eds_config,
              ClusterManager& cm, Event::Dispatcher& dispatcher, Runtime::RandomGenerator& random,
-             const LocalInfo::LocalInfo& local_info, Stats::Scope& scope);
+             const LocalInfo::LocalInfo& local_info, Stats::Scope& scope, uint32_t parse_threads);
   void runInitializeCallbackIfAny();
+  void validateClusters(const ResourceVector& clusters);
 
   ClusterManager& cm_;
+  const uint32_t parse_threads_;
   std::unique_ptr<Config::Subscription<envoy::api::v2::Cluster>> subscription_;
   std::string version_info_;
   std::function<void()> initialize_callback_;
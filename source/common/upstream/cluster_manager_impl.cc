@@ -1,10 +1,12 @@
 #include "common/upstream/cluster_manager_impl.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <functional>
 #include <list>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "envoy/admin/v2alpha/config_dump.pb.h"
@@ -217,7 +219,8 @@ ClusterManagerImpl::ClusterManagerImpl(const envoy::config::bootstrap::v2::Boots
         main_thread_dispatcher,
         *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
             "envoy.service.discovery.v2.AggregatedDiscoveryService.StreamAggregatedResources"),
-        random_));
+        random_, monotonic_time_source,
+        runtime_.snapshot().featureEnabled("config.incremental_ads", 0)));
   } else {
     ads_mux_.reset(new Config::NullGrpcMuxImpl());
   }
@@ -271,9 +274,12 @@ ClusterManagerImpl::ClusterManagerImpl(const envoy::config::bootstrap::v2::Boots
 
   // Once the initial set of static bootstrap clusters are created (including the local cluster),
   // we can instantiate the thread local cluster manager.
-  tls_->set([this, local_cluster_name](
+  // Only workers serve requests, so only the worker cluster managers prefetch connections. The
+  // main thread holds a cluster manager too, and health check threads are not registered for it.
+  tls_->set([this, local_cluster_name, &main_thread_dispatcher](
                 Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
-    return std::make_shared<ThreadLocalClusterManagerImpl>(*this, dispatcher, local_cluster_name);
+    return std::make_shared<ThreadLocalClusterManagerImpl>(
+        *this, dispatcher, local_cluster_name, &dispatcher != &main_thread_dispatcher);
   });
 
   // We can now potentially create the CDS API once the backing cluster exists.
@@ -684,8 +690,8 @@ ClusterManagerImpl::ClusterUpdateCallbacksHandleImpl::~ClusterUpdateCallbacksHan
 
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ThreadLocalClusterManagerImpl(
     ClusterManagerImpl& parent, Event::Dispatcher& dispatcher,
-    const absl::optional<std::string>& local_cluster_name)
-    : parent_(parent), thread_local_dispatcher_(dispatcher) {
+    const absl::optional<std::string>& local_cluster_name, bool prefetch)
+    : parent_(parent), thread_local_dispatcher_(dispatcher), prefetch_(prefetch) {
   // If local cluster is defined then we need to initialize it first.
   if (local_cluster_name) {
     ENVOY_LOG(debug, "adding TLS local cluster {}", local_cluster_name.value());
@@ -961,11 +967,16 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ClusterEntry(
   }
 
   priority_set_.addMemberUpdateCb(
-      [this](uint32_t, const HostVector&, const HostVector& hosts_removed) -> void {
+      [this](uint32_t, const HostVector& hosts_added, const HostVector& hosts_removed) -> void {
         // We need to go through and purge any connection pools for hosts that got deleted.
         // Even if two hosts actually point to the same address this will be safe, since if a
         // host is readded it will be a different physical HostSharedPtr.
         parent_.drainConnPools(hosts_removed);
+
+        // Hosts are reported as added both on EDS/DNS updates and when a warming cluster becomes
+        // active, and health changes are reported as updates too, so this is where warm
+        // connections are established.
+        prefetchConnPools(hosts_added, hosts_removed);
       });
 }
 
@@ -1019,6 +1030,50 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
   return container.pools_[hash_key].get();
 }
 
+void ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::prefetchConnPools(
+    const HostVector& hosts_added, const HostVector& hosts_removed) {
+  if (!parent_.prefetch_ || cluster_info_->warmConnections() == 0) {
+    return;
+  }
+
+  for (const HostSharedPtr& host : hosts_removed) {
+    unwarmed_hosts_.erase(host);
+  }
+  // Hosts that are added pending their first health check become healthy in a later update.
+  for (auto it = unwarmed_hosts_.begin(); it != unwarmed_hosts_.end();) {
+    if ((*it)->healthy()) {
+      prefetchConnPool(*it);
+      it = unwarmed_hosts_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (const HostSharedPtr& host : hosts_added) {
+    if (host->healthy()) {
+      prefetchConnPool(host);
+    } else {
+      unwarmed_hosts_.insert(host);
+    }
+  }
+}
+
+void ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::prefetchConnPool(
+    const HostSharedPtr& host) {
+  const Http::Protocol protocol = (cluster_info_->features() & ClusterInfo::Features::HTTP2)
+                                      ? Http::Protocol::Http2
+                                      : Http::Protocol::Http11;
+  // Use the same key that connPool() computes for a request without downstream socket options
+  // so that the warm connections are picked up by the first requests routed to the host.
+  std::vector<uint8_t> hash_key = {uint8_t(protocol), uint8_t(ResourcePriority::Default)};
+  ConnPoolsContainer& container = parent_.host_http_conn_pool_map_[host];
+  if (!container.pools_[hash_key]) {
+    container.pools_[hash_key] = parent_.parent_.factory_.allocateConnPool(
+        parent_.thread_local_dispatcher_, host, ResourcePriority::Default, protocol, nullptr);
+  }
+
+  container.pools_[hash_key]->prefetchConnections();
+}
+
 Tcp::ConnectionPool::Instance*
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::tcpConnPool(
     ResourcePriority priority, LoadBalancerContext* context) {
@@ -1094,14 +1149,21 @@ ClusterSharedPtr ProdClusterManagerFactory::clusterFromProto(
     bool added_via_api) {
   return ClusterImplBase::create(cluster, cm, stats_, tls_, dns_resolver_, ssl_context_manager_,
                                  runtime_, random_, main_thread_dispatcher_, log_manager,
-                                 local_info_, outlier_event_logger, added_via_api);
+                                 health_check_thread_pool_, local_info_, outlier_event_logger,
+                                 added_via_api);
 }
 
 CdsApiPtr ProdClusterManagerFactory::createCds(
     const envoy::api::v2::core::ConfigSource& cds_config,
     const absl::optional<envoy::api::v2::core::ConfigSource>& eds_config, ClusterManager& cm) {
+  // Only read when the cluster manager is created, like the rest of its configuration. More
+  // threads than cores only add contention, so the value is capped by the number of cores.
+  const uint64_t max_parse_threads = std::max(1U, std::thread::hardware_concurrency());
+  const uint32_t parse_threads = std::min(
+      max_parse_threads,
+      std::max<uint64_t>(1, runtime_.snapshot().getInteger("upstream.cds_parse_threads", 1)));
   return CdsApiImpl::create(cds_config, eds_config, cm, main_thread_dispatcher_, random_,
-                            local_info_, stats_);
+                            local_info_, stats_, parse_threads);
 }
 
 } // namespace Upstream
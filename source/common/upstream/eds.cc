@@ -146,6 +146,14 @@ bool EdsClusterImpl::updateHostsPerLocality(const uint32_t priority, const HostV
   return false;
 }
 
+void EdsClusterImpl::onConfigUpdate(const ResourceVector& added_resources,
+                                    const Protobuf::RepeatedPtrField<std::string>&,
+                                    const std::string& system_version_info) {
+  // Only the assignment of this cluster is watched. An incremental update either carries a new
+  // assignment or its removal, which is handled like a response without it.
+  onConfigUpdate(added_resources, system_version_info);
+}
+
 void EdsClusterImpl::onConfigUpdateFailed(const EnvoyException* e) {
   UNREFERENCED_PARAMETER(e);
   // We need to allow server startup to continue, even if we have a bad config.
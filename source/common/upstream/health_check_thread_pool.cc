@@ -0,0 +1,79 @@
+#include "common/upstream/health_check_thread_pool.h"
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Upstream {
+
+const std::chrono::milliseconds HealthCheckThreadPool::KEEPALIVE_INTERVAL(60000);
+
+HealthCheckThreadPool::HealthCheckThreadPool(uint32_t num_threads, Api::Api& api,
+                                             ThreadLocal::Instance& tls)
+    : tls_(tls) {
+  ASSERT(num_threads > 0);
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads_.emplace_back(new HealthCheckThread());
+    HealthCheckThread& thread = *threads_.back();
+    thread.dispatcher_ = api.allocateDispatcher();
+    tls_.registerRestrictedThread(*thread.dispatcher_);
+    thread.thread_.reset(new Thread::Thread([this, &thread]() -> void { threadRoutine(thread); }));
+  }
+}
+
+HealthCheckThreadPool::~HealthCheckThreadPool() { shutdown(); }
+
+void HealthCheckThreadPool::runOnThreadAndWait(uint32_t index, std::function<void()> callback) {
+  if (shutdown_) {
+    callback();
+    return;
+  }
+
+  Thread::MutexBasicLockable lock;
+  Thread::CondVar cond_var;
+  bool done = false;
+  dispatcher(index).post([&callback, &lock, &cond_var, &done]() -> void {
+    callback();
+    Thread::LockGuard guard(lock);
+    done = true;
+    cond_var.notifyOne();
+  });
+
+  Thread::LockGuard guard(lock);
+  while (!done) {
+    cond_var.wait(lock);
+  }
+}
+
+void HealthCheckThreadPool::shutdown() {
+  if (shutdown_) {
+    return;
+  }
+  shutdown_ = true;
+
+  for (auto& thread : threads_) {
+    // Exiting from a posted callback makes sure the exit is not lost if the thread has not entered
+    // its dispatch loop yet. Without the keepalive timer an idle loop returns on its own.
+    HealthCheckThread* raw_thread = thread.get();
+    thread->dispatcher_->post([raw_thread]() -> void {
+      raw_thread->keepalive_timer_.reset();
+      raw_thread->dispatcher_->exit();
+    });
+    thread->thread_->join();
+  }
+}
+
+void HealthCheckThreadPool::threadRoutine(HealthCheckThread& thread) {
+  ENVOY_LOG(debug, "health check thread entering dispatch loop");
+  thread.keepalive_timer_ = thread.dispatcher_->createTimer(
+      [&thread]() -> void { thread.keepalive_timer_->enableTimer(KEEPALIVE_INTERVAL); });
+  thread.keepalive_timer_->enableTimer(KEEPALIVE_INTERVAL);
+  thread.dispatcher_->run(Event::Dispatcher::RunType::Block);
+  ENVOY_LOG(debug, "health check thread exited dispatch loop");
+
+  thread.keepalive_timer_.reset();
+  tls_.shutdownThread();
+}
+
+} // namespace Upstream
+} // namespace Envoy
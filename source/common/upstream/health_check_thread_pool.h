@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "envoy/api/api.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/logger.h"
+#include "common/common/non_copyable.h"
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * A fixed set of threads that active health check sessions run on instead of the main thread. Each
+ * thread runs its own dispatcher, which is registered as a restricted thread: it only receives the
+ * thread local data of slots that include restricted threads (runtime and stats), so that sessions
+ * can read runtime like they do on the main thread without every other slot being built on the
+ * pool. The pool must therefore be created before those slots are set.
+ */
+class HealthCheckThreadPool : NonCopyable, Logger::Loggable<Logger::Id::hc> {
+public:
+  /**
+   * @param num_threads supplies the number of health check threads to start.
+   * @param api supplies the API used to allocate each thread's dispatcher.
+   * @param tls supplies the thread local instance the threads register with as restricted threads.
+   */
+  HealthCheckThreadPool(uint32_t num_threads, Api::Api& api, ThreadLocal::Instance& tls);
+  ~HealthCheckThreadPool();
+
+  /**
+   * @return uint32_t the number of threads in the pool.
+   */
+  uint32_t size() const { return threads_.size(); }
+
+  /**
+   * @param index supplies the index of a thread.
+   * @return Event::Dispatcher& the dispatcher the thread runs.
+   */
+  Event::Dispatcher& dispatcher(uint32_t index) { return *threads_[index]->dispatcher_; }
+
+  /**
+   * Run a callback on a thread of the pool and block until it has run. Once the pool has shut down
+   * the callback runs inline instead. Must not be called from a thread of the pool.
+   * @param index supplies the index of the thread.
+   * @param callback supplies the callback to run.
+   */
+  void runOnThreadAndWait(uint32_t index, std::function<void()> callback);
+
+  /**
+   * Stop all threads and wait for them to exit. Called on the main thread during server shutdown.
+   */
+  void shutdown();
+
+private:
+  struct HealthCheckThread {
+    Event::DispatcherPtr dispatcher_;
+    // Only touched on the thread itself.
+    Event::TimerPtr keepalive_timer_;
+    Thread::ThreadPtr thread_;
+  };
+
+  void threadRoutine(HealthCheckThread& thread);
+
+  // Keeps an idle dispatcher from running out of events and returning from its loop.
+  static const std::chrono::milliseconds KEEPALIVE_INTERVAL;
+
+  ThreadLocal::Instance& tls_;
+  std::vector<std::unique_ptr<HealthCheckThread>> threads_;
+  bool shutdown_{};
+};
+
+typedef std::unique_ptr<HealthCheckThreadPool> HealthCheckThreadPoolPtr;
+
+} // namespace Upstream
+} // namespace Envoy
@@ -1,7 +1,12 @@
 #include "common/upstream/health_checker_base_impl.h"
 
+#include <list>
+#include <map>
+
 #include "envoy/data/core/v2alpha/health_check_event.pb.h"
 
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
 #include "common/router/router.h"
 
 namespace Envoy {
@@ -28,7 +33,8 @@ HealthCheckerImplBase::HealthCheckerImplBase(const Cluster& cluster,
       unhealthy_edge_interval_(
           PROTOBUF_GET_MS_OR_DEFAULT(config, unhealthy_edge_interval, unhealthy_interval_.count())),
       healthy_edge_interval_(
-          PROTOBUF_GET_MS_OR_DEFAULT(config, healthy_edge_interval, interval_.count())) {
+          PROTOBUF_GET_MS_OR_DEFAULT(config, healthy_edge_interval, interval_.count())),
+      coalesce_probes_(runtime.snapshot().featureEnabled("health_check.coalesce_probes", 0)) {
   cluster_.prioritySet().addMemberUpdateCb(
       [this](uint32_t, const HostVector& hosts_added, const HostVector& hosts_removed) -> void {
         onClusterMemberUpdate(hosts_added, hosts_removed);
@@ -105,7 +111,27 @@ std::chrono::milliseconds HealthCheckerImplBase::interval(HealthState state,
 
 void HealthCheckerImplBase::addHosts(const HostVector& hosts) {
   for (const HostSharedPtr& host : hosts) {
-    active_sessions_[host] = makeSession(host);
+    if (!shards_.empty()) {
+      host->setHealthChecker(
+          HealthCheckHostMonitorPtr{new HealthCheckHostMonitorImpl(shared_from_this(), host)});
+      // Hosts are placed by address, so that sessions of different checkers that probe the same
+      // address run on the same thread and can share their probes.
+      ShardSharedPtr shard =
+          shards_[std::hash<std::string>()(host->healthCheckAddress()->asString()) %
+                  shards_.size()];
+      host_shards_[host] = shard;
+      shard->dispatcher_.post([this, shard, host]() -> void {
+        if (shard->stopped_) {
+          return;
+        }
+        ActiveHealthCheckSessionPtr& session = shard->sessions_[host];
+        session = makeSession(host, shard->dispatcher_);
+        session->start();
+      });
+      continue;
+    }
+
+    active_sessions_[host] = makeSession(host, dispatcher_);
     host->setHealthChecker(
         HealthCheckHostMonitorPtr{new HealthCheckHostMonitorImpl(shared_from_this(), host)});
     active_sessions_[host]->start();
@@ -116,12 +142,36 @@ void HealthCheckerImplBase::onClusterMemberUpdate(const HostVector& hosts_added,
                                                   const HostVector& hosts_removed) {
   addHosts(hosts_added);
   for (const HostSharedPtr& host : hosts_removed) {
+    if (!shards_.empty()) {
+      auto shard_iter = host_shards_.find(host);
+      ASSERT(host_shards_.end() != shard_iter);
+      ShardSharedPtr shard = shard_iter->second;
+      host_shards_.erase(shard_iter);
+      shard->dispatcher_.post([shard, host]() -> void { shard->sessions_.erase(host); });
+      continue;
+    }
+
     auto session_iter = active_sessions_.find(host);
     ASSERT(active_sessions_.end() != session_iter);
     active_sessions_.erase(session_iter);
   }
 }
 
+void HealthCheckerImplBase::onHostHealthy(const HostSharedPtr& host, bool first_check) {
+  incHealthy();
+  if (event_logger_) {
+    event_logger_->logAddHealthy(healthCheckerType(), host, first_check);
+  }
+}
+
+void HealthCheckerImplBase::onHostUnhealthy(
+    const HostSharedPtr& host, envoy::data::core::v2alpha::HealthCheckFailureType type) {
+  decHealthy();
+  if (event_logger_) {
+    event_logger_->logEjectUnhealthy(healthCheckerType(), host, type);
+  }
+}
+
 void HealthCheckerImplBase::refreshHealthyStat() {
   // Each hot restarted process health checks independently. To make the stats easier to read,
   // we assume that both processes will converge and the last one that writes wins for the host.
@@ -140,6 +190,41 @@ void HealthCheckerImplBase::runCallbacks(HostSharedPtr host, HealthTransition ch
   }
 }
 
+void HealthCheckerImplBase::runOnMainThread(std::function<void()> callback) {
+  if (shards_.empty()) {
+    callback();
+    return;
+  }
+
+  // The session runs on a health check thread. By the time the callback runs on the main thread
+  // the checker may have been destroyed along with its cluster.
+  std::weak_ptr<HealthCheckerImplBase> weak_this = weak_this_;
+  dispatcher_.post([weak_this, callback]() -> void {
+    std::shared_ptr<HealthCheckerImplBase> shared_this = weak_this.lock();
+    if (shared_this != nullptr) {
+      callback();
+    }
+  });
+}
+
+void HealthCheckerImplBase::setThreadPool(HealthCheckThreadPool& thread_pool) {
+  ASSERT(shards_.empty());
+  thread_pool_ = &thread_pool;
+  weak_this_ = shared_from_this();
+  for (uint32_t i = 0; i < thread_pool.size(); i++) {
+    shards_.emplace_back(std::make_shared<Shard>(i, thread_pool.dispatcher(i)));
+  }
+}
+
+void HealthCheckerImplBase::stopSessions() {
+  for (const ShardSharedPtr& shard : shards_) {
+    thread_pool_->runOnThreadAndWait(shard->index_, [&shard]() -> void {
+      shard->stopped_ = true;
+      shard->sessions_.clear();
+    });
+  }
+}
+
 void HealthCheckerImplBase::HealthCheckHostMonitorImpl::setUnhealthy() {
   // This is called cross thread. The cluster/health checker might already be gone.
   std::shared_ptr<HealthCheckerImplBase> health_checker = health_checker_.lock();
@@ -163,6 +248,23 @@ void HealthCheckerImplBase::setUnhealthyCrossThread(const HostSharedPtr& host) {
       return;
     }
 
+    if (!shared_this->shards_.empty()) {
+      // 4) With a health check thread pool, the session has to be found on its own thread.
+      const auto shard_iter = shared_this->host_shards_.find(host);
+      if (shard_iter == shared_this->host_shards_.end()) {
+        return;
+      }
+      ShardSharedPtr shard = shard_iter->second;
+      shard->dispatcher_.post([shard, host]() -> void {
+        const auto session = shard->sessions_.find(host);
+        if (session == shard->sessions_.end()) {
+          return;
+        }
+        session->second->setUnhealthy(envoy::data::core::v2alpha::HealthCheckFailureType::PASSIVE);
+      });
+      return;
+    }
+
     const auto session = shared_this->active_sessions_.find(host);
     if (session == shared_this->active_sessions_.end()) {
       return;
@@ -178,24 +280,110 @@ void HealthCheckerImplBase::start() {
   }
 }
 
+/**
+ * Sessions on one thread that share their probes. The first session is the leader. It is the only
+ * one probing and hands each result to the others. Only touched on the thread of the sessions.
+ */
+struct HealthCheckerImplBase::ActiveHealthCheckSession::ProbeGroup {
+  std::list<ActiveHealthCheckSession*> sessions_;
+  // The last result of the leader, taken over by sessions joining later.
+  bool has_result_{};
+  bool success_{};
+  envoy::data::core::v2alpha::HealthCheckFailureType failure_type_{};
+};
+
+/**
+ * All probe groups of the process, by the dispatcher of their sessions and their key.
+ */
+struct HealthCheckerImplBase::ActiveHealthCheckSession::ProbeGroupRegistry {
+  Thread::MutexBasicLockable lock_;
+  std::map<std::pair<const Event::Dispatcher*, std::string>, ProbeGroupSharedPtr> groups_;
+};
+
+HealthCheckerImplBase::ActiveHealthCheckSession::ProbeGroupRegistry&
+HealthCheckerImplBase::ActiveHealthCheckSession::probeGroupRegistry() {
+  // Leaked on purpose, so that it does not depend on the order of destruction at exit.
+  static ProbeGroupRegistry* registry = new ProbeGroupRegistry();
+  return *registry;
+}
+
 HealthCheckerImplBase::ActiveHealthCheckSession::ActiveHealthCheckSession(
-    HealthCheckerImplBase& parent, HostSharedPtr host)
-    : host_(host), parent_(parent),
-      interval_timer_(parent.dispatcher_.createTimer([this]() -> void { onIntervalBase(); })),
-      timeout_timer_(parent.dispatcher_.createTimer([this]() -> void { onTimeoutBase(); })) {
+    HealthCheckerImplBase& parent, HostSharedPtr host, Event::Dispatcher& dispatcher)
+    : host_(host), dispatcher_(dispatcher), parent_(parent),
+      interval_timer_(dispatcher.createTimer([this]() -> void { onIntervalBase(); })),
+      timeout_timer_(dispatcher.createTimer([this]() -> void { onTimeoutBase(); })) {
 
   if (!host->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC)) {
-    parent.incHealthy();
+    parent.runOnMainThread([&parent]() -> void { parent.incHealthy(); });
   }
 }
 
 HealthCheckerImplBase::ActiveHealthCheckSession::~ActiveHealthCheckSession() {
+  if (probe_group_ != nullptr) {
+    leaveProbeGroup();
+  }
+
   if (!host_->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC)) {
-    parent_.decHealthy();
+    HealthCheckerImplBase& parent = parent_;
+    parent_.runOnMainThread([&parent]() -> void { parent.decHealthy(); });
   }
 }
 
-void HealthCheckerImplBase::ActiveHealthCheckSession::handleSuccess() {
+void HealthCheckerImplBase::ActiveHealthCheckSession::start() {
+  if (parent_.coalesce_probes_) {
+    const std::string key = parent_.coalescingKey(*host_);
+    if (!key.empty()) {
+      joinProbeGroup(key);
+      if (probe_group_->sessions_.front() != this) {
+        // Another session already probes for us. Take over its last result if there is one,
+        // otherwise its next result will be handed to us.
+        if (probe_group_->has_result_) {
+          onCoalescedResult(probe_group_->success_, probe_group_->failure_type_);
+        }
+        return;
+      }
+    }
+  }
+
+  onIntervalBase();
+}
+
+void HealthCheckerImplBase::ActiveHealthCheckSession::joinProbeGroup(const std::string& key) {
+  ProbeGroupRegistry& registry = probeGroupRegistry();
+  Thread::LockGuard lock(registry.lock_);
+  ProbeGroupSharedPtr& group = registry.groups_[std::make_pair(&dispatcher_, key)];
+  if (group == nullptr) {
+    group = std::make_shared<ProbeGroup>();
+  }
+  group->sessions_.push_back(this);
+  probe_key_ = key;
+  probe_group_ = group;
+}
+
+void HealthCheckerImplBase::ActiveHealthCheckSession::leaveProbeGroup() {
+  const bool leader = probe_group_->sessions_.front() == this;
+  probe_group_->sessions_.remove(this);
+  if (probe_group_->sessions_.empty()) {
+    ProbeGroupRegistry& registry = probeGroupRegistry();
+    Thread::LockGuard lock(registry.lock_);
+    registry.groups_.erase(std::make_pair(&dispatcher_, probe_key_));
+  } else if (leader) {
+    // The next session takes over probing from its own timer rather than from here, as its checker
+    // may be getting destroyed as well.
+    probe_group_->sessions_.front()->interval_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+  probe_group_.reset();
+}
+
+bool HealthCheckerImplBase::ActiveHealthCheckSession::reportToMainThread(
+    HealthTransition changed_state, bool first_check) const {
+  // Reporting from a health check thread costs a post to the main thread, so a result that changes
+  // nothing is only reported for the first check of the host, which cluster initialization waits
+  // for. This keeps the main thread's work proportional to health changes rather than to checks.
+  return parent_.shards_.empty() || changed_state != HealthTransition::Unchanged || first_check;
+}
+
+HealthTransition HealthCheckerImplBase::ActiveHealthCheckSession::recordSuccess() {
   // If we are healthy, reset the # of unhealthy to zero.
   num_unhealthy_ = 0;
 
@@ -206,22 +394,35 @@ void HealthCheckerImplBase::ActiveHealthCheckSession::handleSuccess() {
     // depending on the HC settings.
     if (first_check_ || ++num_healthy_ == parent_.healthy_threshold_) {
       host_->healthFlagClear(Host::HealthFlag::FAILED_ACTIVE_HC);
-      parent_.incHealthy();
       changed_state = HealthTransition::Changed;
-      if (parent_.event_logger_) {
-        parent_.event_logger_->logAddHealthy(parent_.healthCheckerType(), host_, first_check_);
-      }
     } else {
       changed_state = HealthTransition::ChangePending;
     }
   }
 
   parent_.stats_.success_.inc();
+  const bool first_check = first_check_;
   first_check_ = false;
-  parent_.runCallbacks(host_, changed_state);
+  if (!reportToMainThread(changed_state, first_check)) {
+    return changed_state;
+  }
 
+  HealthCheckerImplBase& parent = parent_;
+  HostSharedPtr host = host_;
+  parent_.runOnMainThread([&parent, host, changed_state, first_check]() -> void {
+    if (changed_state == HealthTransition::Changed) {
+      parent.onHostHealthy(host, first_check);
+    }
+    parent.runCallbacks(host, changed_state);
+  });
+  return changed_state;
+}
+
+void HealthCheckerImplBase::ActiveHealthCheckSession::handleSuccess() {
+  HealthTransition changed_state = recordSuccess();
+  publishResult(true, envoy::data::core::v2alpha::HealthCheckFailureType::ACTIVE);
   timeout_timer_->disableTimer();
-  interval_timer_->enableTimer(parent_.interval(HealthState::Healthy, changed_state));
+  interval_timer_->enableTimer(nextInterval(HealthState::Healthy, changed_state));
 }
 
 HealthTransition HealthCheckerImplBase::ActiveHealthCheckSession::setUnhealthy(
@@ -234,11 +435,7 @@ HealthTransition HealthCheckerImplBase::ActiveHealthCheckSession::setUnhealthy(
     if (type != envoy::data::core::v2alpha::HealthCheckFailureType::NETWORK ||
         ++num_unhealthy_ == parent_.unhealthy_threshold_) {
       host_->healthFlagSet(Host::HealthFlag::FAILED_ACTIVE_HC);
-      parent_.decHealthy();
       changed_state = HealthTransition::Changed;
-      if (parent_.event_logger_) {
-        parent_.event_logger_->logEjectUnhealthy(parent_.healthCheckerType(), host_, type);
-      }
     } else {
       changed_state = HealthTransition::ChangePending;
     }
@@ -251,16 +448,66 @@ HealthTransition HealthCheckerImplBase::ActiveHealthCheckSession::setUnhealthy(
     parent_.stats_.passive_failure_.inc();
   }
 
+  const bool first_check = first_check_;
   first_check_ = false;
-  parent_.runCallbacks(host_, changed_state);
+  if (!reportToMainThread(changed_state, first_check)) {
+    return changed_state;
+  }
+
+  HealthCheckerImplBase& parent = parent_;
+  HostSharedPtr host = host_;
+  parent_.runOnMainThread([&parent, host, changed_state, type]() -> void {
+    if (changed_state == HealthTransition::Changed) {
+      parent.onHostUnhealthy(host, type);
+    }
+    parent.runCallbacks(host, changed_state);
+  });
   return changed_state;
 }
 
 void HealthCheckerImplBase::ActiveHealthCheckSession::handleFailure(
     envoy::data::core::v2alpha::HealthCheckFailureType type) {
   HealthTransition changed_state = setUnhealthy(type);
+  publishResult(false, type);
   timeout_timer_->disableTimer();
-  interval_timer_->enableTimer(parent_.interval(HealthState::Unhealthy, changed_state));
+  interval_timer_->enableTimer(nextInterval(HealthState::Unhealthy, changed_state));
+}
+
+std::chrono::milliseconds
+HealthCheckerImplBase::ActiveHealthCheckSession::nextInterval(HealthState state,
+                                                              HealthTransition changed_state) {
+  std::chrono::milliseconds next = parent_.interval(state, changed_state);
+  if (probe_group_ != nullptr) {
+    // Probe as often as the most demanding session of the group would on its own.
+    for (const ActiveHealthCheckSession* session : probe_group_->sessions_) {
+      if (session != this) {
+        next = std::min(next, session->parent_.interval(state, session->last_transition_));
+      }
+    }
+  }
+  return next;
+}
+
+void HealthCheckerImplBase::ActiveHealthCheckSession::publishResult(
+    bool success, envoy::data::core::v2alpha::HealthCheckFailureType type) {
+  if (probe_group_ == nullptr) {
+    return;
+  }
+
+  probe_group_->has_result_ = true;
+  probe_group_->success_ = success;
+  probe_group_->failure_type_ = type;
+  for (ActiveHealthCheckSession* session : probe_group_->sessions_) {
+    if (session != this) {
+      session->onCoalescedResult(success, type);
+    }
+  }
+}
+
+void HealthCheckerImplBase::ActiveHealthCheckSession::onCoalescedResult(
+    bool success, envoy::data::core::v2alpha::HealthCheckFailureType type) {
+  parent_.stats_.coalesced_.inc();
+  last_transition_ = success ? recordSuccess() : setUnhealthy(type);
 }
 
 void HealthCheckerImplBase::ActiveHealthCheckSession::onIntervalBase() {
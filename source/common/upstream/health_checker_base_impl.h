@@ -6,7 +6,9 @@
 #include "envoy/runtime/runtime.h"
 #include "envoy/upstream/health_checker.h"
 
+#include "common/common/empty_string.h"
 #include "common/common/logger.h"
+#include "common/upstream/health_check_thread_pool.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -22,6 +24,7 @@ namespace Upstream {
   COUNTER(passive_failure)                                                                         \
   COUNTER(network_failure)                                                                         \
   COUNTER(verify_cluster)                                                                          \
+  COUNTER(coalesced)                                                                               \
   GAUGE  (healthy)
 // clang-format on
 
@@ -43,26 +46,60 @@ public:
   void addHostCheckCompleteCb(HostStatusCb callback) override { callbacks_.push_back(callback); }
   void start() override;
 
+  /**
+   * Run the checker's sessions on the threads of a health check thread pool instead of the main
+   * thread. Hosts are spread across the threads as they are added. Health flags are updated from
+   * the session's thread, while the healthy gauge, host check callbacks and event logging are
+   * posted back to the main thread. Must be called before start(), and on a checker owned by a
+   * shared_ptr.
+   * @param thread_pool supplies the pool, which must outlive the checker.
+   */
+  void setThreadPool(HealthCheckThreadPool& thread_pool);
+
+  /**
+   * Destroy all sessions running on health check threads, blocking until each thread has done
+   * so. Sessions use the checker, including state owned by derived classes, so this must be
+   * called before the checker starts being destroyed. No-op if setThreadPool() was not called.
+   */
+  void stopSessions();
+
 protected:
   class ActiveHealthCheckSession {
   public:
     virtual ~ActiveHealthCheckSession();
     HealthTransition setUnhealthy(envoy::data::core::v2alpha::HealthCheckFailureType type);
-    void start() { onIntervalBase(); }
+    void start();
 
   protected:
-    ActiveHealthCheckSession(HealthCheckerImplBase& parent, HostSharedPtr host);
+    ActiveHealthCheckSession(HealthCheckerImplBase& parent, HostSharedPtr host,
+                             Event::Dispatcher& dispatcher);
 
     void handleSuccess();
     void handleFailure(envoy::data::core::v2alpha::HealthCheckFailureType type);
 
     HostSharedPtr host_;
+    // The dispatcher of the thread the session runs on. Timers and connections must use it.
+    Event::Dispatcher& dispatcher_;
 
   private:
+    struct ProbeGroup;
+    struct ProbeGroupRegistry;
+    typedef std::shared_ptr<ProbeGroup> ProbeGroupSharedPtr;
+
     virtual void onInterval() PURE;
     void onIntervalBase();
     virtual void onTimeout() PURE;
     void onTimeoutBase();
+    std::chrono::milliseconds nextInterval(HealthState state, HealthTransition changed_state);
+    void onCoalescedResult(bool success, envoy::data::core::v2alpha::HealthCheckFailureType type);
+    void publishResult(bool success, envoy::data::core::v2alpha::HealthCheckFailureType type);
+    HealthTransition recordSuccess();
+    bool reportToMainThread(HealthTransition changed_state, bool first_check) const;
+
+    void joinProbeGroup(const std::string& key);
+    void leaveProbeGroup();
+
+    static ProbeGroupRegistry& probeGroupRegistry();
 
     HealthCheckerImplBase& parent_;
     Event::TimerPtr interval_timer_;
@@ -70,6 +107,11 @@ protected:
     uint32_t num_unhealthy_{};
     uint32_t num_healthy_{};
     bool first_check_{true};
+    // Set when the session shares its probes with sessions of other checkers. @see coalescingKey()
+    std::string probe_key_;
+    ProbeGroupSharedPtr probe_group_;
+    // The transition of the last result handed to the session by the leader of its probe group.
+    HealthTransition last_transition_{HealthTransition::Unchanged};
   };
 
   typedef std::unique_ptr<ActiveHealthCheckSession> ActiveHealthCheckSessionPtr;
@@ -78,9 +120,21 @@ protected:
                         Event::Dispatcher& dispatcher, Runtime::Loader& runtime,
                         Runtime::RandomGenerator& random, HealthCheckEventLoggerPtr&& event_logger);
 
-  virtual ActiveHealthCheckSessionPtr makeSession(HostSharedPtr host) PURE;
+  virtual ActiveHealthCheckSessionPtr makeSession(HostSharedPtr host,
+                                                  Event::Dispatcher& dispatcher) PURE;
   virtual envoy::data::core::v2alpha::HealthCheckerType healthCheckerType() const PURE;
 
+  /**
+   * Sessions of any checkers that return the same non-empty key for their hosts, and run on the
+   * same thread, share one probe if runtime key health_check.coalesce_probes was enabled when the
+   * checkers were created. The key must therefore cover everything that can change the outcome of
+   * a probe: the address, what is sent and how the response is judged. Thresholds and intervals
+   * are not part of it, each session still applies its own thresholds to the shared results.
+   * @param host supplies the host a session is about to be started for.
+   * @return std::string the key, or empty if the host's probes must not be shared.
+   */
+  virtual std::string coalescingKey(const Host&) const { return EMPTY_STRING; }
+
   const Cluster& cluster_;
   Event::Dispatcher& dispatcher_;
   const std::chrono::milliseconds timeout_;
@@ -105,14 +159,34 @@ private:
     std::weak_ptr<Host> host_;
   };
 
+  /**
+   * The sessions running on one health check thread. Everything but the thread index is only
+   * touched on that thread. Work posted to the thread holds a reference to the shard and checks
+   * stopped_ before touching the checker, which may be gone by then.
+   */
+  struct Shard {
+    Shard(uint32_t index, Event::Dispatcher& dispatcher) : index_(index), dispatcher_(dispatcher) {}
+
+    const uint32_t index_;
+    Event::Dispatcher& dispatcher_;
+    std::unordered_map<HostSharedPtr, ActiveHealthCheckSessionPtr> sessions_;
+    bool stopped_{};
+  };
+
+  typedef std::shared_ptr<Shard> ShardSharedPtr;
+
   void addHosts(const HostVector& hosts);
   void decHealthy();
   HealthCheckerStats generateStats(Stats::Scope& scope);
   void incHealthy();
   std::chrono::milliseconds interval(HealthState state, HealthTransition changed_state) const;
   void onClusterMemberUpdate(const HostVector& hosts_added, const HostVector& hosts_removed);
+  void onHostHealthy(const HostSharedPtr& host, bool first_check);
+  void onHostUnhealthy(const HostSharedPtr& host,
+                       envoy::data::core::v2alpha::HealthCheckFailureType type);
   void refreshHealthyStat();
   void runCallbacks(HostSharedPtr host, HealthTransition changed_state);
+  void runOnMainThread(std::function<void()> callback);
   void setUnhealthyCrossThread(const HostSharedPtr& host);
 
   static const std::chrono::milliseconds NO_TRAFFIC_INTERVAL;
@@ -125,8 +199,17 @@ private:
   const std::chrono::milliseconds unhealthy_interval_;
   const std::chrono::milliseconds unhealthy_edge_interval_;
   const std::chrono::milliseconds healthy_edge_interval_;
+  // Whether sessions share probes, @see coalescingKey(). Only read when the checker is created.
+  const bool coalesce_probes_;
   std::unordered_map<HostSharedPtr, ActiveHealthCheckSessionPtr> active_sessions_;
   uint64_t local_process_healthy_{};
+  HealthCheckThreadPool* thread_pool_{};
+  std::vector<ShardSharedPtr> shards_;
+  // Which shard runs the session of each host, when sessions run on a health check thread pool.
+  std::unordered_map<HostSharedPtr, ShardSharedPtr> host_shards_;
+  // Set by setThreadPool(), so that sessions on health check threads can post to the main thread
+  // without racing with the last strong reference going away.
+  std::weak_ptr<HealthCheckerImplBase> weak_this_;
 };
 
 class HealthCheckEventLoggerImpl : public HealthCheckEventLogger {
@@ -45,7 +45,34 @@ HealthCheckerSharedPtr
 HealthCheckerFactory::create(const envoy::api::v2::core::HealthCheck& hc_config,
                              Upstream::Cluster& cluster, Runtime::Loader& runtime,
                              Runtime::RandomGenerator& random, Event::Dispatcher& dispatcher,
-                             AccessLog::AccessLogManager& log_manager) {
+                             AccessLog::AccessLogManager& log_manager,
+                             HealthCheckThreadPool* thread_pool) {
+  HealthCheckerSharedPtr checker =
+      createChecker(hc_config, cluster, runtime, random, dispatcher, log_manager);
+  if (thread_pool == nullptr) {
+    return checker;
+  }
+  std::shared_ptr<HealthCheckerImplBase> checker_base =
+      std::dynamic_pointer_cast<HealthCheckerImplBase>(checker);
+  if (checker_base == nullptr) {
+    // Custom checkers that are not built on HealthCheckerImplBase stay on the main thread.
+    return checker;
+  }
+
+  // Sessions on the health check threads use the checker until they are destroyed, so they are
+  // stopped before the last owner lets go of the checker and its destructors start running.
+  checker_base->setThreadPool(*thread_pool);
+  return HealthCheckerSharedPtr(checker.get(), [checker_base](HealthChecker*) mutable {
+    checker_base->stopSessions();
+    checker_base.reset();
+  });
+}
+
+HealthCheckerSharedPtr
+HealthCheckerFactory::createChecker(const envoy::api::v2::core::HealthCheck& hc_config,
+                                    Upstream::Cluster& cluster, Runtime::Loader& runtime,
+                                    Runtime::RandomGenerator& random, Event::Dispatcher& dispatcher,
+                                    AccessLog::AccessLogManager& log_manager) {
   HealthCheckEventLoggerPtr event_logger;
   if (!hc_config.event_log_path().empty()) {
     event_logger =
@@ -96,15 +123,31 @@ HttpHealthCheckerImpl::HttpHealthCheckerImpl(const Cluster& cluster,
       path_(config.http_health_check().path()), host_value_(config.http_health_check().host()),
       request_headers_parser_(
           Router::HeaderParser::configure(config.http_health_check().request_headers_to_add())),
+      http_health_check_hash_(MessageUtil::hash(config.http_health_check())),
       codec_client_type_(codecClientType(config.http_health_check().use_http2())) {
   if (!config.http_health_check().service_name().empty()) {
     service_name_ = config.http_health_check().service_name();
   }
 }
 
+std::string HttpHealthCheckerImpl::coalescingKey(const Host& host) const {
+  // A secure transport depends on per cluster state such as certificates and SNI, which cannot be
+  // compared here. Only plaintext probes are shared.
+  ClusterInfoConstSharedPtr cluster_info = cluster_.info();
+  if (cluster_info->transportSocketFactory().implementsSecureTransport()) {
+    return EMPTY_STRING;
+  }
+
+  const Network::Address::InstanceConstSharedPtr& source_address = cluster_info->sourceAddress();
+  return fmt::format("http|{}|{}|{}|{}|{}", host.healthCheckAddress()->asString(),
+                     source_address != nullptr ? source_address->asString() : EMPTY_STRING,
+                     host_value_.empty() ? cluster_info->name() : host_value_, timeout_.count(),
+                     http_health_check_hash_);
+}
+
 HttpHealthCheckerImpl::HttpActiveHealthCheckSession::HttpActiveHealthCheckSession(
-    HttpHealthCheckerImpl& parent, const HostSharedPtr& host)
-    : ActiveHealthCheckSession(parent, host), parent_(parent) {}
+    HttpHealthCheckerImpl& parent, const HostSharedPtr& host, Event::Dispatcher& dispatcher)
+    : ActiveHealthCheckSession(parent, host, dispatcher), parent_(parent) {}
 
 HttpHealthCheckerImpl::HttpActiveHealthCheckSession::~HttpActiveHealthCheckSession() {
   if (client_) {
@@ -129,7 +172,7 @@ void HttpHealthCheckerImpl::HttpActiveHealthCheckSession::onEvent(Network::Conne
     // For the raw disconnect event, we are either between intervals in which case we already have
     // a timer setup, or we did the close or got a reset, in which case we already setup a new
     // timer. There is nothing to do here other than blow away the client.
-    parent_.dispatcher_.deferredDelete(std::move(client_));
+    dispatcher_.deferredDelete(std::move(client_));
   }
 }
 
@@ -139,7 +182,7 @@ const RequestInfo::RequestInfoImpl
 void HttpHealthCheckerImpl::HttpActiveHealthCheckSession::onInterval() {
   if (!client_) {
     Upstream::Host::CreateConnectionData conn =
-        host_->createHealthCheckConnection(parent_.dispatcher_);
+        host_->createHealthCheckConnection(dispatcher_);
     client_.reset(parent_.createCodecClient(conn));
     client_->addConnectionCallbacks(connection_callback_impl_);
     expect_reset_ = false;
@@ -231,8 +274,10 @@ Http::CodecClient::Type HttpHealthCheckerImpl::codecClientType(bool use_http2) {
 
 Http::CodecClient*
 ProdHttpHealthCheckerImpl::createCodecClient(Upstream::Host::CreateConnectionData& data) {
+  // The connection was created on the dispatcher of the session's thread.
+  Event::Dispatcher& dispatcher = data.connection_->dispatcher();
   return new Http::CodecClientProd(codec_client_type_, std::move(data.connection_),
-                                   data.host_description_, dispatcher_);
+                                   data.host_description_, dispatcher);
 }
 
 TcpHealthCheckMatcher::MatchSegments TcpHealthCheckMatcher::loadProtoBytes(
@@ -304,7 +349,7 @@ void TcpHealthCheckerImpl::TcpActiveHealthCheckSession::onEvent(Network::Connect
 
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
-    parent_.dispatcher_.deferredDelete(std::move(client_));
+    dispatcher_.deferredDelete(std::move(client_));
   }
 
   if (event == Network::ConnectionEvent::Connected && parent_.receive_bytes_.empty()) {
@@ -329,7 +374,7 @@ void TcpHealthCheckerImpl::TcpActiveHealthCheckSession::onEvent(Network::Connect
 
 void TcpHealthCheckerImpl::TcpActiveHealthCheckSession::onInterval() {
   if (!client_) {
-    client_ = host_->createHealthCheckConnection(parent_.dispatcher_).connection_;
+    client_ = host_->createHealthCheckConnection(dispatcher_).connection_;
     session_callbacks_.reset(new TcpSessionCallbacks(*this));
     client_->addConnectionCallbacks(*session_callbacks_);
     client_->addReadFilter(session_callbacks_);
@@ -367,8 +412,8 @@ GrpcHealthCheckerImpl::GrpcHealthCheckerImpl(const Cluster& cluster,
 }
 
 GrpcHealthCheckerImpl::GrpcActiveHealthCheckSession::GrpcActiveHealthCheckSession(
-    GrpcHealthCheckerImpl& parent, const HostSharedPtr& host)
-    : ActiveHealthCheckSession(parent, host), parent_(parent) {}
+    GrpcHealthCheckerImpl& parent, const HostSharedPtr& host, Event::Dispatcher& dispatcher)
+    : ActiveHealthCheckSession(parent, host, dispatcher), parent_(parent) {}
 
 GrpcHealthCheckerImpl::GrpcActiveHealthCheckSession::~GrpcActiveHealthCheckSession() {
   if (client_) {
@@ -461,14 +506,14 @@ void GrpcHealthCheckerImpl::GrpcActiveHealthCheckSession::onEvent(Network::Conne
     // For the raw disconnect event, we are either between intervals in which case we already have
     // a timer setup, or we did the close or got a reset, in which case we already setup a new
     // timer. There is nothing to do here other than blow away the client.
-    parent_.dispatcher_.deferredDelete(std::move(client_));
+    dispatcher_.deferredDelete(std::move(client_));
   }
 }
 
 void GrpcHealthCheckerImpl::GrpcActiveHealthCheckSession::onInterval() {
   if (!client_) {
     Upstream::Host::CreateConnectionData conn =
-        host_->createHealthCheckConnection(parent_.dispatcher_);
+        host_->createHealthCheckConnection(dispatcher_);
     client_ = parent_.createCodecClient(conn);
     client_->addConnectionCallbacks(connection_callback_impl_);
     client_->setCodecConnectionCallbacks(http_connection_callback_impl_);
@@ -614,9 +659,11 @@ void GrpcHealthCheckerImpl::GrpcActiveHealthCheckSession::logHealthCheckStatus(
 
 Http::CodecClientPtr
 ProdGrpcHealthCheckerImpl::createCodecClient(Upstream::Host::CreateConnectionData& data) {
+  // The connection was created on the dispatcher of the session's thread.
+  Event::Dispatcher& dispatcher = data.connection_->dispatcher();
   return std::make_unique<Http::CodecClientProd>(Http::CodecClient::Type::HTTP2,
                                                  std::move(data.connection_),
-                                                 data.host_description_, dispatcher_);
+                                                 data.host_description_, dispatcher);
 }
 
 std::ostream& operator<<(std::ostream& out, HealthState state) {
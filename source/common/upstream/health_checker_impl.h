@@ -29,13 +29,23 @@ public:
    * @param random supplies the random generator.
    * @param dispatcher supplies the dispatcher.
    * @param event_logger supplies the event_logger.
+   * @param thread_pool supplies the health check threads to run sessions on, or nullptr to run
+   *        them on the main thread.
    * @return a health checker.
    */
   static HealthCheckerSharedPtr create(const envoy::api::v2::core::HealthCheck& hc_config,
                                        Upstream::Cluster& cluster, Runtime::Loader& runtime,
                                        Runtime::RandomGenerator& random,
                                        Event::Dispatcher& dispatcher,
-                                       AccessLog::AccessLogManager& log_manager);
+                                       AccessLog::AccessLogManager& log_manager,
+                                       HealthCheckThreadPool* thread_pool);
+
+private:
+  static HealthCheckerSharedPtr createChecker(const envoy::api::v2::core::HealthCheck& hc_config,
+                                              Upstream::Cluster& cluster, Runtime::Loader& runtime,
+                                              Runtime::RandomGenerator& random,
+                                              Event::Dispatcher& dispatcher,
+                                              AccessLog::AccessLogManager& log_manager);
 };
 
 /**
@@ -51,7 +61,8 @@ private:
   struct HttpActiveHealthCheckSession : public ActiveHealthCheckSession,
                                         public Http::StreamDecoder,
                                         public Http::StreamCallbacks {
-    HttpActiveHealthCheckSession(HttpHealthCheckerImpl& parent, const HostSharedPtr& host);
+    HttpActiveHealthCheckSession(HttpHealthCheckerImpl& parent, const HostSharedPtr& host,
+                                 Event::Dispatcher& dispatcher);
     ~HttpActiveHealthCheckSession();
 
     void onResponseComplete();
@@ -105,12 +116,14 @@ private:
   virtual Http::CodecClient* createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
 
   // HealthCheckerImplBase
-  ActiveHealthCheckSessionPtr makeSession(HostSharedPtr host) override {
-    return std::make_unique<HttpActiveHealthCheckSession>(*this, host);
+  ActiveHealthCheckSessionPtr makeSession(HostSharedPtr host,
+                                          Event::Dispatcher& dispatcher) override {
+    return std::make_unique<HttpActiveHealthCheckSession>(*this, host, dispatcher);
   }
   envoy::data::core::v2alpha::HealthCheckerType healthCheckerType() const override {
     return envoy::data::core::v2alpha::HealthCheckerType::HTTP;
   }
+  std::string coalescingKey(const Host& host) const override;
 
   Http::CodecClient::Type codecClientType(bool use_http2);
 
@@ -118,6 +131,8 @@ private:
   const std::string host_value_;
   absl::optional<std::string> service_name_;
   Router::HeaderParserPtr request_headers_parser_;
+  // Covers the request and how the response is judged. @see coalescingKey()
+  const std::size_t http_health_check_hash_;
 
 protected:
   const Http::CodecClient::Type codec_client_type_;
@@ -217,8 +232,9 @@ private:
   };
 
   struct TcpActiveHealthCheckSession : public ActiveHealthCheckSession {
-    TcpActiveHealthCheckSession(TcpHealthCheckerImpl& parent, const HostSharedPtr& host)
-        : ActiveHealthCheckSession(parent, host), parent_(parent) {}
+    TcpActiveHealthCheckSession(TcpHealthCheckerImpl& parent, const HostSharedPtr& host,
+                                Event::Dispatcher& dispatcher)
+        : ActiveHealthCheckSession(parent, host, dispatcher), parent_(parent) {}
     ~TcpActiveHealthCheckSession();
 
     void onData(Buffer::Instance& data);
@@ -236,8 +252,9 @@ private:
   typedef std::unique_ptr<TcpActiveHealthCheckSession> TcpActiveHealthCheckSessionPtr;
 
   // HealthCheckerImplBase
-  ActiveHealthCheckSessionPtr makeSession(HostSharedPtr host) override {
-    return std::make_unique<TcpActiveHealthCheckSession>(*this, host);
+  ActiveHealthCheckSessionPtr makeSession(HostSharedPtr host,
+                                          Event::Dispatcher& dispatcher) override {
+    return std::make_unique<TcpActiveHealthCheckSession>(*this, host, dispatcher);
   }
   envoy::data::core::v2alpha::HealthCheckerType healthCheckerType() const override {
     return envoy::data::core::v2alpha::HealthCheckerType::TCP;
@@ -260,7 +277,8 @@ private:
   struct GrpcActiveHealthCheckSession : public ActiveHealthCheckSession,
                                         public Http::StreamDecoder,
                                         public Http::StreamCallbacks {
-    GrpcActiveHealthCheckSession(GrpcHealthCheckerImpl& parent, const HostSharedPtr& host);
+    GrpcActiveHealthCheckSession(GrpcHealthCheckerImpl& parent, const HostSharedPtr& host,
+                                 Event::Dispatcher& dispatcher);
     ~GrpcActiveHealthCheckSession();
 
     void onRpcComplete(Grpc::Status::GrpcStatus grpc_status, const std::string& grpc_message,
@@ -326,8 +344,9 @@ private:
   virtual Http::CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
 
   // HealthCheckerImplBase
-  ActiveHealthCheckSessionPtr makeSession(HostSharedPtr host) override {
-    return std::make_unique<GrpcActiveHealthCheckSession>(*this, host);
+  ActiveHealthCheckSessionPtr makeSession(HostSharedPtr host,
+                                          Event::Dispatcher& dispatcher) override {
+    return std::make_unique<GrpcActiveHealthCheckSession>(*this, host, dispatcher);
   }
   envoy::data::core::v2alpha::HealthCheckerType healthCheckerType() const override {
     return envoy::data::core::v2alpha::HealthCheckerType::GRPC;
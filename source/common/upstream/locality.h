@@ -17,7 +17,7 @@ struct LocalityHash {
 struct LocalityEqualTo {
   bool operator()(const envoy::api::v2::core::Locality& lhs,
                   const envoy::api::v2::core::Locality& rhs) const {
-    return Protobuf::util::MessageDifferencer::Equivalent(lhs, rhs);
+    return MessageUtil::equal(lhs, rhs);
   }
 };
 
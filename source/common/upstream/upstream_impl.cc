@@ -1,7 +1,10 @@
 #include "common/upstream/upstream_impl.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <limits>
 #include <list>
 #include <memory>
 #include <string>
@@ -352,6 +355,34 @@ ClusterInfoImpl::ClusterInfoImpl(const envoy::api::v2::Cluster& config,
     idle_timeout_ = std::chrono::milliseconds(
         DurationUtil::durationToMilliseconds(config.common_http_protocol_options().idle_timeout()));
   }
+
+  // Connection pool prefetching is configured through the envoy.conn_pool metadata namespace.
+  const ProtobufWkt::Value& prefetch_ratio =
+      Config::Metadata::metadataValue(metadata_, Config::MetadataFilters::get().ENVOY_CONN_POOL,
+                                      Config::MetadataEnvoyConnPoolKeys::get().PREFETCH_RATIO);
+  if (prefetch_ratio.kind_case() == ProtobufWkt::Value::kNumberValue) {
+    if (prefetch_ratio.number_value() < 1.0) {
+      throw EnvoyException(fmt::format("cluster: prefetch_ratio must be >= 1.0, got {}",
+                                       prefetch_ratio.number_value()));
+    }
+    prefetch_ratio_ = prefetch_ratio.number_value();
+  }
+  const ProtobufWkt::Value& warm_connections =
+      Config::Metadata::metadataValue(metadata_, Config::MetadataFilters::get().ENVOY_CONN_POOL,
+                                      Config::MetadataEnvoyConnPoolKeys::get().WARM_CONNECTIONS);
+  if (warm_connections.kind_case() == ProtobufWkt::Value::kNumberValue) {
+    const double value = warm_connections.number_value();
+    if (value < 0 || std::floor(value) != value) {
+      throw EnvoyException(
+          fmt::format("cluster: warm_connections must be an integer >= 0, got {}", value));
+    }
+    // Warm connections count against the circuit breaker like any other, so more than it allows
+    // could never be opened.
+    const uint64_t max_connections = std::min<uint64_t>(
+        resource_managers_.managers_[enumToInt(ResourcePriority::Default)]->connections().max(),
+        std::numeric_limits<uint32_t>::max());
+    warm_connections_ = static_cast<uint32_t>(std::min(value, static_cast<double>(max_connections)));
+  }
 }
 
 ClusterSharedPtr ClusterImplBase::create(
@@ -359,8 +390,9 @@ ClusterSharedPtr ClusterImplBase::create(
     ThreadLocal::Instance& tls, Network::DnsResolverSharedPtr dns_resolver,
     Ssl::ContextManager& ssl_context_manager, Runtime::Loader& runtime,
     Runtime::RandomGenerator& random, Event::Dispatcher& dispatcher,
-    AccessLog::AccessLogManager& log_manager, const LocalInfo::LocalInfo& local_info,
-    Outlier::EventLoggerSharedPtr outlier_event_logger, bool added_via_api) {
+    AccessLog::AccessLogManager& log_manager, HealthCheckThreadPool* health_check_thread_pool,
+    const LocalInfo::LocalInfo& local_info, Outlier::EventLoggerSharedPtr outlier_event_logger,
+    bool added_via_api) {
   std::unique_ptr<ClusterImplBase> new_cluster;
 
   // We make this a shared pointer to deal with the distinct ownership
@@ -423,8 +455,9 @@ ClusterSharedPtr ClusterImplBase::create(
   if (!cluster.health_checks().empty()) {
     // TODO(htuch): Need to support multiple health checks in v2.
     ASSERT(cluster.health_checks().size() == 1);
-    new_cluster->setHealthChecker(HealthCheckerFactory::create(
-        cluster.health_checks()[0], *new_cluster, runtime, random, dispatcher, log_manager));
+    new_cluster->setHealthChecker(
+        HealthCheckerFactory::create(cluster.health_checks()[0], *new_cluster, runtime, random,
+                                     dispatcher, log_manager, health_check_thread_pool));
   }
 
   new_cluster->setOutlierDetector(Outlier::DetectorImplFactory::createForCluster(
@@ -610,6 +643,9 @@ ClusterInfoImpl::ResourceManagers::load(const envoy::api::v2::Cluster& config,
   uint64_t max_pending_requests = 1024;
   uint64_t max_requests = 1024;
   uint64_t max_retries = 3;
+  // There is no threshold for shadow requests in the circuit breaker configuration yet, so the
+  // limit is only adjustable through the runtime key.
+  uint64_t max_shadow_requests = 1024;
 
   std::string priority_name;
   switch (priority) {
@@ -639,8 +675,9 @@ ClusterInfoImpl::ResourceManagers::load(const envoy::api::v2::Cluster& config,
     max_requests = PROTOBUF_GET_WRAPPED_OR_DEFAULT(*it, max_requests, max_requests);
     max_retries = PROTOBUF_GET_WRAPPED_OR_DEFAULT(*it, max_retries, max_retries);
   }
-  return ResourceManagerImplPtr{new ResourceManagerImpl(
-      runtime, runtime_prefix, max_connections, max_pending_requests, max_requests, max_retries)};
+  return ResourceManagerImplPtr{new ResourceManagerImpl(runtime, runtime_prefix, max_connections,
+                                                        max_pending_requests, max_requests,
+                                                        max_retries, max_shadow_requests)};
 }
 
 PriorityStateManager::PriorityStateManager(ClusterImplBase& cluster,
@@ -849,8 +886,7 @@ bool BaseDynamicClusterImpl::updateDynamicHostList(const HostVector& new_hosts,
         }
 
         // Did metadata change?
-        const bool metadata_changed =
-            !Protobuf::util::MessageDifferencer::Equivalent(*host->metadata(), *(*i)->metadata());
+        const bool metadata_changed = !MessageUtil::equal(*host->metadata(), *(*i)->metadata());
         if (metadata_changed) {
           // First, update the entire metadata for the endpoint.
           (*i)->metadata(*host->metadata());
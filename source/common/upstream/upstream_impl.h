@@ -34,6 +34,7 @@
 #include "common/config/well_known_names.h"
 #include "common/network/utility.h"
 #include "common/stats/stats_impl.h"
+#include "common/upstream/health_check_thread_pool.h"
 #include "common/upstream/load_balancer_impl.h"
 #include "common/upstream/locality.h"
 #include "common/upstream/outlier_detection_impl.h"
@@ -348,6 +349,8 @@ public:
   const absl::optional<std::chrono::milliseconds> idleTimeout() const override {
     return idle_timeout_;
   }
+  float prefetchRatio() const override { return prefetch_ratio_; }
+  uint32_t warmConnections() const override { return warm_connections_; }
   uint32_t perConnectionBufferLimitBytes() const override {
     return per_connection_buffer_limit_bytes_;
   }
@@ -405,6 +408,8 @@ private:
   const uint64_t max_requests_per_connection_;
   const std::chrono::milliseconds connect_timeout_;
   absl::optional<std::chrono::milliseconds> idle_timeout_;
+  float prefetch_ratio_{1.0};
+  uint32_t warm_connections_{};
   const uint32_t per_connection_buffer_limit_bytes_;
   Stats::ScopePtr stats_scope_;
   mutable ClusterStats stats_;
@@ -439,7 +444,8 @@ public:
          ThreadLocal::Instance& tls, Network::DnsResolverSharedPtr dns_resolver,
          Ssl::ContextManager& ssl_context_manager, Runtime::Loader& runtime,
          Runtime::RandomGenerator& random, Event::Dispatcher& dispatcher,
-         AccessLog::AccessLogManager& log_manager, const LocalInfo::LocalInfo& local_info,
+         AccessLog::AccessLogManager& log_manager, HealthCheckThreadPool* health_check_thread_pool,
+         const LocalInfo::LocalInfo& local_info,
          Outlier::EventLoggerSharedPtr outlier_event_logger, bool added_via_api);
   // From Upstream::Cluster
   virtual PrioritySet& prioritySet() override { return priority_set_; }
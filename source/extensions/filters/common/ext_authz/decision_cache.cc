@@ -0,0 +1,263 @@
+#include "extensions/filters/common/ext_authz/decision_cache.h"
+
+#include "envoy/common/exception.h"
+
+#include "common/common/fmt.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace ExtAuthz {
+
+namespace {
+
+const std::string HeadersAttributePrefix = "request.http.headers.";
+
+} // namespace
+
+CacheConfig::CacheConfig(uint64_t max_entries, std::chrono::milliseconds ttl,
+                         const std::string& key_attributes, const std::string& stats_prefix,
+                         Stats::Scope& scope)
+    : max_entries_(max_entries), ttl_(ttl),
+      stats_{ALL_EXT_AUTHZ_CACHE_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix + "ext_authz."))} {
+  ASSERT(max_entries_ > 0);
+  for (const absl::string_view attribute : StringUtil::splitToken(key_attributes, ",")) {
+    key_attributes_.push_back(attributeGetter(std::string(StringUtil::trim(attribute))));
+  }
+}
+
+CacheConfigConstSharedPtr CacheConfig::fromRuntime(Runtime::Loader& runtime,
+                                                   const std::string& stats_prefix,
+                                                   Stats::Scope& scope) {
+  const Runtime::Snapshot& snapshot = runtime.snapshot();
+  const uint64_t max_entries = snapshot.getInteger("ext_authz.cache.max_entries", 0);
+  if (max_entries == 0) {
+    return nullptr;
+  }
+
+  const std::string& key_attributes = snapshot.get("ext_authz.cache.key_attributes");
+  return std::make_shared<const CacheConfig>(
+      max_entries,
+      std::chrono::milliseconds(snapshot.getInteger("ext_authz.cache.ttl_ms", DefaultCacheTtlMs)),
+      key_attributes.empty() ? DefaultCacheKeyAttributes : key_attributes, stats_prefix, scope);
+}
+
+CacheConfig::AttributeGetter CacheConfig::attributeGetter(const std::string& attribute) {
+  typedef envoy::service::auth::v2alpha::AttributeContext AttributeContext;
+
+  if (attribute == "source.address") {
+    return [](const AttributeContext& context) {
+      return context.source().address().socket_address().address();
+    };
+  }
+  if (attribute == "source.service") {
+    return [](const AttributeContext& context) { return context.source().service(); };
+  }
+  if (attribute == "source.principal") {
+    return [](const AttributeContext& context) { return context.source().principal(); };
+  }
+  if (attribute == "destination.address") {
+    return [](const AttributeContext& context) {
+      return context.destination().address().socket_address().address();
+    };
+  }
+  if (attribute == "destination.port") {
+    return [](const AttributeContext& context) {
+      return std::to_string(context.destination().address().socket_address().port_value());
+    };
+  }
+  if (attribute == "destination.principal") {
+    return [](const AttributeContext& context) { return context.destination().principal(); };
+  }
+  if (attribute == "request.http.method") {
+    return [](const AttributeContext& context) { return context.request().http().method(); };
+  }
+  if (attribute == "request.http.path") {
+    return [](const AttributeContext& context) { return context.request().http().path(); };
+  }
+  if (attribute == "request.http.host") {
+    return [](const AttributeContext& context) { return context.request().http().host(); };
+  }
+  if (attribute == "request.http.scheme") {
+    return [](const AttributeContext& context) { return context.request().http().scheme(); };
+  }
+  if (StringUtil::startsWith(attribute.c_str(), HeadersAttributePrefix) &&
+      attribute.size() > HeadersAttributePrefix.size()) {
+    const std::string header = attribute.substr(HeadersAttributePrefix.size());
+    return [header](const AttributeContext& context) -> std::string {
+      const auto& headers = context.request().http().headers();
+      const auto it = headers.find(header);
+      // A missing header is keyed apart from an empty one.
+      return it == headers.end() ? std::string(1, '\0') : it->second;
+    };
+  }
+  throw EnvoyException(fmt::format("ext_authz: unknown cache key attribute '{}'", attribute));
+}
+
+std::string CacheConfig::key(const envoy::service::auth::v2alpha::CheckRequest& request) const {
+  std::string key;
+  for (const AttributeGetter& attribute : key_attributes_) {
+    // The length prefix keeps the boundaries of the values unambiguous.
+    const std::string value = attribute(request.attributes());
+    absl::StrAppend(&key, value.size(), ":", value);
+  }
+  return key;
+}
+
+void DecisionCache::PendingCheck::onComplete(ResponsePtr&& response) {
+  parent_.onCheckComplete(*this, std::move(response));
+}
+
+DecisionCache::DecisionCache(const CacheConfigConstSharedPtr& config,
+                             const ClientFactory& client_factory, Event::Dispatcher& dispatcher,
+                             MonotonicTimeSource& time_source)
+    : config_(config), client_factory_(client_factory), dispatcher_(dispatcher),
+      time_source_(time_source) {}
+
+DecisionCache::~DecisionCache() {
+  for (auto& pending : pending_) {
+    pending.second->client_->cancel();
+  }
+}
+
+DecisionCache::PendingCheck*
+DecisionCache::check(RequestCallbacks& callbacks,
+                     const envoy::service::auth::v2alpha::CheckRequest& request,
+                     Tracing::Span& parent_span) {
+  const std::string key = config_->key(request);
+  const Response* cached = find(key);
+  if (cached != nullptr) {
+    config_->stats().cache_hit_.inc();
+    callbacks.onComplete(std::make_unique<Response>(*cached));
+    return nullptr;
+  }
+  config_->stats().cache_miss_.inc();
+
+  const auto it = pending_.find(key);
+  if (it != pending_.end()) {
+    config_->stats().coalesced_.inc();
+    it->second->waiters_.push_back(&callbacks);
+    return it->second.get();
+  }
+
+  PendingCheck* pending =
+      pending_.emplace(key, std::make_unique<PendingCheck>(*this, key, client_factory_()))
+          .first->second.get();
+  pending->waiters_.push_back(&callbacks);
+  pending->client_->check(*pending, request, parent_span);
+  // The check may have failed within the call. The pending check is only deleted once the call
+  // stack unwinds.
+  return pending->complete_ ? nullptr : pending;
+}
+
+void DecisionCache::cancel(PendingCheck& pending, RequestCallbacks& callbacks) {
+  pending.waiters_.remove(&callbacks);
+  if (!pending.waiters_.empty() || pending.complete_) {
+    return;
+  }
+
+  pending.client_->cancel();
+  const auto it = pending_.find(pending.key_);
+  ASSERT(it != pending_.end());
+  dispatcher_.deferredDelete(std::move(it->second));
+  pending_.erase(it);
+}
+
+const Response* DecisionCache::find(const std::string& key) {
+  const auto it = index_.find(key);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+
+  const EntryList::iterator entry = it->second;
+  if (entry->expiry_ <= time_source_.currentTime()) {
+    index_.erase(it);
+    entries_.erase(entry);
+    return nullptr;
+  }
+
+  entries_.splice(entries_.begin(), entries_, entry);
+  return &entry->response_;
+}
+
+void DecisionCache::insert(const std::string& key, const Response& response) {
+  // Only the check in flight for a key inserts it, so the key is normally not cached yet.
+  const auto it = index_.find(key);
+  if (it != index_.end()) {
+    const EntryList::iterator entry = it->second;
+    index_.erase(it);
+    entries_.erase(entry);
+  } else if (entries_.size() >= config_->maxEntries()) {
+    index_.erase(entries_.back().key_);
+    entries_.pop_back();
+  }
+  entries_.push_front({key, response, time_source_.currentTime() + config_->ttl()});
+  index_.emplace(entries_.front().key_, entries_.begin());
+}
+
+void DecisionCache::onCheckComplete(PendingCheck& pending, ResponsePtr&& response) {
+  pending.complete_ = true;
+  // The client that completed the check is still on the call stack.
+  const auto it = pending_.find(pending.key_);
+  ASSERT(it != pending_.end());
+  dispatcher_.deferredDelete(std::move(it->second));
+  pending_.erase(it);
+
+  if (response->status != CheckStatus::Error) {
+    insert(pending.key_, *response);
+  }
+
+  // Waiters that are cancelled from the callbacks of the others remove themselves from the list.
+  while (!pending.waiters_.empty()) {
+    RequestCallbacks* callbacks = pending.waiters_.front();
+    pending.waiters_.pop_front();
+    callbacks->onComplete(pending.waiters_.empty() ? std::move(response)
+                                                   : std::make_unique<Response>(*response));
+  }
+}
+
+void CachingClientImpl::cancel() {
+  ASSERT(callbacks_ != nullptr);
+  cache_.cancel(*pending_, *this);
+  pending_ = nullptr;
+  callbacks_ = nullptr;
+}
+
+void CachingClientImpl::check(RequestCallbacks& callbacks,
+                              const envoy::service::auth::v2alpha::CheckRequest& request,
+                              Tracing::Span& parent_span) {
+  ASSERT(callbacks_ == nullptr);
+  callbacks_ = &callbacks;
+  pending_ = cache_.check(*this, request, parent_span);
+}
+
+void CachingClientImpl::onComplete(ResponsePtr&& response) {
+  RequestCallbacks* callbacks = callbacks_;
+  pending_ = nullptr;
+  callbacks_ = nullptr;
+  callbacks->onComplete(std::move(response));
+}
+
+CachingClientFactory::CachingClientFactory(const CacheConfigConstSharedPtr& config,
+                                           const ClientFactory& client_factory,
+                                           ThreadLocal::SlotAllocator& tls)
+    : tls_(tls.allocateSlot()) {
+  tls_->set([config, client_factory](Event::Dispatcher& dispatcher) {
+    return ThreadLocal::ThreadLocalObjectSharedPtr{
+        new DecisionCache(config, client_factory, dispatcher)};
+  });
+}
+
+ClientPtr CachingClientFactory::create() {
+  return std::make_unique<CachingClientImpl>(tls_->getTyped<DecisionCache>());
+}
+
+} // namespace ExtAuthz
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
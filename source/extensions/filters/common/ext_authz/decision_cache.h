@@ -0,0 +1,235 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/runtime/runtime.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/assert.h"
+#include "common/common/utility.h"
+
+#include "extensions/filters/common/ext_authz/ext_authz.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace ExtAuthz {
+
+/**
+ * All decision cache stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_EXT_AUTHZ_CACHE_STATS(COUNTER)                                                         \
+  COUNTER(cache_hit)                                                                               \
+  COUNTER(cache_miss)                                                                              \
+  COUNTER(coalesced)
+// clang-format on
+
+/**
+ * Struct definition for all decision cache stats. @see stats_macros.h
+ */
+struct CacheStats {
+  ALL_EXT_AUTHZ_CACHE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+// The default time for which a decision is cached.
+constexpr uint64_t DefaultCacheTtlMs = 5000;
+
+// The default attributes of a CheckRequest that a decision is assumed to depend on. The principal
+// is empty on listeners without mTLS, so the credential headers are part of the key, and requests
+// with different credentials never share a decision.
+constexpr char DefaultCacheKeyAttributes[] =
+    "request.http.method,request.http.path,source.principal,request.http.headers.authorization,"
+    "request.http.headers.cookie";
+
+/**
+ * Settings of the decision cache, shared by all workers. A decision is cached under the values of
+ * the configured CheckRequest attributes, so requests that only differ in other attributes get the
+ * same decision. The supported attributes are:
+ *     source.address, source.service, source.principal,
+ *     destination.address, destination.port, destination.principal,
+ *     request.http.method, request.http.path, request.http.host, request.http.scheme,
+ *     request.http.headers.<lower case header name>
+ */
+class CacheConfig {
+public:
+  /**
+   * @param max_entries supplies the number of decisions kept by each worker, which is positive.
+   * @param ttl supplies the time for which a decision is kept.
+   * @param key_attributes supplies the comma separated attributes the decisions are keyed by.
+   * @param stats_prefix supplies the prefix of the stats, which are emitted under
+   *        <stats_prefix>ext_authz.
+   */
+  CacheConfig(uint64_t max_entries, std::chrono::milliseconds ttl,
+              const std::string& key_attributes, const std::string& stats_prefix,
+              Stats::Scope& scope);
+
+  /**
+   * Reads the settings from the runtime keys ext_authz.cache.max_entries, ext_authz.cache.ttl_ms
+   * and ext_authz.cache.key_attributes.
+   * @return the settings, or nullptr if max_entries is 0 (the default), which disables the cache.
+   */
+  static std::shared_ptr<const CacheConfig>
+  fromRuntime(Runtime::Loader& runtime, const std::string& stats_prefix, Stats::Scope& scope);
+
+  uint64_t maxEntries() const { return max_entries_; }
+  std::chrono::milliseconds ttl() const { return ttl_; }
+  const CacheStats& stats() const { return stats_; }
+
+  /**
+   * @return the key of the decision for a request.
+   */
+  std::string key(const envoy::service::auth::v2alpha::CheckRequest& request) const;
+
+private:
+  typedef std::function<std::string(const envoy::service::auth::v2alpha::AttributeContext&)>
+      AttributeGetter;
+
+  static AttributeGetter attributeGetter(const std::string& attribute);
+
+  const uint64_t max_entries_;
+  const std::chrono::milliseconds ttl_;
+  std::vector<AttributeGetter> key_attributes_;
+  const CacheStats stats_;
+};
+
+typedef std::shared_ptr<const CacheConfig> CacheConfigConstSharedPtr;
+
+/**
+ * Creates the client that sends a check to the authorization service.
+ */
+typedef std::function<ClientPtr()> ClientFactory;
+
+/**
+ * Per worker LRU cache of the OK and denied decisions of the authorization service, which also
+ * coalesces the checks of the same key that are in flight at the same time into a single one.
+ * Errors are neither cached nor shared beyond the checks that were already waiting for them.
+ */
+class DecisionCache : public ThreadLocal::ThreadLocalObject {
+public:
+  /**
+   * A check that was sent to the authorization service, with the callbacks of all the requests
+   * waiting for its decision.
+   */
+  class PendingCheck : public RequestCallbacks, public Event::DeferredDeletable {
+  public:
+    PendingCheck(DecisionCache& parent, const std::string& key, ClientPtr&& client)
+        : parent_(parent), key_(key), client_(std::move(client)) {}
+
+    // ExtAuthz::RequestCallbacks
+    void onComplete(ResponsePtr&& response) override;
+
+  private:
+    friend class DecisionCache;
+
+    DecisionCache& parent_;
+    const std::string key_;
+    ClientPtr client_;
+    std::list<RequestCallbacks*> waiters_;
+    bool complete_{};
+  };
+
+  DecisionCache(const CacheConfigConstSharedPtr& config, const ClientFactory& client_factory,
+                Event::Dispatcher& dispatcher,
+                MonotonicTimeSource& time_source = ProdMonotonicTimeSource::instance_);
+  ~DecisionCache();
+
+  /**
+   * Completes a check with a cached decision, or makes it wait for the decision of the check of
+   * the same key that is in flight, or sends a new check.
+   * @param callbacks supplies the callbacks to complete. They may be called within this call.
+   * @return the check that the callbacks wait for, or nullptr if they were already completed.
+   */
+  PendingCheck* check(RequestCallbacks& callbacks,
+                      const envoy::service::auth::v2alpha::CheckRequest& request,
+                      Tracing::Span& parent_span);
+
+  /**
+   * Stops waiting for a check. The check is cancelled if nothing else waits for it.
+   */
+  void cancel(PendingCheck& pending, RequestCallbacks& callbacks);
+
+  uint64_t size() const { return entries_.size(); }
+
+private:
+  struct Entry {
+    std::string key_;
+    Response response_;
+    MonotonicTime expiry_;
+  };
+  typedef std::list<Entry> EntryList;
+
+  const Response* find(const std::string& key);
+  void insert(const std::string& key, const Response& response);
+  void onCheckComplete(PendingCheck& pending, ResponsePtr&& response);
+
+  const CacheConfigConstSharedPtr config_;
+  const ClientFactory client_factory_;
+  Event::Dispatcher& dispatcher_;
+  MonotonicTimeSource& time_source_;
+  // Most recently used first.
+  EntryList entries_;
+  // Keys point into the key of the entry.
+  std::unordered_map<absl::string_view, EntryList::iterator, StringViewHash> index_;
+  std::unordered_map<std::string, std::unique_ptr<PendingCheck>> pending_;
+};
+
+/**
+ * Client that checks through the DecisionCache of the worker it is used on.
+ */
+class CachingClientImpl : public Client, public RequestCallbacks {
+public:
+  CachingClientImpl(DecisionCache& cache) : cache_(cache) {}
+  ~CachingClientImpl() { ASSERT(!callbacks_); }
+
+  // ExtAuthz::Client
+  void cancel() override;
+  void check(RequestCallbacks& callbacks,
+             const envoy::service::auth::v2alpha::CheckRequest& request,
+             Tracing::Span& parent_span) override;
+
+  // ExtAuthz::RequestCallbacks
+  void onComplete(ResponsePtr&& response) override;
+
+private:
+  DecisionCache& cache_;
+  DecisionCache::PendingCheck* pending_{};
+  RequestCallbacks* callbacks_{};
+};
+
+/**
+ * Creates CachingClientImpls on the DecisionCache of each worker.
+ */
+class CachingClientFactory {
+public:
+  CachingClientFactory(const CacheConfigConstSharedPtr& config, const ClientFactory& client_factory,
+                       ThreadLocal::SlotAllocator& tls);
+
+  /**
+   * @return a client for the worker this is called on.
+   */
+  ClientPtr create();
+
+private:
+  ThreadLocal::SlotPtr tls_;
+};
+
+typedef std::shared_ptr<CachingClientFactory> CachingClientFactorySharedPtr;
+
+} // namespace ExtAuthz
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
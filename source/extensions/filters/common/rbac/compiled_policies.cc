@@ -0,0 +1,318 @@
+#include "extensions/filters/common/rbac/compiled_policies.h"
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/network/cidr_range.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+
+namespace {
+
+// Rough relative costs of evaluating the leaf rules. Connection rules are cheaper than header
+// rules, which look up the header and may run a regex, and than metadata rules, which walk a path
+// of struct fields.
+constexpr uint32_t AnyCost = 0;
+constexpr uint32_t PortCost = 1;
+constexpr uint32_t AuthenticatedCost = 2;
+constexpr uint32_t IpCost = 3;
+constexpr uint32_t MetadataCost = 4;
+constexpr uint32_t HeaderCost = 5;
+
+const envoy::api::v2::core::CidrRange*
+directIpRange(const envoy::config::rbac::v2alpha::Permission& permission) {
+  return permission.rule_case() ==
+                 envoy::config::rbac::v2alpha::Permission::RuleCase::kDestinationIp
+             ? &permission.destination_ip()
+             : nullptr;
+}
+
+const envoy::api::v2::core::CidrRange*
+directIpRange(const envoy::config::rbac::v2alpha::Principal& principal) {
+  return principal.identifier_case() ==
+                 envoy::config::rbac::v2alpha::Principal::IdentifierCase::kSourceIp
+             ? &principal.source_ip()
+             : nullptr;
+}
+
+} // namespace
+
+/**
+ * Builds the nodes of the DAG, merging identical rules through a key that describes each node.
+ */
+class CompiledPolicies::Compiler {
+public:
+  Compiler(std::vector<Node>& nodes) : nodes_(nodes) {}
+
+  uint32_t addPolicies(
+      const Protobuf::Map<ProtobufTypes::String, envoy::config::rbac::v2alpha::Policy>& policies) {
+    std::vector<uint32_t> children;
+    for (const auto& policy : policies) {
+      children.push_back(addSet(NodeType::And, {addAny(policy.second.permissions()),
+                                                addAny(policy.second.principals())}));
+    }
+    return addSet(NodeType::Or, std::move(children));
+  }
+
+private:
+  uint32_t add(const envoy::config::rbac::v2alpha::Permission& permission) {
+    switch (permission.rule_case()) {
+    case envoy::config::rbac::v2alpha::Permission::RuleCase::kAndRules:
+      return addAll(permission.and_rules().rules());
+    case envoy::config::rbac::v2alpha::Permission::RuleCase::kOrRules:
+      return addAny(permission.or_rules().rules());
+    case envoy::config::rbac::v2alpha::Permission::RuleCase::kHeader:
+      return addHeader(permission.header());
+    case envoy::config::rbac::v2alpha::Permission::RuleCase::kDestinationIp:
+      return addIp({&permission.destination_ip()}, true);
+    case envoy::config::rbac::v2alpha::Permission::RuleCase::kDestinationPort:
+      return addLeaf(fmt::format("port:{}", permission.destination_port()), PortCost, [&] {
+        return std::make_shared<const PortMatcher>(permission.destination_port());
+      });
+    case envoy::config::rbac::v2alpha::Permission::RuleCase::kAny:
+      return addAlways();
+    case envoy::config::rbac::v2alpha::Permission::RuleCase::kMetadata:
+      return addMetadata(permission.metadata());
+    case envoy::config::rbac::v2alpha::Permission::RuleCase::kNotRule:
+      return addSet(NodeType::Not, {add(permission.not_rule())});
+    default:
+      NOT_REACHED;
+    }
+  }
+
+  uint32_t add(const envoy::config::rbac::v2alpha::Principal& principal) {
+    switch (principal.identifier_case()) {
+    case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kAndIds:
+      return addAll(principal.and_ids().ids());
+    case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kOrIds:
+      return addAny(principal.or_ids().ids());
+    case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kAuthenticated:
+      return addLeaf("authenticated:" + principal.authenticated().name(), AuthenticatedCost, [&] {
+        return std::make_shared<const AuthenticatedMatcher>(principal.authenticated());
+      });
+    case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kSourceIp:
+      return addIp({&principal.source_ip()}, false);
+    case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kHeader:
+      return addHeader(principal.header());
+    case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kAny:
+      return addAlways();
+    case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kMetadata:
+      return addMetadata(principal.metadata());
+    case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kNotId:
+      return addSet(NodeType::Not, {add(principal.not_id())});
+    default:
+      NOT_REACHED;
+    }
+  }
+
+  template <class Rule> uint32_t addAll(const Protobuf::RepeatedPtrField<Rule>& rules) {
+    std::vector<uint32_t> children;
+    for (const auto& rule : rules) {
+      children.push_back(add(rule));
+    }
+    return addSet(NodeType::And, std::move(children));
+  }
+
+  // As with OrMatcher, the IP rules of the set are compiled into a single IP node.
+  template <class Rule> uint32_t addAny(const Protobuf::RepeatedPtrField<Rule>& rules) {
+    std::vector<uint32_t> children;
+    std::vector<const envoy::api::v2::core::CidrRange*> ranges;
+    for (const auto& rule : rules) {
+      const envoy::api::v2::core::CidrRange* range = directIpRange(rule);
+      if (range != nullptr) {
+        ranges.push_back(range);
+      } else {
+        children.push_back(add(rule));
+      }
+    }
+    if (!ranges.empty()) {
+      constexpr bool destination =
+          std::is_same<Rule, envoy::config::rbac::v2alpha::Permission>::value;
+      children.push_back(addIp(ranges, destination));
+    }
+    return addSet(NodeType::Or, std::move(children));
+  }
+
+  uint32_t addIp(const std::vector<const envoy::api::v2::core::CidrRange*>& protos,
+                 bool destination) {
+    std::string key = destination ? "destination_ip:" : "source_ip:";
+    for (const envoy::api::v2::core::CidrRange* proto : protos) {
+      key += fmt::format("{}/{},", proto->address_prefix(), proto->prefix_len().value());
+    }
+    return addLeaf(std::move(key), IpCost, [&] {
+      std::vector<Network::Address::CidrRange> ranges;
+      for (const envoy::api::v2::core::CidrRange* proto : protos) {
+        // A range that is not valid matches no address.
+        Network::Address::CidrRange range = Network::Address::CidrRange::create(*proto);
+        if (range.isValid()) {
+          ranges.push_back(range);
+        }
+      }
+      return std::make_shared<const IPMatcher>(ranges, destination);
+    });
+  }
+
+  uint32_t addHeader(const envoy::api::v2::route::HeaderMatcher& header) {
+    return addLeaf("header:" + header.SerializeAsString(), HeaderCost,
+                   [&] { return std::make_shared<const HeaderMatcher>(header); });
+  }
+
+  uint32_t addMetadata(const envoy::type::matcher::MetadataMatcher& metadata) {
+    return addLeaf("metadata:" + metadata.SerializeAsString(), MetadataCost,
+                   [&] { return std::make_shared<const MetadataMatcher>(metadata); });
+  }
+
+  uint32_t addAlways() {
+    return addLeaf("any", AnyCost, [] { return std::make_shared<const AlwaysMatcher>(); });
+  }
+
+  // The matcher is only created if there is no identical leaf yet.
+  uint32_t addLeaf(std::string key, uint32_t cost,
+                   const std::function<MatcherConstSharedPtr()>& create_matcher) {
+    const auto it = index_.find(key);
+    if (it != index_.end()) {
+      return it->second;
+    }
+    return addNode(std::move(key), Node{NodeType::Leaf, {}, create_matcher(), cost});
+  }
+
+  uint32_t addSet(NodeType type, std::vector<uint32_t> children) {
+    if (type == NodeType::Not) {
+      ASSERT(children.size() == 1);
+      Node node{type, children, nullptr, nodes_[children[0]].cost_};
+      return addNode(fmt::format("not:{}", children[0]), std::move(node));
+    }
+
+    // A rule that always matches decides an OR set, and can be left out of an AND set.
+    const bool is_and = type == NodeType::And;
+    const auto always = index_.find("any");
+    if (always != index_.end()) {
+      if (!is_and &&
+          std::find(children.begin(), children.end(), always->second) != children.end()) {
+        return always->second;
+      }
+      children.erase(std::remove(children.begin(), children.end(), always->second),
+                     children.end());
+      if (is_and && children.empty()) {
+        return always->second;
+      }
+    }
+
+    // Order the children cheapest first, and merge duplicates.
+    std::sort(children.begin(), children.end(), [this](uint32_t lhs, uint32_t rhs) {
+      return std::make_pair(nodes_[lhs].cost_, lhs) < std::make_pair(nodes_[rhs].cost_, rhs);
+    });
+    children.erase(std::unique(children.begin(), children.end()), children.end());
+    if (children.size() == 1) {
+      return children[0];
+    }
+
+    std::string key = is_and ? "and:" : "or:";
+    uint32_t cost = 0;
+    for (const uint32_t child : children) {
+      key += fmt::format("{},", child);
+      cost += nodes_[child].cost_;
+    }
+    Node node{type, std::move(children), nullptr, cost};
+    return addNode(std::move(key), std::move(node));
+  }
+
+  uint32_t addNode(std::string key, Node node) {
+    const auto it = index_.find(key);
+    if (it != index_.end()) {
+      return it->second;
+    }
+    const uint32_t index = nodes_.size();
+    nodes_.push_back(std::move(node));
+    index_.emplace(std::move(key), index);
+    return index;
+  }
+
+  std::vector<Node>& nodes_;
+  std::unordered_map<std::string, uint32_t> index_;
+};
+
+CompiledPolicies::CompiledPolicies(
+    const Protobuf::Map<ProtobufTypes::String, envoy::config::rbac::v2alpha::Policy>& policies) {
+  root_ = Compiler(nodes_).addPolicies(policies);
+
+  // Keep the results of the nodes that more than one set refers to, unless evaluating them again
+  // is about as cheap as looking up a kept result.
+  std::vector<uint32_t> parents(nodes_.size());
+  for (const Node& node : nodes_) {
+    for (const uint32_t child : node.children_) {
+      parents[child]++;
+    }
+  }
+  for (size_t i = 0; i < nodes_.size(); i++) {
+    if (parents[i] > 1 && nodes_[i].cost_ > PortCost) {
+      nodes_[i].result_index_ = shared_nodes_++;
+    }
+  }
+}
+
+bool CompiledPolicies::matches(const Network::Connection& connection,
+                               const Envoy::Http::HeaderMap& headers,
+                               const envoy::api::v2::core::Metadata& metadata) const {
+  // -1 for results that were not evaluated yet.
+  std::vector<int8_t> results(shared_nodes_, -1);
+  return evaluate(root_, connection, headers, metadata, results);
+}
+
+bool CompiledPolicies::evaluate(uint32_t index, const Network::Connection& connection,
+                                const Envoy::Http::HeaderMap& headers,
+                                const envoy::api::v2::core::Metadata& metadata,
+                                std::vector<int8_t>& results) const {
+  const Node& node = nodes_[index];
+  if (node.result_index_ >= 0 && results[node.result_index_] >= 0) {
+    return results[node.result_index_] == 1;
+  }
+
+  bool result;
+  switch (node.type_) {
+  case NodeType::Leaf:
+    result = node.leaf_->matches(connection, headers, metadata);
+    break;
+  case NodeType::Not:
+    result = !evaluate(node.children_[0], connection, headers, metadata, results);
+    break;
+  case NodeType::And:
+    result = true;
+    for (const uint32_t child : node.children_) {
+      if (!evaluate(child, connection, headers, metadata, results)) {
+        result = false;
+        break;
+      }
+    }
+    break;
+  case NodeType::Or:
+    result = false;
+    for (const uint32_t child : node.children_) {
+      if (evaluate(child, connection, headers, metadata, results)) {
+        result = true;
+        break;
+      }
+    }
+    break;
+  default:
+    NOT_REACHED;
+  }
+
+  if (node.result_index_ >= 0) {
+    results[node.result_index_] = result ? 1 : 0;
+  }
+  return result;
+}
+
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
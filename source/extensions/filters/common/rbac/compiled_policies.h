@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/api/v2/core/base.pb.h"
+#include "envoy/config/rbac/v2alpha/rbac.pb.h"
+#include "envoy/http/header_map.h"
+#include "envoy/network/connection.h"
+
+#include "extensions/filters/common/rbac/matchers.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+
+/**
+ * A set of policies compiled into a flat decision DAG, which matches if any of the policies do.
+ *
+ * Identical rules are compiled into a single node, whichever policies (or sets within a policy)
+ * they appear in, and such shared nodes are evaluated at most once per request. The children of
+ * each set are evaluated cheapest first (e.g. ports before headers), so that evaluation
+ * short-circuits before the costly rules wherever it can.
+ */
+class CompiledPolicies {
+public:
+  CompiledPolicies(
+      const Protobuf::Map<ProtobufTypes::String, envoy::config::rbac::v2alpha::Policy>& policies);
+
+  /**
+   * @return true if any of the policies matches the connection, headers and metadata.
+   */
+  bool matches(const Network::Connection& connection, const Envoy::Http::HeaderMap& headers,
+               const envoy::api::v2::core::Metadata& metadata) const;
+
+  /**
+   * @return the number of nodes in the DAG, after identical rules were merged.
+   */
+  size_t size() const { return nodes_.size(); }
+
+private:
+  enum class NodeType { And, Or, Not, Leaf };
+
+  struct Node {
+    NodeType type_;
+    // Sorted by ascending cost.
+    std::vector<uint32_t> children_;
+    MatcherConstSharedPtr leaf_;
+    // Rough relative cost of evaluating the node, which orders the children of sets.
+    uint32_t cost_;
+    // Index of the result of the node among the results kept during an evaluation, if the node has
+    // more than one parent.
+    int32_t result_index_{-1};
+  };
+
+  class Compiler;
+
+  bool evaluate(uint32_t index, const Network::Connection& connection,
+                const Envoy::Http::HeaderMap& headers,
+                const envoy::api::v2::core::Metadata& metadata,
+                std::vector<int8_t>& results) const;
+
+  std::vector<Node> nodes_;
+  uint32_t root_;
+  size_t shared_nodes_{};
+};
+
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -9,22 +9,13 @@ namespace RBAC {
 RoleBasedAccessControlEngineImpl::RoleBasedAccessControlEngineImpl(
     const envoy::config::rbac::v2alpha::RBAC& rules)
     : allowed_if_matched_(rules.action() ==
-                          envoy::config::rbac::v2alpha::RBAC_Action::RBAC_Action_ALLOW) {
-  for (const auto& policy : rules.policies()) {
-    policies_.emplace_back(policy.second);
-  }
-}
+                          envoy::config::rbac::v2alpha::RBAC_Action::RBAC_Action_ALLOW),
+      policies_(rules.policies()) {}
 
 bool RoleBasedAccessControlEngineImpl::allowed(
     const Network::Connection& connection, const Envoy::Http::HeaderMap& headers,
     const envoy::api::v2::core::Metadata& metadata) const {
-  bool matched = false;
-  for (const auto& policy : policies_) {
-    if (policy.matches(connection, headers, metadata)) {
-      matched = true;
-      break;
-    }
-  }
+  const bool matched = policies_.matches(connection, headers, metadata);
 
   // only allowed if:
   //   - matched and ALLOW action
@@ -2,8 +2,8 @@
 
 #include "envoy/config/filter/http/rbac/v2/rbac.pb.h"
 
+#include "extensions/filters/common/rbac/compiled_policies.h"
 #include "extensions/filters/common/rbac/engine.h"
-#include "extensions/filters/common/rbac/matchers.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -21,7 +21,7 @@ public:
 private:
   const bool allowed_if_matched_;
 
-  std::vector<PolicyMatcher> policies_;
+  const CompiledPolicies policies_;
 };
 
 } // namespace RBAC
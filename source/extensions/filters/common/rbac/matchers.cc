@@ -78,17 +78,58 @@ bool AndMatcher::matches(const Network::Connection& connection,
   return true;
 }
 
+namespace {
+
+// A range that is not valid matches no address, so it is left out of the ranges to match.
+void addRange(std::vector<Network::Address::CidrRange>& ranges,
+              const envoy::api::v2::core::CidrRange& proto) {
+  Network::Address::CidrRange range = Network::Address::CidrRange::create(proto);
+  if (range.isValid()) {
+    ranges.push_back(range);
+  }
+}
+
+std::vector<Network::Address::CidrRange>
+validRanges(const envoy::api::v2::core::CidrRange& proto) {
+  std::vector<Network::Address::CidrRange> ranges;
+  addRange(ranges, proto);
+  return ranges;
+}
+
+} // namespace
+
 OrMatcher::OrMatcher(
     const Protobuf::RepeatedPtrField<::envoy::config::rbac::v2alpha::Permission>& rules) {
+  bool has_ip_rules = false;
+  std::vector<Network::Address::CidrRange> ranges;
   for (const auto& rule : rules) {
-    matchers_.push_back(Matcher::create(rule));
+    if (rule.rule_case() == envoy::config::rbac::v2alpha::Permission::RuleCase::kDestinationIp) {
+      has_ip_rules = true;
+      addRange(ranges, rule.destination_ip());
+    } else {
+      matchers_.push_back(Matcher::create(rule));
+    }
+  }
+  if (has_ip_rules) {
+    matchers_.insert(matchers_.begin(), std::make_shared<const IPMatcher>(ranges, true));
   }
 }
 
 OrMatcher::OrMatcher(
     const Protobuf::RepeatedPtrField<::envoy::config::rbac::v2alpha::Principal>& ids) {
+  bool has_ip_ids = false;
+  std::vector<Network::Address::CidrRange> ranges;
   for (const auto& id : ids) {
-    matchers_.push_back(Matcher::create(id));
+    if (id.identifier_case() ==
+        envoy::config::rbac::v2alpha::Principal::IdentifierCase::kSourceIp) {
+      has_ip_ids = true;
+      addRange(ranges, id.source_ip());
+    } else {
+      matchers_.push_back(Matcher::create(id));
+    }
+  }
+  if (has_ip_ids) {
+    matchers_.insert(matchers_.begin(), std::make_shared<const IPMatcher>(ranges, false));
   }
 }
 
@@ -115,12 +156,15 @@ bool HeaderMatcher::matches(const Network::Connection&, const Envoy::Http::Heade
   return Envoy::Http::HeaderUtility::matchHeaders(headers, header_);
 }
 
+IPMatcher::IPMatcher(const envoy::api::v2::core::CidrRange& range, bool destination)
+    : ranges_(validRanges(range)), destination_(destination) {}
+
 bool IPMatcher::matches(const Network::Connection& connection, const Envoy::Http::HeaderMap&,
                         const envoy::api::v2::core::Metadata&) const {
   const Envoy::Network::Address::InstanceConstSharedPtr& ip =
       destination_ ? connection.localAddress() : connection.remoteAddress();
 
-  return range_.isInRange(*ip.get());
+  return ranges_.contains(*ip.get());
 }
 
 bool PortMatcher::matches(const Network::Connection& connection, const Envoy::Http::HeaderMap&,
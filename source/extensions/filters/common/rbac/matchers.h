@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "envoy/api/v2/core/base.pb.h"
 #include "envoy/config/rbac/v2alpha/rbac.pb.h"
@@ -10,6 +11,7 @@
 #include "common/common/matchers.h"
 #include "common/http/header_utility.h"
 #include "common/network/cidr_range.h"
+#include "common/network/cidr_set.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -80,7 +82,8 @@ private:
 
 /**
  * A composite matcher where only one sub-matcher must match for this to return true. Evaluation
- * short-circuits on the first match.
+ * short-circuits on the first match. The IP rules of the set are compiled into a single IPMatcher,
+ * which is evaluated first.
  */
 class OrMatcher : public Matcher {
 public:
@@ -126,19 +129,20 @@ private:
 };
 
 /**
- * Perform a match against an IP CIDR range. This rule can be applied to either the source
+ * Perform a match against a set of IP CIDR ranges. This rule can be applied to either the source
  * (remote) or the destination (local) IP.
  */
 class IPMatcher : public Matcher {
 public:
-  IPMatcher(const envoy::api::v2::core::CidrRange& range, bool destination)
-      : range_(Network::Address::CidrRange::create(range)), destination_(destination) {}
+  IPMatcher(const envoy::api::v2::core::CidrRange& range, bool destination);
+  IPMatcher(const std::vector<Network::Address::CidrRange>& ranges, bool destination)
+      : ranges_(ranges), destination_(destination) {}
 
   bool matches(const Network::Connection& connection, const Envoy::Http::HeaderMap& headers,
                const envoy::api::v2::core::Metadata&) const override;
 
 private:
-  const Network::Address::CidrRange range_;
+  const Network::Address::CidrSet ranges_;
   const bool destination_;
 };
 
@@ -8,6 +8,7 @@
 
 #include "common/protobuf/utility.h"
 
+#include "extensions/filters/common/ext_authz/decision_cache.h"
 #include "extensions/filters/common/ext_authz/ext_authz_grpc_impl.h"
 #include "extensions/filters/common/ext_authz/ext_authz_http_impl.h"
 #include "extensions/filters/http/ext_authz/ext_authz.h"
@@ -19,7 +20,7 @@ namespace ExtAuthz {
 
 Http::FilterFactoryCb ExtAuthzFilterConfig::createFilterFactoryFromProtoTyped(
     const envoy::config::filter::http::ext_authz::v2alpha::ExtAuthz& proto_config,
-    const std::string&, Server::Configuration::FactoryContext& context) {
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
 
   const auto filter_config =
       std::make_shared<FilterConfig>(proto_config, context.localInfo(), context.scope(),
@@ -43,6 +44,27 @@ Http::FilterFactoryCb ExtAuthzFilterConfig::createFilterFactoryFromProtoTyped(
   const uint32_t timeout_ms =
       PROTOBUF_GET_MS_OR_DEFAULT(proto_config.grpc_service(), timeout, DefaultTimeout);
 
+  const auto cache_config = Filters::Common::ExtAuthz::CacheConfig::fromRuntime(
+      filter_config->runtime(), stats_prefix, filter_config->scope());
+  if (cache_config != nullptr) {
+    // The checks are sent by the decision cache of each worker, on a client per check.
+    const auto caching_client_factory =
+        std::make_shared<Filters::Common::ExtAuthz::CachingClientFactory>(
+            cache_config,
+            [ grpc_service = proto_config.grpc_service(), &context, timeout_ms ]() {
+              const auto async_client_factory =
+                  context.clusterManager().grpcAsyncClientManager().factoryForGrpcService(
+                      grpc_service, context.scope(), true);
+              return std::make_unique<Filters::Common::ExtAuthz::GrpcClientImpl>(
+                  async_client_factory->create(), std::chrono::milliseconds(timeout_ms));
+            },
+            context.threadLocal());
+    return [filter_config, caching_client_factory](Http::FilterChainFactoryCallbacks& callbacks) {
+      callbacks.addStreamDecoderFilter(Http::StreamDecoderFilterSharedPtr{
+          std::make_shared<Filter>(filter_config, caching_client_factory->create())});
+    };
+  }
+
   return [ grpc_service = proto_config.grpc_service(), &context, filter_config,
            timeout_ms ](Http::FilterChainFactoryCallbacks & callbacks) {
     const auto async_client_factory =
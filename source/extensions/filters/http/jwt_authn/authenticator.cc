@@ -44,6 +44,9 @@ private:
   // Verify with a specific public key.
   void verifyKey();
 
+  // Forward the payload of a verified token and complete with Status::Ok.
+  void acceptToken(const std::string& payload_str_base64url);
+
   // Handle the public key fetch done event.
   void onFetchRemoteJwksDone(const std::string& jwks_str);
 
@@ -102,6 +105,22 @@ void AuthenticatorImpl::verify(Http::HeaderMap& headers, Authenticator::Callback
   // Only process the first token for now.
   token_.swap(tokens[0]);
 
+  const auto unix_timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+                                  std::chrono::system_clock::now().time_since_epoch())
+                                  .count();
+
+  // A token that passed verification before is accepted without parsing or verifying it again.
+  const TokenCache::VerifiedToken* verified =
+      config_->getCache().getTokenCache().find(token_->token(), unix_timestamp);
+  if (verified != nullptr && token_->isIssuerSpecified(verified->issuer_)) {
+    config_->stats().token_cache_hit_.inc();
+    jwks_data_ = config_->getCache().getJwksCache().findByIssuer(verified->issuer_);
+    ASSERT(jwks_data_ != nullptr);
+    acceptToken(verified->payload_str_base64url_);
+    return;
+  }
+  config_->stats().token_cache_miss_.inc();
+
   const Status status = jwt_.parseFromString(token_->token());
   if (status != Status::Ok) {
     doneWithStatus(status);
@@ -116,9 +135,6 @@ void AuthenticatorImpl::verify(Http::HeaderMap& headers, Authenticator::Callback
   }
 
   // Check "exp" claim.
-  const auto unix_timestamp = std::chrono::duration_cast<std::chrono::seconds>(
-                                  std::chrono::system_clock::now().time_since_epoch())
-                                  .count();
   if (jwt_.exp_ < unix_timestamp) {
     doneWithStatus(Status::JwtExpired);
     return;
@@ -218,11 +234,17 @@ void AuthenticatorImpl::verifyKey() {
     return;
   }
 
+  config_->getCache().getTokenCache().insert(
+      token_->token(), {jwt_.iss_, jwt_.payload_str_base64url_, jwt_.exp_});
+  acceptToken(jwt_.payload_str_base64url_);
+}
+
+void AuthenticatorImpl::acceptToken(const std::string& payload_str_base64url) {
   // Forward the payload
   const auto& provider = jwks_data_->getJwtProvider();
   if (!provider.forward_payload_header().empty()) {
     headers_->addCopy(Http::LowerCaseString(provider.forward_payload_header()),
-                      jwt_.payload_str_base64url_);
+                      payload_str_base64url);
   }
 
   if (!provider.forward()) {
@@ -8,6 +8,7 @@
 
 #include "extensions/filters/http/jwt_authn/extractor.h"
 #include "extensions/filters/http/jwt_authn/jwks_cache.h"
+#include "extensions/filters/http/jwt_authn/token_cache.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -16,23 +17,29 @@ namespace JwtAuthn {
 
 /**
  * Making cache as a thread local object, its read/write operations don't need to be protected.
- * Now it only has jwks_cache, but in the future, it will have token cache: to cache the tokens
- * with their verification results.
+ * It has jwks_cache, and token cache: to cache the tokens that passed verification.
  */
 class ThreadLocalCache : public ThreadLocal::ThreadLocalObject {
 public:
   // Load the config from envoy config.
   ThreadLocalCache(
-      const ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication& config) {
+      const ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication& config,
+      uint64_t token_cache_size)
+      : token_cache_(token_cache_size) {
     jwks_cache_ = JwksCache::create(config);
   }
 
   // Get the JwksCache object.
   JwksCache& getJwksCache() { return *jwks_cache_; }
 
+  // Get the TokenCache object.
+  TokenCache& getTokenCache() { return token_cache_; }
+
 private:
   // The JwksCache object.
   JwksCachePtr jwks_cache_;
+  // The TokenCache object.
+  TokenCache token_cache_;
 };
 
 /**
@@ -42,7 +49,9 @@ private:
 // clang-format off
 #define ALL_JWT_AUTHN_FILTER_STATS(COUNTER)                                                        \
   COUNTER(allowed)                                                                                 \
-  COUNTER(denied)
+  COUNTER(denied)                                                                                  \
+  COUNTER(token_cache_hit)                                                                         \
+  COUNTER(token_cache_miss)
 // clang-format on
 
 /**
@@ -63,9 +72,12 @@ public:
       : proto_config_(proto_config), stats_(generateStats(stats_prefix, context.scope())),
         tls_(context.threadLocal().allocateSlot()), cm_(context.clusterManager()) {
     ENVOY_LOG(info, "Loaded JwtAuthConfig: {}", proto_config_.DebugString());
-    tls_->set([this](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
-      return std::make_shared<ThreadLocalCache>(proto_config_);
-    });
+    const uint64_t token_cache_size = context.runtime().snapshot().getInteger(
+        "jwt_authn.token_cache_size", DefaultTokenCacheSize);
+    tls_->set(
+        [this, token_cache_size](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+          return std::make_shared<ThreadLocalCache>(proto_config_, token_cache_size);
+        });
     extractor_ = Extractor::create(proto_config_);
   }
 
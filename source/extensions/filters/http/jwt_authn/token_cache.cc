@@ -0,0 +1,48 @@
+#include "extensions/filters/http/jwt_authn/token_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+
+const TokenCache::VerifiedToken* TokenCache::find(const std::string& token, int64_t now) {
+  const auto it = index_.find(token);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+
+  const EntryList::iterator entry = it->second;
+  if (entry->verified_.exp_ < now) {
+    index_.erase(it);
+    entries_.erase(entry);
+    return nullptr;
+  }
+
+  entries_.splice(entries_.begin(), entries_, entry);
+  return &entry->verified_;
+}
+
+void TokenCache::insert(const std::string& token, VerifiedToken&& verified) {
+  if (max_size_ == 0) {
+    return;
+  }
+
+  const auto it = index_.find(token);
+  if (it != index_.end()) {
+    it->second->verified_ = std::move(verified);
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+
+  if (entries_.size() >= max_size_) {
+    index_.erase(entries_.back().token_);
+    entries_.pop_back();
+  }
+  entries_.push_front({token, std::move(verified)});
+  index_.emplace(entries_.front().token_, entries_.begin());
+}
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "common/common/utility.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+
+// The default number of verified tokens kept by each worker.
+constexpr uint64_t DefaultTokenCacheSize = 1000;
+
+/**
+ * LRU cache of the JWTs that passed verification, with the parts of their payload that are needed
+ * to accept them again. Clients usually send the same token for its whole lifetime, so a cached
+ * token skips parsing and signature verification until it expires.
+ * Its usage:
+ *     auto* verified = token_cache.find(token, now);
+ *     if (verified == nullptr) {
+ *        // Parse and verify the token.
+ *        token_cache.insert(token, {jwt.iss_, jwt.payload_str_base64url_, jwt.exp_});
+ *     }
+ *
+ * It is only accessed by one thread, so its operations don't need to be protected.
+ */
+class TokenCache {
+public:
+  struct VerifiedToken {
+    // The "iss" claim.
+    std::string issuer_;
+    // The payload to forward.
+    std::string payload_str_base64url_;
+    // The "exp" claim, in seconds since the epoch.
+    int64_t exp_;
+  };
+
+  // A max_size of 0 disables the cache.
+  TokenCache(uint64_t max_size) : max_size_(max_size) {}
+
+  // Lookup a token. Expired tokens are removed from the cache.
+  // @param now supplies the current time in seconds since the epoch.
+  // @return the verified token, or nullptr if the token is not in the cache.
+  const VerifiedToken* find(const std::string& token, int64_t now);
+
+  // Add a token that passed verification, evicting the least recently used one if the cache is
+  // full.
+  void insert(const std::string& token, VerifiedToken&& verified);
+
+  uint64_t size() const { return entries_.size(); }
+
+private:
+  struct Entry {
+    std::string token_;
+    VerifiedToken verified_;
+  };
+  typedef std::list<Entry> EntryList;
+
+  // Most recently used first.
+  EntryList entries_;
+  // Keys point into the token of the entry.
+  std::unordered_map<absl::string_view, EntryList::iterator, StringViewHash> index_;
+  const uint64_t max_size_;
+};
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
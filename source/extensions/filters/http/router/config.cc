@@ -3,6 +3,7 @@
 #include "envoy/config/filter/http/router/v2/router.pb.validate.h"
 #include "envoy/registry/registry.h"
 
+#include "common/common/arena_impl.h"
 #include "common/config/filter_json.h"
 #include "common/json/config_schemas.h"
 #include "common/router/router.h"
@@ -21,7 +22,8 @@ Http::FilterFactoryCb RouterFilterConfig::createFilterFactoryFromProtoTyped(
       proto_config));
 
   return [filter_config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addStreamDecoderFilter(std::make_shared<Router::ProdFilter>(*filter_config));
+    callbacks.addStreamDecoderFilter(
+        makeArenaShared<Router::ProdFilter>(callbacks.arena(), *filter_config));
   };
 }
 
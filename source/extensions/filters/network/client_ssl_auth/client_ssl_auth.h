@@ -13,7 +13,7 @@
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/http/rest_api_fetcher.h"
-#include "common/network/cidr_range.h"
+#include "common/network/cidr_set.h"
 #include "common/network/utility.h"
 #include "common/protobuf/utility.h"
 
@@ -80,7 +80,7 @@ public:
          Event::Dispatcher& dispatcher, Stats::Scope& scope, Runtime::RandomGenerator& random);
 
   const AllowedPrincipals& allowedPrincipals();
-  const Network::Address::IpList& ipWhiteList() { return ip_white_list_; }
+  const Network::Address::CidrSet& ipWhiteList() { return ip_white_list_; }
   GlobalStats& stats() { return stats_; }
 
 private:
@@ -98,7 +98,7 @@ private:
   void onFetchFailure(const EnvoyException* e) override;
 
   ThreadLocal::SlotPtr tls_;
-  Network::Address::IpList ip_white_list_;
+  Network::Address::CidrSet ip_white_list_;
   GlobalStats stats_;
 };
 
@@ -6,6 +6,7 @@
 #include <list>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "envoy/config/filter/network/http_connection_manager/v2/http_connection_manager.pb.validate.h"
 #include "envoy/http/filter.h"
@@ -110,7 +111,7 @@ public:
   const Http::Http1Settings& http1Settings() const override { return http1_settings_; }
 
 private:
-  typedef std::list<Http::FilterFactoryCb> FilterFactoriesList;
+  typedef std::vector<Http::FilterFactoryCb> FilterFactoriesList;
   enum class CodecType { HTTP1, HTTP2, AUTO };
   void processFilter(
       const envoy::config::filter::network::http_connection_manager::v2::HttpFilter& proto_config,
@@ -21,8 +21,9 @@ RedisHealthChecker::RedisHealthChecker(
 }
 
 RedisHealthChecker::RedisActiveHealthCheckSession::RedisActiveHealthCheckSession(
-    RedisHealthChecker& parent, const Upstream::HostSharedPtr& host)
-    : ActiveHealthCheckSession(parent, host), parent_(parent) {}
+    RedisHealthChecker& parent, const Upstream::HostSharedPtr& host,
+    Event::Dispatcher& dispatcher)
+    : ActiveHealthCheckSession(parent, host, dispatcher), parent_(parent) {}
 
 RedisHealthChecker::RedisActiveHealthCheckSession::~RedisActiveHealthCheckSession() {
   if (current_request_) {
@@ -40,13 +41,13 @@ void RedisHealthChecker::RedisActiveHealthCheckSession::onEvent(Network::Connect
       event == Network::ConnectionEvent::LocalClose) {
     // This should only happen after any active requests have been failed/cancelled.
     ASSERT(!current_request_);
-    parent_.dispatcher_.deferredDelete(std::move(client_));
+    dispatcher_.deferredDelete(std::move(client_));
   }
 }
 
 void RedisHealthChecker::RedisActiveHealthCheckSession::onInterval() {
   if (!client_) {
-    client_ = parent_.client_factory_.create(host_, parent_.dispatcher_, *this);
+    client_ = parent_.client_factory_.create(host_, dispatcher_, *this);
     client_->addConnectionCallbacks(*this);
   }
 
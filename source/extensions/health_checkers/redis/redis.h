@@ -45,7 +45,8 @@ private:
         public Extensions::NetworkFilters::RedisProxy::ConnPool::Config,
         public Extensions::NetworkFilters::RedisProxy::ConnPool::PoolCallbacks,
         public Network::ConnectionCallbacks {
-    RedisActiveHealthCheckSession(RedisHealthChecker& parent, const Upstream::HostSharedPtr& host);
+    RedisActiveHealthCheckSession(RedisHealthChecker& parent, const Upstream::HostSharedPtr& host,
+                                  Event::Dispatcher& dispatcher);
     ~RedisActiveHealthCheckSession();
     // ActiveHealthCheckSession
     void onInterval() override;
@@ -84,8 +85,9 @@ private:
   typedef std::unique_ptr<RedisActiveHealthCheckSession> RedisActiveHealthCheckSessionPtr;
 
   // HealthCheckerImplBase
-  ActiveHealthCheckSessionPtr makeSession(Upstream::HostSharedPtr host) override {
-    return std::make_unique<RedisActiveHealthCheckSession>(*this, host);
+  ActiveHealthCheckSessionPtr makeSession(Upstream::HostSharedPtr host,
+                                          Event::Dispatcher& dispatcher) override {
+    return std::make_unique<RedisActiveHealthCheckSession>(*this, host, dispatcher);
   }
 
   Extensions::NetworkFilters::RedisProxy::ConnPool::ClientFactory& client_factory_;
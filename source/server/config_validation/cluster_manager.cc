@@ -11,7 +11,7 @@ ValidationClusterManagerFactory::ValidationClusterManagerFactory(
     Ssl::ContextManager& ssl_context_manager, Event::Dispatcher& main_thread_dispatcher,
     const LocalInfo::LocalInfo& local_info, Secret::SecretManager& secret_manager)
     : ProdClusterManagerFactory(runtime, stats, tls, random, dns_resolver, ssl_context_manager,
-                                main_thread_dispatcher, local_info, secret_manager) {}
+                                main_thread_dispatcher, local_info, secret_manager, nullptr) {}
 
 ClusterManagerPtr ValidationClusterManagerFactory::clusterManagerFromProto(
     const envoy::config::bootstrap::v2::Bootstrap& bootstrap, Stats::Store& stats,
@@ -17,6 +17,7 @@
 #include "common/config/lds_json.h"
 #include "common/config/utility.h"
 #include "common/protobuf/utility.h"
+#include "common/ratelimit/local_quota_impl.h"
 #include "common/ratelimit/ratelimit_impl.h"
 #include "common/tracing/http_tracer_impl.h"
 
@@ -79,9 +80,18 @@ void MainImpl::initialize(const envoy::config::bootstrap::v2::Bootstrap& bootstr
   initializeTracers(bootstrap.tracing(), server);
 
   if (bootstrap.has_rate_limit_service()) {
-    ratelimit_client_factory_.reset(
-        new RateLimit::GrpcFactoryImpl(bootstrap.rate_limit_service(),
-                                       cluster_manager_->grpcAsyncClientManager(), server.stats()));
+    const absl::optional<RateLimit::LocalQuotaSettings> local_quota_settings =
+        RateLimit::LocalQuotaSettings::fromRuntime(server.runtime());
+    if (local_quota_settings.has_value()) {
+      ratelimit_client_factory_.reset(new RateLimit::LocalQuotaFactoryImpl(
+          bootstrap.rate_limit_service(), local_quota_settings.value(),
+          cluster_manager_->grpcAsyncClientManager(), server.stats(), server.threadLocal(),
+          server.options().concurrency()));
+    } else {
+      ratelimit_client_factory_.reset(new RateLimit::GrpcFactoryImpl(
+          bootstrap.rate_limit_service(), cluster_manager_->grpcAsyncClientManager(),
+          server.stats()));
+    }
   } else {
     ratelimit_client_factory_.reset(new RateLimit::NullFactoryImpl());
   }
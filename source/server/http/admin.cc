@@ -258,6 +258,8 @@ void AdminImpl::addCircuitSettings(const std::string& cluster_name, const std::s
                            resource_manager.requests().max()));
   response.add(fmt::format("{}::{}_priority::max_retries::{}\n", cluster_name, priority_str,
                            resource_manager.retries().max()));
+  response.add(fmt::format("{}::{}_priority::max_shadow_requests::{}\n", cluster_name,
+                           priority_str, resource_manager.shadowRequests().max()));
 }
 
 void AdminImpl::writeClustersAsJson(Buffer::Instance& response) {
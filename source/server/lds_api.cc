@@ -84,6 +84,40 @@ void LdsApiImpl::onConfigUpdate(const ResourceVector& resources, const std::stri
   runInitializeCallbackIfAny();
 }
 
+void LdsApiImpl::onConfigUpdate(const ResourceVector& added_resources,
+                                const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+                                const std::string& system_version_info) {
+  cm_.adsMux().pause(Config::TypeUrl::get().RouteConfiguration);
+  Cleanup rds_resume([this] { cm_.adsMux().resume(Config::TypeUrl::get().RouteConfiguration); });
+  for (const auto& listener : added_resources) {
+    MessageUtil::validate(listener);
+  }
+
+  // As above, removed listeners go first so that their addresses can be reused by added ones.
+  for (const std::string& listener_name : removed_resources) {
+    if (listener_manager_.removeListener(listener_name)) {
+      ENVOY_LOG(info, "lds: remove listener '{}'", listener_name);
+    }
+  }
+
+  for (const auto& listener : added_resources) {
+    const std::string listener_name = listener.name();
+    try {
+      if (listener_manager_.addOrUpdateListener(listener, system_version_info, true)) {
+        ENVOY_LOG(info, "lds: add/update listener '{}'", listener_name);
+      } else {
+        ENVOY_LOG(debug, "lds: add/update listener '{}' skipped", listener_name);
+      }
+    } catch (const EnvoyException& e) {
+      throw EnvoyException(
+          fmt::format("Error adding/updating listener {}: {}", listener_name, e.what()));
+    }
+  }
+
+  version_info_ = system_version_info;
+  runInitializeCallbackIfAny();
+}
+
 void LdsApiImpl::onConfigUpdateFailed(const EnvoyException*) {
   // We need to allow server startup to continue, even if we have a bad
   // config.
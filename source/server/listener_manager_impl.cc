@@ -346,15 +346,8 @@ void ListenerImpl::addFilterChainForServerNames(
                                           application_protocols, filter_chain);
   } else {
     for (const auto& server_name : server_names) {
-      if (isWildcardServerName(server_name)) {
-        // Add mapping for the wildcard domain, i.e. ".example.com" for "*.example.com".
-        addFilterChainForApplicationProtocols(
-            server_names_map[server_name.substr(1)][transport_protocol], application_protocols,
-            filter_chain);
-      } else {
-        addFilterChainForApplicationProtocols(server_names_map[server_name][transport_protocol],
-                                              application_protocols, filter_chain);
-      }
+      addFilterChainForApplicationProtocols(server_names_map[server_name][transport_protocol],
+                                            application_protocols, filter_chain);
     }
   }
 }
@@ -377,22 +370,24 @@ void ListenerImpl::convertDestinationIPsMapToTrie() {
     auto& destination_ips_pair = port.second;
     auto& destination_ips_map = destination_ips_pair.first;
     std::vector<std::pair<ServerNamesMapSharedPtr, std::vector<Network::Address::CidrRange>>> list;
-    for (const auto& entry : destination_ips_map) {
+    for (auto& entry : destination_ips_map) {
       std::vector<Network::Address::CidrRange> subnets;
       if (entry.first == EMPTY_STRING) {
         list.push_back(
             std::make_pair<ServerNamesMapSharedPtr, std::vector<Network::Address::CidrRange>>(
-                std::make_shared<ServerNamesMap>(entry.second),
+                std::make_shared<ServerNamesMap>(std::move(entry.second)),
                 {Network::Address::CidrRange::create("0.0.0.0/0"),
                  Network::Address::CidrRange::create("::/0")}));
       } else {
         list.push_back(
             std::make_pair<ServerNamesMapSharedPtr, std::vector<Network::Address::CidrRange>>(
-                std::make_shared<ServerNamesMap>(entry.second),
+                std::make_shared<ServerNamesMap>(std::move(entry.second)),
                 {Network::Address::CidrRange::create(entry.first)}));
       }
     }
     destination_ips_pair.second = std::make_unique<DestinationIPsTrie>(list, true);
+    // The server names have been moved into the trie, which is all that lookups use.
+    destination_ips_map.clear();
   }
 }
 
@@ -441,29 +436,12 @@ ListenerImpl::findFilterChainForDestinationIP(const DestinationIPsTrie& destinat
 const Network::FilterChain*
 ListenerImpl::findFilterChainForServerName(const ServerNamesMap& server_names_map,
                                            const Network::ConnectionSocket& socket) const {
-  const std::string server_name(socket.requestedServerName());
-
-  // Match on exact server name, i.e. "www.example.com" for "www.example.com".
-  const auto server_name_exact_match = server_names_map.find(server_name);
-  if (server_name_exact_match != server_names_map.end()) {
-    return findFilterChainForTransportProtocol(server_name_exact_match->second, socket);
-  }
-
-  // Match on all wildcard domains, i.e. ".example.com" and ".com" for "www.example.com".
-  size_t pos = server_name.find('.', 1);
-  while (pos < server_name.size() - 1 && pos != std::string::npos) {
-    const std::string wildcard = server_name.substr(pos);
-    const auto server_name_wildcard_match = server_names_map.find(wildcard);
-    if (server_name_wildcard_match != server_names_map.end()) {
-      return findFilterChainForTransportProtocol(server_name_wildcard_match->second, socket);
-    }
-    pos = server_name.find('.', pos + 1);
-  }
-
-  // Match on a filter chain without server name requirements.
-  const auto server_name_catchall_match = server_names_map.find(EMPTY_STRING);
-  if (server_name_catchall_match != server_names_map.end()) {
-    return findFilterChainForTransportProtocol(server_name_catchall_match->second, socket);
+  // Match on exact server name, i.e. "www.example.com" for "www.example.com", then on the longest
+  // wildcard domain, i.e. "*.example.com" and then "*.com" for "www.example.com", and finally on a
+  // filter chain without server name requirements.
+  const auto* server_name_match = server_names_map.find(socket.requestedServerName());
+  if (server_name_match != nullptr) {
+    return findFilterChainForTransportProtocol(*server_name_match, socket);
   }
 
   return nullptr;
@@ -13,6 +13,7 @@
 #include "common/common/logger.h"
 #include "common/network/cidr_range.h"
 #include "common/network/lc_trie.h"
+#include "common/network/server_name_trie.h"
 
 #include "server/init_manager_impl.h"
 #include "server/lds_api.h"
@@ -311,10 +312,10 @@ public:
 private:
   typedef std::unordered_map<std::string, Network::FilterChainSharedPtr> ApplicationProtocolsMap;
   typedef std::unordered_map<std::string, ApplicationProtocolsMap> TransportProtocolsMap;
-  // Both exact server names and wildcard domains are part of the same map, in which wildcard
-  // domains are prefixed with "." (i.e. ".example.com" for "*.example.com") to differentiate
-  // between exact and wildcard entries.
-  typedef std::unordered_map<std::string, TransportProtocolsMap> ServerNamesMap;
+  // Both exact server names and wildcard domains are part of the same trie, keyed by the
+  // configured names (i.e. "www.example.com" and "*.example.com"), while the empty name stands for
+  // filter chains without server name requirements.
+  typedef Network::ServerNameTrie<TransportProtocolsMap> ServerNamesMap;
   typedef std::unordered_map<std::string, ServerNamesMap> DestinationIPsMap;
   typedef std::shared_ptr<ServerNamesMap> ServerNamesMapSharedPtr;
   typedef Network::LcTrie::LcTrie<ServerNamesMapSharedPtr> DestinationIPsTrie;
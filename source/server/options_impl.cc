@@ -52,6 +52,14 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
       "uint32_t", cmd);
   TCLAP::ValueArg<uint32_t> concurrency("", "concurrency", "# of worker threads to run", false,
                                         std::thread::hardware_concurrency(), "uint32_t", cmd);
+  TCLAP::ValueArg<uint32_t> private_key_threads(
+      "", "private-key-threads",
+      "# of threads to run TLS handshake private key operations on (0 runs them on the workers)",
+      false, 0, "uint32_t", cmd);
+  TCLAP::ValueArg<uint32_t> health_check_threads(
+      "", "health-check-threads",
+      "# of threads to run active health checks on (0 runs them on the main thread)", false, 0,
+      "uint32_t", cmd);
   TCLAP::ValueArg<std::string> config_path("c", "config-path", "Path to configuration file", false,
                                            "", "string", cmd);
   TCLAP::ValueArg<std::string> config_yaml(
@@ -181,6 +189,8 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
   // For base ID, scale what the user inputs by 10 so that we have spread for domain sockets.
   base_id_ = base_id.getValue() * 10;
   concurrency_ = concurrency.getValue();
+  private_key_threads_ = private_key_threads.getValue();
+  health_check_threads_ = health_check_threads.getValue();
   config_path_ = config_path.getValue();
   config_yaml_ = config_yaml.getValue();
   v2_config_only_ = !allow_v1_config.getValue();
@@ -35,6 +35,12 @@ public:
   // Setters for option fields. These are not part of the Options interface.
   void setBaseId(uint64_t base_id) { base_id_ = base_id; };
   void setConcurrency(uint32_t concurrency) { concurrency_ = concurrency; }
+  void setPrivateKeyThreads(uint32_t private_key_threads) {
+    private_key_threads_ = private_key_threads;
+  }
+  void setHealthCheckThreads(uint32_t health_check_threads) {
+    health_check_threads_ = health_check_threads;
+  }
   void setConfigPath(const std::string& config_path) { config_path_ = config_path; }
   void setConfigYaml(const std::string& config_yaml) { config_yaml_ = config_yaml; }
   void setV2ConfigOnly(bool v2_config_only) { v2_config_only_ = v2_config_only; }
@@ -70,6 +76,8 @@ public:
   // Server::Options
   uint64_t baseId() const override { return base_id_; }
   uint32_t concurrency() const override { return concurrency_; }
+  uint32_t privateKeyThreads() const override { return private_key_threads_; }
+  uint32_t healthCheckThreads() const override { return health_check_threads_; }
   const std::string& configPath() const override { return config_path_; }
   const std::string& configYaml() const override { return config_yaml_; }
   bool v2ConfigOnly() const override { return v2_config_only_; }
@@ -97,6 +105,8 @@ public:
 private:
   uint64_t base_id_;
   uint32_t concurrency_;
+  uint32_t private_key_threads_;
+  uint32_t health_check_threads_;
   std::string config_path_;
   std::string config_yaml_;
   bool v2_config_only_;
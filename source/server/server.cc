@@ -31,6 +31,7 @@
 #include "common/router/rds_impl.h"
 #include "common/runtime/runtime_impl.h"
 #include "common/singleton/manager_impl.h"
+#include "common/ssl/thread_pool_private_key_method.h"
 #include "common/stats/thread_local_store.h"
 #include "common/upstream/cluster_manager_impl.h"
 
@@ -251,6 +252,14 @@ void InstanceImpl::initialize(Options& options,
   listener_manager_.reset(new ListenerManagerImpl(
       *this, listener_component_factory_, worker_factory_, ProdSystemTimeSource::instance_));
 
+  // Health check threads register as restricted threads, which only receive the runtime and stats
+  // thread local data. Unlike workers they start running right away, since clusters wait for their
+  // initial health checks before workers are started.
+  if (options.healthCheckThreads() > 0) {
+    health_check_thread_pool_ = std::make_unique<Upstream::HealthCheckThreadPool>(
+        options.healthCheckThreads(), *api_, thread_local_);
+  }
+
   // The main thread is also registered for thread local updates so that code that does not care
   // whether it runs on the main thread or on workers can still use TLS.
   thread_local_.registerThread(*dispatcher_, true);
@@ -263,11 +272,17 @@ void InstanceImpl::initialize(Options& options,
   runtime_loader_ = component_factory.createRuntime(*this, initial_config);
 
   // Once we have runtime we can initialize the SSL context manager.
-  ssl_context_manager_.reset(new Ssl::ContextManagerImpl(*runtime_loader_));
+  Ssl::PrivateKeyMethodProviderSharedPtr private_key_method_provider;
+  if (options.privateKeyThreads() > 0) {
+    private_key_method_provider = std::make_shared<Ssl::ThreadPoolPrivateKeyMethodProvider>(
+        options.privateKeyThreads());
+  }
+  ssl_context_manager_.reset(
+      new Ssl::ContextManagerImpl(*runtime_loader_, private_key_method_provider));
 
   cluster_manager_factory_.reset(new Upstream::ProdClusterManagerFactory(
       runtime(), stats(), threadLocal(), random(), dnsResolver(), sslContextManager(), dispatcher(),
-      localInfo(), secretManager()));
+      localInfo(), secretManager(), health_check_thread_pool_.get()));
 
   // Now the configuration gets parsed. The configuration may start setting thread local data
   // per above. See MainImpl::initialize() for why we do this pointer dance.
@@ -443,6 +458,11 @@ void InstanceImpl::terminate() {
   if (config_.get() != nullptr && config_->clusterManager() != nullptr) {
     config_->clusterManager()->shutdown();
   }
+
+  // Health check sessions went away with the clusters.
+  if (health_check_thread_pool_) {
+    health_check_thread_pool_->shutdown();
+  }
   handler_.reset();
   thread_local_.shutdownThread();
   restarter_.shutdown();
@@ -22,6 +22,7 @@
 #include "common/runtime/runtime_impl.h"
 #include "common/secret/secret_manager_impl.h"
 #include "common/ssl/context_manager_impl.h"
+#include "common/upstream/health_check_thread_pool.h"
 #include "common/upstream/health_discovery_service.h"
 
 #include "server/http/admin.h"
@@ -206,6 +207,8 @@ private:
   ProdWorkerFactory worker_factory_;
   std::unique_ptr<ListenerManager> listener_manager_;
   std::unique_ptr<Secret::SecretManager> secret_manager_;
+  // Declared before config_ so that the threads outlive the health checkers of the clusters.
+  Upstream::HealthCheckThreadPoolPtr health_check_thread_pool_;
   std::unique_ptr<Configuration::Main> config_;
   Network::DnsResolverSharedPtr dns_resolver_;
   Event::TimerPtr stat_flush_timer_;
@@ -0,0 +1,77 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Compares replaying a large request body for retries and shadowing by copying it into a new
+// buffer each time against referencing the slices of a SharedSliceBuffer. The bytes_copied counter
+// reports the bytes of body data allocated per iteration, on top of the initial receive buffer.
+
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/buffer/shared_slice_buffer.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+
+// Receive a body of state.range(0) bytes in 16KB chunks and send it state.range(1) times, as a
+// request with that many attempts would.
+static void BM_ReplayBodyCopy(benchmark::State& state) {
+  const std::string chunk(16384, 'a');
+  const uint64_t body_size = state.range(0);
+  const int64_t attempts = state.range(1);
+  uint64_t bytes_copied = 0;
+  for (auto _ : state) {
+    // The body is buffered as received and each attempt encodes a full copy of it.
+    Buffer::OwnedImpl body;
+    for (uint64_t received = 0; received < body_size; received += chunk.size()) {
+      Buffer::OwnedImpl data(chunk);
+      Buffer::OwnedImpl copy(data);
+      body.move(data);
+      bytes_copied += copy.length();
+    }
+    for (int64_t attempt = 1; attempt < attempts; attempt++) {
+      Buffer::OwnedImpl copy(body);
+      bytes_copied += copy.length();
+      benchmark::DoNotOptimize(copy.length());
+    }
+  }
+  state.counters["bytes_copied"] =
+      benchmark::Counter(bytes_copied / state.iterations(), benchmark::Counter::kDefaults);
+}
+BENCHMARK(BM_ReplayBodyCopy)->Args({10 << 20, 1})->Args({10 << 20, 3})->Args({10 << 20, 5});
+
+static void BM_ReplayBodyShared(benchmark::State& state) {
+  const std::string chunk(16384, 'a');
+  const uint64_t body_size = state.range(0);
+  const int64_t attempts = state.range(1);
+  uint64_t bytes_copied = 0;
+  for (auto _ : state) {
+    // The body is copied into immutable slices once and each attempt references them.
+    Buffer::SharedSliceBuffer body;
+    for (uint64_t received = 0; received < body_size; received += chunk.size()) {
+      Buffer::OwnedImpl data(chunk);
+      body.add(data);
+      bytes_copied += data.length();
+    }
+    for (int64_t attempt = 1; attempt < attempts; attempt++) {
+      Buffer::OwnedImpl copy;
+      body.addTo(copy);
+      benchmark::DoNotOptimize(copy.length());
+    }
+  }
+  state.counters["bytes_copied"] =
+      benchmark::Counter(bytes_copied / state.iterations(), benchmark::Counter::kDefaults);
+}
+BENCHMARK(BM_ReplayBodyShared)->Args({10 << 20, 1})->Args({10 << 20, 3})->Args({10 << 20, 5});
+
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
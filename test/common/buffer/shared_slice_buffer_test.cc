@@ -0,0 +1,76 @@
+#include <memory>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/buffer/shared_slice_buffer.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+TEST(SharedSliceBufferTest, AddDoesNotModifySource) {
+  SharedSliceBuffer shared;
+  OwnedImpl data("hello");
+  shared.add(data);
+  EXPECT_EQ(5, shared.length());
+  EXPECT_EQ("hello", data.toString());
+}
+
+TEST(SharedSliceBufferTest, EmptyAdd) {
+  SharedSliceBuffer shared;
+  OwnedImpl data;
+  shared.add(data);
+  EXPECT_EQ(0, shared.length());
+
+  OwnedImpl out;
+  shared.addTo(out);
+  EXPECT_EQ(0, out.length());
+}
+
+TEST(SharedSliceBufferTest, AddToMultipleBuffers) {
+  SharedSliceBuffer shared;
+  OwnedImpl part1("hello ");
+  OwnedImpl part2("world");
+  shared.add(part1);
+  shared.add(part2);
+  EXPECT_EQ(11, shared.length());
+
+  OwnedImpl out1;
+  OwnedImpl out2("> ");
+  shared.addTo(out1);
+  shared.addTo(out2);
+  EXPECT_EQ("hello world", out1.toString());
+  EXPECT_EQ("> hello world", out2.toString());
+
+  // Draining one buffer does not affect the other or the shared slices.
+  out1.drain(out1.length());
+  EXPECT_EQ("> hello world", out2.toString());
+  OwnedImpl out3;
+  shared.addTo(out3);
+  EXPECT_EQ("hello world", out3.toString());
+}
+
+TEST(SharedSliceBufferTest, ReferencesOutliveClear) {
+  std::unique_ptr<SharedSliceBuffer> shared(new SharedSliceBuffer());
+  OwnedImpl data("hello");
+  shared->add(data);
+
+  OwnedImpl out;
+  shared->addTo(out);
+  shared->clear();
+  EXPECT_EQ(0, shared->length());
+  shared.reset();
+
+  // The buffer still holds a reference to the slice.
+  EXPECT_EQ("hello", out.toString());
+
+  // Moving the references into another buffer keeps them alive as well.
+  OwnedImpl moved;
+  moved.move(out);
+  EXPECT_EQ("hello", moved.toString());
+}
+
+} // namespace
+} // namespace Buffer
+} // namespace Envoy
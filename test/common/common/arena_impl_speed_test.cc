@@ -0,0 +1,72 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Compares constructing a per-stream filter chain (a wrapper and a shared filter per filter) on
+// the heap with constructing it in a stream owned arena, as the HTTP connection manager does for
+// each new stream.
+
+#include <list>
+#include <memory>
+
+#include "common/common/arena_impl.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+
+// Stand-ins for a stream filter and the connection manager wrapper that holds it.
+struct Filter {
+  char state_[192];
+};
+
+struct Wrapper {
+  Wrapper(std::shared_ptr<Filter> filter) : filter_(filter) {}
+
+  std::shared_ptr<Filter> filter_;
+  char state_[48];
+};
+
+static void BM_FilterChainHeap(benchmark::State& state) {
+  for (auto _ : state) {
+    std::list<std::unique_ptr<Wrapper>> chain;
+    for (int64_t i = 0; i < state.range(0); i++) {
+      chain.emplace_back(new Wrapper(std::make_shared<Filter>()));
+    }
+    benchmark::DoNotOptimize(chain.size());
+  }
+}
+BENCHMARK(BM_FilterChainHeap)->Arg(1)->Arg(5)->Arg(10);
+
+struct ArenaWrapper : public Wrapper {
+  using Wrapper::Wrapper;
+
+  static void* operator new(size_t size, Arena& arena) {
+    return arena.allocate(size, alignof(std::max_align_t));
+  }
+  static void operator delete(void*, Arena&) {}
+  static void operator delete(void*) {}
+};
+
+static void BM_FilterChainArena(benchmark::State& state) {
+  for (auto _ : state) {
+    InlineArenaImpl<1024> arena(4096);
+    std::list<std::unique_ptr<ArenaWrapper>> chain;
+    for (int64_t i = 0; i < state.range(0); i++) {
+      chain.emplace_back(new (arena) ArenaWrapper(makeArenaShared<Filter>(arena)));
+    }
+    benchmark::DoNotOptimize(chain.size());
+    state.counters["heap_blocks"] = arena.heapBlocks();
+  }
+}
+BENCHMARK(BM_FilterChainArena)->Arg(1)->Arg(5)->Arg(10);
+
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
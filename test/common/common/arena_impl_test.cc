@@ -0,0 +1,87 @@
+#include <cstdint>
+#include <memory>
+
+#include "common/common/arena_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+
+bool isAligned(void* ptr, size_t alignment) {
+  return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+TEST(ArenaImplTest, Alignment) {
+  ArenaImpl arena(64);
+
+  void* a = arena.allocate(1, 1);
+  void* b = arena.allocate(8, 8);
+  void* c = arena.allocate(3, 2);
+  void* d = arena.allocate(16, alignof(std::max_align_t));
+  EXPECT_TRUE(isAligned(b, 8));
+  EXPECT_TRUE(isAligned(c, 2));
+  EXPECT_TRUE(isAligned(d, alignof(std::max_align_t)));
+  EXPECT_LT(a, b);
+  EXPECT_LT(b, c);
+  EXPECT_EQ(1U, arena.heapBlocks());
+}
+
+TEST(ArenaImplTest, HeapBlocks) {
+  ArenaImpl arena(64);
+  EXPECT_EQ(0U, arena.heapBlocks());
+
+  arena.allocate(48, 8);
+  EXPECT_EQ(1U, arena.heapBlocks());
+  arena.allocate(16, 8);
+  EXPECT_EQ(1U, arena.heapBlocks());
+
+  // The current block is exhausted.
+  arena.allocate(1, 1);
+  EXPECT_EQ(2U, arena.heapBlocks());
+
+  // Allocations larger than the block size get a block of their own.
+  char* large = static_cast<char*>(arena.allocate(1000, 8));
+  large[999] = 'a';
+  EXPECT_EQ(3U, arena.heapBlocks());
+}
+
+TEST(ArenaImplTest, Inline) {
+  InlineArenaImpl<128> arena(64);
+
+  arena.allocate(100, 8);
+  arena.allocate(28, 1);
+  EXPECT_EQ(0U, arena.heapBlocks());
+
+  arena.allocate(1, 1);
+  EXPECT_EQ(1U, arena.heapBlocks());
+}
+
+class Counted {
+public:
+  Counted(uint32_t& destroyed) : destroyed_(destroyed) {}
+  ~Counted() { destroyed_++; }
+
+private:
+  uint32_t& destroyed_;
+};
+
+// Objects constructed with makeArenaShared() are destroyed when their last reference goes away,
+// even though their memory is released with the arena.
+TEST(ArenaImplTest, MakeArenaShared) {
+  InlineArenaImpl<256> arena(256);
+  uint32_t destroyed = 0;
+
+  std::shared_ptr<Counted> first = makeArenaShared<Counted>(arena, destroyed);
+  std::shared_ptr<Counted> second = makeArenaShared<Counted>(arena, destroyed);
+  std::shared_ptr<Counted> copy = first;
+  EXPECT_EQ(0U, arena.heapBlocks());
+
+  first.reset();
+  EXPECT_EQ(0U, destroyed);
+  copy.reset();
+  EXPECT_EQ(1U, destroyed);
+  second.reset();
+  EXPECT_EQ(2U, destroyed);
+}
+
+} // namespace Envoy
@@ -0,0 +1,192 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "common/common/concurrent_token_bucket_impl.h"
+
+#include "test/mocks/common.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::ReturnPointee;
+
+namespace Envoy {
+
+class ConcurrentTokenBucketImplTest : public testing::Test {
+public:
+  ConcurrentTokenBucketImplTest() {
+    ON_CALL(time_source_, currentTime()).WillByDefault(ReturnPointee(&time_));
+  }
+
+  // Consumes single tokens from threads until the bucket is empty. Returns the tokens consumed.
+  static uint64_t drain(TokenBucket& bucket, uint32_t threads) {
+    std::atomic<uint64_t> consumed{0};
+    std::vector<std::thread> workers;
+    for (uint32_t i = 0; i < threads; ++i) {
+      workers.emplace_back([&bucket, &consumed]() -> void {
+        while (bucket.consume()) {
+          ++consumed;
+        }
+      });
+    }
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+    return consumed;
+  }
+
+protected:
+  MonotonicTime time_;
+  NiceMock<MockMonotonicTimeSource> time_source_;
+};
+
+// Verifies ConcurrentTokenBucketImpl initialization.
+TEST_F(ConcurrentTokenBucketImplTest, Initialization) {
+  ConcurrentTokenBucketImpl token_bucket{1, -1.0, time_source_};
+
+  EXPECT_TRUE(token_bucket.consume());
+  EXPECT_FALSE(token_bucket.consume());
+}
+
+// Verifies ConcurrentTokenBucketImpl's maximum capacity.
+TEST_F(ConcurrentTokenBucketImplTest, MaxBucketSize) {
+  ConcurrentTokenBucketImpl token_bucket{3, 1, time_source_};
+
+  EXPECT_TRUE(token_bucket.consume(3));
+  time_ += std::chrono::seconds(10);
+  EXPECT_FALSE(token_bucket.consume(4));
+  EXPECT_TRUE(token_bucket.consume(3));
+}
+
+// Verifies that ConcurrentTokenBucketImpl can consume and refill tokens.
+TEST_F(ConcurrentTokenBucketImplTest, ConsumeAndRefill) {
+  ConcurrentTokenBucketImpl token_bucket{10, 1, time_source_};
+
+  EXPECT_FALSE(token_bucket.consume(20));
+  EXPECT_TRUE(token_bucket.consume(9));
+  EXPECT_TRUE(token_bucket.consume());
+  EXPECT_FALSE(token_bucket.consume());
+
+  time_ += std::chrono::milliseconds(999);
+  EXPECT_FALSE(token_bucket.consume());
+
+  time_ += std::chrono::milliseconds(5000);
+  EXPECT_TRUE(token_bucket.consume(5));
+  EXPECT_FALSE(token_bucket.consume());
+
+  time_ += std::chrono::milliseconds(1);
+  EXPECT_TRUE(token_bucket.consume());
+}
+
+// A bucket with no fill rate keeps its initial tokens only.
+TEST_F(ConcurrentTokenBucketImplTest, NoFill) {
+  ConcurrentTokenBucketImpl token_bucket{2, 0, time_source_};
+
+  EXPECT_TRUE(token_bucket.consume(2));
+  time_ += std::chrono::hours(1);
+  EXPECT_FALSE(token_bucket.consume());
+}
+
+// Tokens can be taken out of the bucket and returned, up to its maximum.
+TEST_F(ConcurrentTokenBucketImplTest, TakeAndGive) {
+  ConcurrentTokenBucketImpl token_bucket{10, 1, time_source_};
+
+  EXPECT_EQ(4UL, token_bucket.take(4));
+  EXPECT_EQ(6UL, token_bucket.tokens());
+  EXPECT_EQ(4UL, token_bucket.give(10));
+  EXPECT_EQ(10UL, token_bucket.tokens());
+  EXPECT_EQ(10UL, token_bucket.take(20));
+  EXPECT_EQ(0UL, token_bucket.take(1));
+  EXPECT_EQ(3UL, token_bucket.give(3));
+  EXPECT_EQ(3UL, token_bucket.tokens());
+
+  time_ += std::chrono::seconds(2);
+  EXPECT_EQ(5UL, token_bucket.tokens());
+}
+
+// Threads consuming concurrently never get more tokens than the bucket holds.
+TEST_F(ConcurrentTokenBucketImplTest, ConcurrentConsume) {
+  ConcurrentTokenBucketImpl token_bucket{100000, 0};
+
+  EXPECT_EQ(100000UL, drain(token_bucket, 4));
+}
+
+// The shards hold the tokens of the bucket together.
+TEST_F(ConcurrentTokenBucketImplTest, ShardedConsume) {
+  ShardedTokenBucketImpl token_bucket{5, 0, 2, std::chrono::milliseconds(100), time_source_};
+
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(token_bucket.consume());
+  }
+  EXPECT_FALSE(token_bucket.consume());
+}
+
+// A consume starts at the given shard, taken modulo the number of shards.
+TEST_F(ConcurrentTokenBucketImplTest, ShardedConsumeFromShard) {
+  ShardedTokenBucketImpl token_bucket{4, 0, 2, std::chrono::milliseconds(100), time_source_};
+
+  EXPECT_TRUE(token_bucket.consume(2, 0));
+  // Starts at the empty shard 0, which then takes one of the two tokens of shard 1.
+  EXPECT_FALSE(token_bucket.consume(2, 2));
+  EXPECT_TRUE(token_bucket.consume(1, 0));
+  EXPECT_TRUE(token_bucket.consume(1, 1));
+  EXPECT_FALSE(token_bucket.consume(1, 1));
+}
+
+// The shards fill in proportion to their share of the tokens.
+TEST_F(ConcurrentTokenBucketImplTest, ShardedCap) {
+  ShardedTokenBucketImpl token_bucket{4, 1, 2, std::chrono::milliseconds(100), time_source_};
+
+  EXPECT_EQ(0U, token_bucket.cap(4));
+  EXPECT_EQ(3U, token_bucket.cap(1));
+  EXPECT_TRUE(token_bucket.consume(1, 0));
+  EXPECT_FALSE(token_bucket.consume(1, 0));
+
+  // The bucket fills again at its rate, a token per shard every two seconds.
+  time_ += std::chrono::seconds(2);
+  EXPECT_TRUE(token_bucket.consume(1, 0));
+  EXPECT_TRUE(token_bucket.consume(1, 0));
+  EXPECT_FALSE(token_bucket.consume(1, 0));
+}
+
+TEST_F(ConcurrentTokenBucketImplTest, ShardedRefill) {
+  ShardedTokenBucketImpl token_bucket{4, 4, 2, std::chrono::milliseconds(100), time_source_};
+
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(token_bucket.consume());
+  }
+  EXPECT_FALSE(token_bucket.consume());
+
+  time_ += std::chrono::milliseconds(500);
+  EXPECT_TRUE(token_bucket.consume());
+  EXPECT_TRUE(token_bucket.consume());
+  EXPECT_FALSE(token_bucket.consume());
+}
+
+// Rebalancing moves the tokens between the shards without adding or losing any.
+TEST_F(ConcurrentTokenBucketImplTest, ShardedRebalance) {
+  ShardedTokenBucketImpl token_bucket{8, 0, 2, std::chrono::milliseconds(100), time_source_};
+
+  // Empties the shard of this thread, which gets half of the other one's tokens when it runs out.
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_TRUE(token_bucket.consume());
+  }
+  token_bucket.rebalance();
+  // The shard of this thread got one of the two tokens left, so a consume of both fails.
+  EXPECT_FALSE(token_bucket.consume(2));
+  EXPECT_TRUE(token_bucket.consume());
+  EXPECT_TRUE(token_bucket.consume());
+  EXPECT_FALSE(token_bucket.consume());
+}
+
+// Threads consuming concurrently from their shards never get more tokens than the bucket holds.
+TEST_F(ConcurrentTokenBucketImplTest, ShardedConcurrentConsume) {
+  ShardedTokenBucketImpl token_bucket{100000, 0, 4};
+
+  EXPECT_EQ(100000UL, drain(token_bucket, 4));
+}
+
+} // namespace Envoy
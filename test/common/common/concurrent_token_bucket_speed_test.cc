@@ -0,0 +1,90 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Measures the cost of a consume() from a token bucket that many threads share: a TokenBucketImpl
+// behind a mutex, a ConcurrentTokenBucketImpl, and a ShardedTokenBucketImpl with a shard per
+// thread. The buckets fill faster than the threads consume, so that every consume succeeds and
+// only the contention on the bucket is measured.
+
+#include <memory>
+
+#include "common/common/assert.h"
+#include "common/common/concurrent_token_bucket_impl.h"
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+#include "common/common/token_bucket_impl.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+
+static const uint64_t MaxTokens = 1000000;
+static const double FillRate = 1e9;
+
+// TokenBucketImpl is not thread safe, so the threads take turns with it.
+class LockedTokenBucket : public TokenBucket {
+public:
+  bool consume(uint64_t tokens) override {
+    Thread::LockGuard lock(mutex_);
+    return bucket_.consume(tokens);
+  }
+
+private:
+  Thread::MutexBasicLockable mutex_;
+  TokenBucketImpl bucket_{MaxTokens, FillRate};
+};
+
+// Shared by the threads of a benchmark, and created and destroyed by its first thread.
+static std::unique_ptr<TokenBucket> bucket;
+
+static void consumeLoop(benchmark::State& state) {
+  uint64_t consumed = 0;
+  for (auto _ : state) {
+    consumed += bucket->consume(1);
+  }
+  RELEASE_ASSERT(consumed > 0, "");
+}
+
+static void BM_LockedTokenBucket(benchmark::State& state) {
+  if (state.thread_index == 0) {
+    bucket = std::make_unique<LockedTokenBucket>();
+  }
+  consumeLoop(state);
+  if (state.thread_index == 0) {
+    bucket.reset();
+  }
+}
+BENCHMARK(BM_LockedTokenBucket)->Threads(1)->Threads(4)->Threads(8)->UseRealTime();
+
+static void BM_ConcurrentTokenBucket(benchmark::State& state) {
+  if (state.thread_index == 0) {
+    bucket = std::make_unique<ConcurrentTokenBucketImpl>(MaxTokens, FillRate);
+  }
+  consumeLoop(state);
+  if (state.thread_index == 0) {
+    bucket.reset();
+  }
+}
+BENCHMARK(BM_ConcurrentTokenBucket)->Threads(1)->Threads(4)->Threads(8)->UseRealTime();
+
+static void BM_ShardedTokenBucket(benchmark::State& state) {
+  if (state.thread_index == 0) {
+    bucket = std::make_unique<ShardedTokenBucketImpl>(MaxTokens, FillRate, state.threads);
+  }
+  consumeLoop(state);
+  if (state.thread_index == 0) {
+    bucket.reset();
+  }
+}
+BENCHMARK(BM_ShardedTokenBucket)->Threads(1)->Threads(4)->Threads(8)->UseRealTime();
+
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
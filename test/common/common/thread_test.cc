@@ -0,0 +1,46 @@
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "common/common/thread.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Thread {
+
+TEST(ParallelForTest, Serial) {
+  std::vector<size_t> order;
+  const ThreadId thread_id = Thread::currentThreadId();
+  parallelFor(4, 1, [&order, thread_id](size_t i) -> void {
+    EXPECT_EQ(thread_id, Thread::currentThreadId());
+    order.push_back(i);
+  });
+  EXPECT_EQ(std::vector<size_t>({0, 1, 2, 3}), order);
+
+  parallelFor(0, 4, [](size_t) -> void { FAIL(); });
+}
+
+TEST(ParallelForTest, EachIndexOnce) {
+  std::vector<std::atomic<uint32_t>> calls(1000);
+  parallelFor(calls.size(), 4, [&calls](size_t i) -> void { calls[i]++; });
+  for (const auto& count : calls) {
+    EXPECT_EQ(1, count);
+  }
+}
+
+TEST(ParallelForTest, RethrowsOnCallingThread) {
+  std::atomic<uint32_t> calls{0};
+  EXPECT_THROW(parallelFor(1000, 4,
+                          [&calls](size_t i) -> void {
+                            calls++;
+                            if (i == 10) {
+                              throw std::runtime_error("bad index");
+                            }
+                          }),
+               std::runtime_error);
+  EXPECT_LE(calls, 1000);
+}
+
+} // namespace Thread
+} // namespace Envoy
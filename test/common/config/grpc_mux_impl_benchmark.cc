@@ -0,0 +1,137 @@
+// Usage: bazel run //test/common/config:grpc_mux_impl_benchmark
+//
+// Measures the cost of handling an EDS update over ADS in which one of many cluster load
+// assignments changed, in state of the world and incremental mode. A mock gRPC stream stands in
+// for the management server. Delivered resources are parsed the way GrpcMuxSubscriptionImpl does.
+
+#include "envoy/api/v2/discovery.pb.h"
+#include "envoy/api/v2/eds.pb.h"
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/config/grpc_mux_impl.h"
+#include "common/config/protobuf_link_hacks.h"
+#include "common/config/resources.h"
+#include "common/protobuf/utility.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/grpc/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+
+#include "testing/base/public/benchmark.h"
+
+using testing::NiceMock;
+using testing::Return;
+using testing::_;
+
+namespace Envoy {
+namespace Config {
+namespace {
+
+class ParsingCallbacks : public GrpcMuxCallbacks {
+public:
+  // Config::GrpcMuxCallbacks
+  void onConfigUpdate(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
+                      const std::string&) override {
+    parse(resources);
+  }
+  void onConfigUpdate(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& added_resources,
+                      const Protobuf::RepeatedPtrField<std::string>&, const std::string&) override {
+    parse(added_resources);
+  }
+  void onConfigUpdateFailed(const EnvoyException*) override {}
+  std::string resourceName(const ProtobufWkt::Any& resource) override {
+    return MessageUtil::anyConvert<envoy::api::v2::ClusterLoadAssignment>(resource).cluster_name();
+  }
+
+private:
+  void parse(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources) {
+    for (const auto& resource : resources) {
+      auto assignment = MessageUtil::anyConvert<envoy::api::v2::ClusterLoadAssignment>(resource);
+      benchmark::DoNotOptimize(assignment);
+    }
+  }
+};
+
+envoy::api::v2::ClusterLoadAssignment makeAssignment(uint64_t index, uint32_t generation) {
+  envoy::api::v2::ClusterLoadAssignment assignment;
+  assignment.set_cluster_name(fmt::format("cluster_{}", index));
+  auto* locality_lb_endpoints = assignment.add_endpoints();
+  locality_lb_endpoints->set_priority(generation);
+  for (uint32_t i = 0; i < 4; i++) {
+    auto* socket_address = locality_lb_endpoints->add_lb_endpoints()
+                               ->mutable_endpoint()
+                               ->mutable_address()
+                               ->mutable_socket_address();
+    socket_address->set_address(fmt::format("10.{}.{}.{}", index / 65536 % 256, index / 256 % 256,
+                                            index % 256));
+    socket_address->set_port_value(8000 + i);
+  }
+  return assignment;
+}
+
+void updateOneOfMany(benchmark::State& state, bool incremental) {
+  const uint64_t num_assignments = state.range(0);
+  NiceMock<Event::MockDispatcher> dispatcher;
+  NiceMock<Runtime::MockRandomGenerator> random;
+  NiceMock<MockMonotonicTimeSource> time_source;
+  auto* async_client = new NiceMock<Grpc::MockAsyncClient>();
+  NiceMock<Grpc::MockAsyncStream> async_stream;
+  ON_CALL(*async_client, start(_, _)).WillByDefault(Return(&async_stream));
+  GrpcMuxImpl grpc_mux(
+      envoy::api::v2::core::Node(), Grpc::AsyncClientPtr(async_client), dispatcher,
+      *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
+          "envoy.service.discovery.v2.AggregatedDiscoveryService.StreamAggregatedResources"),
+      random, time_source, incremental);
+
+  // One watch per cluster, as EDS clusters have.
+  const std::string& type_url = TypeUrl::get().ClusterLoadAssignment;
+  ParsingCallbacks callbacks;
+  std::vector<GrpcMuxWatchPtr> watches;
+  for (uint64_t i = 0; i < num_assignments; i++) {
+    watches.emplace_back(grpc_mux.subscribe(type_url, {fmt::format("cluster_{}", i)}, callbacks));
+  }
+  grpc_mux.start();
+
+  envoy::api::v2::DiscoveryResponse response;
+  response.set_type_url(type_url);
+  for (uint64_t i = 0; i < num_assignments; i++) {
+    response.add_resources()->PackFrom(makeAssignment(i, 0));
+  }
+  grpc_mux.onReceiveMessage(std::make_unique<envoy::api::v2::DiscoveryResponse>(response));
+
+  uint32_t generation = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    const uint64_t index = generation % num_assignments;
+    response.mutable_resources(index)->PackFrom(makeAssignment(index, ++generation));
+    auto message = std::make_unique<envoy::api::v2::DiscoveryResponse>(response);
+    state.ResumeTiming();
+
+    grpc_mux.onReceiveMessage(std::move(message));
+  }
+}
+
+void BM_StateOfTheWorldUpdate(benchmark::State& state) { updateOneOfMany(state, false); }
+BENCHMARK(BM_StateOfTheWorldUpdate)->Arg(1000)->Arg(20000)->Unit(benchmark::kMillisecond);
+
+void BM_IncrementalUpdate(benchmark::State& state) { updateOneOfMany(state, true); }
+BENCHMARK(BM_IncrementalUpdate)->Arg(1000)->Arg(20000)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace Config
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Registry::initialize(spdlog::level::warn,
+                                      Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -33,7 +33,7 @@ namespace {
 // is provided in [grpc_]subscription_impl_test.cc.
 class GrpcMuxImplTest : public testing::Test {
 public:
-  GrpcMuxImplTest()
+  GrpcMuxImplTest(bool incremental = false)
       : async_client_(new Grpc::MockAsyncClient()), timer_(new Event::MockTimer()), time_source_{} {
     EXPECT_CALL(dispatcher_, createTimer_(_)).WillOnce(Invoke([this](Event::TimerCb timer_cb) {
       timer_cb_ = timer_cb;
@@ -45,7 +45,7 @@ public:
         dispatcher_,
         *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
             "envoy.service.discovery.v2.AggregatedDiscoveryService.StreamAggregatedResources"),
-        random_, time_source_));
+        random_, time_source_, incremental));
   }
 
   void expectSendMessage(const std::string& type_url,
@@ -402,6 +402,132 @@ TEST_F(GrpcMuxImplTest, UnwatchedTypeRejectsResources) {
                       grpc_mux_->onReceiveMessage(std::move(response)));
 }
 
+class GrpcMuxImplIncrementalTest : public GrpcMuxImplTest {
+public:
+  GrpcMuxImplIncrementalTest() : GrpcMuxImplTest(true) {}
+
+  void onReceiveAssignments(const std::string& version,
+                            const std::vector<envoy::api::v2::ClusterLoadAssignment>& assignments) {
+    std::unique_ptr<envoy::api::v2::DiscoveryResponse> response(
+        new envoy::api::v2::DiscoveryResponse());
+    response->set_type_url(Config::TypeUrl::get().ClusterLoadAssignment);
+    response->set_version_info(version);
+    for (const auto& assignment : assignments) {
+      response->add_resources()->PackFrom(assignment);
+    }
+    grpc_mux_->onReceiveMessage(std::move(response));
+  }
+
+  static std::vector<std::string>
+  names(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& added_resources) {
+    std::vector<std::string> names;
+    for (const auto& resource : added_resources) {
+      names.push_back(MessageUtil::anyConvert<envoy::api::v2::ClusterLoadAssignment>(resource)
+                          .cluster_name());
+    }
+    return names;
+  }
+};
+
+// Validate that a wildcard watch is only handed resources that changed, and the names of those that
+// are gone, and that unchanged resources are not parsed for their name again.
+TEST_F(GrpcMuxImplIncrementalTest, WildcardWatch) {
+  InSequence s;
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  auto foo_sub = grpc_mux_->subscribe(type_url, {}, callbacks_);
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {}, "");
+  grpc_mux_->start();
+
+  envoy::api::v2::ClusterLoadAssignment x;
+  x.set_cluster_name("x");
+  envoy::api::v2::ClusterLoadAssignment y;
+  y.set_cluster_name("y");
+
+  EXPECT_CALL(callbacks_, resourceName(_)).Times(2);
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, _, "1"))
+      .WillOnce(Invoke([](const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& added_resources,
+                          const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+                          const std::string&) {
+        EXPECT_THAT(names(added_resources), testing::UnorderedElementsAre("x", "y"));
+        EXPECT_TRUE(removed_resources.empty());
+      }));
+  expectSendMessage(type_url, {}, "1");
+  onReceiveAssignments("1", {x, y});
+
+  y.add_endpoints()->set_priority(1);
+  EXPECT_CALL(callbacks_, resourceName(_));
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, _, "2"))
+      .WillOnce(Invoke([](const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& added_resources,
+                          const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+                          const std::string&) {
+        EXPECT_THAT(names(added_resources), testing::ElementsAre("y"));
+        EXPECT_TRUE(removed_resources.empty());
+      }));
+  expectSendMessage(type_url, {}, "2");
+  onReceiveAssignments("2", {x, y});
+
+  EXPECT_CALL(callbacks_, resourceName(_)).Times(0);
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, _, "3"))
+      .WillOnce(Invoke([](const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& added_resources,
+                          const Protobuf::RepeatedPtrField<std::string>& removed_resources,
+                          const std::string&) {
+        EXPECT_TRUE(added_resources.empty());
+        EXPECT_THAT(removed_resources, testing::ElementsAre("y"));
+      }));
+  expectSendMessage(type_url, {}, "3");
+  onReceiveAssignments("3", {x});
+
+  // Nothing changed, the watch is not called but the version is still acknowledged.
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, _, _)).Times(0);
+  expectSendMessage(type_url, {}, "4");
+  onReceiveAssignments("4", {x});
+}
+
+// Validate that watches on named resources are only called when one of their resources changes.
+TEST_F(GrpcMuxImplIncrementalTest, WatchDemux) {
+  InSequence s;
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  NiceMock<MockGrpcMuxCallbacks> foo_callbacks;
+  auto foo_sub = grpc_mux_->subscribe(type_url, {"x"}, foo_callbacks);
+  NiceMock<MockGrpcMuxCallbacks> bar_callbacks;
+  auto bar_sub = grpc_mux_->subscribe(type_url, {"y"}, bar_callbacks);
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {"y", "x"}, "");
+  grpc_mux_->start();
+
+  envoy::api::v2::ClusterLoadAssignment x;
+  x.set_cluster_name("x");
+  envoy::api::v2::ClusterLoadAssignment y;
+  y.set_cluster_name("y");
+
+  // The first update is delivered to every watch, even if it has none of their resources.
+  EXPECT_CALL(bar_callbacks, onConfigUpdate(_, _, "1"))
+      .WillOnce(Invoke([](const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& added_resources,
+                          const Protobuf::RepeatedPtrField<std::string>&, const std::string&) {
+        EXPECT_TRUE(added_resources.empty());
+      }));
+  EXPECT_CALL(foo_callbacks, onConfigUpdate(_, _, "1"))
+      .WillOnce(Invoke([](const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& added_resources,
+                          const Protobuf::RepeatedPtrField<std::string>&, const std::string&) {
+        EXPECT_THAT(names(added_resources), testing::ElementsAre("x"));
+      }));
+  expectSendMessage(type_url, {"y", "x"}, "1");
+  onReceiveAssignments("1", {x});
+
+  EXPECT_CALL(bar_callbacks, onConfigUpdate(_, _, "2"))
+      .WillOnce(Invoke([](const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& added_resources,
+                          const Protobuf::RepeatedPtrField<std::string>&, const std::string&) {
+        EXPECT_THAT(names(added_resources), testing::ElementsAre("y"));
+      }));
+  EXPECT_CALL(foo_callbacks, onConfigUpdate(_, _, _)).Times(0);
+  expectSendMessage(type_url, {"y", "x"}, "2");
+  onReceiveAssignments("2", {x, y});
+
+  expectSendMessage(type_url, {"x"}, "2");
+  expectSendMessage(type_url, {}, "2");
+}
+
 } // namespace
 } // namespace Config
 } // namespace Envoy
@@ -12,6 +12,7 @@
 #include "common/access_log/access_log_formatter.h"
 #include "common/access_log/access_log_impl.h"
 #include "common/buffer/buffer_impl.h"
+#include "common/common/arena_impl.h"
 #include "common/common/empty_string.h"
 #include "common/common/macros.h"
 #include "common/http/conn_manager_impl.h"
@@ -36,6 +37,7 @@
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/mocks.h"
 #include "test/mocks/ssl/mocks.h"
+#include "test/mocks/tcp/mocks.h"
 #include "test/mocks/tracing/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/printers.h"
@@ -379,6 +381,42 @@ TEST_F(HttpConnectionManagerImplTest, HeaderOnlyRequestAndResponse) {
   EXPECT_EQ(1U, listener_stats_.downstream_rq_2xx_.value());
 }
 
+// Filters may be constructed in the stream's arena, in which case they are destroyed along with
+// the stream like any other filter.
+TEST_F(HttpConnectionManagerImplTest, ArenaAllocatedFilter) {
+  setup(false, "envoy-custom-server", false);
+
+  MockStreamDecoderFilter* filter = nullptr;
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillOnce(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> void {
+        auto arena_filter = makeArenaShared<NiceMock<MockStreamDecoderFilter>>(callbacks.arena());
+        filter = arena_filter.get();
+        EXPECT_CALL(*filter, decodeHeaders(_, true))
+            .WillOnce(Return(FilterHeadersStatus::StopIteration));
+        EXPECT_CALL(*filter, onDestroy());
+        callbacks.addStreamDecoderFilter(arena_filter);
+      }));
+
+  EXPECT_CALL(filter_callbacks_.connection_.dispatcher_, deferredDelete_(_));
+
+  StreamDecoder* decoder = nullptr;
+  NiceMock<MockStreamEncoder> encoder;
+  EXPECT_CALL(*codec_, dispatch(_)).WillOnce(Invoke([&](Buffer::Instance& data) -> void {
+    decoder = &conn_manager_->newStream(encoder);
+    HeaderMapPtr headers{new TestHeaderMapImpl{{":authority", "host"}, {":path", "/"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+
+    HeaderMapPtr response_headers{new TestHeaderMapImpl{{":status", "200"}}};
+    filter->callbacks_->encodeHeaders(std::move(response_headers), true);
+    data.drain(4);
+  }));
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+
+  EXPECT_EQ(1U, stats_.named_.downstream_rq_2xx_.value());
+}
+
 TEST_F(HttpConnectionManagerImplTest, 100ContinueResponse) {
   proxy_100_continue_ = true;
   setup(false, "envoy-custom-server", false);
@@ -1163,8 +1201,7 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketNoThreadLocalCluster) {
 TEST_F(HttpConnectionManagerImplTest, WebSocketNoConnInPool) {
   setup(false, "");
 
-  Upstream::MockHost::MockCreateConnectionData conn_info;
-  EXPECT_CALL(cluster_manager_, tcpConnForCluster_(_, _)).WillOnce(Return(conn_info));
+  EXPECT_CALL(cluster_manager_, tcpConnPoolForCluster(_, _, _)).WillOnce(Return(nullptr));
 
   expectOnUpstreamInitFailure();
   EXPECT_EQ(1U, stats_.named_.downstream_cx_websocket_active_.value());
@@ -1179,8 +1216,7 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketNoConnInPool) {
 TEST_F(HttpConnectionManagerImplTest, WebSocketDataAfterConnectFail) {
   setup(false, "");
 
-  Upstream::MockHost::MockCreateConnectionData conn_info;
-  EXPECT_CALL(cluster_manager_, tcpConnForCluster_(_, _)).WillOnce(Return(conn_info));
+  EXPECT_CALL(cluster_manager_, tcpConnPoolForCluster(_, _, _)).WillOnce(Return(nullptr));
 
   expectOnUpstreamInitFailure();
   EXPECT_EQ(1U, stats_.named_.downstream_cx_websocket_active_.value());
@@ -1206,13 +1242,14 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketMetadataMatch) {
       .WillByDefault(Return(
           &route_config_provider_.route_config_->route_->route_entry_.metadata_matches_criteria_));
 
-  EXPECT_CALL(cluster_manager_, tcpConnForCluster_(_, _))
-      .WillOnce(Invoke([&](const std::string&, Upstream::LoadBalancerContext* context)
-                           -> Upstream::MockHost::MockCreateConnectionData {
+  EXPECT_CALL(cluster_manager_, tcpConnPoolForCluster(_, _, _))
+      .WillOnce(Invoke([&](const std::string&, Upstream::ResourcePriority,
+                           Upstream::LoadBalancerContext* context)
+                           -> Tcp::ConnectionPool::Instance* {
         EXPECT_EQ(
             context->metadataMatchCriteria(),
             &route_config_provider_.route_config_->route_->route_entry_.metadata_matches_criteria_);
-        return {};
+        return nullptr;
       }));
   expectOnUpstreamInitFailure();
 
@@ -1223,21 +1260,22 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketMetadataMatch) {
 TEST_F(HttpConnectionManagerImplTest, WebSocketConnectTimeoutError) {
   setup(false, "");
 
-  Event::MockTimer* connect_timer =
-      new NiceMock<Event::MockTimer>(&filter_callbacks_.connection_.dispatcher_);
-  NiceMock<Network::MockClientConnection>* upstream_connection =
-      new NiceMock<Network::MockClientConnection>();
-  Upstream::MockHost::MockCreateConnectionData conn_info;
+  NiceMock<Tcp::ConnectionPool::MockCancellable> conn_pool_handle;
+  Tcp::ConnectionPool::Callbacks* conn_pool_callbacks = nullptr;
 
-  conn_info.connection_ = upstream_connection;
-  conn_info.host_description_.reset(new Upstream::HostImpl(
+  Upstream::HostDescriptionConstSharedPtr host(new Upstream::HostImpl(
       cluster_manager_.thread_local_cluster_.cluster_.info_, "newhost",
       Network::Utility::resolveUrl("tcp://127.0.0.1:80"),
       envoy::api::v2::core::Metadata::default_instance(), 1,
       envoy::api::v2::core::Locality().default_instance(),
       envoy::api::v2::endpoint::Endpoint::HealthCheckConfig().default_instance()));
-  EXPECT_CALL(*connect_timer, enableTimer(_));
-  EXPECT_CALL(cluster_manager_, tcpConnForCluster_("fake_cluster", _)).WillOnce(Return(conn_info));
+  EXPECT_CALL(cluster_manager_, tcpConnPoolForCluster("fake_cluster", _, _));
+  EXPECT_CALL(cluster_manager_.tcp_conn_pool_, newConnection(_))
+      .WillOnce(Invoke(
+          [&](Tcp::ConnectionPool::Callbacks& callbacks) -> Tcp::ConnectionPool::Cancellable* {
+            conn_pool_callbacks = &callbacks;
+            return &conn_pool_handle;
+          }));
 
   StreamDecoder* decoder = nullptr;
   NiceMock<MockStreamEncoder> encoder;
@@ -1263,7 +1301,7 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketConnectTimeoutError) {
   Buffer::OwnedImpl fake_input("1234");
   conn_manager_->onData(fake_input, false);
 
-  connect_timer->callback_();
+  conn_pool_callbacks->onPoolFailure(Tcp::ConnectionPool::PoolFailureReason::Timeout, host);
   filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
   conn_manager_.reset();
 }
@@ -1271,21 +1309,22 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketConnectTimeoutError) {
 TEST_F(HttpConnectionManagerImplTest, WebSocketConnectionFailure) {
   setup(false, "");
 
-  Event::MockTimer* connect_timer =
-      new NiceMock<Event::MockTimer>(&filter_callbacks_.connection_.dispatcher_);
-  NiceMock<Network::MockClientConnection>* upstream_connection =
-      new NiceMock<Network::MockClientConnection>();
-  Upstream::MockHost::MockCreateConnectionData conn_info;
+  NiceMock<Tcp::ConnectionPool::MockCancellable> conn_pool_handle;
+  Tcp::ConnectionPool::Callbacks* conn_pool_callbacks = nullptr;
 
-  conn_info.connection_ = upstream_connection;
-  conn_info.host_description_.reset(new Upstream::HostImpl(
+  Upstream::HostDescriptionConstSharedPtr host(new Upstream::HostImpl(
       cluster_manager_.thread_local_cluster_.cluster_.info_, "newhost",
       Network::Utility::resolveUrl("tcp://127.0.0.1:80"),
       envoy::api::v2::core::Metadata::default_instance(), 1,
       envoy::api::v2::core::Locality().default_instance(),
       envoy::api::v2::endpoint::Endpoint::HealthCheckConfig().default_instance()));
-  EXPECT_CALL(*connect_timer, enableTimer(_));
-  EXPECT_CALL(cluster_manager_, tcpConnForCluster_("fake_cluster", _)).WillOnce(Return(conn_info));
+  EXPECT_CALL(cluster_manager_, tcpConnPoolForCluster("fake_cluster", _, _));
+  EXPECT_CALL(cluster_manager_.tcp_conn_pool_, newConnection(_))
+      .WillOnce(Invoke(
+          [&](Tcp::ConnectionPool::Callbacks& callbacks) -> Tcp::ConnectionPool::Cancellable* {
+            conn_pool_callbacks = &callbacks;
+            return &conn_pool_handle;
+          }));
 
   StreamDecoder* decoder = nullptr;
   NiceMock<MockStreamEncoder> encoder;
@@ -1311,8 +1350,8 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketConnectionFailure) {
   Buffer::OwnedImpl fake_input("1234");
   conn_manager_->onData(fake_input, false);
 
-  // expectOnUpstreamInitFailure("504");
-  upstream_connection->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_callbacks->onPoolFailure(Tcp::ConnectionPool::PoolFailureReason::ConnectionFailure,
+                                     host);
   filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
   conn_manager_.reset();
 }
@@ -1322,9 +1361,11 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketPrefixAndAutoHostRewrite) {
 
   StreamDecoder* decoder = nullptr;
   NiceMock<MockStreamEncoder> encoder;
-  NiceMock<Network::MockClientConnection>* upstream_connection =
-      new NiceMock<Network::MockClientConnection>();
-  Upstream::MockHost::MockCreateConnectionData conn_info;
+  NiceMock<Network::MockClientConnection> upstream_connection;
+  NiceMock<Tcp::ConnectionPool::MockConnectionData> upstream_connection_data;
+  ON_CALL(upstream_connection_data, connection()).WillByDefault(ReturnRef(upstream_connection));
+  NiceMock<Tcp::ConnectionPool::MockCancellable> conn_pool_handle;
+  Tcp::ConnectionPool::Callbacks* conn_pool_callbacks = nullptr;
   HeaderMapPtr headers{new TestHeaderMapImpl{{":authority", "host"},
                                              {":method", "GET"},
                                              {":path", "/"},
@@ -1332,14 +1373,19 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketPrefixAndAutoHostRewrite) {
                                              {"upgrade", "websocket"}}};
   auto raw_header_ptr = headers.get();
 
-  conn_info.connection_ = upstream_connection;
-  conn_info.host_description_.reset(new Upstream::HostImpl(
+  Upstream::HostDescriptionConstSharedPtr host(new Upstream::HostImpl(
       cluster_manager_.thread_local_cluster_.cluster_.info_, "newhost",
       Network::Utility::resolveUrl("tcp://127.0.0.1:80"),
       envoy::api::v2::core::Metadata::default_instance(), 1,
       envoy::api::v2::core::Locality().default_instance(),
       envoy::api::v2::endpoint::Endpoint::HealthCheckConfig().default_instance()));
-  EXPECT_CALL(cluster_manager_, tcpConnForCluster_("fake_cluster", _)).WillOnce(Return(conn_info));
+  EXPECT_CALL(cluster_manager_, tcpConnPoolForCluster("fake_cluster", _, _));
+  EXPECT_CALL(cluster_manager_.tcp_conn_pool_, newConnection(_))
+      .WillOnce(Invoke(
+          [&](Tcp::ConnectionPool::Callbacks& callbacks) -> Tcp::ConnectionPool::Cancellable* {
+            conn_pool_callbacks = &callbacks;
+            return &conn_pool_handle;
+          }));
 
   configureRouteForWebsocket(route_config_provider_.route_config_->route_->route_entry_);
 
@@ -1356,7 +1402,7 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketPrefixAndAutoHostRewrite) {
 
   Buffer::OwnedImpl fake_input("1234");
   conn_manager_->onData(fake_input, false);
-  upstream_connection->raiseEvent(Network::ConnectionEvent::Connected);
+  conn_pool_callbacks->onPoolReady(upstream_connection_data, host);
 
   // rewritten authority header when auto_host_rewrite is true
   EXPECT_STREQ("newhost", raw_header_ptr->Host()->value().c_str());
@@ -1372,21 +1418,25 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketPrefixAndAutoHostRewrite) {
 TEST_F(HttpConnectionManagerImplTest, WebSocketEarlyData) {
   setup(false, "");
 
-  Event::MockTimer* connect_timer =
-      new NiceMock<Event::MockTimer>(&filter_callbacks_.connection_.dispatcher_);
-  NiceMock<Network::MockClientConnection>* upstream_connection =
-      new NiceMock<Network::MockClientConnection>();
-  Upstream::MockHost::MockCreateConnectionData conn_info;
+  NiceMock<Network::MockClientConnection> upstream_connection;
+  NiceMock<Tcp::ConnectionPool::MockConnectionData> upstream_connection_data;
+  ON_CALL(upstream_connection_data, connection()).WillByDefault(ReturnRef(upstream_connection));
+  NiceMock<Tcp::ConnectionPool::MockCancellable> conn_pool_handle;
+  Tcp::ConnectionPool::Callbacks* conn_pool_callbacks = nullptr;
 
-  conn_info.connection_ = upstream_connection;
-  conn_info.host_description_.reset(new Upstream::HostImpl(
+  Upstream::HostDescriptionConstSharedPtr host(new Upstream::HostImpl(
       cluster_manager_.thread_local_cluster_.cluster_.info_, "newhost",
       Network::Utility::resolveUrl("tcp://127.0.0.1:80"),
       envoy::api::v2::core::Metadata::default_instance(), 1,
       envoy::api::v2::core::Locality().default_instance(),
       envoy::api::v2::endpoint::Endpoint::HealthCheckConfig().default_instance()));
-  EXPECT_CALL(*connect_timer, enableTimer(_));
-  EXPECT_CALL(cluster_manager_, tcpConnForCluster_("fake_cluster", _)).WillOnce(Return(conn_info));
+  EXPECT_CALL(cluster_manager_, tcpConnPoolForCluster("fake_cluster", _, _));
+  EXPECT_CALL(cluster_manager_.tcp_conn_pool_, newConnection(_))
+      .WillOnce(Invoke(
+          [&](Tcp::ConnectionPool::Callbacks& callbacks) -> Tcp::ConnectionPool::Cancellable* {
+            conn_pool_callbacks = &callbacks;
+            return &conn_pool_handle;
+          }));
 
   StreamDecoder* decoder = nullptr;
   NiceMock<MockStreamEncoder> encoder;
@@ -1413,10 +1463,10 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketEarlyData) {
 
   conn_manager_->onData(fake_input, false);
 
-  EXPECT_CALL(*upstream_connection, write(_, false));
-  EXPECT_CALL(*upstream_connection, write(BufferEqual(&early_data), false));
+  EXPECT_CALL(upstream_connection, write(_, false));
+  EXPECT_CALL(upstream_connection, write(BufferEqual(&early_data), false));
   EXPECT_CALL(filter_callbacks_.connection_, readDisable(false));
-  upstream_connection->raiseEvent(Network::ConnectionEvent::Connected);
+  conn_pool_callbacks->onPoolReady(upstream_connection_data, host);
   filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
   conn_manager_.reset();
 }
@@ -1424,21 +1474,22 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketEarlyData) {
 TEST_F(HttpConnectionManagerImplTest, WebSocketEarlyDataConnectionFail) {
   setup(false, "");
 
-  Event::MockTimer* connect_timer =
-      new NiceMock<Event::MockTimer>(&filter_callbacks_.connection_.dispatcher_);
-  NiceMock<Network::MockClientConnection>* upstream_connection =
-      new NiceMock<Network::MockClientConnection>();
-  Upstream::MockHost::MockCreateConnectionData conn_info;
+  NiceMock<Tcp::ConnectionPool::MockCancellable> conn_pool_handle;
+  Tcp::ConnectionPool::Callbacks* conn_pool_callbacks = nullptr;
 
-  conn_info.connection_ = upstream_connection;
-  conn_info.host_description_.reset(new Upstream::HostImpl(
+  Upstream::HostDescriptionConstSharedPtr host(new Upstream::HostImpl(
       cluster_manager_.thread_local_cluster_.cluster_.info_, "newhost",
       Network::Utility::resolveUrl("tcp://127.0.0.1:80"),
       envoy::api::v2::core::Metadata::default_instance(), 1,
       envoy::api::v2::core::Locality().default_instance(),
       envoy::api::v2::endpoint::Endpoint::HealthCheckConfig().default_instance()));
-  EXPECT_CALL(*connect_timer, enableTimer(_));
-  EXPECT_CALL(cluster_manager_, tcpConnForCluster_("fake_cluster", _)).WillOnce(Return(conn_info));
+  EXPECT_CALL(cluster_manager_, tcpConnPoolForCluster("fake_cluster", _, _));
+  EXPECT_CALL(cluster_manager_.tcp_conn_pool_, newConnection(_))
+      .WillOnce(Invoke(
+          [&](Tcp::ConnectionPool::Callbacks& callbacks) -> Tcp::ConnectionPool::Cancellable* {
+            conn_pool_callbacks = &callbacks;
+            return &conn_pool_handle;
+          }));
 
   StreamDecoder* decoder = nullptr;
   NiceMock<MockStreamEncoder> encoder;
@@ -1465,7 +1516,8 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketEarlyDataConnectionFail) {
 
   conn_manager_->onData(fake_input, false);
 
-  upstream_connection->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_callbacks->onPoolFailure(Tcp::ConnectionPool::PoolFailureReason::ConnectionFailure,
+                                     host);
   filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
 
   // This should get dropped, with no crash or ASSERT.
@@ -1478,21 +1530,25 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketEarlyDataConnectionFail) {
 TEST_F(HttpConnectionManagerImplTest, WebSocketEarlyEndStream) {
   setup(false, "");
 
-  Event::MockTimer* connect_timer =
-      new NiceMock<Event::MockTimer>(&filter_callbacks_.connection_.dispatcher_);
-  NiceMock<Network::MockClientConnection>* upstream_connection =
-      new NiceMock<Network::MockClientConnection>();
-  Upstream::MockHost::MockCreateConnectionData conn_info;
+  NiceMock<Network::MockClientConnection> upstream_connection;
+  NiceMock<Tcp::ConnectionPool::MockConnectionData> upstream_connection_data;
+  ON_CALL(upstream_connection_data, connection()).WillByDefault(ReturnRef(upstream_connection));
+  NiceMock<Tcp::ConnectionPool::MockCancellable> conn_pool_handle;
+  Tcp::ConnectionPool::Callbacks* conn_pool_callbacks = nullptr;
 
-  conn_info.connection_ = upstream_connection;
-  conn_info.host_description_.reset(new Upstream::HostImpl(
+  Upstream::HostDescriptionConstSharedPtr host(new Upstream::HostImpl(
       cluster_manager_.thread_local_cluster_.cluster_.info_, "newhost",
       Network::Utility::resolveUrl("tcp://127.0.0.1:80"),
       envoy::api::v2::core::Metadata::default_instance(), 1,
       envoy::api::v2::core::Locality().default_instance(),
       envoy::api::v2::endpoint::Endpoint::HealthCheckConfig().default_instance()));
-  EXPECT_CALL(*connect_timer, enableTimer(_));
-  EXPECT_CALL(cluster_manager_, tcpConnForCluster_("fake_cluster", _)).WillOnce(Return(conn_info));
+  EXPECT_CALL(cluster_manager_, tcpConnPoolForCluster("fake_cluster", _, _));
+  EXPECT_CALL(cluster_manager_.tcp_conn_pool_, newConnection(_))
+      .WillOnce(Invoke(
+          [&](Tcp::ConnectionPool::Callbacks& callbacks) -> Tcp::ConnectionPool::Cancellable* {
+            conn_pool_callbacks = &callbacks;
+            return &conn_pool_handle;
+          }));
 
   StreamDecoder* decoder = nullptr;
   NiceMock<MockStreamEncoder> encoder;
@@ -1514,9 +1570,9 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketEarlyEndStream) {
   Buffer::OwnedImpl fake_input("1234");
   conn_manager_->onData(fake_input, true);
 
-  EXPECT_CALL(*upstream_connection, write(_, false));
-  EXPECT_CALL(*upstream_connection, write(_, true)).Times(0);
-  upstream_connection->raiseEvent(Network::ConnectionEvent::Connected);
+  EXPECT_CALL(upstream_connection, write(_, false));
+  EXPECT_CALL(upstream_connection, write(_, true)).Times(0);
+  conn_pool_callbacks->onPoolReady(upstream_connection_data, host);
   filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
   conn_manager_.reset();
 }
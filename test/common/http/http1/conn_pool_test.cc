@@ -203,7 +203,7 @@ struct ActiveTestRequest {
  */
 TEST_F(Http1ConnPoolImplTest, DrainConnections) {
   cluster_->resource_manager_.reset(
-      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 2, 1024, 1024, 1));
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 2, 1024, 1024, 1, 1024));
   InSequence s;
 
   ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
@@ -289,7 +289,7 @@ TEST_F(Http1ConnPoolImplTest, MultipleRequestAndResponse) {
  */
 TEST_F(Http1ConnPoolImplTest, MaxPendingRequests) {
   cluster_->resource_manager_.reset(
-      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1, 1, 1024, 1));
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1, 1, 1024, 1, 1024));
 
   NiceMock<Http::MockStreamDecoder> outer_decoder;
   ConnPoolCallbacks callbacks;
@@ -606,7 +606,7 @@ TEST_F(Http1ConnPoolImplTest, ConcurrentConnections) {
   InSequence s;
 
   cluster_->resource_manager_.reset(
-      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 2, 1024, 1024, 1));
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 2, 1024, 1024, 1, 1024));
   ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
   r1.startRequest();
 
@@ -711,6 +711,90 @@ TEST_F(Http1ConnPoolImplTest, RemoteCloseToCompleteResponse) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+// Simulate a burst of requests against a cold pool with a prefetch ratio of 1.5. Every queued
+// request creates its own connection, and the pool prefetches on top of that so that connecting
+// plus established connections stay at ceil(1.5 * demand).
+TEST_F(Http1ConnPoolImplTest, PrefetchBurst) {
+  InSequence s;
+
+  cluster_->prefetch_ratio_ = 1.5;
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1024, 1024, 1024, 1, 1024));
+
+  // Demand 1: one connection for the request plus one prefetched.
+  conn_pool_.expectClientCreate();
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::Pending);
+
+  // Demand 2: the request's own connection already satisfies ceil(3.0).
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r2(*this, 1, ActiveTestRequest::Type::Pending);
+
+  // Demand 3: one connection for the request plus one prefetched to reach ceil(4.5).
+  conn_pool_.expectClientCreate();
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r3(*this, 2, ActiveTestRequest::Type::Pending);
+
+  // Demand 4: the request's own connection already satisfies ceil(6.0).
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r4(*this, 3, ActiveTestRequest::Type::Pending);
+
+  EXPECT_EQ(6U, conn_pool_.test_clients_.size());
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  // The first four connections bind to the pending requests in order, and the two prefetched
+  // connections become ready.
+  for (ActiveTestRequest* r : {&r1, &r2, &r3, &r4}) {
+    r->expectNewStream();
+    conn_pool_.test_clients_[r->client_index_].connection_->raiseEvent(
+        Network::ConnectionEvent::Connected);
+  }
+  conn_pool_.test_clients_[4].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  conn_pool_.test_clients_[5].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  for (ActiveTestRequest* r : {&r1, &r2, &r3, &r4}) {
+    r->startRequest();
+    r->completeResponse(false);
+  }
+
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(6);
+  for (size_t i = 0; i < 6; i++) {
+    conn_pool_.test_clients_[i].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  }
+  dispatcher_.clearDeferredDeleteList();
+}
+
+// Warm connections are established ahead of demand, and the most recently used ready connection is
+// the one handed out first.
+TEST_F(Http1ConnPoolImplTest, PrefetchWarmConnections) {
+  InSequence s;
+
+  cluster_->warm_connections_ = 2;
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1024, 1024, 1024, 1, 1024));
+
+  conn_pool_.expectClientCreate();
+  conn_pool_.expectClientCreate();
+  conn_pool_.prefetchConnections();
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  // The pool is already warm so this is a no-op.
+  conn_pool_.prefetchConnections();
+  EXPECT_EQ(2U, conn_pool_.test_clients_.size());
+
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  ActiveTestRequest r1(*this, 1, ActiveTestRequest::Type::Immediate);
+  r1.startRequest();
+  r1.completeResponse(false);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(2);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 } // namespace Http1
 } // namespace Http
 } // namespace Envoy
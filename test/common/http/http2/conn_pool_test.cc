@@ -400,7 +400,7 @@ TEST_F(Http2ConnPoolImplTest, ConnectTimeout) {
 TEST_F(Http2ConnPoolImplTest, MaxGlobalRequests) {
   InSequence s;
   cluster_->resource_manager_.reset(
-      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1024, 1024, 1, 1));
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1024, 1024, 1, 1, 1024));
 
   expectClientCreate();
   ActiveTestRequest r1(*this, 0);
@@ -0,0 +1,112 @@
+#include <string>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/fmt.h"
+#include "common/json/json_loader.h"
+#include "common/network/address_impl.h"
+#include "common/network/cidr_range.h"
+#include "common/network/cidr_set.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+namespace Address {
+namespace {
+
+TEST(CidrSetTest, Errors) {
+  EXPECT_THROW_WITH_MESSAGE(CidrSet(std::vector<std::string>{"10.0.0.0/8", "192.168.1.1/33"}),
+                            EnvoyException,
+                            "invalid ip/mask combo '192.168.1.1/33' (format is <ip>/<# mask bits>)");
+  EXPECT_THROW(CidrSet(std::vector<std::string>{"foo/bar"}), EnvoyException);
+  EXPECT_THROW(CidrSet(std::vector<std::string>{"192.168.1.1"}), EnvoyException);
+  EXPECT_THROW(CidrSet(std::vector<std::string>{"::/129"}), EnvoyException);
+
+  Protobuf::RepeatedPtrField<envoy::api::v2::core::CidrRange> cidrs;
+  auto* cidr = cidrs.Add();
+  cidr->set_address_prefix("192.168.1.1");
+  cidr->mutable_prefix_len()->set_value(33);
+  EXPECT_THROW_WITH_MESSAGE(CidrSet{cidrs}, EnvoyException,
+                            "invalid ip/mask combo '192.168.1.1/33' (format is <ip>/<# mask bits>)");
+}
+
+TEST(CidrSetTest, Empty) {
+  CidrSet set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_FALSE(set.contains(Ipv4Instance("192.168.3.3")));
+  EXPECT_FALSE(set.contains(Ipv6Instance("::1")));
+
+  Json::ObjectSharedPtr loader = Json::Factory::loadFromString("{}");
+  EXPECT_TRUE(CidrSet(*loader, "ip_white_list").empty());
+}
+
+TEST(CidrSetTest, AddressVersionMix) {
+  std::string json = R"EOF(
+  {
+    "ip_white_list": [
+      "192.168.3.0/24",
+      "192.168.3.128/25",
+      "50.1.2.3/32",
+      "2001:db8:85a3::/64",
+      "::1/128"
+     ]
+  }
+  )EOF";
+
+  Json::ObjectSharedPtr loader = Json::Factory::loadFromString(json);
+  CidrSet set(*loader, "ip_white_list");
+  EXPECT_FALSE(set.empty());
+
+  EXPECT_TRUE(set.contains(Ipv4Instance("192.168.3.0")));
+  EXPECT_TRUE(set.contains(Ipv4Instance("192.168.3.3")));
+  EXPECT_TRUE(set.contains(Ipv4Instance("192.168.3.255")));
+  EXPECT_FALSE(set.contains(Ipv4Instance("192.168.2.255")));
+  EXPECT_FALSE(set.contains(Ipv4Instance("192.168.4.0")));
+  EXPECT_TRUE(set.contains(Ipv4Instance("50.1.2.3")));
+  EXPECT_FALSE(set.contains(Ipv4Instance("50.1.2.4")));
+
+  EXPECT_TRUE(set.contains(Ipv6Instance("2001:db8:85a3::")));
+  EXPECT_TRUE(set.contains(Ipv6Instance("2001:db8:85a3::ffff:ffff:ffff:ffff")));
+  EXPECT_FALSE(set.contains(Ipv6Instance("2001:db8:85a3:1::")));
+  EXPECT_TRUE(set.contains(Ipv6Instance("::1")));
+  EXPECT_FALSE(set.contains(Ipv6Instance("::")));
+
+  EXPECT_FALSE(set.contains(PipeInstance("foo")));
+}
+
+TEST(CidrSetTest, MatchAny) {
+  CidrSet set(std::vector<std::string>{"0.0.0.0/0", "10.0.0.0/8"});
+
+  EXPECT_TRUE(set.contains(Ipv4Instance("192.168.3.3")));
+  EXPECT_TRUE(set.contains(Ipv4Instance("10.1.1.1")));
+  EXPECT_TRUE(set.contains(Ipv4Instance("0.0.0.0")));
+  EXPECT_FALSE(set.contains(Ipv6Instance("::1")));
+}
+
+// Agrees with IpList, which checks each range in turn, on a set with many ranges.
+TEST(CidrSetTest, ManyRanges) {
+  std::vector<std::string> subnets;
+  for (int i = 0; i < 4096; i++) {
+    subnets.push_back(fmt::format("10.{}.{}.0/{}", i / 256, i % 256, 24 + i % 9));
+  }
+  const CidrSet set(subnets);
+  const IpList list(subnets);
+
+  for (int i = 0; i < 20; i++) {
+    for (int j = 0; j < 256; j += 3) {
+      for (int k = 0; k < 256; k += 7) {
+        const Ipv4Instance address(fmt::format("10.{}.{}.{}", i, j, k));
+        EXPECT_EQ(list.contains(address), set.contains(address)) << address.asString();
+      }
+    }
+  }
+}
+
+} // namespace
+} // namespace Address
+} // namespace Network
+} // namespace Envoy
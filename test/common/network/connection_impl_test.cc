@@ -866,6 +866,188 @@ TEST_P(ConnectionImplTest, EmptyReadOnCloseTest) {
   disconnect(true);
 }
 
+class ConnectionImplSpliceTest : public ConnectionImplTest {
+public:
+  // Connects a second client, so that the server ends of the two connections can be spliced
+  // together: whatever one client writes is then read by the other one.
+  void connectPeer() {
+    setUpBasicConnection();
+    connect();
+    client_connection_->addReadFilter(client_read_filter_);
+
+    int expected_callbacks = 2;
+    peer_client_ = dispatcher_->createClientConnection(
+        socket_.localAddress(), source_address_, Network::Test::createRawBufferSocket(), nullptr);
+    peer_client_->addConnectionCallbacks(peer_client_callbacks_);
+    peer_client_->addReadFilter(peer_read_filter_);
+    peer_client_->connect();
+    EXPECT_CALL(listener_callbacks_, onAccept_(_, _))
+        .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket, bool) -> void {
+          Network::ConnectionPtr new_connection = dispatcher_->createServerConnection(
+              std::move(socket), Network::Test::createRawBufferSocket());
+          listener_callbacks_.onNewConnection(std::move(new_connection));
+        }));
+    EXPECT_CALL(listener_callbacks_, onNewConnection_(_))
+        .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+          peer_server_ = std::move(conn);
+          peer_server_->addConnectionCallbacks(peer_server_callbacks_);
+          if (--expected_callbacks == 0) {
+            dispatcher_->exit();
+          }
+        }));
+    EXPECT_CALL(peer_client_callbacks_, onEvent(ConnectionEvent::Connected))
+        .WillOnce(InvokeWithoutArgs([&]() -> void {
+          if (--expected_callbacks == 0) {
+            dispatcher_->exit();
+          }
+        }));
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  }
+
+  void closeAll() {
+    EXPECT_CALL(client_callbacks_, onEvent(_)).Times(AnyNumber());
+    EXPECT_CALL(server_callbacks_, onEvent(_)).Times(AnyNumber());
+    server_connection_->close(ConnectionCloseType::NoFlush);
+    peer_server_->close(ConnectionCloseType::NoFlush);
+    client_connection_->close(ConnectionCloseType::NoFlush);
+    peer_client_->close(ConnectionCloseType::NoFlush);
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+protected:
+  std::shared_ptr<MockReadFilter> client_read_filter_{new NiceMock<MockReadFilter>()};
+  Network::ClientConnectionPtr peer_client_;
+  NiceMock<MockConnectionCallbacks> peer_client_callbacks_;
+  std::shared_ptr<MockReadFilter> peer_read_filter_{new NiceMock<MockReadFilter>()};
+  Network::ConnectionPtr peer_server_;
+  NiceMock<MockConnectionCallbacks> peer_server_callbacks_;
+};
+
+INSTANTIATE_TEST_CASE_P(IpVersions, ConnectionImplSpliceTest,
+                        testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
+                        TestUtility::ipTestParamsToString);
+
+// Spliced data bypasses the read filters of the spliced connections and is reported to the bytes
+// sent callbacks of the connection that sends it.
+TEST_P(ConnectionImplSpliceTest, BothDirections) {
+  connectPeer();
+  ASSERT_TRUE(server_connection_->startSplice(*peer_server_));
+  uint64_t peer_bytes_sent = 0;
+  peer_server_->addBytesSentCallback([&](uint64_t bytes) { peer_bytes_sent += bytes; });
+  uint64_t bytes_sent = 0;
+  server_connection_->addBytesSentCallback([&](uint64_t bytes) { bytes_sent += bytes; });
+  EXPECT_CALL(*read_filter_, onData(_, _)).Times(0);
+
+  Buffer::OwnedImpl request("hello");
+  client_connection_->write(request, false);
+  EXPECT_CALL(*peer_read_filter_, onData(BufferStringEqual("hello"), false))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> FilterStatus {
+        data.drain(data.length());
+        dispatcher_->exit();
+        return FilterStatus::StopIteration;
+      }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(5UL, peer_bytes_sent);
+
+  Buffer::OwnedImpl response("world!");
+  peer_client_->write(response, false);
+  EXPECT_CALL(*client_read_filter_, onData(BufferStringEqual("world!"), false))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> FilterStatus {
+        data.drain(data.length());
+        dispatcher_->exit();
+        return FilterStatus::StopIteration;
+      }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(6UL, bytes_sent);
+
+  closeAll();
+}
+
+// The read filter still sees end_stream, and the half-close it forwards follows the spliced data.
+TEST_P(ConnectionImplSpliceTest, HalfClose) {
+  connectPeer();
+  client_connection_->enableHalfClose(true);
+  server_connection_->enableHalfClose(true);
+  peer_server_->enableHalfClose(true);
+  peer_client_->enableHalfClose(true);
+  ASSERT_TRUE(server_connection_->startSplice(*peer_server_));
+
+  EXPECT_CALL(*read_filter_, onData(BufferStringEqual(""), true))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool end_stream) -> FilterStatus {
+        peer_server_->write(data, end_stream);
+        return FilterStatus::StopIteration;
+      }));
+  std::string received;
+  EXPECT_CALL(*peer_read_filter_, onData(_, _))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool end_stream) -> FilterStatus {
+        received.append(data.toString());
+        data.drain(data.length());
+        if (end_stream) {
+          dispatcher_->exit();
+        }
+        return FilterStatus::StopIteration;
+      }));
+  Buffer::OwnedImpl request("data");
+  client_connection_->write(request, true);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ("data", received);
+
+  closeAll();
+}
+
+// A full pipe raises the high watermark of the connection it drains to, and draining it raises
+// the low watermark.
+TEST_P(ConnectionImplSpliceTest, Watermarks) {
+  connectPeer();
+  peer_server_->setBufferLimits(16384);
+  peer_client_->readDisable(true);
+  ASSERT_TRUE(server_connection_->startSplice(*peer_server_));
+
+  EXPECT_CALL(peer_server_callbacks_, onAboveWriteBufferHighWatermark())
+      .WillOnce(InvokeWithoutArgs([&]() -> void { dispatcher_->exit(); }));
+  // Enough to fill the loopback socket buffers behind the pipe.
+  Buffer::OwnedImpl request(std::string(32 * 1024 * 1024, 'a'));
+  client_connection_->write(request, false);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_TRUE(peer_server_->aboveHighWatermark());
+
+  EXPECT_CALL(peer_server_callbacks_, onBelowWriteBufferLowWatermark())
+      .WillOnce(InvokeWithoutArgs([&]() -> void { dispatcher_->exit(); }));
+  peer_client_->readDisable(false);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_FALSE(peer_server_->aboveHighWatermark());
+
+  closeAll();
+}
+
+// Once the peer closes, data goes back through the read filters.
+TEST_P(ConnectionImplSpliceTest, PeerClose) {
+  connectPeer();
+  ASSERT_TRUE(server_connection_->startSplice(*peer_server_));
+  peer_server_->close(ConnectionCloseType::NoFlush);
+
+  Buffer::OwnedImpl request("hello");
+  client_connection_->write(request, false);
+  EXPECT_CALL(*read_filter_, onData(BufferStringEqual("hello"), false))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> FilterStatus {
+        data.drain(data.length());
+        dispatcher_->exit();
+        return FilterStatus::StopIteration;
+      }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  closeAll();
+}
+
+TEST_P(ConnectionImplSpliceTest, RefusedWithWriteFilter) {
+  connectPeer();
+  server_connection_->addWriteFilter(std::make_shared<NiceMock<MockWriteFilter>>());
+  EXPECT_FALSE(server_connection_->startSplice(*peer_server_));
+  EXPECT_FALSE(peer_server_->startSplice(*server_connection_));
+
+  closeAll();
+}
+
 class MockTransportConnectionImplTest : public testing::Test {
 public:
   MockTransportConnectionImplTest() {
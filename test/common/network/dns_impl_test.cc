@@ -22,6 +22,7 @@
 #include "common/network/utility.h"
 #include "common/stats/stats_impl.h"
 
+#include "test/mocks/common.h"
 #include "test/mocks/network/mocks.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/network_utility.h"
@@ -33,6 +34,7 @@
 #include "gtest/gtest.h"
 
 using testing::InSequence;
+using testing::Invoke;
 using testing::Mock;
 using testing::NiceMock;
 using testing::Return;
@@ -56,9 +58,9 @@ enum record_type { A, AAAA };
 class TestDnsServerQuery {
 public:
   TestDnsServerQuery(ConnectionPtr connection, const HostMap& hosts_A, const HostMap& hosts_AAAA,
-                     const CNameMap& cnames)
+                     const CNameMap& cnames, const uint32_t& record_ttl, uint32_t& query_count)
       : connection_(std::move(connection)), hosts_A_(hosts_A), hosts_AAAA_(hosts_AAAA),
-        cnames_(cnames) {
+        cnames_(cnames), record_ttl_(record_ttl), query_count_(query_count) {
     connection_->addReadFilter(Network::ReadFilterSharedPtr{new ReadFilter(*this)});
   }
 
@@ -113,6 +115,7 @@ private:
         unsigned char* request = static_cast<unsigned char*>(buffer_.linearize(size_));
         // Only expecting a single question.
         ASSERT_EQ(1, DNS_HEADER_QDCOUNT(request));
+        parent_.query_count_++;
         // Decode the question and perform lookup.
         const unsigned char* question = request + HFIXEDSZ;
         // The number of bytes the encoded question name takes up in the request.
@@ -215,7 +218,7 @@ private:
           DNS_RR_SET_LEN(response_rr_fixed, sizeof(in6_addr));
         }
         DNS_RR_SET_CLASS(response_rr_fixed, C_IN);
-        DNS_RR_SET_TTL(response_rr_fixed, 0);
+        DNS_RR_SET_TTL(response_rr_fixed, parent_.record_ttl_);
         if (ips != nullptr) {
           for (const auto& it : *ips) {
             write_buffer.add(ip_question, ip_name_len);
@@ -253,6 +256,8 @@ private:
   const HostMap& hosts_A_;
   const HostMap& hosts_AAAA_;
   const CNameMap& cnames_;
+  const uint32_t& record_ttl_;
+  uint32_t& query_count_;
 };
 
 class TestDnsServer : public ListenerCallbacks {
@@ -266,8 +271,9 @@ public:
   }
 
   void onNewConnection(ConnectionPtr&& new_connection) override {
-    TestDnsServerQuery* query =
-        new TestDnsServerQuery(std::move(new_connection), hosts_A_, hosts_AAAA_, cnames_);
+    TestDnsServerQuery* query = new TestDnsServerQuery(std::move(new_connection), hosts_A_,
+                                                       hosts_AAAA_, cnames_, record_ttl_,
+                                                       query_count_);
     queries_.emplace_back(query);
   }
 
@@ -283,12 +289,20 @@ public:
     cnames_[hostname] = cname;
   }
 
+  // Set the TTL of the address records in responses, 0 by default.
+  void setRecordTtl(uint32_t ttl) { record_ttl_ = ttl; }
+
+  // The number of questions answered so far.
+  uint32_t queryCount() const { return query_count_; }
+
 private:
   Event::DispatcherImpl& dispatcher_;
 
   HostMap hosts_A_;
   HostMap hosts_AAAA_;
   CNameMap cnames_;
+  uint32_t record_ttl_{};
+  uint32_t query_count_{};
   // All queries are tracked so we can do resource reclamation when the test is
   // over.
   std::vector<std::unique_ptr<TestDnsServerQuery>> queries_;
@@ -300,6 +314,11 @@ public:
   DnsResolverImplPeer(DnsResolverImpl* resolver) : resolver_(resolver) {}
   ares_channel channel() const { return resolver_->channel_; }
   const std::unordered_map<int, Event::FileEventPtr>& events() { return resolver_->events_; }
+  size_t pendingLookups() const { return resolver_->lookups_.size(); }
+  size_t cacheSize() const {
+    EXPECT_EQ(resolver_->cache_.size(), resolver_->cache_expiries_.size());
+    return resolver_->cache_.size();
+  }
   // Reset the channel state for a DnsResolverImpl such that it will only use
   // TCP and optionally has a zero timeout (for validating timeout behavior).
   void resetChannelTcpOnly(bool zero_timeout) {
@@ -399,7 +418,9 @@ TEST(DnsImplConstructor, BadCustomResolvers) {
 class DnsImplTest : public testing::TestWithParam<Address::IpVersion> {
 public:
   void SetUp() override {
-    resolver_ = dispatcher_.createDnsResolver({});
+    resolver_ = std::make_shared<DnsResolverImpl>(
+        dispatcher_, std::vector<Network::Address::InstanceConstSharedPtr>{}, time_source_);
+    ON_CALL(time_source_, currentTime()).WillByDefault(Invoke([this]() { return now_; }));
 
     // Instantiate TestDnsServer and listen on a random port on the loopback address.
     server_.reset(new TestDnsServer(dispatcher_));
@@ -429,6 +450,8 @@ protected:
   Stats::IsolatedStoreImpl stats_store_;
   std::unique_ptr<Network::Listener> listener_;
   Event::DispatcherImpl dispatcher_;
+  NiceMock<MockMonotonicTimeSource> time_source_;
+  MonotonicTime now_;
   DnsResolverSharedPtr resolver_;
 };
 
@@ -717,6 +740,219 @@ TEST_P(DnsImplTest, Cancel) {
   EXPECT_TRUE(hasAddress(address_list, "201.134.56.7"));
 }
 
+// Validate that answers are served from the cache for as long as their TTL allows.
+TEST_P(DnsImplTest, CachedUntilTtlExpires) {
+  server_->addHosts("some.good.domain", {"201.134.56.7"}, A);
+  server_->setRecordTtl(60);
+  std::list<Address::InstanceConstSharedPtr> address_list;
+  EXPECT_NE(nullptr,
+            resolver_->resolve("some.good.domain", DnsLookupFamily::V4Only,
+                               [&](std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                                 address_list = results;
+                                 dispatcher_.exit();
+                               }));
+
+  dispatcher_.run(Event::Dispatcher::RunType::Block);
+  EXPECT_TRUE(hasAddress(address_list, "201.134.56.7"));
+
+  server_->addHosts("some.good.domain", {"123.4.5.6"}, A);
+  now_ += std::chrono::seconds(59);
+  EXPECT_EQ(nullptr,
+            resolver_->resolve("some.good.domain", DnsLookupFamily::V4Only,
+                               [&](std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                                 address_list = results;
+                               }));
+  EXPECT_TRUE(hasAddress(address_list, "201.134.56.7"));
+  EXPECT_EQ(1U, server_->queryCount());
+
+  // Other lookup families are cached separately.
+  EXPECT_NE(nullptr,
+            resolver_->resolve("some.good.domain", DnsLookupFamily::Auto,
+                               [&](std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                                 address_list = results;
+                                 dispatcher_.exit();
+                               }));
+
+  dispatcher_.run(Event::Dispatcher::RunType::Block);
+  EXPECT_TRUE(hasAddress(address_list, "123.4.5.6"));
+
+  now_ += std::chrono::seconds(1);
+  EXPECT_NE(nullptr,
+            resolver_->resolve("some.good.domain", DnsLookupFamily::V4Only,
+                               [&](std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                                 address_list = results;
+                                 dispatcher_.exit();
+                               }));
+
+  dispatcher_.run(Event::Dispatcher::RunType::Block);
+  EXPECT_TRUE(hasAddress(address_list, "123.4.5.6"));
+}
+
+// Validate that answers with a zero TTL are not cached.
+TEST_P(DnsImplTest, ZeroTtlNotCached) {
+  server_->addHosts("some.good.domain", {"201.134.56.7"}, A);
+  for (int i = 0; i < 2; ++i) {
+    std::list<Address::InstanceConstSharedPtr> address_list;
+    EXPECT_NE(nullptr,
+              resolver_->resolve("some.good.domain", DnsLookupFamily::V4Only,
+                                 [&](std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                                   address_list = results;
+                                   dispatcher_.exit();
+                                 }));
+
+    dispatcher_.run(Event::Dispatcher::RunType::Block);
+    EXPECT_TRUE(hasAddress(address_list, "201.134.56.7"));
+  }
+  EXPECT_EQ(2U, server_->queryCount());
+}
+
+// Validate that expired answers for other names are dropped when an answer is cached.
+TEST_P(DnsImplTest, ExpiredEntriesDropped) {
+  server_->addHosts("some.good.domain", {"201.134.56.7"}, A);
+  server_->addHosts("other.good.domain", {"123.4.5.6"}, A);
+  server_->setRecordTtl(10);
+  for (const char* name : {"some.good.domain", "other.good.domain"}) {
+    EXPECT_NE(nullptr,
+              resolver_->resolve(name, DnsLookupFamily::V4Only,
+                                 [&](std::list<Address::InstanceConstSharedPtr> &&) -> void {
+                                   dispatcher_.exit();
+                                 }));
+    dispatcher_.run(Event::Dispatcher::RunType::Block);
+    EXPECT_EQ(1U, peer_->cacheSize());
+    now_ += std::chrono::seconds(10);
+  }
+}
+
+// Validate that resolutions of the same name in flight at the same time share a query.
+TEST_P(DnsImplTest, ConcurrentResolutionsShareQuery) {
+  server_->addHosts("some.good.domain", {"201.134.56.7"}, A);
+  std::list<Address::InstanceConstSharedPtr> address_list1;
+  std::list<Address::InstanceConstSharedPtr> address_list2;
+  ActiveDnsQuery* query1 =
+      resolver_->resolve("some.good.domain", DnsLookupFamily::V4Only,
+                         [&](std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                           address_list1 = results;
+                         });
+  ActiveDnsQuery* query2 =
+      resolver_->resolve("some.good.domain", DnsLookupFamily::V4Only,
+                         [](std::list<Address::InstanceConstSharedPtr> &&) -> void { FAIL(); });
+  ActiveDnsQuery* query3 =
+      resolver_->resolve("some.good.domain", DnsLookupFamily::V4Only,
+                         [&](std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                           address_list2 = results;
+                           dispatcher_.exit();
+                         });
+  ASSERT_NE(nullptr, query1);
+  ASSERT_NE(nullptr, query2);
+  ASSERT_NE(nullptr, query3);
+  EXPECT_EQ(1U, peer_->pendingLookups());
+  query2->cancel();
+
+  dispatcher_.run(Event::Dispatcher::RunType::Block);
+  EXPECT_TRUE(hasAddress(address_list1, "201.134.56.7"));
+  EXPECT_TRUE(hasAddress(address_list2, "201.134.56.7"));
+  EXPECT_EQ(1U, server_->queryCount());
+  EXPECT_EQ(0U, peer_->pendingLookups());
+}
+
+// Validate that a cached answer used shortly before it expires is refreshed in the background.
+TEST_P(DnsImplTest, RefreshBeforeExpiry) {
+  server_->addHosts("some.good.domain", {"201.134.56.7"}, A);
+  server_->setRecordTtl(100);
+  std::list<Address::InstanceConstSharedPtr> address_list;
+  EXPECT_NE(nullptr,
+            resolver_->resolve("some.good.domain", DnsLookupFamily::V4Only,
+                               [&](std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                                 address_list = results;
+                                 dispatcher_.exit();
+                               }));
+
+  dispatcher_.run(Event::Dispatcher::RunType::Block);
+  server_->addHosts("some.good.domain", {"123.4.5.6"}, A);
+
+  // Not close enough to expiry yet.
+  now_ += std::chrono::seconds(50);
+  EXPECT_EQ(nullptr,
+            resolver_->resolve("some.good.domain", DnsLookupFamily::V4Only,
+                               [&](std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                                 address_list = results;
+                               }));
+  EXPECT_TRUE(hasAddress(address_list, "201.134.56.7"));
+  EXPECT_EQ(0U, peer_->pendingLookups());
+
+  // The cached answer is still returned, and a refresh starts.
+  now_ += std::chrono::seconds(45);
+  EXPECT_EQ(nullptr,
+            resolver_->resolve("some.good.domain", DnsLookupFamily::V4Only,
+                               [&](std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                                 address_list = results;
+                               }));
+  EXPECT_TRUE(hasAddress(address_list, "201.134.56.7"));
+  EXPECT_EQ(1U, peer_->pendingLookups());
+  while (peer_->pendingLookups() > 0) {
+    dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+  }
+  EXPECT_EQ(2U, server_->queryCount());
+
+  // The original answer would have expired by now.
+  now_ += std::chrono::seconds(10);
+  EXPECT_EQ(nullptr,
+            resolver_->resolve("some.good.domain", DnsLookupFamily::V4Only,
+                               [&](std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                                 address_list = results;
+                               }));
+  EXPECT_TRUE(hasAddress(address_list, "123.4.5.6"));
+}
+
+// TTLs shorter than PrefetchDivisor seconds still get refreshed before they expire.
+TEST_P(DnsImplTest, RefreshBeforeExpiryShortTtl) {
+  server_->addHosts("some.good.domain", {"201.134.56.7"}, A);
+  server_->setRecordTtl(5);
+  std::list<Address::InstanceConstSharedPtr> address_list;
+  EXPECT_NE(nullptr,
+            resolver_->resolve("some.good.domain", DnsLookupFamily::V4Only,
+                               [&](std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                                 address_list = results;
+                                 dispatcher_.exit();
+                               }));
+
+  dispatcher_.run(Event::Dispatcher::RunType::Block);
+  server_->addHosts("some.good.domain", {"123.4.5.6"}, A);
+
+  // Not close enough to expiry yet.
+  now_ += std::chrono::seconds(4);
+  EXPECT_EQ(nullptr,
+            resolver_->resolve("some.good.domain", DnsLookupFamily::V4Only,
+                               [&](std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                                 address_list = results;
+                               }));
+  EXPECT_TRUE(hasAddress(address_list, "201.134.56.7"));
+  EXPECT_EQ(0U, peer_->pendingLookups());
+
+  // Within the last 500ms of the TTL a refresh starts.
+  now_ += std::chrono::milliseconds(600);
+  EXPECT_EQ(nullptr,
+            resolver_->resolve("some.good.domain", DnsLookupFamily::V4Only,
+                               [&](std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                                 address_list = results;
+                               }));
+  EXPECT_TRUE(hasAddress(address_list, "201.134.56.7"));
+  EXPECT_EQ(1U, peer_->pendingLookups());
+  while (peer_->pendingLookups() > 0) {
+    dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+  }
+  EXPECT_EQ(2U, server_->queryCount());
+
+  // The original answer would have expired by now.
+  now_ += std::chrono::seconds(1);
+  EXPECT_EQ(nullptr,
+            resolver_->resolve("some.good.domain", DnsLookupFamily::V4Only,
+                               [&](std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                                 address_list = results;
+                               }));
+  EXPECT_TRUE(hasAddress(address_list, "123.4.5.6"));
+}
+
 class DnsImplZeroTimeoutTest : public DnsImplTest {
 protected:
   bool zero_timeout() const override { return true; }
@@ -749,7 +985,7 @@ TEST(DnsImplUnitTest, PendingTimerEnable) {
   Event::MockDispatcher dispatcher;
   Event::MockTimer* timer = new NiceMock<Event::MockTimer>();
   EXPECT_CALL(dispatcher, createTimer_(_)).WillOnce(Return(timer));
-  DnsResolverImpl resolver(dispatcher, {});
+  DnsResolverImpl resolver(dispatcher, {}, ProdMonotonicTimeSource::instance_);
   Event::FileEvent* file_event = new NiceMock<Event::MockFileEvent>();
   EXPECT_CALL(dispatcher, createFileEvent_(_, _, _, _)).WillOnce(Return(file_event));
   EXPECT_CALL(*timer, enableTimer(_));
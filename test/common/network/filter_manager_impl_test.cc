@@ -16,6 +16,7 @@
 #include "test/mocks/ratelimit/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/mocks.h"
+#include "test/mocks/tcp/mocks.h"
 #include "test/mocks/tracing/mocks.h"
 #include "test/mocks/upstream/host.h"
 #include "test/mocks/upstream/mocks.h"
@@ -28,6 +29,7 @@ using testing::InSequence;
 using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
+using testing::ReturnRef;
 using testing::WithArgs;
 using testing::_;
 
@@ -202,21 +204,28 @@ TEST_F(NetworkFilterManagerTest, RateLimitAndTcpProxy) {
 
   EXPECT_EQ(manager.initializeReadFilters(), true);
 
-  NiceMock<Network::MockClientConnection>* upstream_connection =
-      new NiceMock<Network::MockClientConnection>();
-  Upstream::MockHost::MockCreateConnectionData conn_info;
-  conn_info.connection_ = upstream_connection;
-  conn_info.host_description_ = Upstream::makeTestHost(
-      factory_context.cluster_manager_.thread_local_cluster_.cluster_.info_, "tcp://127.0.0.1:80");
-  EXPECT_CALL(factory_context.cluster_manager_, tcpConnForCluster_("fake_cluster", _))
-      .WillOnce(Return(conn_info));
+  NiceMock<Network::MockClientConnection> upstream_connection;
+  NiceMock<Tcp::ConnectionPool::MockConnectionData> conn_data;
+  ON_CALL(conn_data, connection()).WillByDefault(ReturnRef(upstream_connection));
+  Tcp::ConnectionPool::Callbacks* conn_pool_callbacks = nullptr;
+  NiceMock<Tcp::ConnectionPool::MockCancellable> conn_pool_handle;
+  EXPECT_CALL(factory_context.cluster_manager_, tcpConnPoolForCluster("fake_cluster", _, _));
+  EXPECT_CALL(factory_context.cluster_manager_.tcp_conn_pool_, newConnection(_))
+      .WillOnce(Invoke(
+          [&](Tcp::ConnectionPool::Callbacks& callbacks) -> Tcp::ConnectionPool::Cancellable* {
+            conn_pool_callbacks = &callbacks;
+            return &conn_pool_handle;
+          }));
 
   request_callbacks->complete(RateLimit::LimitStatus::OK);
 
-  upstream_connection->raiseEvent(Network::ConnectionEvent::Connected);
+  conn_pool_callbacks->onPoolReady(
+      conn_data, Upstream::makeTestHost(
+                     factory_context.cluster_manager_.thread_local_cluster_.cluster_.info_,
+                     "tcp://127.0.0.1:80"));
 
   Buffer::OwnedImpl buffer("hello");
-  EXPECT_CALL(*upstream_connection, write(BufferEqual(&buffer), _));
+  EXPECT_CALL(upstream_connection, write(BufferEqual(&buffer), _));
   read_buffer_.add("hello");
   manager.onRead();
 }
@@ -0,0 +1,89 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/network/server_name_trie.h"
+
+#include "fmt/format.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace {
+
+// Half of the names are exact names and half are wildcard domains, like a multi-tenant listener
+// with one filter chain per tenant. The requested names hit both kinds of entries and miss them.
+std::vector<std::string> requestedServerNames(size_t num_names) {
+  std::vector<std::string> names;
+  for (size_t i = 0; i < 16; i++) {
+    const size_t tenant = (i * 7919) % num_names;
+    names.push_back(tenant % 2 == 0 ? fmt::format("www.tenant{}.example.com", tenant)
+                                    : fmt::format("api.eu.tenant{}.example.com", tenant));
+  }
+  names.push_back("www.unknown.example.org");
+  return names;
+}
+
+void BM_ServerNameTrieLookup(benchmark::State& state) {
+  const size_t num_names = state.range(0);
+  Network::ServerNameTrie<size_t> trie;
+  for (size_t i = 0; i < num_names; i++) {
+    trie[i % 2 == 0 ? fmt::format("www.tenant{}.example.com", i)
+                    : fmt::format("*.tenant{}.example.com", i)] = i;
+  }
+  trie[""] = num_names;
+  const std::vector<std::string> names = requestedServerNames(num_names);
+
+  size_t i = 0;
+  size_t matches = 0;
+  for (auto _ : state) {
+    matches += *trie.find(names[i++ % names.size()]);
+  }
+  benchmark::DoNotOptimize(matches);
+}
+BENCHMARK(BM_ServerNameTrieLookup)->Arg(100)->Arg(1000)->Arg(40000);
+
+// The lookup the listener used before, which keeps wildcard domains as ".example.com" in the same
+// map as exact names and tries every suffix of the requested name.
+void BM_ServerNameMapLookup(benchmark::State& state) {
+  const size_t num_names = state.range(0);
+  std::unordered_map<std::string, size_t> map;
+  for (size_t i = 0; i < num_names; i++) {
+    map[i % 2 == 0 ? fmt::format("www.tenant{}.example.com", i)
+                   : fmt::format(".tenant{}.example.com", i)] = i;
+  }
+  map[""] = num_names;
+  const std::vector<std::string> names = requestedServerNames(num_names);
+
+  size_t i = 0;
+  size_t matches = 0;
+  for (auto _ : state) {
+    const std::string server_name(names[i++ % names.size()]);
+    auto match = map.find(server_name);
+    size_t pos = server_name.find('.', 1);
+    while (match == map.end() && pos < server_name.size() - 1 && pos != std::string::npos) {
+      match = map.find(server_name.substr(pos));
+      pos = server_name.find('.', pos + 1);
+    }
+    if (match == map.end()) {
+      match = map.find("");
+    }
+    matches += match->second;
+  }
+  benchmark::DoNotOptimize(matches);
+}
+BENCHMARK(BM_ServerNameMapLookup)->Arg(100)->Arg(1000)->Arg(40000);
+
+} // namespace
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,92 @@
+#include <string>
+
+#include "common/network/server_name_trie.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+
+class ServerNameTrieTest : public testing::Test {
+public:
+  void add(const std::string& server_name) { trie_[server_name] = server_name; }
+
+  std::string find(const std::string& server_name) {
+    const std::string* data = trie_.find(server_name);
+    return data != nullptr ? *data : "<none>";
+  }
+
+  ServerNameTrie<std::string> trie_;
+};
+
+TEST_F(ServerNameTrieTest, Empty) {
+  EXPECT_EQ("<none>", find("www.example.com"));
+  EXPECT_EQ("<none>", find(""));
+}
+
+TEST_F(ServerNameTrieTest, ExactMatch) {
+  add("www.example.com");
+  add("example.com");
+
+  EXPECT_EQ("www.example.com", find("www.example.com"));
+  EXPECT_EQ("example.com", find("example.com"));
+  EXPECT_EQ("<none>", find("com"));
+  EXPECT_EQ("<none>", find("api.example.com"));
+  EXPECT_EQ("<none>", find("www.example.com.org"));
+  EXPECT_EQ("<none>", find(""));
+}
+
+TEST_F(ServerNameTrieTest, WildcardMatch) {
+  add("*.example.com");
+  add("*.com");
+
+  EXPECT_EQ("*.example.com", find("www.example.com"));
+  EXPECT_EQ("*.example.com", find("a.b.example.com"));
+  EXPECT_EQ("*.com", find("example.com"));
+  EXPECT_EQ("*.com", find("www.example2.com"));
+  EXPECT_EQ("*.com", find(".example.com"));
+  EXPECT_EQ("<none>", find(".com"));
+  EXPECT_EQ("<none>", find("com"));
+  EXPECT_EQ("<none>", find("www.example.org"));
+}
+
+TEST_F(ServerNameTrieTest, Precedence) {
+  add("");
+  add("*.com");
+  add("*.example.com");
+  add("www.example.com");
+
+  EXPECT_EQ("www.example.com", find("www.example.com"));
+  EXPECT_EQ("*.example.com", find("api.example.com"));
+  EXPECT_EQ("*.com", find("api.example2.com"));
+  EXPECT_EQ("", find("www.example.org"));
+  EXPECT_EQ("", find(""));
+}
+
+// Wildcard domains and exact names for the same domain don't overlap.
+TEST_F(ServerNameTrieTest, WildcardAndExactForSameDomain) {
+  add("*.example.com");
+  add("example.com");
+
+  EXPECT_EQ("example.com", find("example.com"));
+  EXPECT_EQ("*.example.com", find("www.example.com"));
+}
+
+TEST_F(ServerNameTrieTest, EmptyLabels) {
+  add("a..b");
+  add("*.b");
+
+  EXPECT_EQ("a..b", find("a..b"));
+  EXPECT_EQ("*.b", find("c..b"));
+  EXPECT_EQ("<none>", find("b."));
+}
+
+TEST_F(ServerNameTrieTest, AddIsIdempotent) {
+  trie_["www.example.com"] = "first";
+  EXPECT_EQ("first", trie_["www.example.com"]);
+  trie_["www.example.com"] += "+second";
+  EXPECT_EQ("first+second", find("www.example.com"));
+}
+
+} // namespace Network
+} // namespace Envoy
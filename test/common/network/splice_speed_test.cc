@@ -0,0 +1,158 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Measures the throughput of proxying between two loopback TCP connections, the way a plaintext
+// tcp_proxy does: either reading into a Buffer::OwnedImpl and writing it out again (how
+// RawBufferSocket works), or splicing through a SplicePipe without copying into user space. A
+// thread keeps the source connection full and another one drains the sink connection.
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/network/splice_pipe.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Network {
+
+static const uint64_t ChunkSize = 1024 * 1024;
+
+// The default per connection buffer limit of listeners and clusters.
+static const uint32_t BufferLimit = 1024 * 1024;
+
+// Connects a loopback TCP socket pair. The accepted end is non-blocking.
+static void connectLoopback(int& client_fd, int& server_fd) {
+  int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  RELEASE_ASSERT(listen_fd >= 0, "");
+  sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t address_length = sizeof(address);
+  RELEASE_ASSERT(bind(listen_fd, reinterpret_cast<sockaddr*>(&address), address_length) == 0, "");
+  RELEASE_ASSERT(listen(listen_fd, 1) == 0, "");
+  RELEASE_ASSERT(
+      getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &address_length) == 0, "");
+  client_fd = socket(AF_INET, SOCK_STREAM, 0);
+  RELEASE_ASSERT(connect(client_fd, reinterpret_cast<sockaddr*>(&address), address_length) == 0,
+                 "");
+  server_fd = accept(listen_fd, nullptr, nullptr);
+  RELEASE_ASSERT(server_fd >= 0, "");
+  RELEASE_ASSERT(fcntl(server_fd, F_SETFL, O_NONBLOCK) == 0, "");
+  close(listen_fd);
+}
+
+static void waitFor(int fd, short events) {
+  pollfd poll_fd{fd, events, 0};
+  RELEASE_ASSERT(poll(&poll_fd, 1, -1) == 1, "");
+}
+
+// Data flows from source_ into the proxy's downstream_ socket, and from its upstream_ socket into
+// sink_. The proxy's sockets are non-blocking like an Envoy connection's.
+class LoopbackProxy {
+public:
+  LoopbackProxy() {
+    connectLoopback(source_, downstream_);
+    connectLoopback(sink_, upstream_);
+
+    writer_ = std::thread([this]() {
+      const std::string chunk(ChunkSize, 'a');
+      while (send(source_, chunk.data(), chunk.size(), MSG_NOSIGNAL) > 0) {
+      }
+    });
+    reader_ = std::thread([this]() {
+      char buffer[65536];
+      while (read(sink_, buffer, sizeof(buffer)) > 0) {
+      }
+    });
+  }
+
+  ~LoopbackProxy() {
+    // Both threads see their socket shut down and exit.
+    shutdown(source_, SHUT_RDWR);
+    shutdown(sink_, SHUT_RDWR);
+    writer_.join();
+    reader_.join();
+    close(source_);
+    close(downstream_);
+    close(upstream_);
+    close(sink_);
+  }
+
+  int source_;
+  int downstream_;
+  int upstream_;
+  int sink_;
+  std::thread writer_;
+  std::thread reader_;
+};
+
+static void BM_ReadWrite(benchmark::State& state) {
+  LoopbackProxy proxy;
+  Buffer::OwnedImpl buffer;
+  for (auto _ : state) {
+    uint64_t proxied = 0;
+    while (proxied < ChunkSize) {
+      waitFor(proxy.downstream_, POLLIN);
+      // 16K reads until the buffer limit or EAGAIN, as in RawBufferSocket::doRead().
+      while (buffer.length() < BufferLimit && buffer.read(proxy.downstream_, 16384) > 0) {
+      }
+      while (buffer.length() > 0) {
+        const int rc = buffer.write(proxy.upstream_);
+        if (rc > 0) {
+          proxied += rc;
+        } else {
+          waitFor(proxy.upstream_, POLLOUT);
+        }
+      }
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * ChunkSize);
+}
+BENCHMARK(BM_ReadWrite);
+
+static void BM_Splice(benchmark::State& state) {
+  LoopbackProxy proxy;
+  SplicePipeSharedPtr pipe = SplicePipe::create(BufferLimit);
+  if (pipe == nullptr) {
+    state.SkipWithError("splice is not supported on this platform");
+    return;
+  }
+  for (auto _ : state) {
+    uint64_t proxied = 0;
+    while (proxied < ChunkSize) {
+      waitFor(proxy.downstream_, POLLIN);
+      pipe->readFrom(proxy.downstream_);
+      while (pipe->length() > 0) {
+        proxied += pipe->writeTo(proxy.upstream_).bytes_processed_;
+        if (pipe->length() > 0) {
+          waitFor(proxy.upstream_, POLLOUT);
+        }
+      }
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * ChunkSize);
+}
+BENCHMARK(BM_Splice);
+
+} // namespace Network
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
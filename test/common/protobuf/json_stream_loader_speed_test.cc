@@ -0,0 +1,114 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include "envoy/api/v2/discovery.pb.h"
+#include "envoy/api/v2/eds.pb.h"
+#include "envoy/config/bootstrap/v2/bootstrap.pb.h"
+
+#include "common/protobuf/json_stream_loader.h"
+#include "common/protobuf/protobuf.h"
+#include "common/protobuf/utility.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace {
+
+// The JSON of a bootstrap with the given number of EDS clusters.
+std::string makeBootstrapJson(uint64_t num_clusters) {
+  envoy::config::bootstrap::v2::Bootstrap bootstrap;
+  for (uint64_t i = 0; i < num_clusters; i++) {
+    auto* cluster = bootstrap.mutable_static_resources()->add_clusters();
+    cluster->set_name("cluster_" + std::to_string(i));
+    cluster->set_type(envoy::api::v2::Cluster::EDS);
+    cluster->mutable_connect_timeout()->set_seconds(1);
+    cluster->mutable_eds_cluster_config()->set_service_name("service_" + std::to_string(i));
+    cluster->mutable_eds_cluster_config()->mutable_eds_config()->mutable_ads();
+    cluster->mutable_circuit_breakers()->add_thresholds()->mutable_max_connections()->set_value(
+        1024);
+    auto* health_check = cluster->add_health_checks();
+    health_check->mutable_timeout()->set_seconds(1);
+    health_check->mutable_interval()->set_seconds(5);
+    health_check->mutable_http_health_check()->set_path("/healthz");
+    (*cluster->mutable_metadata()->mutable_filter_metadata())["envoy.lb"] =
+        MessageUtil::keyValueStruct("tenant", "tenant_" + std::to_string(i));
+  }
+  return MessageUtil::getJsonStringFromMessage(bootstrap, true);
+}
+
+// The JSON of a REST EDS response with the given number of load assignments of 8 endpoints each.
+std::string makeEdsResponseJson(uint64_t num_assignments) {
+  envoy::api::v2::DiscoveryResponse response;
+  response.set_version_info("1");
+  for (uint64_t i = 0; i < num_assignments; i++) {
+    envoy::api::v2::ClusterLoadAssignment assignment;
+    assignment.set_cluster_name("cluster_" + std::to_string(i));
+    auto* locality_lb_endpoints = assignment.add_endpoints();
+    for (uint32_t j = 0; j < 8; j++) {
+      auto* socket_address = locality_lb_endpoints->add_lb_endpoints()
+                                 ->mutable_endpoint()
+                                 ->mutable_address()
+                                 ->mutable_socket_address();
+      socket_address->set_address("10.0." + std::to_string(i % 256) + "." + std::to_string(j));
+      socket_address->set_port_value(8000 + j);
+    }
+    response.add_resources()->PackFrom(assignment);
+  }
+  return MessageUtil::getJsonStringFromMessage(response, false);
+}
+
+void BM_ProtobufBootstrap(benchmark::State& state) {
+  const std::string json = makeBootstrapJson(state.range(0));
+  Protobuf::util::JsonParseOptions options;
+  options.ignore_unknown_fields = true;
+  for (auto _ : state) {
+    envoy::config::bootstrap::v2::Bootstrap bootstrap;
+    benchmark::DoNotOptimize(Protobuf::util::JsonStringToMessage(json, &bootstrap, options));
+  }
+  state.SetBytesProcessed(state.iterations() * json.size());
+}
+BENCHMARK(BM_ProtobufBootstrap)->Arg(1000)->Arg(20000)->Unit(benchmark::kMillisecond);
+
+void BM_JsonStreamLoaderBootstrap(benchmark::State& state) {
+  const std::string json = makeBootstrapJson(state.range(0));
+  for (auto _ : state) {
+    envoy::config::bootstrap::v2::Bootstrap bootstrap;
+    JsonStreamLoader::load(json, bootstrap);
+  }
+  state.SetBytesProcessed(state.iterations() * json.size());
+}
+BENCHMARK(BM_JsonStreamLoaderBootstrap)->Arg(1000)->Arg(20000)->Unit(benchmark::kMillisecond);
+
+void BM_ProtobufEdsResponse(benchmark::State& state) {
+  const std::string json = makeEdsResponseJson(state.range(0));
+  Protobuf::util::JsonParseOptions options;
+  options.ignore_unknown_fields = true;
+  for (auto _ : state) {
+    envoy::api::v2::DiscoveryResponse response;
+    benchmark::DoNotOptimize(Protobuf::util::JsonStringToMessage(json, &response, options));
+  }
+  state.SetBytesProcessed(state.iterations() * json.size());
+}
+BENCHMARK(BM_ProtobufEdsResponse)->Arg(1000)->Arg(20000)->Unit(benchmark::kMillisecond);
+
+void BM_JsonStreamLoaderEdsResponse(benchmark::State& state) {
+  const std::string json = makeEdsResponseJson(state.range(0));
+  for (auto _ : state) {
+    envoy::api::v2::DiscoveryResponse response;
+    JsonStreamLoader::load(json, response);
+  }
+  state.SetBytesProcessed(state.iterations() * json.size());
+}
+BENCHMARK(BM_JsonStreamLoaderEdsResponse)->Arg(1000)->Arg(20000)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
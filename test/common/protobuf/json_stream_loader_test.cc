@@ -0,0 +1,168 @@
+#include "envoy/api/v2/cds.pb.h"
+#include "envoy/api/v2/discovery.pb.h"
+#include "envoy/api/v2/eds.pb.h"
+#include "envoy/api/v2/route/route.pb.h"
+
+#include "common/protobuf/json_stream_loader.h"
+#include "common/protobuf/protobuf.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace {
+
+// Load JSON with both the streaming loader and protobuf's own parser, which must agree.
+template <class MessageType> MessageType loadAndCompare(const std::string& json) {
+  MessageType expected;
+  Protobuf::util::JsonParseOptions options;
+  options.ignore_unknown_fields = true;
+  EXPECT_TRUE(Protobuf::util::JsonStringToMessage(json, &expected, options).ok());
+
+  MessageType message;
+  JsonStreamLoader::load(json, message);
+  EXPECT_TRUE(TestUtility::protoEqual(expected, message))
+      << "expected: " << expected.DebugString() << "actual: " << message.DebugString();
+  return message;
+}
+
+TEST(JsonStreamLoaderTest, Cluster) {
+  const auto cluster = loadAndCompare<envoy::api::v2::Cluster>(R"EOF(
+  {
+    "name": "cluster_0",
+    "type": "EDS",
+    "connectTimeout": "0.250s",
+    "per_connection_buffer_limit_bytes": 32768,
+    "lb_policy": 3,
+    "max_requests_per_connection": "10",
+    "eds_cluster_config": {"eds_config": {"ads": {}}, "service_name": "service_0"},
+    "hosts": [
+      {"socket_address": {"address": "10.0.0.1", "port_value": 80}},
+      {"socket_address": {"address": "10.0.0.2", "port_value": 8.0e1}}
+    ],
+    "health_checks": [
+      {
+        "timeout": "1s",
+        "interval": "5s",
+        "unhealthy_threshold": 3,
+        "healthy_threshold": null,
+        "http_health_check": {"path": "/healthz"}
+      }
+    ],
+    "circuit_breakers": {"thresholds": [{"priority": "HIGH", "max_connections": 1024}]},
+    "metadata": {
+      "filter_metadata": {
+        "envoy.lb": {"canary": true, "weight": 1.5, "tags": ["a", null, {"b": []}], "none": null}
+      }
+    },
+    "unknown_field": {"nested": [1, {"deeper": [[]]}]}
+  }
+  )EOF");
+  EXPECT_EQ("cluster_0", cluster.name());
+  EXPECT_EQ(2, cluster.hosts_size());
+  EXPECT_EQ(10, cluster.max_requests_per_connection().value());
+}
+
+TEST(JsonStreamLoaderTest, DiscoveryResponseWithAny) {
+  const auto response = loadAndCompare<envoy::api::v2::DiscoveryResponse>(R"EOF(
+  {
+    "version_info": "1",
+    "resources": [
+      {
+        "@type": "type.googleapis.com/envoy.api.v2.ClusterLoadAssignment",
+        "cluster_name": "cluster_0",
+        "endpoints": [
+          {
+            "lb_endpoints": [
+              {
+                "endpoint": {
+                  "address": {"socket_address": {"address": "10.0.0.1", "port_value": 80}}
+                }
+              }
+            ]
+          }
+        ]
+      },
+      {
+        "@type": "type.googleapis.com/envoy.api.v2.ClusterLoadAssignment",
+        "cluster_name": "cluster_1"
+      }
+    ],
+    "type_url": "type.googleapis.com/envoy.api.v2.ClusterLoadAssignment"
+  }
+  )EOF");
+  ASSERT_EQ(2, response.resources_size());
+  envoy::api::v2::ClusterLoadAssignment assignment;
+  ASSERT_TRUE(response.resources(1).UnpackTo(&assignment));
+  EXPECT_EQ("cluster_1", assignment.cluster_name());
+}
+
+// JSON that is left to protobuf's parser still loads the same.
+TEST(JsonStreamLoaderTest, Fallback) {
+  // Any whose type is not the first key.
+  loadAndCompare<envoy::api::v2::DiscoveryResponse>(
+      R"EOF({"resources": [{"cluster_name": "c", "@type": "type.googleapis.com/)EOF"
+      R"EOF(envoy.api.v2.ClusterLoadAssignment"}]})EOF");
+  // Single quoted strings.
+  loadAndCompare<envoy::api::v2::Cluster>("{'name': 'cluster_0'}");
+  // A single element of a repeated field.
+  loadAndCompare<envoy::api::v2::Cluster>(
+      R"EOF({"hosts": {"socket_address": {"address": "10.0.0.1", "port_value": 80}}})EOF");
+}
+
+TEST(JsonStreamLoaderTest, ReplacesContents) {
+  envoy::api::v2::Cluster cluster;
+  cluster.set_name("old");
+  cluster.add_hosts();
+  JsonStreamLoader::load(R"EOF({"type": "STATIC"})EOF", cluster);
+  EXPECT_EQ("", cluster.name());
+  EXPECT_EQ(0, cluster.hosts_size());
+  EXPECT_EQ(envoy::api::v2::Cluster::STATIC, cluster.type());
+}
+
+TEST(JsonStreamLoaderTest, ErrorsReportLine) {
+  envoy::api::v2::Cluster cluster;
+  EXPECT_THROW_WITH_MESSAGE(
+      JsonStreamLoader::load("{\n  \"name\": \"cluster_0\",\n  \"circuit_breakers\": \"none\"\n}",
+                             cluster),
+      EnvoyException,
+      "Unable to parse JSON as proto (line 3): unexpected string for field "
+      "'envoy.api.v2.Cluster.circuit_breakers'");
+  EXPECT_THROW_WITH_MESSAGE(
+      JsonStreamLoader::load("{\n  \"per_connection_buffer_limit_bytes\": -1\n}", cluster),
+      EnvoyException,
+      "Unable to parse JSON as proto (line 2): unexpected '-1' for field "
+      "'envoy.api.v2.Cluster.per_connection_buffer_limit_bytes'");
+  EXPECT_THROW_WITH_REGEX(
+      JsonStreamLoader::load("{\n  \"name\": \"cluster_0\"\n  \"type\"}", cluster),
+      EnvoyException, "^Unable to parse JSON as proto \\(line 3\\): ");
+}
+
+// Setting a second member of a oneof would silently clear the first one.
+TEST(JsonStreamLoaderTest, MultipleOneofMembers) {
+  envoy::api::v2::route::Route route;
+  EXPECT_THROW_WITH_MESSAGE(
+      JsonStreamLoader::load(R"EOF({
+  "match": {"prefix": "/"},
+  "route": {
+    "cluster": "cluster_0",
+    "weighted_clusters": {"clusters": [{"name": "cluster_1", "weight": 100}]}
+  }
+})EOF",
+                             route),
+      EnvoyException,
+      "Unable to parse JSON as proto (line 5): multiple values for oneof "
+      "'envoy.api.v2.route.RouteAction.cluster_specifier'");
+
+  // Members of different oneofs are fine.
+  loadAndCompare<envoy::api::v2::route::Route>(R"EOF(
+  {
+    "match": {"prefix": "/"},
+    "route": {"cluster": "cluster_0", "host_rewrite": "example.com"}
+  }
+  )EOF");
+}
+
+} // namespace
+} // namespace Envoy
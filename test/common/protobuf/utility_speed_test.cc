@@ -0,0 +1,105 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include "envoy/config/bootstrap/v2/bootstrap.pb.h"
+
+#include "common/common/hash.h"
+#include "common/protobuf/protobuf.h"
+#include "common/protobuf/utility.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace {
+
+// A bootstrap with the given number of EDS clusters, each with some of the fields a CDS response
+// typically carries.
+envoy::config::bootstrap::v2::Bootstrap makeBootstrap(uint64_t num_clusters) {
+  envoy::config::bootstrap::v2::Bootstrap bootstrap;
+  for (uint64_t i = 0; i < num_clusters; i++) {
+    auto* cluster = bootstrap.mutable_static_resources()->add_clusters();
+    cluster->set_name("cluster_" + std::to_string(i));
+    cluster->set_type(envoy::api::v2::Cluster::EDS);
+    cluster->mutable_connect_timeout()->set_seconds(1);
+    cluster->mutable_eds_cluster_config()->set_service_name("service_" + std::to_string(i));
+    cluster->mutable_eds_cluster_config()->mutable_eds_config()->mutable_ads();
+    cluster->mutable_circuit_breakers()->add_thresholds()->mutable_max_connections()->set_value(
+        1024);
+    auto* health_check = cluster->add_health_checks();
+    health_check->mutable_timeout()->set_seconds(1);
+    health_check->mutable_interval()->set_seconds(5);
+    health_check->mutable_http_health_check()->set_path("/healthz");
+    (*cluster->mutable_metadata()->mutable_filter_metadata())["envoy.lb"] =
+        MessageUtil::keyValueStruct("tenant", "tenant_" + std::to_string(i));
+  }
+  return bootstrap;
+}
+
+// How MessageUtil::hash() used to hash a message.
+uint64_t hashThroughString(const Protobuf::Message& message) {
+  ProtobufTypes::String text;
+  {
+    Protobuf::io::StringOutputStream string_stream(&text);
+    Protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    coded_stream.SetSerializationDeterministic(true);
+    message.SerializeToCodedStream(&coded_stream);
+  }
+  return HashUtil::xxHash64(text);
+}
+
+void BM_HashThroughString(benchmark::State& state) {
+  const auto bootstrap = makeBootstrap(state.range(0));
+  for (auto _ : state) {
+    for (const auto& cluster : bootstrap.static_resources().clusters()) {
+      benchmark::DoNotOptimize(hashThroughString(cluster));
+    }
+  }
+}
+BENCHMARK(BM_HashThroughString)->Arg(1000)->Arg(20000)->Unit(benchmark::kMillisecond);
+
+void BM_MessageUtilHash(benchmark::State& state) {
+  const auto bootstrap = makeBootstrap(state.range(0));
+  for (auto _ : state) {
+    for (const auto& cluster : bootstrap.static_resources().clusters()) {
+      benchmark::DoNotOptimize(MessageUtil::hash(cluster));
+    }
+  }
+}
+BENCHMARK(BM_MessageUtilHash)->Arg(1000)->Arg(20000)->Unit(benchmark::kMillisecond);
+
+// Compare every cluster against an unchanged copy of itself, as a no-op update does.
+void BM_MessageDifferencerEquivalent(benchmark::State& state) {
+  const auto bootstrap = makeBootstrap(state.range(0));
+  const auto copy = bootstrap;
+  for (auto _ : state) {
+    for (int i = 0; i < bootstrap.static_resources().clusters_size(); i++) {
+      benchmark::DoNotOptimize(Protobuf::util::MessageDifferencer::Equivalent(
+          bootstrap.static_resources().clusters(i), copy.static_resources().clusters(i)));
+    }
+  }
+}
+BENCHMARK(BM_MessageDifferencerEquivalent)->Arg(1000)->Arg(20000)->Unit(benchmark::kMillisecond);
+
+void BM_MessageUtilEqual(benchmark::State& state) {
+  const auto bootstrap = makeBootstrap(state.range(0));
+  const auto copy = bootstrap;
+  for (auto _ : state) {
+    for (int i = 0; i < bootstrap.static_resources().clusters_size(); i++) {
+      benchmark::DoNotOptimize(MessageUtil::equal(bootstrap.static_resources().clusters(i),
+                                                  copy.static_resources().clusters(i)));
+    }
+  }
+}
+BENCHMARK(BM_MessageUtilEqual)->Arg(1000)->Arg(20000)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -22,6 +22,50 @@ TEST(UtilityTest, RepeatedPtrUtilDebugString) {
   EXPECT_EQ("[value: 10\n, value: 20\n]", RepeatedPtrUtil::debugString(repeated));
 }
 
+// The hash is the xxHash64 of the deterministic serialization, including for messages that don't
+// fit in the buffer it is computed through.
+TEST(UtilityTest, HashMatchesSerializedBytes) {
+  envoy::config::bootstrap::v2::Bootstrap bootstrap;
+  for (int i = 0; i < 500; i++) {
+    auto* cluster = bootstrap.mutable_static_resources()->add_clusters();
+    cluster->set_name("cluster_" + std::to_string(i));
+    (*cluster->mutable_metadata()->mutable_filter_metadata())["envoy.lb"] =
+        MessageUtil::keyValueStruct("key", "value");
+  }
+
+  ProtobufTypes::String text;
+  {
+    Protobuf::io::StringOutputStream string_stream(&text);
+    Protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    coded_stream.SetSerializationDeterministic(true);
+    bootstrap.SerializeToCodedStream(&coded_stream);
+  }
+  EXPECT_GT(text.size(), 4096);
+  EXPECT_EQ(HashUtil::xxHash64(text), MessageUtil::hash(bootstrap));
+  Protobuf::RepeatedPtrField<envoy::config::bootstrap::v2::Bootstrap> repeated;
+  *repeated.Add() = bootstrap;
+  EXPECT_EQ(HashUtil::xxHash64(text), RepeatedPtrUtil::hash(repeated));
+
+  EXPECT_EQ(HashUtil::xxHash64(""), MessageUtil::hash(ProtobufWkt::Empty()));
+}
+
+TEST(UtilityTest, MessageUtilEqual) {
+  ProtobufWkt::Struct s1 = MessageUtil::keyValueStruct("key", "value");
+  ProtobufWkt::Struct s2 = MessageUtil::keyValueStruct("key", "value");
+  ProtobufWkt::Struct s3 = MessageUtil::keyValueStruct("key", "other");
+  EXPECT_TRUE(MessageUtil::equal(s1, s1));
+  EXPECT_TRUE(MessageUtil::equal(s1, s2));
+  EXPECT_FALSE(MessageUtil::equal(s1, s3));
+  EXPECT_TRUE(MessageUtil()(s1, s2));
+
+  // Equivalent, even though the serialized bytes differ.
+  ProtobufWkt::Value v1;
+  ProtobufWkt::Value v2;
+  v2.set_number_value(0);
+  EXPECT_NE(MessageUtil::hash(v1), MessageUtil::hash(v2));
+  EXPECT_TRUE(MessageUtil::equal(v1, v2));
+}
+
 TEST(UtilityTest, DowncastAndValidate) {
   envoy::config::bootstrap::v2::Bootstrap bootstrap;
   EXPECT_THROW(MessageUtil::validate(bootstrap), ProtoValidationException);
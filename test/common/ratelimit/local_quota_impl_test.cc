@@ -0,0 +1,271 @@
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "common/ratelimit/local_quota_impl.h"
+#include "common/stats/stats_impl.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/grpc/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/printers.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::_;
+
+namespace Envoy {
+namespace RateLimit {
+namespace {
+
+class MockRequestCallbacks : public RequestCallbacks {
+public:
+  MOCK_METHOD1(complete, void(LimitStatus status));
+};
+
+class LocalQuotaTest : public testing::Test {
+public:
+  LocalQuotaTest() : report_timer_(new Event::MockTimer(&dispatcher_)) {
+    Grpc::MockAsyncClientFactory* factory = new Grpc::MockAsyncClientFactory();
+    // The clients of the quotas of other workers are not looked at.
+    EXPECT_CALL(*factory, create())
+        .WillOnce(Invoke([this] { return Grpc::AsyncClientPtr{async_client_}; }))
+        .WillRepeatedly(
+            Invoke([] { return Grpc::AsyncClientPtr{new NiceMock<Grpc::MockAsyncClient>()}; }));
+    ON_CALL(time_source_, currentTime()).WillByDefault(Return(MonotonicTime{}));
+    EXPECT_CALL(*report_timer_, enableTimer(std::chrono::milliseconds(1000)));
+    shared_state_ = std::make_shared<ThreadLocalQuotas::SharedState>(
+        LocalQuotaSettings{2, 1, std::chrono::milliseconds(1000)},
+        Grpc::AsyncClientFactoryPtr{factory}, stats_store_, 1, time_source_);
+    quotas_ = std::make_unique<ThreadLocalQuotas>(shared_state_, dispatcher_);
+  }
+
+  LimitStatus admit(const std::string& domain, const std::string& value) {
+    return quotas_->admit(domain, {{{{"key", value}}}});
+  }
+
+  // Fires the report timer and expects a report of the given hits for each quota in the map.
+  void expectReports(const std::map<std::string, uint32_t>& expected_hits) {
+    for (size_t i = 0; i < expected_hits.size(); ++i) {
+      EXPECT_CALL(*async_client_, send(_, _, _, _, _))
+          .WillOnce(Invoke([this, expected_hits](
+                               const Protobuf::MethodDescriptor& service_method,
+                               const Protobuf::Message& message,
+                               Grpc::AsyncRequestCallbacks& callbacks, Tracing::Span&,
+                               const absl::optional<std::chrono::milliseconds>& timeout)
+                               -> Grpc::AsyncRequest* {
+            EXPECT_EQ("envoy.service.ratelimit.v2.RateLimitService.ShouldRateLimit",
+                      service_method.full_name());
+            EXPECT_EQ(std::chrono::milliseconds(1000), timeout.value());
+            const auto& request =
+                dynamic_cast<const envoy::service::ratelimit::v2::RateLimitRequest&>(message);
+            const std::string& value = request.descriptors(0).entries(0).value();
+            EXPECT_EQ(expected_hits.at(value), request.hits_addend());
+            callbacks_[value] = dynamic_cast<RateLimitAsyncCallbacks*>(&callbacks);
+            return &async_request_;
+          }))
+          .RetiresOnSaturation();
+    }
+    EXPECT_CALL(*report_timer_, enableTimer(std::chrono::milliseconds(1000)));
+    report_timer_->callback_();
+  }
+
+  // Answers the report of a quota. If given, the descriptor has a limit of requests_per_unit a
+  // minute, of which limit_remaining are left.
+  void respond(const std::string& value, envoy::service::ratelimit::v2::RateLimitResponse_Code code,
+               absl::optional<uint32_t> requests_per_unit = absl::nullopt,
+               uint32_t limit_remaining = 0) {
+    std::unique_ptr<envoy::service::ratelimit::v2::RateLimitResponse> response =
+        std::make_unique<envoy::service::ratelimit::v2::RateLimitResponse>();
+    response->set_overall_code(code);
+    auto* status = response->add_statuses();
+    status->set_code(code);
+    if (requests_per_unit) {
+      status->mutable_current_limit()->set_requests_per_unit(requests_per_unit.value());
+      status->mutable_current_limit()->set_unit(
+          envoy::service::ratelimit::v2::RateLimitResponse_RateLimit_Unit_MINUTE);
+      status->set_limit_remaining(limit_remaining);
+    }
+    callbacks_.at(value)->onSuccess(std::move(response), span_);
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  NiceMock<MockMonotonicTimeSource> time_source_;
+  Event::MockDispatcher dispatcher_;
+  Event::MockTimer* report_timer_;
+  Grpc::MockAsyncClient* async_client_{new Grpc::MockAsyncClient()};
+  Grpc::MockAsyncRequest async_request_;
+  std::map<std::string, RateLimitAsyncCallbacks*> callbacks_;
+  Tracing::MockSpan span_;
+  ThreadLocalQuotas::SharedStateSharedPtr shared_state_;
+  std::unique_ptr<ThreadLocalQuotas> quotas_;
+};
+
+// Requests are admitted against the local bucket, and their hits are reported in a single request.
+TEST_F(LocalQuotaTest, AdmitAndReport) {
+  EXPECT_EQ(LimitStatus::OK, admit("domain", "foo"));
+  EXPECT_EQ(LimitStatus::OK, admit("domain", "foo"));
+  EXPECT_EQ(LimitStatus::OverLimit, admit("domain", "foo"));
+  EXPECT_EQ(LimitStatus::OK, admit("domain", "bar"));
+  EXPECT_EQ(2UL, quotas_->size());
+
+  expectReports({{"foo", 3}, {"bar", 1}});
+  respond("foo", envoy::service::ratelimit::v2::RateLimitResponse_Code_OK);
+  respond("bar", envoy::service::ratelimit::v2::RateLimitResponse_Code_OK);
+  EXPECT_EQ(2UL, stats_store_.counter("ratelimit.local_quota.report_ok").value());
+
+  // The quotas saw no request since the last report.
+  expectReports({});
+  EXPECT_EQ(0UL, quotas_->size());
+}
+
+// The same descriptors in another domain get another quota.
+TEST_F(LocalQuotaTest, QuotaPerDomain) {
+  EXPECT_EQ(LimitStatus::OK, admit("domain", "foo"));
+  EXPECT_EQ(LimitStatus::OK, admit("domain", "foo"));
+  EXPECT_EQ(LimitStatus::OK, admit("other", "foo"));
+  EXPECT_EQ(2UL, quotas_->size());
+}
+
+// The quotas of all workers draw on the same bucket.
+TEST_F(LocalQuotaTest, BucketSharedByWorkers) {
+  NiceMock<Event::MockDispatcher> other_dispatcher;
+  ThreadLocalQuotas other_quotas(shared_state_, other_dispatcher);
+
+  EXPECT_EQ(LimitStatus::OK, admit("domain", "foo"));
+  EXPECT_EQ(LimitStatus::OK, other_quotas.admit("domain", {{{{"key", "foo"}}}}));
+  EXPECT_EQ(LimitStatus::OverLimit, admit("domain", "foo"));
+  EXPECT_EQ(LimitStatus::OverLimit, other_quotas.admit("domain", {{{{"key", "foo"}}}}));
+}
+
+// An OVER_LIMIT verdict closes the quota until the service reports it as OK again.
+TEST_F(LocalQuotaTest, OverLimitVerdict) {
+  EXPECT_EQ(LimitStatus::OK, admit("domain", "foo"));
+  expectReports({{"foo", 1}});
+  respond("foo", envoy::service::ratelimit::v2::RateLimitResponse_Code_OVER_LIMIT);
+  EXPECT_EQ(1UL, stats_store_.counter("ratelimit.local_quota.report_over_limit").value());
+
+  EXPECT_EQ(LimitStatus::OverLimit, admit("domain", "foo"));
+  EXPECT_EQ(LimitStatus::OverLimit, admit("domain", "foo"));
+
+  expectReports({{"foo", 2}});
+  respond("foo", envoy::service::ratelimit::v2::RateLimitResponse_Code_OK);
+  EXPECT_EQ(LimitStatus::OK, admit("domain", "foo"));
+}
+
+// A failed report keeps the last verdict.
+// The service's limit for the descriptors is below the size of the bucket, which is capped at what
+// the limit has left.
+TEST_F(LocalQuotaTest, LimitRemainingCapsBucket) {
+  EXPECT_EQ(LimitStatus::OK, admit("domain", "foo"));
+  expectReports({{"foo", 1}});
+  respond("foo", envoy::service::ratelimit::v2::RateLimitResponse_Code_OK, 1, 0);
+  EXPECT_EQ(1UL, stats_store_.counter("ratelimit.local_quota.report_ok").value());
+
+  EXPECT_EQ(LimitStatus::OverLimit, admit("domain", "foo"));
+}
+
+// A descriptor without a limit at the service leaves the bucket as it is.
+TEST_F(LocalQuotaTest, NoLimitLeavesBucket) {
+  EXPECT_EQ(LimitStatus::OK, admit("domain", "foo"));
+  expectReports({{"foo", 1}});
+  respond("foo", envoy::service::ratelimit::v2::RateLimitResponse_Code_OK);
+
+  EXPECT_EQ(LimitStatus::OK, admit("domain", "foo"));
+  EXPECT_EQ(LimitStatus::OverLimit, admit("domain", "foo"));
+}
+
+TEST_F(LocalQuotaTest, ReportFailure) {
+  EXPECT_EQ(LimitStatus::OK, admit("domain", "foo"));
+  expectReports({{"foo", 1}});
+  respond("foo", envoy::service::ratelimit::v2::RateLimitResponse_Code_OVER_LIMIT);
+
+  EXPECT_EQ(LimitStatus::OverLimit, admit("domain", "foo"));
+  expectReports({{"foo", 1}});
+  callbacks_.at("foo")->onFailure(Grpc::Status::Unavailable, "", span_);
+  EXPECT_EQ(1UL, stats_store_.counter("ratelimit.local_quota.report_error").value());
+  EXPECT_EQ(LimitStatus::OverLimit, admit("domain", "foo"));
+}
+
+// Hits made while a report is in flight wait for the next report, and the report in flight is
+// cancelled when the quotas are destroyed.
+TEST_F(LocalQuotaTest, ReportInFlight) {
+  EXPECT_EQ(LimitStatus::OK, admit("domain", "foo"));
+  expectReports({{"foo", 1}});
+  EXPECT_EQ(LimitStatus::OK, admit("domain", "foo"));
+  expectReports({});
+  EXPECT_EQ(1UL, quotas_->size());
+
+  respond("foo", envoy::service::ratelimit::v2::RateLimitResponse_Code_OK);
+  expectReports({{"foo", 1}});
+
+  EXPECT_CALL(async_request_, cancel());
+  quotas_.reset();
+}
+
+TEST(LocalQuotaSettingsTest, FromRuntime) {
+  NiceMock<Runtime::MockLoader> runtime;
+  EXPECT_FALSE(LocalQuotaSettings::fromRuntime(runtime).has_value());
+
+  ON_CALL(runtime.snapshot_, getInteger("ratelimit.local_quota.max_tokens", 0))
+      .WillByDefault(Return(10));
+  const absl::optional<LocalQuotaSettings> settings = LocalQuotaSettings::fromRuntime(runtime);
+  ASSERT_TRUE(settings.has_value());
+  EXPECT_EQ(10UL, settings->max_tokens_);
+  EXPECT_EQ(10, settings->tokens_per_second_);
+  EXPECT_EQ(std::chrono::milliseconds(1000), settings->report_interval_);
+}
+
+TEST(LocalQuotaFactoryTest, Create) {
+  envoy::config::ratelimit::v2::RateLimitServiceConfig config;
+  config.mutable_grpc_service()->mutable_envoy_grpc()->set_cluster_name("ratelimit");
+  config.set_use_data_plane_proto(true);
+  Grpc::MockAsyncClientManager async_client_manager;
+  Stats::IsolatedStoreImpl stats_store;
+  NiceMock<ThreadLocal::MockInstance> tls;
+  EXPECT_CALL(async_client_manager, factoryForGrpcService(_, _, _))
+      .WillOnce(Invoke([](const envoy::api::v2::core::GrpcService& grpc_service, Stats::Scope&,
+                          bool) {
+        EXPECT_EQ("ratelimit", grpc_service.envoy_grpc().cluster_name());
+        Grpc::MockAsyncClientFactory* factory = new Grpc::MockAsyncClientFactory();
+        EXPECT_CALL(*factory, create()).WillOnce(Invoke([] {
+          return Grpc::AsyncClientPtr{new NiceMock<Grpc::MockAsyncClient>()};
+        }));
+        return Grpc::AsyncClientFactoryPtr{factory};
+      }));
+  LocalQuotaFactoryImpl factory(config, {1, 1, std::chrono::milliseconds(1000)},
+                                async_client_manager, stats_store, tls, 1);
+
+  // The client completes within the call.
+  MockRequestCallbacks callbacks;
+  ClientPtr client = factory.create(absl::nullopt);
+  EXPECT_CALL(callbacks, complete(LimitStatus::OK));
+  client->limit(callbacks, "domain", {{{{"key", "value"}}}}, Tracing::NullSpan::instance());
+  EXPECT_CALL(callbacks, complete(LimitStatus::OverLimit));
+  client->limit(callbacks, "domain", {{{{"key", "value"}}}}, Tracing::NullSpan::instance());
+}
+
+TEST(LocalQuotaFactoryTest, LegacyProto) {
+  envoy::config::ratelimit::v2::RateLimitServiceConfig config;
+  config.set_cluster_name("ratelimit");
+  Grpc::MockAsyncClientManager async_client_manager;
+  Stats::IsolatedStoreImpl stats_store;
+  NiceMock<ThreadLocal::MockInstance> tls;
+  EXPECT_THROW_WITH_MESSAGE(
+      LocalQuotaFactoryImpl(config, {1, 1, std::chrono::milliseconds(1000)}, async_client_manager,
+                            stats_store, tls, 1),
+      EnvoyException,
+      "ratelimit: local quotas require the data-plane-api defined rate limit service");
+}
+
+} // namespace
+} // namespace RateLimit
+} // namespace Envoy
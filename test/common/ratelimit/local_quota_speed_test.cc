@@ -0,0 +1,196 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Measures how long a request waits to be admitted by a rate limit client: GrpcClientImpl asks the
+// rate limit service for each request, while the local quotas admit it on the worker and report
+// the usage in the background. The service is an in-process fake that answers after a simulated
+// round trip, and enforces a per second limit on the hits it is told about.
+
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/event/deferred_deletable.h"
+
+#include "common/common/assert.h"
+#include "common/event/dispatcher_impl.h"
+#include "common/ratelimit/local_quota_impl.h"
+#include "common/ratelimit/ratelimit_impl.h"
+#include "common/stats/stats_impl.h"
+#include "common/tracing/http_tracer_impl.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace RateLimit {
+
+// The hits per second the fake service allows.
+static const uint64_t ServiceLimit = 1000000;
+
+class FakeRateLimitService : public Grpc::AsyncClient {
+public:
+  FakeRateLimitService(Event::Dispatcher& dispatcher, std::chrono::milliseconds round_trip)
+      : dispatcher_(dispatcher), round_trip_(round_trip) {}
+
+  // Grpc::AsyncClient
+  Grpc::AsyncRequest* send(const Protobuf::MethodDescriptor&, const Protobuf::Message& request,
+                           Grpc::AsyncRequestCallbacks& callbacks, Tracing::Span&,
+                           const absl::optional<std::chrono::milliseconds>&) override {
+    // The request goes through its wire format, as it would on its way to the service.
+    envoy::service::ratelimit::v2::RateLimitRequest received;
+    RELEASE_ASSERT(received.ParseFromString(request.SerializeAsString()), "");
+
+    const std::chrono::seconds window = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch());
+    if (window != window_) {
+      window_ = window;
+      hits_ = 0;
+    }
+    hits_ += std::max<uint32_t>(received.hits_addend(), 1);
+
+    envoy::service::ratelimit::v2::RateLimitResponse response;
+    response.set_overall_code(hits_ > ServiceLimit
+                                  ? envoy::service::ratelimit::v2::RateLimitResponse_Code_OVER_LIMIT
+                                  : envoy::service::ratelimit::v2::RateLimitResponse_Code_OK);
+    pending_.emplace_back(new PendingRequest(*this, callbacks, response.SerializeAsString()));
+    return pending_.back().get();
+  }
+  Grpc::AsyncStream* start(const Protobuf::MethodDescriptor&,
+                           Grpc::AsyncStreamCallbacks&) override {
+    NOT_IMPLEMENTED;
+  }
+
+private:
+  struct PendingRequest : public Grpc::AsyncRequest, public Event::DeferredDeletable {
+    PendingRequest(FakeRateLimitService& parent, Grpc::AsyncRequestCallbacks& callbacks,
+                   std::string&& response)
+        : parent_(parent), callbacks_(callbacks), response_(std::move(response)),
+          timer_(parent.dispatcher_.createTimer([this]() -> void { respond(); })) {
+      timer_->enableTimer(parent_.round_trip_);
+    }
+
+    void respond() {
+      ProtobufTypes::MessagePtr response = callbacks_.createEmptyResponse();
+      RELEASE_ASSERT(response->ParseFromString(response_), "");
+      parent_.remove(*this);
+      callbacks_.onSuccessUntyped(std::move(response), Tracing::NullSpan::instance());
+    }
+
+    // Grpc::AsyncRequest
+    void cancel() override {
+      timer_->disableTimer();
+      parent_.remove(*this);
+    }
+
+    FakeRateLimitService& parent_;
+    Grpc::AsyncRequestCallbacks& callbacks_;
+    const std::string response_;
+    Event::TimerPtr timer_;
+  };
+
+  void remove(PendingRequest& request) {
+    const auto it =
+        std::find_if(pending_.begin(), pending_.end(),
+                     [&request](const std::unique_ptr<PendingRequest>& pending) -> bool {
+                       return pending.get() == &request;
+                     });
+    ASSERT(it != pending_.end());
+    dispatcher_.deferredDelete(std::move(*it));
+    pending_.erase(it);
+  }
+
+  Event::Dispatcher& dispatcher_;
+  const std::chrono::milliseconds round_trip_;
+  std::chrono::seconds window_{};
+  uint64_t hits_{};
+  std::list<std::unique_ptr<PendingRequest>> pending_;
+};
+
+class FakeRateLimitServiceFactory : public Grpc::AsyncClientFactory {
+public:
+  FakeRateLimitServiceFactory(Event::Dispatcher& dispatcher, std::chrono::milliseconds round_trip)
+      : dispatcher_(dispatcher), round_trip_(round_trip) {}
+
+  // Grpc::AsyncClientFactory
+  Grpc::AsyncClientPtr create() override {
+    return std::make_unique<FakeRateLimitService>(dispatcher_, round_trip_);
+  }
+
+private:
+  Event::Dispatcher& dispatcher_;
+  const std::chrono::milliseconds round_trip_;
+};
+
+struct CountingCallbacks : public RequestCallbacks {
+  // RateLimit::RequestCallbacks
+  void complete(LimitStatus status) override {
+    completed_ = true;
+    over_limit_ += status == LimitStatus::OverLimit;
+  }
+
+  bool completed_{};
+  uint64_t over_limit_{};
+};
+
+static const std::vector<Descriptor> descriptors = {{{{"destination_cluster", "cluster_0"}}}};
+
+// Every request waits for the round trip to the service.
+static void BM_GrpcClientAdmission(benchmark::State& state) {
+  Event::DispatcherImpl dispatcher;
+  GrpcClientImpl client(
+      std::make_unique<FakeRateLimitService>(dispatcher, std::chrono::milliseconds(state.range(0))),
+      absl::nullopt, "envoy.service.ratelimit.v2.RateLimitService.ShouldRateLimit");
+  CountingCallbacks callbacks;
+
+  for (auto _ : state) {
+    client.limit(callbacks, "domain", descriptors, Tracing::NullSpan::instance());
+    dispatcher.run(Event::Dispatcher::RunType::Block);
+    RELEASE_ASSERT(callbacks.completed_, "");
+    callbacks.completed_ = false;
+  }
+  state.counters["over_limit"] = callbacks.over_limit_;
+}
+BENCHMARK(BM_GrpcClientAdmission)->Arg(1)->Arg(5)->Unit(benchmark::kMicrosecond);
+
+// Requests are admitted by the local quota, which reports to the service every 100ms.
+static void BM_LocalQuotaAdmission(benchmark::State& state) {
+  Event::DispatcherImpl dispatcher;
+  Stats::IsolatedStoreImpl stats_store;
+  ThreadLocalQuotas quotas(
+      std::make_shared<ThreadLocalQuotas::SharedState>(
+          LocalQuotaSettings{ServiceLimit, ServiceLimit, std::chrono::milliseconds(100)},
+          std::make_unique<FakeRateLimitServiceFactory>(
+              dispatcher, std::chrono::milliseconds(state.range(0))),
+          stats_store, 1, ProdMonotonicTimeSource::instance_),
+      dispatcher);
+  LocalQuotaClientImpl client(quotas);
+  CountingCallbacks callbacks;
+
+  for (auto _ : state) {
+    client.limit(callbacks, "domain", descriptors, Tracing::NullSpan::instance());
+    RELEASE_ASSERT(callbacks.completed_, "");
+    callbacks.completed_ = false;
+    // Lets the reports and the verdicts of the service through.
+    dispatcher.run(Event::Dispatcher::RunType::NonBlock);
+  }
+  state.counters["over_limit"] = callbacks.over_limit_;
+  state.counters["reports"] =
+      stats_store.counter("ratelimit.local_quota.report_ok").value() +
+      stats_store.counter("ratelimit.local_quota.report_over_limit").value();
+}
+BENCHMARK(BM_LocalQuotaAdmission)->Arg(1)->Arg(5)->Unit(benchmark::kMicrosecond);
+
+} // namespace RateLimit
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
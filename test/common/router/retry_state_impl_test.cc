@@ -319,7 +319,7 @@ TEST_F(RouterRetryStateImplTest, RouteConfigNoHeaderConfig) {
 
 TEST_F(RouterRetryStateImplTest, NoAvailableRetries) {
   cluster_.resource_manager_.reset(
-      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 0, 0, 0, 0));
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 0, 0, 0, 0, 0));
 
   Http::TestHeaderMapImpl request_headers{{"x-envoy-retry-on", "connect-failure"}};
   setup(request_headers);
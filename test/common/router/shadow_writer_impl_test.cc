@@ -4,6 +4,7 @@
 #include "common/http/headers.h"
 #include "common/http/message_impl.h"
 #include "common/router/shadow_writer_impl.h"
+#include "common/upstream/resource_manager_impl.h"
 
 #include "test/mocks/upstream/mocks.h"
 
@@ -11,6 +12,8 @@
 #include "gtest/gtest.h"
 
 using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
 using testing::_;
 
 namespace Envoy {
@@ -65,5 +68,61 @@ TEST(ShadowWriterImplTest, All) {
   expectShadowWriter("cluster1:80", "cluster1-shadow:80");
 }
 
+Http::MessagePtr makeShadowRequest() {
+  Http::MessagePtr message(new Http::RequestMessageImpl());
+  message->headers().insertHost().value(std::string("cluster1"));
+  return message;
+}
+
+// Shadow requests past the shadow cluster's limit are dropped without being sent, and the limit is
+// released as in flight shadow requests complete.
+TEST(ShadowWriterImplTest, Overflow) {
+  NiceMock<Upstream::MockClusterManager> cm;
+  auto& info = *cm.thread_local_cluster_.cluster_.info_;
+  info.resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(info.runtime_, "fake_key", 1024, 1024, 1024, 1, 1));
+  ShadowWriterImpl writer(cm);
+
+  Http::MockAsyncClientRequest request(&cm.async_client_);
+  Http::AsyncClient::Callbacks* callback;
+  EXPECT_CALL(cm.async_client_, send_(_, _, _))
+      .WillOnce(Invoke([&](Http::MessagePtr&, Http::AsyncClient::Callbacks& callbacks,
+                           const absl::optional<std::chrono::milliseconds>&)
+                           -> Http::AsyncClient::Request* {
+        callback = &callbacks;
+        return &request;
+      }));
+  writer.shadow("foo", makeShadowRequest(), std::chrono::milliseconds(5));
+
+  EXPECT_CALL(cm.async_client_, send_(_, _, _)).Times(0);
+  writer.shadow("foo", makeShadowRequest(), std::chrono::milliseconds(5));
+  EXPECT_EQ(1U, info.stats_store_.counter("upstream_rq_shadow_overflow").value());
+
+  callback->onSuccess(Http::MessagePtr{new Http::RequestMessageImpl()});
+
+  // A request that fails inline also releases the limit.
+  EXPECT_CALL(cm.async_client_, send_(_, _, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](Http::MessagePtr&, Http::AsyncClient::Callbacks& callbacks,
+                                 const absl::optional<std::chrono::milliseconds>&)
+                                 -> Http::AsyncClient::Request* {
+        callbacks.onFailure(Http::AsyncClient::FailureReason::Reset);
+        return nullptr;
+      }));
+  writer.shadow("foo", makeShadowRequest(), std::chrono::milliseconds(5));
+  writer.shadow("foo", makeShadowRequest(), std::chrono::milliseconds(5));
+  EXPECT_EQ(1U, info.stats_store_.counter("upstream_rq_shadow_overflow").value());
+}
+
+// Shadowing to a cluster that no longer exists is a no-op.
+TEST(ShadowWriterImplTest, UnknownCluster) {
+  NiceMock<Upstream::MockClusterManager> cm;
+  ShadowWriterImpl writer(cm);
+
+  EXPECT_CALL(cm, get("foo")).WillOnce(Return(nullptr));
+  EXPECT_CALL(cm, httpAsyncClientForCluster(_)).Times(0);
+  writer.shadow("foo", makeShadowRequest(), std::chrono::milliseconds(5));
+}
+
 } // namespace Router
 } // namespace Envoy
@@ -0,0 +1,168 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Simulates a storm of concurrent RSA-2048 server handshakes on one event loop and reports the
+// longest time a single handshake step blocked the loop, with private key operations run inline
+// and with them handed to ThreadPoolPrivateKeyMethodProvider. Both ends of each handshake run in
+// process over an in-memory BIO pair.
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/event/dispatcher_impl.h"
+#include "common/ssl/thread_pool_private_key_method.h"
+
+#include "openssl/bio.h"
+#include "openssl/bn.h"
+#include "openssl/evp.h"
+#include "openssl/rsa.h"
+#include "openssl/ssl.h"
+#include "openssl/x509.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Ssl {
+
+// Builds a server context with a self-signed RSA-2048 certificate. Key generation is slow, so the
+// key is generated once.
+static bssl::UniquePtr<SSL_CTX> newServerContext(PrivateKeyMethodProvider* provider) {
+  static EVP_PKEY* pkey = []() -> EVP_PKEY* {
+    bssl::UniquePtr<RSA> rsa(RSA_new());
+    bssl::UniquePtr<BIGNUM> e(BN_new());
+    RELEASE_ASSERT(BN_set_word(e.get(), RSA_F4) == 1, "");
+    RELEASE_ASSERT(RSA_generate_key_ex(rsa.get(), 2048, e.get(), nullptr) == 1, "");
+    EVP_PKEY* pkey = EVP_PKEY_new();
+    RELEASE_ASSERT(EVP_PKEY_assign_RSA(pkey, rsa.release()) == 1, "");
+    return pkey;
+  }();
+
+  bssl::UniquePtr<X509> cert(X509_new());
+  X509_set_version(cert.get(), 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1);
+  X509_gmtime_adj(X509_get_notBefore(cert.get()), 0);
+  X509_gmtime_adj(X509_get_notAfter(cert.get()), 60 * 60 * 24);
+  X509_NAME* name = X509_get_subject_name(cert.get());
+  X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                             reinterpret_cast<const uint8_t*>("localhost"), -1, -1, 0);
+  X509_set_issuer_name(cert.get(), name);
+  X509_set_pubkey(cert.get(), pkey);
+  RELEASE_ASSERT(X509_sign(cert.get(), pkey, EVP_sha256()) != 0, "");
+
+  bssl::UniquePtr<SSL_CTX> ctx(SSL_CTX_new(TLS_method()));
+  RELEASE_ASSERT(SSL_CTX_use_certificate(ctx.get(), cert.get()) == 1, "");
+  RELEASE_ASSERT(SSL_CTX_use_PrivateKey(ctx.get(), pkey) == 1, "");
+  if (provider != nullptr) {
+    SSL_CTX_set_private_key_method(ctx.get(), provider->getBoringSslPrivateKeyMethod());
+  }
+  return ctx;
+}
+
+class Handshake : public PrivateKeyConnectionCallbacks {
+public:
+  Handshake(SSL_CTX* client_ctx, SSL_CTX* server_ctx)
+      : client_(SSL_new(client_ctx)), server_(SSL_new(server_ctx)) {
+    SSL_set_connect_state(client_.get());
+    SSL_set_accept_state(server_.get());
+    BIO* client_bio;
+    BIO* server_bio;
+    RELEASE_ASSERT(BIO_new_bio_pair(&client_bio, 0, &server_bio, 0) == 1, "");
+    SSL_set_bio(client_.get(), client_bio, client_bio);
+    SSL_set_bio(server_.get(), server_bio, server_bio);
+  }
+
+  // Advances both ends as far as possible. Returns the time spent in the server's handshake.
+  std::chrono::nanoseconds step() {
+    if (!client_done_) {
+      client_done_ = SSL_do_handshake(client_.get()) == 1;
+    }
+    if (server_done_ || waiting_) {
+      return std::chrono::nanoseconds(0);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    int rc = SSL_do_handshake(server_.get());
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    server_done_ = rc == 1;
+    if (!server_done_) {
+      int err = SSL_get_error(server_.get(), rc);
+      RELEASE_ASSERT(err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_PRIVATE_KEY_OPERATION,
+                     "");
+      waiting_ = err == SSL_ERROR_WANT_PRIVATE_KEY_OPERATION;
+    }
+    return elapsed;
+  }
+
+  bool done() const { return client_done_ && server_done_; }
+
+  // Ssl::PrivateKeyConnectionCallbacks
+  void onPrivateKeyMethodComplete() override { waiting_ = false; }
+
+  bssl::UniquePtr<SSL> client_;
+  bssl::UniquePtr<SSL> server_;
+  bool client_done_{};
+  bool server_done_{};
+  bool waiting_{};
+};
+
+static void runStorm(benchmark::State& state, PrivateKeyMethodProvider* provider) {
+  Event::DispatcherImpl dispatcher;
+  bssl::UniquePtr<SSL_CTX> server_ctx = newServerContext(provider);
+  bssl::UniquePtr<SSL_CTX> client_ctx(SSL_CTX_new(TLS_method()));
+  std::chrono::nanoseconds max_stall(0);
+
+  for (auto _ : state) {
+    std::vector<std::unique_ptr<Handshake>> handshakes;
+    for (int64_t i = 0; i < state.range(0); i++) {
+      handshakes.emplace_back(new Handshake(client_ctx.get(), server_ctx.get()));
+      if (provider != nullptr) {
+        provider->registerPrivateKeyMethod(handshakes.back()->server_.get(), *handshakes.back(),
+                                           dispatcher);
+      }
+    }
+
+    bool done = false;
+    while (!done) {
+      done = true;
+      for (auto& handshake : handshakes) {
+        max_stall = std::max(max_stall, handshake->step());
+        done &= handshake->done();
+      }
+      // Deliver completed private key operations.
+      dispatcher.run(Event::Dispatcher::RunType::NonBlock);
+    }
+
+    if (provider != nullptr) {
+      for (auto& handshake : handshakes) {
+        provider->unregisterPrivateKeyMethod(handshake->server_.get());
+      }
+    }
+  }
+
+  state.counters["max_stall_us"] =
+      std::chrono::duration_cast<std::chrono::microseconds>(max_stall).count();
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_HandshakeStormInline(benchmark::State& state) { runStorm(state, nullptr); }
+BENCHMARK(BM_HandshakeStormInline)->Arg(1)->Arg(16)->Arg(64)->Unit(benchmark::kMillisecond);
+
+static void BM_HandshakeStormThreadPool(benchmark::State& state) {
+  ThreadPoolPrivateKeyMethodProvider provider(4);
+  runStorm(state, &provider);
+}
+BENCHMARK(BM_HandshakeStormThreadPool)->Arg(1)->Arg(16)->Arg(64)->Unit(benchmark::kMillisecond);
+
+} // namespace Ssl
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
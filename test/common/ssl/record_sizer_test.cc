@@ -0,0 +1,85 @@
+#include <chrono>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/ssl/record_sizer.h"
+
+#include "test/mocks/common.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Ssl {
+
+class RecordSizerTest : public testing::Test {
+public:
+  RecordSizerTest() : sizer_(time_source_) {
+    ON_CALL(time_source_, currentTime()).WillByDefault(testing::ReturnPointee(&now_));
+  }
+
+  void advance(std::chrono::milliseconds duration) { now_ += duration; }
+
+  MonotonicTime now_{std::chrono::seconds(10)};
+  NiceMock<MockMonotonicTimeSource> time_source_;
+  RecordSizer sizer_;
+};
+
+TEST_F(RecordSizerTest, SmallRecordsFirst) {
+  sizer_.onWriteStart();
+  EXPECT_EQ(RecordSizer::SmallRecordSize, sizer_.recordSize());
+  sizer_.onBytesWritten(RecordSizer::SmallRecordBytes - 1);
+  EXPECT_EQ(RecordSizer::SmallRecordSize, sizer_.recordSize());
+  sizer_.onBytesWritten(1);
+  EXPECT_EQ(RecordSizer::LargeRecordSize, sizer_.recordSize());
+}
+
+TEST_F(RecordSizerTest, ResetAfterIdle) {
+  sizer_.onWriteStart();
+  sizer_.onBytesWritten(RecordSizer::SmallRecordBytes);
+  EXPECT_EQ(RecordSizer::LargeRecordSize, sizer_.recordSize());
+
+  // Busy connections keep large records.
+  advance(std::chrono::milliseconds(999));
+  sizer_.onWriteStart();
+  EXPECT_EQ(RecordSizer::LargeRecordSize, sizer_.recordSize());
+
+  advance(std::chrono::milliseconds(1000));
+  sizer_.onWriteStart();
+  EXPECT_EQ(RecordSizer::SmallRecordSize, sizer_.recordSize());
+}
+
+TEST_F(RecordSizerTest, WholeRecordsFromLargeSlice) {
+  sizer_.onWriteStart();
+  Buffer::OwnedImpl buffer(std::string(10000, 'a'));
+  // 7 small records fit the slice; the remainder is left to be coalesced with later data.
+  EXPECT_EQ(7 * RecordSizer::SmallRecordSize, sizer_.nextWriteSize(buffer));
+
+  sizer_.onBytesWritten(RecordSizer::SmallRecordBytes);
+  Buffer::OwnedImpl large_buffer(std::string(10 * RecordSizer::LargeRecordSize, 'a'));
+  uint64_t size = sizer_.nextWriteSize(large_buffer);
+  EXPECT_EQ(0UL, size % RecordSizer::LargeRecordSize);
+  EXPECT_LE(size, RecordSizer::MaxWriteSize);
+}
+
+TEST_F(RecordSizerTest, CoalesceSmallSlices) {
+  sizer_.onWriteStart();
+  Buffer::OwnedImpl buffer;
+  for (uint32_t i = 0; i < 10; i++) {
+    Buffer::OwnedImpl slice(std::string(300, 'a'));
+    buffer.move(slice);
+  }
+  EXPECT_EQ(RecordSizer::SmallRecordSize, sizer_.nextWriteSize(buffer));
+
+  Buffer::OwnedImpl short_buffer("hello");
+  EXPECT_EQ(5UL, sizer_.nextWriteSize(short_buffer));
+
+  Buffer::OwnedImpl empty_buffer;
+  EXPECT_EQ(0UL, sizer_.nextWriteSize(empty_buffer));
+}
+
+} // namespace Ssl
+} // namespace Envoy
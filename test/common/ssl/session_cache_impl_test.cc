@@ -0,0 +1,112 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common/thread.h"
+#include "common/ssl/session_cache_impl.h"
+
+#include "gtest/gtest.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Ssl {
+
+class SessionCacheImplTest : public testing::Test {
+public:
+  SessionCacheImplTest() : ctx_(SSL_CTX_new(TLS_method())) {}
+
+  bssl::UniquePtr<SSL_SESSION> newSession() {
+    return bssl::UniquePtr<SSL_SESSION>(SSL_SESSION_new(ctx_.get()));
+  }
+
+  bssl::UniquePtr<SSL_CTX> ctx_;
+};
+
+TEST_F(SessionCacheImplTest, InsertLookupRemove) {
+  SessionCacheImpl cache(16, 4);
+  bssl::UniquePtr<SSL_SESSION> session = newSession();
+  SSL_SESSION* raw_session = session.get();
+
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  cache.insert("a", std::move(session));
+  EXPECT_EQ(1UL, cache.size());
+
+  bssl::UniquePtr<SSL_SESSION> found = cache.lookup("a");
+  EXPECT_EQ(raw_session, found.get());
+  // The cache still holds its own reference.
+  found.reset();
+  EXPECT_EQ(raw_session, cache.lookup("a").get());
+
+  cache.remove("a");
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  EXPECT_EQ(0UL, cache.size());
+  cache.remove("a");
+}
+
+TEST_F(SessionCacheImplTest, Replace) {
+  SessionCacheImpl cache(16, 4);
+  cache.insert("a", newSession());
+  bssl::UniquePtr<SSL_SESSION> session = newSession();
+  SSL_SESSION* raw_session = session.get();
+  cache.insert("a", std::move(session));
+
+  EXPECT_EQ(1UL, cache.size());
+  EXPECT_EQ(raw_session, cache.lookup("a").get());
+}
+
+TEST_F(SessionCacheImplTest, KeysAreBinary) {
+  SessionCacheImpl cache(16, 4);
+  const std::string key1("\0\1", 2);
+  const std::string key2("\0\2", 2);
+  cache.insert(key1, newSession());
+
+  EXPECT_NE(nullptr, cache.lookup(key1));
+  EXPECT_EQ(nullptr, cache.lookup(key2));
+}
+
+TEST_F(SessionCacheImplTest, EvictLeastRecentlyUsed) {
+  // A single shard makes eviction order deterministic.
+  SessionCacheImpl cache(2, 1);
+  cache.insert("a", newSession());
+  cache.insert("b", newSession());
+  // Touch "a" so that "b" is the least recently used.
+  EXPECT_NE(nullptr, cache.lookup("a"));
+  cache.insert("c", newSession());
+
+  EXPECT_EQ(2UL, cache.size());
+  EXPECT_NE(nullptr, cache.lookup("a"));
+  EXPECT_EQ(nullptr, cache.lookup("b"));
+  EXPECT_NE(nullptr, cache.lookup("c"));
+}
+
+TEST_F(SessionCacheImplTest, Bounded) {
+  SessionCacheImpl cache(64, 8);
+  for (uint32_t i = 0; i < 1000; i++) {
+    cache.insert(std::to_string(i), newSession());
+  }
+  EXPECT_LE(cache.size(), 64UL);
+}
+
+TEST_F(SessionCacheImplTest, ConcurrentAccess) {
+  SessionCacheImpl cache(1024, 16);
+  std::vector<std::unique_ptr<Thread::Thread>> threads;
+  for (uint32_t t = 0; t < 4; t++) {
+    threads.emplace_back(new Thread::Thread([this, &cache, t]() -> void {
+      for (uint32_t i = 0; i < 1000; i++) {
+        const std::string key = std::to_string((t * 1000 + i) % 256);
+        cache.insert(key, newSession());
+        cache.lookup(key);
+        if (i % 7 == 0) {
+          cache.remove(key);
+        }
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  EXPECT_LE(cache.size(), 256UL);
+}
+
+} // namespace Ssl
+} // namespace Envoy
@@ -0,0 +1,182 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Compares a full TLS handshake with one resumed from the sharded session cache used by the server
+// and client contexts. Both ends run in process over an in-memory BIO pair so only the handshake
+// itself is measured.
+
+#include <string>
+
+#include "common/common/assert.h"
+#include "common/ssl/session_cache_impl.h"
+
+#include "openssl/bio.h"
+#include "openssl/ec_key.h"
+#include "openssl/evp.h"
+#include "openssl/ssl.h"
+#include "openssl/x509.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Ssl {
+
+static const char Peer[] = "127.0.0.1:443";
+
+static SessionCacheImpl& serverCache() {
+  static SessionCacheImpl* cache = new SessionCacheImpl(20 * 1024, 16);
+  return *cache;
+}
+
+static SessionCacheImpl& clientCache() {
+  static SessionCacheImpl* cache = new SessionCacheImpl(1024, 16);
+  return *cache;
+}
+
+static SSL_SESSION* getSession(SSL*, const uint8_t* id, int id_length, int* out_copy) {
+  *out_copy = 0;
+  return serverCache()
+      .lookup(absl::string_view(reinterpret_cast<const char*>(id), id_length))
+      .release();
+}
+
+// Builds a server context with a self-signed P-256 certificate. Tickets are disabled and the
+// protocol capped at TLS 1.2 so that resumption goes through the session cache.
+static bssl::UniquePtr<SSL_CTX> newServerContext() {
+  bssl::UniquePtr<EC_KEY> ec_key(EC_KEY_new_by_curve_name(NID_X9_62_prime256v1));
+  RELEASE_ASSERT(ec_key != nullptr && EC_KEY_generate_key(ec_key.get()) == 1, "");
+  bssl::UniquePtr<EVP_PKEY> pkey(EVP_PKEY_new());
+  RELEASE_ASSERT(EVP_PKEY_assign_EC_KEY(pkey.get(), ec_key.release()) == 1, "");
+
+  bssl::UniquePtr<X509> cert(X509_new());
+  X509_set_version(cert.get(), 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1);
+  X509_gmtime_adj(X509_get_notBefore(cert.get()), 0);
+  X509_gmtime_adj(X509_get_notAfter(cert.get()), 60 * 60 * 24);
+  X509_NAME* name = X509_get_subject_name(cert.get());
+  X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                             reinterpret_cast<const uint8_t*>("localhost"), -1, -1, 0);
+  X509_set_issuer_name(cert.get(), name);
+  X509_set_pubkey(cert.get(), pkey.get());
+  RELEASE_ASSERT(X509_sign(cert.get(), pkey.get(), EVP_sha256()) != 0, "");
+
+  bssl::UniquePtr<SSL_CTX> ctx(SSL_CTX_new(TLS_method()));
+  RELEASE_ASSERT(SSL_CTX_use_certificate(ctx.get(), cert.get()) == 1, "");
+  RELEASE_ASSERT(SSL_CTX_use_PrivateKey(ctx.get(), pkey.get()) == 1, "");
+  SSL_CTX_set_max_proto_version(ctx.get(), TLS1_2_VERSION);
+  SSL_CTX_set_options(ctx.get(), SSL_OP_NO_TICKET);
+  const uint8_t session_id_context[] = "bench";
+  SSL_CTX_set_session_id_context(ctx.get(), session_id_context, sizeof(session_id_context));
+
+  SSL_CTX_set_session_cache_mode(ctx.get(), SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+  SSL_CTX_sess_set_new_cb(ctx.get(), [](SSL*, SSL_SESSION* session) -> int {
+    unsigned id_length = 0;
+    const uint8_t* id = SSL_SESSION_get_id(session, &id_length);
+    serverCache().insert(absl::string_view(reinterpret_cast<const char*>(id), id_length),
+                         bssl::UniquePtr<SSL_SESSION>(session));
+    return 1;
+  });
+  SSL_CTX_sess_set_get_cb(ctx.get(), getSession);
+  return ctx;
+}
+
+static bssl::UniquePtr<SSL_CTX> newClientContext() {
+  bssl::UniquePtr<SSL_CTX> ctx(SSL_CTX_new(TLS_method()));
+  SSL_CTX_set_session_cache_mode(ctx.get(), SSL_SESS_CACHE_CLIENT);
+  SSL_CTX_sess_set_new_cb(ctx.get(), [](SSL*, SSL_SESSION* session) -> int {
+    clientCache().insert(Peer, bssl::UniquePtr<SSL_SESSION>(session));
+    return 1;
+  });
+  return ctx;
+}
+
+// Runs one handshake between new connections of the given contexts.
+static bool handshake(SSL_CTX* client_ctx, SSL_CTX* server_ctx, bool resume) {
+  bssl::UniquePtr<SSL> client(SSL_new(client_ctx));
+  bssl::UniquePtr<SSL> server(SSL_new(server_ctx));
+  SSL_set_connect_state(client.get());
+  SSL_set_accept_state(server.get());
+
+  BIO* client_bio;
+  BIO* server_bio;
+  RELEASE_ASSERT(BIO_new_bio_pair(&client_bio, 0, &server_bio, 0) == 1, "");
+  SSL_set_bio(client.get(), client_bio, client_bio);
+  SSL_set_bio(server.get(), server_bio, server_bio);
+
+  if (resume) {
+    bssl::UniquePtr<SSL_SESSION> session = clientCache().lookup(Peer);
+    if (session != nullptr) {
+      SSL_set_session(client.get(), session.get());
+    }
+  }
+
+  bool client_done = false;
+  bool server_done = false;
+  while (!client_done || !server_done) {
+    if (!client_done) {
+      int rc = SSL_do_handshake(client.get());
+      client_done = rc == 1;
+      RELEASE_ASSERT(client_done || SSL_get_error(client.get(), rc) == SSL_ERROR_WANT_READ, "");
+    }
+    if (!server_done) {
+      int rc = SSL_do_handshake(server.get());
+      server_done = rc == 1;
+      RELEASE_ASSERT(server_done || SSL_get_error(server.get(), rc) == SSL_ERROR_WANT_READ, "");
+    }
+  }
+
+  return SSL_session_reused(client.get()) == 1;
+}
+
+static void BM_FullHandshake(benchmark::State& state) {
+  bssl::UniquePtr<SSL_CTX> server_ctx = newServerContext();
+  bssl::UniquePtr<SSL_CTX> client_ctx = newClientContext();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(handshake(client_ctx.get(), server_ctx.get(), false));
+  }
+}
+BENCHMARK(BM_FullHandshake)->Unit(benchmark::kMicrosecond);
+
+static void BM_ResumedHandshake(benchmark::State& state) {
+  bssl::UniquePtr<SSL_CTX> server_ctx = newServerContext();
+  bssl::UniquePtr<SSL_CTX> client_ctx = newClientContext();
+  // Prime the caches with a full handshake.
+  handshake(client_ctx.get(), server_ctx.get(), false);
+  uint64_t reused = 0;
+  for (auto _ : state) {
+    reused += handshake(client_ctx.get(), server_ctx.get(), true);
+  }
+  state.counters["reused"] = reused;
+}
+BENCHMARK(BM_ResumedHandshake)->Unit(benchmark::kMicrosecond);
+
+// Lookups from concurrent workers, with a single lock and with the default sharding.
+static void BM_SessionCacheLookup(benchmark::State& state) {
+  static SessionCacheImpl* cache;
+  if (state.thread_index == 0) {
+    cache = new SessionCacheImpl(1024, state.range(0));
+    bssl::UniquePtr<SSL_CTX> ctx(SSL_CTX_new(TLS_method()));
+    for (uint32_t i = 0; i < 1024; i++) {
+      cache->insert(std::to_string(i), bssl::UniquePtr<SSL_SESSION>(SSL_SESSION_new(ctx.get())));
+    }
+  }
+  uint32_t i = state.thread_index;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cache->lookup(std::to_string(i++ % 1024)));
+  }
+  if (state.thread_index == 0) {
+    delete cache;
+  }
+}
+BENCHMARK(BM_SessionCacheLookup)->Arg(1)->Arg(16)->ThreadRange(1, 8);
+
+} // namespace Ssl
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
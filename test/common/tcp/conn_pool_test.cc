@@ -41,8 +41,9 @@ struct ConnPoolCallbacks : public Tcp::ConnectionPool::Callbacks {
     pool_ready_.ready();
   }
 
-  void onPoolFailure(Tcp::ConnectionPool::PoolFailureReason,
+  void onPoolFailure(Tcp::ConnectionPool::PoolFailureReason reason,
                      Upstream::HostDescriptionConstSharedPtr host) override {
+    reason_ = reason;
     host_ = host;
     pool_failure_.ready();
   }
@@ -50,6 +51,7 @@ struct ConnPoolCallbacks : public Tcp::ConnectionPool::Callbacks {
   ReadyWatcher pool_failure_;
   ReadyWatcher pool_ready_;
   ConnectionPool::ConnectionData* conn_data_;
+  ConnectionPool::PoolFailureReason reason_;
   Upstream::HostDescriptionConstSharedPtr host_;
 };
 
@@ -248,7 +250,7 @@ struct ActiveTestConn {
  */
 TEST_F(TcpConnPoolImplTest, DrainConnections) {
   cluster_->resource_manager_.reset(
-      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 2, 1024, 1024, 1));
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 2, 1024, 1024, 1, 1024));
   InSequence s;
 
   ActiveTestConn c1(*this, 0, ActiveTestConn::Type::CreateConnection);
@@ -322,6 +324,14 @@ TEST_F(TcpConnPoolImplTest, UpstreamCallbacks) {
   EXPECT_EQ(Network::FilterStatus::StopIteration,
             conn_pool_.test_conns_[0].filter_->onData(buffer, false));
 
+  // Expect write buffer watermarks to be passed on.
+  EXPECT_CALL(callbacks, onAboveWriteBufferHighWatermark());
+  EXPECT_CALL(callbacks, onBelowWriteBufferLowWatermark());
+  for (Network::ConnectionCallbacks* cb : conn_pool_.test_conns_[0].connection_->callbacks_) {
+    cb->onAboveWriteBufferHighWatermark();
+    cb->onBelowWriteBufferLowWatermark();
+  }
+
   // Shutdown normally.
   EXPECT_CALL(conn_pool_, onConnReleasedForTest());
   c1.releaseConn();
@@ -331,6 +341,22 @@ TEST_F(TcpConnPoolImplTest, UpstreamCallbacks) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that a close is passed on to the UpstreamCallbacks of the connection owner.
+ */
+TEST_F(TcpConnPoolImplTest, UpstreamCallbacksCloseEvent) {
+  InSequence s;
+  ConnectionPool::MockUpstreamCallbacks callbacks;
+
+  ActiveTestConn c1(*this, 0, ActiveTestConn::Type::CreateConnection);
+  c1.callbacks_.conn_data_->addUpstreamCallbacks(callbacks);
+
+  EXPECT_CALL(callbacks, onEvent(Network::ConnectionEvent::RemoteClose));
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest());
+  conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 TEST_F(TcpConnPoolImplTest, NoUpstreamCallbacks) {
   Buffer::OwnedImpl buffer;
 
@@ -376,7 +402,7 @@ TEST_F(TcpConnPoolImplTest, MultipleRequestAndResponse) {
  */
 TEST_F(TcpConnPoolImplTest, MaxPendingRequests) {
   cluster_->resource_manager_.reset(
-      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1, 1, 1024, 1));
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1, 1, 1024, 1, 1024));
 
   ConnPoolCallbacks callbacks;
   conn_pool_.expectConnCreate();
@@ -417,6 +443,7 @@ TEST_F(TcpConnPoolImplTest, ConnectFailure) {
   conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
   dispatcher_.clearDeferredDeleteList();
 
+  EXPECT_EQ(ConnectionPool::PoolFailureReason::ConnectionFailure, callbacks.reason_);
   EXPECT_EQ(1U, cluster_->stats_.upstream_cx_connect_fail_.value());
   EXPECT_EQ(1U, cluster_->stats_.upstream_rq_pending_failure_eject_.value());
 }
@@ -446,6 +473,8 @@ TEST_F(TcpConnPoolImplTest, ConnectTimeout) {
   EXPECT_CALL(conn_pool_, onConnDestroyedForTest()).Times(2);
   dispatcher_.clearDeferredDeleteList();
 
+  EXPECT_EQ(ConnectionPool::PoolFailureReason::Timeout, callbacks1.reason_);
+  EXPECT_EQ(ConnectionPool::PoolFailureReason::Timeout, callbacks2.reason_);
   EXPECT_EQ(2U, cluster_->stats_.upstream_cx_connect_fail_.value());
   EXPECT_EQ(2U, cluster_->stats_.upstream_cx_connect_timeout_.value());
 }
@@ -497,7 +526,7 @@ TEST_F(TcpConnPoolImplTest, DisconnectWhilePending) {
   InSequence s;
 
   cluster_->resource_manager_.reset(
-      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1, 1024, 1024, 1));
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1, 1024, 1024, 1, 1024));
 
   // First request connected.
   ConnPoolCallbacks callbacks;
@@ -606,7 +635,7 @@ TEST_F(TcpConnPoolImplTest, ConcurrentConnections) {
   InSequence s;
 
   cluster_->resource_manager_.reset(
-      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 2, 1024, 1024, 1));
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 2, 1024, 1024, 1, 1024));
   ActiveTestConn c1(*this, 0, ActiveTestConn::Type::CreateConnection);
   ActiveTestConn c2(*this, 1, ActiveTestConn::Type::CreateConnection);
   ActiveTestConn c3(*this, 0, ActiveTestConn::Type::Pending);
@@ -629,6 +658,69 @@ TEST_F(TcpConnPoolImplTest, ConcurrentConnections) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that preconnected connections are handed out without waiting for a connect.
+ */
+TEST_F(TcpConnPoolImplTest, Preconnect) {
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1024, 1024, 1024, 1, 1024));
+
+  conn_pool_.expectConnCreate();
+  conn_pool_.expectConnCreate();
+  conn_pool_.preconnect(2);
+
+  // Connections that are still connecting count toward the spare ones.
+  conn_pool_.preconnect(2);
+
+  conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  conn_pool_.test_conns_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  ConnPoolCallbacks callbacks;
+  EXPECT_CALL(callbacks.pool_ready_, ready());
+  EXPECT_EQ(nullptr, conn_pool_.newConnection(callbacks));
+
+  // One spare connection is left, so topping up to two creates one more.
+  conn_pool_.expectConnCreate();
+  conn_pool_.preconnect(2);
+
+  EXPECT_CALL(conn_pool_, onConnReleasedForTest());
+  callbacks.conn_data_->release();
+
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest()).Times(3);
+  conn_pool_.test_conns_[2].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_conns_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that spare connections only count against the cluster's connection limit once they are
+ * used, and that the connections in use and the spare ones together stay within the limit.
+ */
+TEST_F(TcpConnPoolImplTest, PreconnectMaxConnections) {
+  // The limit is one connection, so only one of the two spares is opened.
+  conn_pool_.expectConnCreate();
+  conn_pool_.preconnect(2);
+  EXPECT_EQ(1U, conn_pool_.test_conns_.size());
+  EXPECT_TRUE(cluster_->resource_manager_->connections().canCreate());
+
+  conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  ConnPoolCallbacks callbacks;
+  EXPECT_CALL(callbacks.pool_ready_, ready());
+  EXPECT_EQ(nullptr, conn_pool_.newConnection(callbacks));
+  EXPECT_FALSE(cluster_->resource_manager_->connections().canCreate());
+
+  // The limit of one connection is in use, so the spare one used above is not replaced.
+  conn_pool_.preconnect(2);
+  EXPECT_EQ(1U, conn_pool_.test_conns_.size());
+
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest());
+  conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_TRUE(cluster_->resource_manager_->connections().canCreate());
+}
+
 TEST_F(TcpConnPoolImplTest, DrainCallback) {
   InSequence s;
   ReadyWatcher drained;
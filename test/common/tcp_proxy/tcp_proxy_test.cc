@@ -19,6 +19,7 @@
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/mocks.h"
+#include "test/mocks/tcp/mocks.h"
 #include "test/mocks/upstream/host.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/printers.h"
@@ -26,8 +27,10 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::Invoke;
 using testing::MatchesRegex;
 using testing::NiceMock;
+using testing::Ref;
 using testing::Return;
 using testing::ReturnPointee;
 using testing::ReturnRef;
@@ -379,45 +382,43 @@ public:
     configure(config);
     upstream_local_address_ = Network::Utility::resolveUrl("tcp://2.2.2.2:50000");
     upstream_remote_address_ = Network::Utility::resolveUrl("tcp://127.0.0.1:80");
-    if (connections >= 1) {
-      {
-        testing::InSequence sequence;
-        for (uint32_t i = 0; i < connections; i++) {
-          connect_timers_.push_back(
-              new NiceMock<Event::MockTimer>(&filter_callbacks_.connection_.dispatcher_));
-          EXPECT_CALL(*connect_timers_.at(i), enableTimer(_));
-        }
-      }
-
-      for (uint32_t i = 0; i < connections; i++) {
-        upstream_connections_.push_back(new NiceMock<Network::MockClientConnection>());
-        upstream_hosts_.push_back(std::make_shared<NiceMock<Upstream::MockHost>>());
-        conn_infos_.push_back(Upstream::MockHost::MockCreateConnectionData());
-        conn_infos_.at(i).connection_ = upstream_connections_.back();
-        conn_infos_.at(i).host_description_ = upstream_hosts_.back();
-
-        ON_CALL(*upstream_hosts_.at(i), cluster())
-            .WillByDefault(ReturnPointee(
-                factory_context_.cluster_manager_.thread_local_cluster_.cluster_.info_));
-        ON_CALL(*upstream_hosts_.at(i), address()).WillByDefault(Return(upstream_remote_address_));
-        upstream_connections_.at(i)->local_address_ = upstream_local_address_;
-        EXPECT_CALL(*upstream_connections_.at(i), addReadFilter(_))
-            .WillOnce(SaveArg<0>(&upstream_read_filter_));
-        EXPECT_CALL(*upstream_connections_.at(i), dispatcher())
-            .WillRepeatedly(ReturnRef(filter_callbacks_.connection_.dispatcher_));
-        EXPECT_CALL(*upstream_connections_.at(i), enableHalfClose(true));
-      }
+    for (uint32_t i = 0; i < connections; i++) {
+      upstream_connections_.push_back(
+          std::make_unique<NiceMock<Network::MockClientConnection>>());
+      upstream_connection_data_.push_back(
+          std::make_unique<NiceMock<Tcp::ConnectionPool::MockConnectionData>>());
+      ON_CALL(*upstream_connection_data_.back(), connection())
+          .WillByDefault(ReturnRef(*upstream_connections_.back()));
+      upstream_hosts_.push_back(std::make_shared<NiceMock<Upstream::MockHost>>());
+      conn_pool_handles_.push_back(
+          std::make_unique<NiceMock<Tcp::ConnectionPool::MockCancellable>>());
+
+      ON_CALL(*upstream_hosts_.at(i), cluster())
+          .WillByDefault(ReturnPointee(
+              factory_context_.cluster_manager_.thread_local_cluster_.cluster_.info_));
+      ON_CALL(*upstream_hosts_.at(i), address()).WillByDefault(Return(upstream_remote_address_));
+      upstream_connections_.at(i)->local_address_ = upstream_local_address_;
+      EXPECT_CALL(*upstream_connections_.at(i), dispatcher())
+          .WillRepeatedly(ReturnRef(filter_callbacks_.connection_.dispatcher_));
     }
 
     {
       testing::InSequence sequence;
       for (uint32_t i = 0; i < connections; i++) {
-        EXPECT_CALL(factory_context_.cluster_manager_, tcpConnForCluster_("fake_cluster", _))
-            .WillOnce(Return(conn_infos_.at(i)))
+        EXPECT_CALL(factory_context_.cluster_manager_,
+                    tcpConnPoolForCluster("fake_cluster", Upstream::ResourcePriority::Default, _))
+            .WillOnce(Return(&conn_pool_))
+            .RetiresOnSaturation();
+        EXPECT_CALL(conn_pool_, newConnection(_))
+            .WillOnce(Invoke(
+                [=](Tcp::ConnectionPool::Callbacks& cb) -> Tcp::ConnectionPool::Cancellable* {
+                  conn_pool_callbacks_.push_back(&cb);
+                  return conn_pool_handles_.at(i).get();
+                }))
             .RetiresOnSaturation();
       }
-      EXPECT_CALL(factory_context_.cluster_manager_, tcpConnForCluster_("fake_cluster", _))
-          .WillRepeatedly(Return(Upstream::MockHost::MockCreateConnectionData()));
+      EXPECT_CALL(factory_context_.cluster_manager_, tcpConnPoolForCluster("fake_cluster", _, _))
+          .WillRepeatedly(Return(nullptr));
     }
 
     filter_.reset(new Filter(config_, factory_context_.cluster_manager_));
@@ -436,19 +437,34 @@ public:
   void setup(uint32_t connections) { setup(connections, defaultConfig()); }
 
   void raiseEventUpstreamConnected(uint32_t conn_index) {
-    EXPECT_CALL(*connect_timers_.at(conn_index), disableTimer());
+    // As the pool does, deliver the connection's events to the callbacks the filter installs.
+    EXPECT_CALL(*upstream_connection_data_.at(conn_index), addUpstreamCallbacks(_))
+        .WillOnce(Invoke([=](Tcp::ConnectionPool::UpstreamCallbacks& cb) -> void {
+          upstream_callbacks_ = &cb;
+          upstream_connections_.at(conn_index)->addConnectionCallbacks(cb);
+        }));
+    EXPECT_CALL(*upstream_connections_.at(conn_index), enableHalfClose(true));
     EXPECT_CALL(filter_callbacks_.connection_, readDisable(false));
-    upstream_connections_.at(conn_index)->raiseEvent(Network::ConnectionEvent::Connected);
+    conn_pool_callbacks_.at(conn_index)->onPoolReady(*upstream_connection_data_.at(conn_index),
+                                                     upstream_hosts_.at(conn_index));
+  }
+
+  void raiseEventUpstreamConnectFailed(uint32_t conn_index,
+                                       Tcp::ConnectionPool::PoolFailureReason reason) {
+    conn_pool_callbacks_.at(conn_index)->onPoolFailure(reason, upstream_hosts_.at(conn_index));
   }
 
   ConfigSharedPtr config_;
   NiceMock<Network::MockReadFilterCallbacks> filter_callbacks_;
   NiceMock<Server::Configuration::MockFactoryContext> factory_context_;
   std::vector<std::shared_ptr<NiceMock<Upstream::MockHost>>> upstream_hosts_{};
-  std::vector<NiceMock<Network::MockClientConnection>*> upstream_connections_{};
-  std::vector<Upstream::MockHost::MockCreateConnectionData> conn_infos_;
-  Network::ReadFilterSharedPtr upstream_read_filter_;
-  std::vector<NiceMock<Event::MockTimer>*> connect_timers_;
+  std::vector<std::unique_ptr<NiceMock<Network::MockClientConnection>>> upstream_connections_{};
+  std::vector<std::unique_ptr<NiceMock<Tcp::ConnectionPool::MockConnectionData>>>
+      upstream_connection_data_{};
+  std::vector<Tcp::ConnectionPool::Callbacks*> conn_pool_callbacks_;
+  std::vector<std::unique_ptr<NiceMock<Tcp::ConnectionPool::MockCancellable>>> conn_pool_handles_;
+  NiceMock<Tcp::ConnectionPool::MockInstance> conn_pool_;
+  Tcp::ConnectionPool::UpstreamCallbacks* upstream_callbacks_{};
   std::unique_ptr<Filter> filter_;
   StringViewSaver access_log_data_;
   Network::Address::InstanceConstSharedPtr upstream_local_address_;
@@ -462,35 +478,44 @@ TEST_F(TcpProxyTest, HalfCloseProxy) {
   EXPECT_CALL(filter_callbacks_.connection_, close(_)).Times(0);
   EXPECT_CALL(*upstream_connections_.at(0), close(_)).Times(0);
 
+  raiseEventUpstreamConnected(0);
+
   Buffer::OwnedImpl buffer("hello");
   EXPECT_CALL(*upstream_connections_.at(0), write(BufferEqual(&buffer), true));
   filter_->onData(buffer, true);
 
-  raiseEventUpstreamConnected(0);
-
   Buffer::OwnedImpl response("world");
   EXPECT_CALL(filter_callbacks_.connection_, write(BufferEqual(&response), true));
-  upstream_read_filter_->onData(response, true);
+  upstream_callbacks_->onUpstreamData(response, true);
 
   EXPECT_CALL(filter_callbacks_.connection_, close(_));
-  EXPECT_CALL(filter_callbacks_.connection_.dispatcher_,
-              deferredDelete_(upstream_connections_.at(0)));
   upstream_connections_.at(0)->raiseEvent(Network::ConnectionEvent::RemoteClose);
 }
 
+// Test that data handed to the filter before the upstream connection is ready is sent once it is.
+TEST_F(TcpProxyTest, DataBeforeUpstreamReady) {
+  setup(1);
+
+  Buffer::OwnedImpl buffer("hello");
+  filter_->onData(buffer, true);
+
+  EXPECT_CALL(*upstream_connections_.at(0), write(BufferStringEqual("hello"), true));
+  raiseEventUpstreamConnected(0);
+}
+
 // Test that downstream is closed after an upstream LocalClose.
 TEST_F(TcpProxyTest, UpstreamLocalDisconnect) {
   setup(1);
 
+  raiseEventUpstreamConnected(0);
+
   Buffer::OwnedImpl buffer("hello");
   EXPECT_CALL(*upstream_connections_.at(0), write(BufferEqual(&buffer), false));
   filter_->onData(buffer, false);
 
-  raiseEventUpstreamConnected(0);
-
   Buffer::OwnedImpl response("world");
   EXPECT_CALL(filter_callbacks_.connection_, write(BufferEqual(&response), _));
-  upstream_read_filter_->onData(response, false);
+  upstream_callbacks_->onUpstreamData(response, false);
 
   EXPECT_CALL(filter_callbacks_.connection_, close(_));
   upstream_connections_.at(0)->raiseEvent(Network::ConnectionEvent::LocalClose);
@@ -500,45 +525,45 @@ TEST_F(TcpProxyTest, UpstreamLocalDisconnect) {
 TEST_F(TcpProxyTest, UpstreamRemoteDisconnect) {
   setup(1);
 
+  raiseEventUpstreamConnected(0);
+
   Buffer::OwnedImpl buffer("hello");
   EXPECT_CALL(*upstream_connections_.at(0), write(BufferEqual(&buffer), false));
   filter_->onData(buffer, false);
 
-  raiseEventUpstreamConnected(0);
-
   Buffer::OwnedImpl response("world");
   EXPECT_CALL(filter_callbacks_.connection_, write(BufferEqual(&response), _));
-  upstream_read_filter_->onData(response, false);
+  upstream_callbacks_->onUpstreamData(response, false);
 
   EXPECT_CALL(filter_callbacks_.connection_, close(Network::ConnectionCloseType::FlushWrite));
   upstream_connections_.at(0)->raiseEvent(Network::ConnectionEvent::RemoteClose);
+
+  EXPECT_EQ(1U, factory_context_.cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_
+                    .counter("upstream_cx_destroy_remote")
+                    .value());
 }
 
-// Test that reconnect is attempted after a local connect failure
-TEST_F(TcpProxyTest, ConnectAttemptsUpstreamLocalFail) {
-  envoy::config::filter::network::tcp_proxy::v2::TcpProxy config = defaultConfig();
-  config.mutable_max_connect_attempts()->set_value(2);
-  setup(2, config);
+// Test that the upstream connection is closed, and counted as destroyed, with the filter.
+TEST_F(TcpProxyTest, UpstreamClosedOnDestroy) {
+  setup(1);
 
-  EXPECT_CALL(filter_callbacks_.connection_.dispatcher_,
-              deferredDelete_(upstream_connections_.at(0)));
-  upstream_connections_.at(0)->raiseEvent(Network::ConnectionEvent::LocalClose);
-  raiseEventUpstreamConnected(1);
+  raiseEventUpstreamConnected(0);
 
-  EXPECT_EQ(0U, factory_context_.cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_
-                    .counter("upstream_cx_connect_attempts_exceeded")
+  EXPECT_CALL(*upstream_connections_.at(0), close(Network::ConnectionCloseType::NoFlush));
+  filter_.reset();
+
+  EXPECT_EQ(1U, factory_context_.cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_
+                    .counter("upstream_cx_destroy")
                     .value());
 }
 
-// Test that reconnect is attempted after a remote connect failure
-TEST_F(TcpProxyTest, ConnectAttemptsUpstreamRemoteFail) {
+// Test that reconnect is attempted after a connect failure
+TEST_F(TcpProxyTest, ConnectAttemptsUpstreamFail) {
   envoy::config::filter::network::tcp_proxy::v2::TcpProxy config = defaultConfig();
   config.mutable_max_connect_attempts()->set_value(2);
   setup(2, config);
 
-  EXPECT_CALL(filter_callbacks_.connection_.dispatcher_,
-              deferredDelete_(upstream_connections_.at(0)));
-  upstream_connections_.at(0)->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  raiseEventUpstreamConnectFailed(0, Tcp::ConnectionPool::PoolFailureReason::ConnectionFailure);
   raiseEventUpstreamConnected(1);
 
   EXPECT_EQ(0U, factory_context_.cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_
@@ -552,8 +577,7 @@ TEST_F(TcpProxyTest, ConnectAttemptsUpstreamTimeout) {
   config.mutable_max_connect_attempts()->set_value(2);
   setup(2, config);
 
-  EXPECT_CALL(*upstream_connections_.at(0), close(Network::ConnectionCloseType::NoFlush));
-  connect_timers_.at(0)->callback_();
+  raiseEventUpstreamConnectFailed(0, Tcp::ConnectionPool::PoolFailureReason::Timeout);
   raiseEventUpstreamConnected(1);
 
   EXPECT_EQ(0U, factory_context_.cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_
@@ -567,29 +591,13 @@ TEST_F(TcpProxyTest, ConnectAttemptsLimit) {
   config.mutable_max_connect_attempts()->set_value(3);
   setup(3, config);
 
-  {
-    testing::InSequence sequence;
-    EXPECT_CALL(*upstream_connections_.at(0), close(Network::ConnectionCloseType::NoFlush));
-    EXPECT_CALL(filter_callbacks_.connection_.dispatcher_,
-                deferredDelete_(upstream_connections_.at(0)));
-    EXPECT_CALL(filter_callbacks_.connection_.dispatcher_,
-                deferredDelete_(upstream_connections_.at(1)));
-    EXPECT_CALL(filter_callbacks_.connection_.dispatcher_,
-                deferredDelete_(upstream_connections_.at(2)));
-    EXPECT_CALL(filter_callbacks_.connection_, close(Network::ConnectionCloseType::NoFlush));
-  }
+  EXPECT_CALL(filter_callbacks_.connection_, close(Network::ConnectionCloseType::NoFlush));
 
   // Try both failure modes
-  connect_timers_.at(0)->callback_();
-  upstream_connections_.at(1)->raiseEvent(Network::ConnectionEvent::RemoteClose);
-  upstream_connections_.at(2)->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  raiseEventUpstreamConnectFailed(0, Tcp::ConnectionPool::PoolFailureReason::Timeout);
+  raiseEventUpstreamConnectFailed(1, Tcp::ConnectionPool::PoolFailureReason::ConnectionFailure);
+  raiseEventUpstreamConnectFailed(2, Tcp::ConnectionPool::PoolFailureReason::ConnectionFailure);
 
-  EXPECT_EQ(1U, factory_context_.cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_
-                    .counter("upstream_cx_connect_timeout")
-                    .value());
-  EXPECT_EQ(2U, factory_context_.cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_
-                    .counter("upstream_cx_connect_fail")
-                    .value());
   EXPECT_EQ(1U, factory_context_.cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_
                     .counter("upstream_cx_connect_attempts_exceeded")
                     .value());
@@ -609,11 +617,11 @@ TEST_F(TcpProxyTest, OutlierDetection) {
 
   EXPECT_CALL(upstream_hosts_.at(0)->outlier_detector_,
               putResult(Upstream::Outlier::Result::TIMEOUT));
-  connect_timers_.at(0)->callback_();
+  raiseEventUpstreamConnectFailed(0, Tcp::ConnectionPool::PoolFailureReason::Timeout);
 
   EXPECT_CALL(upstream_hosts_.at(1)->outlier_detector_,
               putResult(Upstream::Outlier::Result::CONNECT_FAILED));
-  upstream_connections_.at(1)->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  raiseEventUpstreamConnectFailed(1, Tcp::ConnectionPool::PoolFailureReason::ConnectionFailure);
 
   EXPECT_CALL(upstream_hosts_.at(2)->outlier_detector_,
               putResult(Upstream::Outlier::Result::SUCCESS));
@@ -623,15 +631,15 @@ TEST_F(TcpProxyTest, OutlierDetection) {
 TEST_F(TcpProxyTest, UpstreamDisconnectDownstreamFlowControl) {
   setup(1);
 
+  raiseEventUpstreamConnected(0);
+
   Buffer::OwnedImpl buffer("hello");
   EXPECT_CALL(*upstream_connections_.at(0), write(BufferEqual(&buffer), _));
   filter_->onData(buffer, false);
 
-  raiseEventUpstreamConnected(0);
-
   Buffer::OwnedImpl response("world");
   EXPECT_CALL(filter_callbacks_.connection_, write(BufferEqual(&response), _));
-  upstream_read_filter_->onData(response, false);
+  upstream_callbacks_->onUpstreamData(response, false);
 
   EXPECT_CALL(*upstream_connections_.at(0), readDisable(true));
   filter_callbacks_.connection_.runHighWatermarkCallbacks();
@@ -642,18 +650,33 @@ TEST_F(TcpProxyTest, UpstreamDisconnectDownstreamFlowControl) {
   filter_callbacks_.connection_.runLowWatermarkCallbacks();
 }
 
+// Test that the pool's write buffer watermark callbacks disable and enable downstream reads.
+TEST_F(TcpProxyTest, UpstreamWatermarksDownstreamFlowControl) {
+  setup(1);
+
+  raiseEventUpstreamConnected(0);
+
+  EXPECT_CALL(filter_callbacks_.connection_, readDisable(true));
+  upstream_callbacks_->onAboveWriteBufferHighWatermark();
+  EXPECT_CALL(filter_callbacks_.connection_, readDisable(false));
+  upstream_callbacks_->onBelowWriteBufferLowWatermark();
+
+  EXPECT_EQ(1U, config_->stats().downstream_flow_control_paused_reading_total_.value());
+  EXPECT_EQ(1U, config_->stats().downstream_flow_control_resumed_reading_total_.value());
+}
+
 TEST_F(TcpProxyTest, DownstreamDisconnectRemote) {
   setup(1);
 
+  raiseEventUpstreamConnected(0);
+
   Buffer::OwnedImpl buffer("hello");
   EXPECT_CALL(*upstream_connections_.at(0), write(BufferEqual(&buffer), _));
   filter_->onData(buffer, false);
 
-  raiseEventUpstreamConnected(0);
-
   Buffer::OwnedImpl response("world");
   EXPECT_CALL(filter_callbacks_.connection_, write(BufferEqual(&response), _));
-  upstream_read_filter_->onData(response, false);
+  upstream_callbacks_->onUpstreamData(response, false);
 
   EXPECT_CALL(*upstream_connections_.at(0), close(Network::ConnectionCloseType::FlushWrite));
   filter_callbacks_.connection_.raiseEvent(Network::ConnectionEvent::RemoteClose);
@@ -662,33 +685,34 @@ TEST_F(TcpProxyTest, DownstreamDisconnectRemote) {
 TEST_F(TcpProxyTest, DownstreamDisconnectLocal) {
   setup(1);
 
+  raiseEventUpstreamConnected(0);
+
   Buffer::OwnedImpl buffer("hello");
   EXPECT_CALL(*upstream_connections_.at(0), write(BufferEqual(&buffer), _));
   filter_->onData(buffer, false);
 
-  raiseEventUpstreamConnected(0);
-
   Buffer::OwnedImpl response("world");
   EXPECT_CALL(filter_callbacks_.connection_, write(BufferEqual(&response), _));
-  upstream_read_filter_->onData(response, false);
+  upstream_callbacks_->onUpstreamData(response, false);
 
   EXPECT_CALL(*upstream_connections_.at(0), close(Network::ConnectionCloseType::NoFlush));
   filter_callbacks_.connection_.raiseEvent(Network::ConnectionEvent::LocalClose);
 }
 
+// Test that the pending pool request is canceled if the downstream closes before the upstream
+// connection is ready.
+TEST_F(TcpProxyTest, DownstreamDisconnectBeforeUpstreamReady) {
+  setup(1);
+
+  EXPECT_CALL(*conn_pool_handles_.at(0), cancel());
+  filter_callbacks_.connection_.raiseEvent(Network::ConnectionEvent::RemoteClose);
+}
+
 TEST_F(TcpProxyTest, UpstreamConnectTimeout) {
   setup(1, accessLogConfig("%RESPONSE_FLAGS%"));
 
-  Buffer::OwnedImpl buffer("hello");
-  EXPECT_CALL(*upstream_connections_.at(0), write(BufferEqual(&buffer), _));
-  filter_->onData(buffer, false);
-
   EXPECT_CALL(filter_callbacks_.connection_, close(Network::ConnectionCloseType::NoFlush));
-  EXPECT_CALL(*upstream_connections_.at(0), close(Network::ConnectionCloseType::NoFlush));
-  connect_timers_.at(0)->callback_();
-  EXPECT_EQ(1U, factory_context_.cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_
-                    .counter("upstream_cx_connect_timeout")
-                    .value());
+  raiseEventUpstreamConnectFailed(0, Tcp::ConnectionPool::PoolFailureReason::Timeout);
 
   filter_.reset();
   EXPECT_EQ(access_log_data_, "UF");
@@ -749,11 +773,7 @@ TEST_F(TcpProxyTest, UpstreamConnectFailure) {
   filter_->onData(buffer, false);
 
   EXPECT_CALL(filter_callbacks_.connection_, close(Network::ConnectionCloseType::NoFlush));
-  EXPECT_CALL(*connect_timers_.at(0), disableTimer());
-  upstream_connections_.at(0)->raiseEvent(Network::ConnectionEvent::RemoteClose);
-  EXPECT_EQ(1U, factory_context_.cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_
-                    .counter("upstream_cx_connect_fail")
-                    .value());
+  raiseEventUpstreamConnectFailed(0, Tcp::ConnectionPool::PoolFailureReason::ConnectionFailure);
 
   filter_.reset();
   EXPECT_EQ(access_log_data_, "UF");
@@ -762,9 +782,10 @@ TEST_F(TcpProxyTest, UpstreamConnectFailure) {
 TEST_F(TcpProxyTest, UpstreamConnectionLimit) {
   configure(accessLogConfig("%RESPONSE_FLAGS%"));
   factory_context_.cluster_manager_.thread_local_cluster_.cluster_.info_->resource_manager_.reset(
-      new Upstream::ResourceManagerImpl(factory_context_.runtime_loader_, "fake_key", 0, 0, 0, 0));
+      new Upstream::ResourceManagerImpl(factory_context_.runtime_loader_, "fake_key", 0, 0, 0, 0,
+                                        0));
 
-  // setup sets up expectation for tcpConnForCluster but this test is expected to NOT call that
+  // setup sets up expectation for tcpConnPoolForCluster but this test is expected to NOT call that
   filter_.reset(new Filter(config_, factory_context_.cluster_manager_));
   // The downstream connection closes if the proxy can't make an upstream connection.
   EXPECT_CALL(filter_callbacks_.connection_, close(Network::ConnectionCloseType::NoFlush));
@@ -779,6 +800,71 @@ TEST_F(TcpProxyTest, UpstreamConnectionLimit) {
   EXPECT_EQ(access_log_data_, "UO");
 }
 
+// Test that a pool overflow closes the downstream connection.
+TEST_F(TcpProxyTest, UpstreamPoolOverflow) {
+  configure(accessLogConfig("%RESPONSE_FLAGS%"));
+  EXPECT_CALL(factory_context_.cluster_manager_, tcpConnPoolForCluster("fake_cluster", _, _))
+      .WillOnce(Return(&conn_pool_));
+  EXPECT_CALL(conn_pool_, newConnection(_))
+      .WillOnce(
+          Invoke([](Tcp::ConnectionPool::Callbacks& cb) -> Tcp::ConnectionPool::Cancellable* {
+            cb.onPoolFailure(Tcp::ConnectionPool::PoolFailureReason::Overflow, nullptr);
+            return nullptr;
+          }));
+
+  filter_.reset(new Filter(config_, factory_context_.cluster_manager_));
+  EXPECT_CALL(filter_callbacks_.connection_, close(Network::ConnectionCloseType::NoFlush));
+  filter_->initializeReadFilterCallbacks(filter_callbacks_);
+  filter_->onNewConnection();
+
+  filter_.reset();
+  EXPECT_EQ(access_log_data_, "UO");
+}
+
+// Test that a connection the pool hands out inline is counted as a preconnect hit, and that the
+// pool is asked to replace it when the route has a preconnect count.
+TEST_F(TcpProxyTest, PreconnectHit) {
+  configure(defaultConfig());
+  NiceMock<Network::MockClientConnection> upstream_connection;
+  NiceMock<Tcp::ConnectionPool::MockConnectionData> upstream_connection_data;
+  ON_CALL(upstream_connection_data, connection()).WillByDefault(ReturnRef(upstream_connection));
+
+  EXPECT_CALL(factory_context_.runtime_loader_.snapshot_,
+              getInteger("tcp_proxy.name.preconnect.fake_cluster", 0))
+      .WillOnce(Return(2));
+  EXPECT_CALL(factory_context_.cluster_manager_, tcpConnPoolForCluster("fake_cluster", _, _))
+      .WillOnce(Return(&conn_pool_));
+  EXPECT_CALL(conn_pool_, newConnection(_))
+      .WillOnce(
+          Invoke([&](Tcp::ConnectionPool::Callbacks& cb) -> Tcp::ConnectionPool::Cancellable* {
+            cb.onPoolReady(upstream_connection_data, conn_pool_.host_);
+            return nullptr;
+          }));
+  EXPECT_CALL(conn_pool_, preconnect(2));
+
+  filter_.reset(new Filter(config_, factory_context_.cluster_manager_));
+  filter_->initializeReadFilterCallbacks(filter_callbacks_);
+  EXPECT_CALL(filter_callbacks_.connection_, readDisable(false));
+  EXPECT_EQ(Network::FilterStatus::Continue, filter_->onNewConnection());
+
+  EXPECT_EQ(1U, config_->stats().upstream_preconnect_hit_.value());
+  EXPECT_EQ(0U, config_->stats().upstream_preconnect_miss_.value());
+
+  // The pool owns the connection, so the filter closes it rather than leave it open.
+  EXPECT_CALL(upstream_connection, close(Network::ConnectionCloseType::NoFlush));
+  filter_.reset();
+}
+
+// Test that waiting for a connect is counted as a preconnect miss, and that the pool is not asked
+// to preconnect without a preconnect count.
+TEST_F(TcpProxyTest, PreconnectMiss) {
+  EXPECT_CALL(conn_pool_, preconnect(_)).Times(0);
+  setup(1);
+
+  EXPECT_EQ(0U, config_->stats().upstream_preconnect_hit_.value());
+  EXPECT_EQ(1U, config_->stats().upstream_preconnect_miss_.value());
+}
+
 // Tests that the idle timer closes both connections, and gets updated when either
 // connection has activity.
 TEST_F(TcpProxyTest, IdleTimeout) {
@@ -796,7 +882,7 @@ TEST_F(TcpProxyTest, IdleTimeout) {
 
   buffer.add("hello2");
   EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(1000)));
-  upstream_read_filter_->onData(buffer, false);
+  upstream_callbacks_->onUpstreamData(buffer, false);
 
   EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(1000)));
   filter_callbacks_.connection_.raiseBytesSentCallbacks(1);
@@ -841,6 +927,7 @@ TEST_F(TcpProxyTest, IdleTimerDisabledUpstreamClose) {
 // Test that access log fields %UPSTREAM_HOST% and %UPSTREAM_CLUSTER% are correctly logged.
 TEST_F(TcpProxyTest, AccessLogUpstreamHost) {
   setup(1, accessLogConfig("%UPSTREAM_HOST% %UPSTREAM_CLUSTER%"));
+  raiseEventUpstreamConnected(0);
   filter_.reset();
   EXPECT_EQ(access_log_data_, "127.0.0.1:80 fake_cluster");
 }
@@ -848,6 +935,7 @@ TEST_F(TcpProxyTest, AccessLogUpstreamHost) {
 // Test that access log field %UPSTREAM_LOCAL_ADDRESS% is correctly logged.
 TEST_F(TcpProxyTest, AccessLogUpstreamLocalAddress) {
   setup(1, accessLogConfig("%UPSTREAM_LOCAL_ADDRESS%"));
+  raiseEventUpstreamConnected(0);
   filter_.reset();
   EXPECT_EQ(access_log_data_, "2.2.2.2:50000");
 }
@@ -874,7 +962,7 @@ TEST_F(TcpProxyTest, AccessLogBytesRxTxDuration) {
   Buffer::OwnedImpl buffer("a");
   filter_->onData(buffer, false);
   Buffer::OwnedImpl response("bb");
-  upstream_read_filter_->onData(response, false);
+  upstream_callbacks_->onUpstreamData(response, false);
 
   std::this_thread::sleep_for(std::chrono::milliseconds(1));
   upstream_connections_.at(0)->raiseEvent(Network::ConnectionEvent::RemoteClose);
@@ -885,6 +973,69 @@ TEST_F(TcpProxyTest, AccessLogBytesRxTxDuration) {
                   "bytesreceived=1 bytessent=2 datetime=[0-9-]+T[0-9:.]+Z nonzeronum=[1-9][0-9]*"));
 }
 
+// Test that when splicing is enabled in runtime it is started once the upstream connects, and that
+// spliced bytes are logged as they are sent by the other connection.
+TEST_F(TcpProxyTest, SpliceAccessLogBytes) {
+  setup(1, accessLogConfig("bytesreceived=%BYTES_RECEIVED% bytessent=%BYTES_SENT%"));
+
+  EXPECT_CALL(factory_context_.runtime_loader_.snapshot_, featureEnabled("tcp_proxy.splice", 0))
+      .WillOnce(Return(true));
+  EXPECT_CALL(filter_callbacks_.connection_, startSplice(Ref(*upstream_connections_.at(0))))
+      .WillOnce(Return(true));
+  raiseEventUpstreamConnected(0);
+  EXPECT_EQ(1U, config_->stats().downstream_cx_splice_total_.value());
+
+  upstream_connections_.at(0)->raiseBytesSentCallbacks(3);
+  filter_callbacks_.connection_.raiseBytesSentCallbacks(4);
+  upstream_connections_.at(0)->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  filter_.reset();
+
+  EXPECT_EQ(access_log_data_, "bytesreceived=3 bytessent=4");
+}
+
+// Test that data that arrived before the upstream connected is accounted once when it is flushed
+// to a spliced upstream connection, which reports it as sent.
+TEST_F(TcpProxyTest, SpliceEarlyDataAccessLogBytes) {
+  setup(1, accessLogConfig("bytesreceived=%BYTES_RECEIVED% bytessent=%BYTES_SENT%"));
+
+  Buffer::OwnedImpl early_data("ab");
+  filter_->onData(early_data, false);
+
+  EXPECT_CALL(factory_context_.runtime_loader_.snapshot_, featureEnabled("tcp_proxy.splice", 0))
+      .WillOnce(Return(true));
+  EXPECT_CALL(filter_callbacks_.connection_, startSplice(Ref(*upstream_connections_.at(0))))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*upstream_connections_.at(0), write(BufferStringEqual("ab"), false));
+  raiseEventUpstreamConnected(0);
+
+  // The early data followed by spliced data.
+  upstream_connections_.at(0)->raiseBytesSentCallbacks(2);
+  upstream_connections_.at(0)->raiseBytesSentCallbacks(3);
+  upstream_connections_.at(0)->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  filter_.reset();
+
+  EXPECT_EQ(access_log_data_, "bytesreceived=5 bytessent=0");
+}
+
+// Test that nothing is accounted twice when the connections cannot be spliced.
+TEST_F(TcpProxyTest, SpliceRefused) {
+  setup(1, accessLogConfig("bytesreceived=%BYTES_RECEIVED% bytessent=%BYTES_SENT%"));
+
+  EXPECT_CALL(factory_context_.runtime_loader_.snapshot_, featureEnabled("tcp_proxy.splice", 0))
+      .WillOnce(Return(true));
+  EXPECT_CALL(filter_callbacks_.connection_, startSplice(_)).WillOnce(Return(false));
+  raiseEventUpstreamConnected(0);
+  EXPECT_EQ(0U, config_->stats().downstream_cx_splice_total_.value());
+
+  Buffer::OwnedImpl buffer("a");
+  filter_->onData(buffer, false);
+  upstream_connections_.at(0)->raiseBytesSentCallbacks(1);
+  upstream_connections_.at(0)->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  filter_.reset();
+
+  EXPECT_EQ(access_log_data_, "bytesreceived=1 bytessent=0");
+}
+
 // Tests that upstream flush works properly with no idle timeout configured.
 TEST_F(TcpProxyTest, UpstreamFlushNoTimeout) {
   setup(1);
@@ -985,7 +1136,7 @@ TEST_F(TcpProxyTest, UpstreamFlushReceiveUpstreamData) {
   // Send some bytes; no timeout configured so this should be a no-op (not a crash).
   Buffer::OwnedImpl buffer("a");
   EXPECT_CALL(*upstream_connections_.at(0), close(Network::ConnectionCloseType::NoFlush));
-  upstream_read_filter_->onData(buffer, false);
+  upstream_callbacks_->onUpstreamData(buffer, false);
 }
 
 class TcpProxyRoutingTest : public testing::Test {
@@ -1050,7 +1201,7 @@ TEST_F(TcpProxyRoutingTest, RoutableConnection) {
   connection_.local_address_ = std::make_shared<Network::Address::Ipv4Instance>("1.2.3.4", 9999);
 
   // Expect filter to try to open a connection to specified cluster.
-  EXPECT_CALL(factory_context_.cluster_manager_, tcpConnForCluster_("fake_cluster", _));
+  EXPECT_CALL(factory_context_.cluster_manager_, tcpConnPoolForCluster("fake_cluster", _, _));
 
   filter_->onNewConnection();
 
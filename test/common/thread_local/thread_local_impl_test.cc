@@ -110,6 +110,52 @@ TEST_F(ThreadLocalInstanceImplTest, RunOnAllThreads) {
   tls_.shutdownThread();
 }
 
+// Restricted threads only receive the data and callbacks of slots that include them.
+TEST(ThreadLocalInstanceImplRestrictedTest, RestrictedThreads) {
+  InstanceImpl tls;
+  Event::MockDispatcher main_dispatcher;
+  Event::MockDispatcher restricted_dispatcher;
+
+  tls.registerThread(main_dispatcher, true);
+  EXPECT_CALL(restricted_dispatcher, post(_));
+  tls.registerRestrictedThread(restricted_dispatcher);
+
+  uint32_t created = 0;
+  auto create = [&created](Event::Dispatcher&) -> ThreadLocalObjectSharedPtr {
+    ++created;
+    return std::make_shared<TestThreadLocalObject>();
+  };
+
+  // A regular slot is only set on the main thread.
+  SlotPtr regular_slot = tls.allocateSlot();
+  EXPECT_CALL(restricted_dispatcher, post(_)).Times(0);
+  regular_slot->set(create);
+  EXPECT_EQ(1, created);
+  uint32_t regular_calls = 0;
+  regular_slot->runOnAllThreads([&regular_calls]() -> void { ++regular_calls; });
+  EXPECT_EQ(1, regular_calls);
+  testing::Mock::VerifyAndClearExpectations(&restricted_dispatcher);
+
+  // A slot that includes restricted threads posts to them as well.
+  SlotPtr included_slot = tls.allocateSlot();
+  included_slot->includeRestrictedThreads();
+  EXPECT_CALL(restricted_dispatcher, post(_)).Times(2);
+  included_slot->set(create);
+  EXPECT_EQ(2, created);
+  included_slot->runOnAllThreads([]() -> void {});
+  testing::Mock::VerifyAndClearExpectations(&restricted_dispatcher);
+
+  // Slot removal is always posted to restricted threads so that a reused index starts out empty.
+  EXPECT_CALL(restricted_dispatcher, post(_)).Times(2);
+  EXPECT_CALL(regular_slot->getTyped<TestThreadLocalObject>(), onDestroy());
+  regular_slot.reset();
+  EXPECT_CALL(included_slot->getTyped<TestThreadLocalObject>(), onDestroy());
+  included_slot.reset();
+
+  tls.shutdownGlobalThreading();
+  tls.shutdownThread();
+}
+
 // Validate ThreadLocal::InstanceImpl's dispatcher() behavior.
 TEST(ThreadLocalInstanceImplDispatcherTest, Dispatcher) {
   InstanceImpl tls;
@@ -0,0 +1,105 @@
+// Usage: bazel run //test/common/upstream:cds_api_impl_benchmark
+//
+// Measures how long the first CDS update over ADS takes to get through decoding and validation,
+// as it does at startup, for a generated set of clusters and a number of parse threads. The
+// cluster manager is a mock, so adding the clusters themselves is not part of it.
+
+#include "envoy/api/v2/cds.pb.h"
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/config/protobuf_link_hacks.h"
+#include "common/protobuf/utility.h"
+#include "common/stats/stats_impl.h"
+#include "common/upstream/cds_api_impl.h"
+
+#include "test/mocks/local_info/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+
+#include "testing/base/public/benchmark.h"
+
+using testing::Invoke;
+using testing::NiceMock;
+using testing::_;
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+// An EDS cluster with some of the fields a CDS response typically carries.
+envoy::api::v2::Cluster makeCluster(uint64_t index) {
+  envoy::api::v2::Cluster cluster;
+  cluster.set_name(fmt::format("cluster_{}", index));
+  cluster.set_type(envoy::api::v2::Cluster::EDS);
+  cluster.mutable_connect_timeout()->set_seconds(1);
+  cluster.mutable_eds_cluster_config()->set_service_name(fmt::format("service_{}", index));
+  cluster.mutable_eds_cluster_config()->mutable_eds_config()->mutable_ads();
+  cluster.mutable_circuit_breakers()->add_thresholds()->mutable_max_connections()->set_value(1024);
+  auto* health_check = cluster.add_health_checks();
+  health_check->mutable_timeout()->set_seconds(1);
+  health_check->mutable_interval()->set_seconds(5);
+  health_check->mutable_unhealthy_threshold()->set_value(3);
+  health_check->mutable_healthy_threshold()->set_value(1);
+  health_check->mutable_http_health_check()->set_path("/healthz");
+  (*cluster.mutable_metadata()->mutable_filter_metadata())["envoy.lb"] =
+      MessageUtil::keyValueStruct("tenant", fmt::format("tenant_{}", index));
+  return cluster;
+}
+
+void BM_InitialCdsUpdate(benchmark::State& state) {
+  const uint64_t num_clusters = state.range(0);
+  const uint32_t parse_threads = state.range(1);
+
+  NiceMock<MockClusterManager> cm;
+  NiceMock<Event::MockDispatcher> dispatcher;
+  NiceMock<Runtime::MockRandomGenerator> random;
+  NiceMock<LocalInfo::MockLocalInfo> local_info;
+  Stats::IsolatedStoreImpl store;
+  Config::GrpcMuxCallbacks* callbacks{};
+  ON_CALL(cm.ads_mux_, subscribe_(_, _, _))
+      .WillByDefault(Invoke([&callbacks](const std::string&, const std::vector<std::string>&,
+                                         Config::GrpcMuxCallbacks& mux_callbacks)
+                                -> Config::GrpcMuxWatch* {
+        callbacks = &mux_callbacks;
+        return nullptr;
+      }));
+
+  envoy::api::v2::core::ConfigSource cds_config;
+  cds_config.mutable_ads();
+  CdsApiPtr cds = CdsApiImpl::create(cds_config, absl::nullopt, cm, dispatcher, random, local_info,
+                                     store, parse_threads);
+  cds->initialize();
+
+  Protobuf::RepeatedPtrField<ProtobufWkt::Any> resources;
+  for (uint64_t i = 0; i < num_clusters; i++) {
+    resources.Add()->PackFrom(makeCluster(i));
+  }
+
+  for (auto _ : state) {
+    callbacks->onConfigUpdate(resources, "1");
+  }
+}
+BENCHMARK(BM_InitialCdsUpdate)
+    ->ArgPair(1000, 1)
+    ->ArgPair(1000, 4)
+    ->ArgPair(20000, 1)
+    ->ArgPair(20000, 4)
+    ->ArgPair(20000, 8)
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Registry::initialize(spdlog::level::warn,
+                                      Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -124,6 +124,25 @@ TEST_F(CdsApiImplTest, ValidateFail) {
   EXPECT_CALL(request_, cancel());
 }
 
+// Added clusters are added or updated and removed clusters removed, leaving the rest untouched.
+TEST_F(CdsApiImplTest, IncrementalUpdate) {
+  InSequence s;
+
+  setup(true);
+
+  Protobuf::RepeatedPtrField<envoy::api::v2::Cluster> clusters;
+  clusters.Add()->set_name("cluster1");
+  Protobuf::RepeatedPtrField<std::string> removed;
+  removed.Add()->assign("cluster2");
+
+  expectAdd("cluster1", "1");
+  EXPECT_CALL(cm_, removeCluster("cluster2"));
+  EXPECT_CALL(initialized_, ready());
+  dynamic_cast<CdsApiImpl*>(cds_.get())->onConfigUpdate(clusters, removed, "1");
+  EXPECT_EQ("1", cds_->versionInfo());
+  EXPECT_CALL(request_, cancel());
+}
+
 TEST_F(CdsApiImplTest, InvalidOptions) {
   const std::string config_json = R"EOF(
   {
@@ -60,7 +60,7 @@ public:
                                   bool added_via_api) -> ClusterSharedPtr {
           return ClusterImplBase::create(
               cluster, cm, stats_, tls_, dns_resolver_, ssl_context_manager_, runtime_, random_,
-              dispatcher_, log_manager, local_info_, outlier_event_logger, added_via_api);
+              dispatcher_, log_manager, nullptr, local_info_, outlier_event_logger, added_via_api);
         }));
   }
 
@@ -1315,6 +1315,103 @@ TEST_F(ClusterManagerImplTest, DoNotCloseTcpConnectionsOnHealthFailure) {
   EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster1.get()));
 }
 
+// Clusters configured with warm connections prefetch a connection pool for every host that is
+// added, and requests without downstream socket options reuse those pools.
+TEST_F(ClusterManagerImplTest, WarmConnectionsPrefetchOnHostAdd) {
+  const std::string yaml = R"EOF(
+  static_resources:
+    clusters:
+    - name: cluster_1
+      connect_timeout: 0.250s
+      type: STATIC
+      lb_policy: ROUND_ROBIN
+      hosts:
+      - socket_address:
+          address: "127.0.0.1"
+          port_value: 11001
+      - socket_address:
+          address: "127.0.0.2"
+          port_value: 11001
+      metadata:
+        filter_metadata:
+          envoy.conn_pool:
+            warm_connections: 2
+  )EOF";
+
+  Http::ConnectionPool::MockInstance* cp1 = new NiceMock<Http::ConnectionPool::MockInstance>();
+  Http::ConnectionPool::MockInstance* cp2 = new NiceMock<Http::ConnectionPool::MockInstance>();
+  EXPECT_CALL(factory_, allocateConnPool_(_)).WillOnce(Return(cp1)).WillOnce(Return(cp2));
+  EXPECT_CALL(*cp1, prefetchConnections());
+  EXPECT_CALL(*cp2, prefetchConnections());
+  create(parseBootstrapFromV2Yaml(yaml));
+  EXPECT_EQ(2U, cluster_manager_->get("cluster_1")->info()->warmConnections());
+
+  Http::ConnectionPool::Instance* cp = cluster_manager_->httpConnPoolForCluster(
+      "cluster_1", ResourcePriority::Default, Http::Protocol::Http11, nullptr);
+  EXPECT_TRUE(cp == cp1 || cp == cp2);
+}
+
+// A host that is added pending its first health check is warmed once it becomes healthy.
+TEST_F(ClusterManagerImplTest, WarmConnectionsPrefetchOnHealthy) {
+  const std::string json =
+      fmt::sprintf("{%s}", clustersJson({defaultStaticClusterJson("some_cluster")}));
+  std::shared_ptr<MockCluster> cluster1(new NiceMock<MockCluster>());
+  cluster1->info_->name_ = "some_cluster";
+  cluster1->info_->warm_connections_ = 2;
+  HostSharedPtr test_host = makeTestHost(cluster1->info_, "tcp://127.0.0.1:80");
+  test_host->healthFlagSet(Host::HealthFlag::FAILED_ACTIVE_HC);
+  cluster1->prioritySet().getMockHostSet(0)->hosts_ = {test_host};
+  ON_CALL(*cluster1, initializePhase()).WillByDefault(Return(Cluster::InitializePhase::Primary));
+
+  EXPECT_CALL(factory_, clusterFromProto_(_, _, _, _, _)).WillOnce(Return(cluster1));
+  EXPECT_CALL(*cluster1, initialize(_))
+      .WillOnce(Invoke([cluster1](std::function<void()> initialize_callback) {
+        initialize_callback();
+      }));
+  EXPECT_CALL(factory_, allocateConnPool_(_)).Times(0);
+  create(parseBootstrapFromJson(json));
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(&factory_));
+
+  // A health change is reported as a membership update without added hosts.
+  Http::ConnectionPool::MockInstance* cp = new NiceMock<Http::ConnectionPool::MockInstance>();
+  EXPECT_CALL(factory_, allocateConnPool_(_)).WillOnce(Return(cp));
+  EXPECT_CALL(*cp, prefetchConnections());
+  test_host->healthFlagClear(Host::HealthFlag::FAILED_ACTIVE_HC);
+  cluster1->prioritySet().getMockHostSet(0)->runCallbacks({}, {});
+
+  // Only once.
+  cluster1->prioritySet().getMockHostSet(0)->runCallbacks({}, {});
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster1.get()));
+}
+
+// The main thread's cluster manager never prefetches, since only workers serve requests.
+TEST_F(ClusterManagerImplTest, WarmConnectionsNotPrefetchedOnMainThread) {
+  const std::string yaml = R"EOF(
+  static_resources:
+    clusters:
+    - name: cluster_1
+      connect_timeout: 0.250s
+      type: STATIC
+      lb_policy: ROUND_ROBIN
+      hosts:
+      - socket_address:
+          address: "127.0.0.1"
+          port_value: 11001
+      metadata:
+        filter_metadata:
+          envoy.conn_pool:
+            warm_connections: 2
+  )EOF";
+
+  // The mock TLS sets its slots with its own dispatcher, which here is also the main dispatcher.
+  EXPECT_CALL(factory_, allocateConnPool_(_)).Times(0);
+  cluster_manager_.reset(new ClusterManagerImpl(
+      parseBootstrapFromV2Yaml(yaml), factory_, factory_.stats_, factory_.tls_, factory_.runtime_,
+      factory_.random_, factory_.local_info_, log_manager_, factory_.tls_.dispatcher_, admin_,
+      system_time_source_, monotonic_time_source_));
+  EXPECT_EQ(2U, cluster_manager_->get("cluster_1")->info()->warmConnections());
+}
+
 TEST_F(ClusterManagerImplTest, DynamicHostRemove) {
   const std::string json = R"EOF(
   {
@@ -1,8 +1,10 @@
 #include <chrono>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
+#include "common/api/api_impl.h"
 #include "common/buffer/buffer_impl.h"
 #include "common/buffer/zero_copy_input_stream_impl.h"
 #include "common/config/cds_json.h"
@@ -11,6 +13,8 @@
 #include "common/json/json_loader.h"
 #include "common/network/utility.h"
 #include "common/protobuf/utility.h"
+#include "common/thread_local/thread_local_impl.h"
+#include "common/upstream/health_check_thread_pool.h"
 #include "common/upstream/health_checker_impl.h"
 #include "common/upstream/upstream_impl.h"
 
@@ -62,7 +66,8 @@ TEST(HealthCheckerFactoryTest, GrpcHealthCheckHTTP2NotConfiguredException) {
   AccessLog::MockAccessLogManager log_manager;
 
   EXPECT_THROW_WITH_MESSAGE(HealthCheckerFactory::create(createGrpcHealthCheckConfig(), cluster,
-                                                         runtime, random, dispatcher, log_manager),
+                                                         runtime, random, dispatcher, log_manager,
+                                                         nullptr),
                             EnvoyException,
                             "fake_cluster cluster must support HTTP/2 for gRPC healthchecking");
 }
@@ -80,7 +85,8 @@ TEST(HealthCheckerFactoryTest, createGrpc) {
 
   EXPECT_NE(nullptr, dynamic_cast<GrpcHealthCheckerImpl*>(
                          HealthCheckerFactory::create(createGrpcHealthCheckConfig(), cluster,
-                                                      runtime, random, dispatcher, log_manager)
+                                                      runtime, random, dispatcher, log_manager,
+                                                      nullptr)
                              .get()));
 }
 
@@ -1075,6 +1081,79 @@ TEST_F(HttpHealthCheckerImplTest, DynamicAddAndRemove) {
   cluster_->prioritySet().getMockHostSet(0)->runCallbacks({}, removed);
 }
 
+// Sessions probing the same address with the same config share the probes of the first one.
+TEST_F(HttpHealthCheckerImplTest, CoalescedProbes) {
+  ON_CALL(runtime_.snapshot_, featureEnabled("health_check.coalesce_probes", 0))
+      .WillByDefault(Return(true));
+  setupNoServiceValidationHC();
+  cluster_->info_->stats().upstream_cx_total_.inc();
+
+  cluster_->prioritySet().getMockHostSet(0)->hosts_ = {
+      makeTestHost(cluster_->info_, "tcp://127.0.0.1:80")};
+  expectSessionCreate();
+  expectStreamCreate(0);
+  EXPECT_CALL(*test_sessions_[0]->timeout_timer_, enableTimer(_));
+  health_checker_->start();
+
+  EXPECT_CALL(*this, onHostStatus(_, HealthTransition::Unchanged));
+  EXPECT_CALL(*test_sessions_[0]->interval_timer_, enableTimer(_));
+  EXPECT_CALL(*test_sessions_[0]->timeout_timer_, disableTimer());
+  respond(0, "200", false);
+
+  // A session joining later takes over the last result instead of probing.
+  expectSessionCreate();
+  EXPECT_CALL(*test_sessions_[1]->timeout_timer_, enableTimer(_)).Times(0);
+  EXPECT_CALL(*this, onHostStatus(_, HealthTransition::Unchanged));
+  cluster_->prioritySet().getMockHostSet(0)->hosts_.push_back(
+      makeTestHost(cluster_->info_, "tcp://127.0.0.1:80"));
+  cluster_->prioritySet().getMockHostSet(0)->runCallbacks(
+      {cluster_->prioritySet().getMockHostSet(0)->hosts_.back()}, {});
+
+  expectStreamCreate(0);
+  EXPECT_CALL(*test_sessions_[0]->timeout_timer_, enableTimer(_));
+  test_sessions_[0]->interval_timer_->callback_();
+
+  EXPECT_CALL(*this, onHostStatus(_, HealthTransition::Changed)).Times(2);
+  EXPECT_CALL(*event_logger_, logEjectUnhealthy(_, _, _)).Times(2);
+  EXPECT_CALL(*test_sessions_[0]->interval_timer_, enableTimer(_));
+  EXPECT_CALL(*test_sessions_[0]->timeout_timer_, disableTimer());
+  respond(0, "503", false);
+  EXPECT_FALSE(cluster_->prioritySet().getMockHostSet(0)->hosts_[0]->healthy());
+  EXPECT_FALSE(cluster_->prioritySet().getMockHostSet(0)->hosts_[1]->healthy());
+
+  EXPECT_EQ(2UL, cluster_->info_->stats_store_.counter("health_check.attempt").value());
+  EXPECT_EQ(2UL, cluster_->info_->stats_store_.counter("health_check.coalesced").value());
+}
+
+TEST_F(HttpHealthCheckerImplTest, CoalescedProbesLeaderRemoved) {
+  ON_CALL(runtime_.snapshot_, featureEnabled("health_check.coalesce_probes", 0))
+      .WillByDefault(Return(true));
+  setupNoServiceValidationHC();
+
+  HostSharedPtr leader = makeTestHost(cluster_->info_, "tcp://127.0.0.1:80");
+  HostSharedPtr follower = makeTestHost(cluster_->info_, "tcp://127.0.0.1:80");
+  cluster_->prioritySet().getMockHostSet(0)->hosts_ = {leader};
+  expectSessionCreate();
+  expectStreamCreate(0);
+  EXPECT_CALL(*test_sessions_[0]->timeout_timer_, enableTimer(_));
+  health_checker_->start();
+
+  expectSessionCreate();
+  EXPECT_CALL(*test_sessions_[1]->timeout_timer_, enableTimer(_)).Times(0);
+  cluster_->prioritySet().getMockHostSet(0)->hosts_.push_back(follower);
+  cluster_->prioritySet().getMockHostSet(0)->runCallbacks({follower}, {});
+
+  // The remaining session takes over probing.
+  EXPECT_CALL(*test_sessions_[1]->interval_timer_, enableTimer(std::chrono::milliseconds(0)));
+  cluster_->prioritySet().getMockHostSet(0)->hosts_ = {follower};
+  cluster_->prioritySet().getMockHostSet(0)->runCallbacks({}, {leader});
+
+  expectStreamCreate(1);
+  EXPECT_CALL(*test_sessions_[1]->timeout_timer_, enableTimer(_));
+  test_sessions_[1]->interval_timer_->callback_();
+  EXPECT_EQ(2UL, cluster_->info_->stats_store_.counter("health_check.attempt").value());
+}
+
 TEST_F(HttpHealthCheckerImplTest, ConnectionClose) {
   setupNoServiceValidationHC();
   EXPECT_CALL(*this, onHostStatus(_, HealthTransition::Unchanged));
@@ -3083,6 +3162,193 @@ TEST_P(BadResponseGrpcHealthCheckerImplTest, GrpcBadResponse) {
   expectHostHealthy(false);
 }
 
+// A checker whose sessions pass one dispatcher iteration after each interval, and which records
+// the threads its sessions run on.
+class TestSessionHealthCheckerImpl : public HealthCheckerImplBase {
+public:
+  TestSessionHealthCheckerImpl(const Cluster& cluster,
+                               const envoy::api::v2::core::HealthCheck& config,
+                               Event::Dispatcher& dispatcher, Runtime::Loader& runtime,
+                               Runtime::RandomGenerator& random)
+      : HealthCheckerImplBase(cluster, config, dispatcher, runtime, random, nullptr) {}
+
+  std::set<Thread::ThreadId> sessionThreads() {
+    Thread::LockGuard lock(lock_);
+    return session_threads_;
+  }
+
+private:
+  struct TestActiveHealthCheckSession : public ActiveHealthCheckSession {
+    TestActiveHealthCheckSession(TestSessionHealthCheckerImpl& parent, const HostSharedPtr& host,
+                                 Event::Dispatcher& dispatcher)
+        : ActiveHealthCheckSession(parent, host, dispatcher), parent_(parent) {}
+
+    // ActiveHealthCheckSession
+    void onInterval() override {
+      {
+        Thread::LockGuard lock(parent_.lock_);
+        parent_.session_threads_.insert(Thread::Thread::currentThreadId());
+      }
+      dispatcher_.post([this]() -> void { handleSuccess(); });
+    }
+    void onTimeout() override {}
+
+    TestSessionHealthCheckerImpl& parent_;
+  };
+
+  // HealthCheckerImplBase
+  ActiveHealthCheckSessionPtr makeSession(HostSharedPtr host,
+                                          Event::Dispatcher& dispatcher) override {
+    return std::make_unique<TestActiveHealthCheckSession>(*this, host, dispatcher);
+  }
+  envoy::data::core::v2alpha::HealthCheckerType healthCheckerType() const override {
+    return envoy::data::core::v2alpha::HealthCheckerType::TCP;
+  }
+
+  Thread::MutexBasicLockable lock_;
+  std::set<Thread::ThreadId> session_threads_;
+};
+
+class HealthCheckThreadPoolTest : public testing::Test {
+public:
+  HealthCheckThreadPoolTest()
+      : cluster_(new NiceMock<MockCluster>()), api_(std::chrono::milliseconds(1000)),
+        dispatcher_(api_.allocateDispatcher()) {
+    tls_.registerThread(*dispatcher_, true);
+    thread_pool_ = std::make_unique<HealthCheckThreadPool>(2, api_, tls_);
+  }
+
+  ~HealthCheckThreadPoolTest() {
+    if (health_checker_) {
+      health_checker_->stopSessions();
+      health_checker_.reset();
+    }
+    thread_pool_.reset();
+    tls_.shutdownGlobalThreading();
+    tls_.shutdownThread();
+  }
+
+  void setup(uint32_t num_hosts, const std::string& interval = "1s") {
+    const std::string yaml = fmt::format(R"EOF(
+    timeout: 1s
+    interval: {}
+    unhealthy_threshold: 2
+    healthy_threshold: 2
+    tcp_health_check: {{}}
+    )EOF",
+                                         interval);
+
+    for (uint32_t i = 0; i < num_hosts; i++) {
+      HostSharedPtr host = makeTestHost(cluster_->info_, fmt::format("tcp://127.0.0.{}:80", i + 1));
+      host->healthFlagSet(Host::HealthFlag::FAILED_ACTIVE_HC);
+      cluster_->prioritySet().getMockHostSet(0)->hosts_.push_back(host);
+    }
+
+    health_checker_ = std::make_shared<TestSessionHealthCheckerImpl>(
+        *cluster_, parseHealthCheckFromV2Yaml(yaml), *dispatcher_, runtime_, random_);
+    health_checker_->addHostCheckCompleteCb(
+        [this](HostSharedPtr, HealthTransition changed_state) -> void {
+          reported_++;
+          if (changed_state == HealthTransition::Changed) {
+            changed_++;
+          }
+        });
+    health_checker_->setThreadPool(*thread_pool_);
+    health_checker_->start();
+  }
+
+  // Results arrive on the main thread by post, so spin its dispatcher until they are in.
+  void runUntilChanged(uint32_t changed) {
+    while (changed_ < changed) {
+      dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+
+  std::shared_ptr<MockCluster> cluster_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<Runtime::MockRandomGenerator> random_;
+  Api::Impl api_;
+  Event::DispatcherPtr dispatcher_;
+  ThreadLocal::InstanceImpl tls_;
+  HealthCheckThreadPoolPtr thread_pool_;
+  std::shared_ptr<TestSessionHealthCheckerImpl> health_checker_;
+  uint32_t changed_{};
+  uint32_t reported_{};
+};
+
+TEST_F(HealthCheckThreadPoolTest, SessionsRunOnHealthCheckThreads) {
+  setup(4);
+  runUntilChanged(4);
+
+  for (const HostSharedPtr& host : cluster_->prioritySet().getMockHostSet(0)->hosts_) {
+    EXPECT_TRUE(host->healthy());
+  }
+  EXPECT_EQ(4UL, cluster_->info_->stats_store_.gauge("health_check.healthy").value());
+  EXPECT_EQ(4UL, cluster_->info_->stats_store_.counter("health_check.success").value());
+
+  // Hosts are spread over both threads, and none of the sessions ran on the main thread.
+  const std::set<Thread::ThreadId> threads = health_checker_->sessionThreads();
+  EXPECT_EQ(2UL, threads.size());
+  EXPECT_EQ(0UL, threads.count(Thread::Thread::currentThreadId()));
+}
+
+TEST_F(HealthCheckThreadPoolTest, PassiveFailureReachesSession) {
+  setup(2);
+  runUntilChanged(2);
+
+  HostSharedPtr host = cluster_->prioritySet().getMockHostSet(0)->hosts_[1];
+  host->healthChecker().setUnhealthy();
+  runUntilChanged(3);
+
+  EXPECT_FALSE(host->healthy());
+  EXPECT_TRUE(cluster_->prioritySet().getMockHostSet(0)->hosts_[0]->healthy());
+  EXPECT_EQ(1UL, cluster_->info_->stats_store_.gauge("health_check.healthy").value());
+  EXPECT_EQ(1UL, cluster_->info_->stats_store_.counter("health_check.passive_failure").value());
+}
+
+// A host that stays healthy costs the main thread nothing after its first check.
+TEST_F(HealthCheckThreadPoolTest, SteadyHealthyHostNotReported) {
+  // The cluster has seen traffic, so the checks run at the short interval.
+  cluster_->info_->stats().upstream_cx_total_.inc();
+  setup(1, "0.01s");
+  runUntilChanged(1);
+
+  // The session reports the result of a check before it schedules the next one, so once the third
+  // check is counted any report of the second one is already queued on the main dispatcher.
+  while (cluster_->info_->stats_store_.counter("health_check.success").value() < 3) {
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+
+  EXPECT_EQ(1U, reported_);
+  EXPECT_EQ(1U, changed_);
+  EXPECT_TRUE(cluster_->prioritySet().getMockHostSet(0)->hosts_[0]->healthy());
+}
+
+TEST_F(HealthCheckThreadPoolTest, RemoveHost) {
+  setup(2);
+  runUntilChanged(2);
+
+  HostVector removed{cluster_->prioritySet().getMockHostSet(0)->hosts_.back()};
+  cluster_->prioritySet().getMockHostSet(0)->hosts_.pop_back();
+  cluster_->prioritySet().getMockHostSet(0)->runCallbacks({}, removed);
+
+  // The session is destroyed on its own thread, which then posts the healthy count back.
+  while (cluster_->info_->stats_store_.gauge("health_check.healthy").value() != 1) {
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+}
+
+TEST_F(HealthCheckThreadPoolTest, StopSessionsAfterShutdown) {
+  setup(2);
+  runUntilChanged(2);
+
+  // Once the threads are gone, sessions are destroyed inline.
+  thread_pool_->shutdown();
+  health_checker_->stopSessions();
+  health_checker_.reset();
+}
+
 TEST(Printer, HealthStatePrinter) {
   std::ostringstream healthy;
   healthy << HealthState::Healthy;
@@ -14,7 +14,7 @@ namespace Upstream {
 TEST(ResourceManagerImplTest, RuntimeResourceManager) {
   NiceMock<Runtime::MockLoader> runtime;
   ResourceManagerImpl resource_manager(
-      runtime, "circuit_breakers.runtime_resource_manager_test.default.", 0, 0, 0, 1);
+      runtime, "circuit_breakers.runtime_resource_manager_test.default.", 0, 0, 0, 1, 1);
 
   EXPECT_CALL(
       runtime.snapshot_,
@@ -45,6 +45,20 @@ TEST(ResourceManagerImplTest, RuntimeResourceManager) {
       .WillRepeatedly(Return(0U));
   EXPECT_EQ(0U, resource_manager.retries().max());
   EXPECT_FALSE(resource_manager.retries().canCreate());
+
+  EXPECT_CALL(
+      runtime.snapshot_,
+      getInteger("circuit_breakers.runtime_resource_manager_test.default.max_shadow_requests", 1U))
+      .Times(2)
+      .WillRepeatedly(Return(0U));
+  EXPECT_EQ(0U, resource_manager.shadowRequests().max());
+  EXPECT_FALSE(resource_manager.shadowRequests().canCreate());
+
+  EXPECT_EQ(0U, resource_manager.connections().count());
+  resource_manager.connections().inc();
+  EXPECT_EQ(1U, resource_manager.connections().count());
+  resource_manager.connections().dec();
+  EXPECT_EQ(0U, resource_manager.connections().count());
 }
 
 } // namespace Upstream
@@ -648,6 +648,9 @@ TEST(StaticClusterImplTest, UrlConfig) {
   EXPECT_EQ(1024U, cluster.info()->resourceManager(ResourcePriority::High).pendingRequests().max());
   EXPECT_EQ(1024U, cluster.info()->resourceManager(ResourcePriority::High).requests().max());
   EXPECT_EQ(3U, cluster.info()->resourceManager(ResourcePriority::High).retries().max());
+  EXPECT_EQ(1024U,
+            cluster.info()->resourceManager(ResourcePriority::Default).shadowRequests().max());
+  EXPECT_EQ(1024U, cluster.info()->resourceManager(ResourcePriority::High).shadowRequests().max());
   EXPECT_EQ(0U, cluster.info()->maxRequestsPerConnection());
   EXPECT_EQ(Http::Http2Settings::DEFAULT_HPACK_TABLE_SIZE,
             cluster.info()->http2Settings().hpack_table_size_);
@@ -874,6 +877,96 @@ TEST(ClusterMetadataTest, Metadata) {
   EXPECT_EQ(LoadBalancerType::Maglev, cluster.info()->lbType());
 }
 
+// Connection pool prefetching configured via the envoy.conn_pool metadata namespace.
+TEST(ClusterMetadataTest, ConnPoolPrefetch) {
+  Stats::IsolatedStoreImpl stats;
+  Ssl::MockContextManager ssl_context_manager;
+  auto dns_resolver = std::make_shared<Network::MockDnsResolver>();
+  NiceMock<Event::MockDispatcher> dispatcher;
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<MockClusterManager> cm;
+
+  {
+    const std::string yaml = R"EOF(
+      name: name
+      connect_timeout: 0.25s
+      type: STRICT_DNS
+      lb_policy: ROUND_ROBIN
+      hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+    )EOF";
+
+    StrictDnsClusterImpl cluster(parseClusterFromV2Yaml(yaml), runtime, stats,
+                                 ssl_context_manager, dns_resolver, cm, dispatcher, false);
+    EXPECT_EQ(1.0, cluster.info()->prefetchRatio());
+    EXPECT_EQ(0U, cluster.info()->warmConnections());
+  }
+
+  {
+    const std::string yaml = R"EOF(
+      name: name
+      connect_timeout: 0.25s
+      type: STRICT_DNS
+      lb_policy: ROUND_ROBIN
+      hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+      metadata: { filter_metadata: { envoy.conn_pool: { prefetch_ratio: 1.5, warm_connections: 4 } } }
+    )EOF";
+
+    StrictDnsClusterImpl cluster(parseClusterFromV2Yaml(yaml), runtime, stats,
+                                 ssl_context_manager, dns_resolver, cm, dispatcher, false);
+    EXPECT_EQ(1.5, cluster.info()->prefetchRatio());
+    EXPECT_EQ(4U, cluster.info()->warmConnections());
+  }
+
+  {
+    const std::string yaml = R"EOF(
+      name: name
+      connect_timeout: 0.25s
+      type: STRICT_DNS
+      lb_policy: ROUND_ROBIN
+      hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+      metadata: { filter_metadata: { envoy.conn_pool: { prefetch_ratio: 0.5 } } }
+    )EOF";
+
+    EXPECT_THROW_WITH_MESSAGE(StrictDnsClusterImpl(parseClusterFromV2Yaml(yaml), runtime, stats,
+                                                   ssl_context_manager, dns_resolver, cm,
+                                                   dispatcher, false),
+                              EnvoyException, "cluster: prefetch_ratio must be >= 1.0, got 0.5");
+  }
+
+  {
+    const std::string yaml = R"EOF(
+      name: name
+      connect_timeout: 0.25s
+      type: STRICT_DNS
+      lb_policy: ROUND_ROBIN
+      hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+      metadata: { filter_metadata: { envoy.conn_pool: { warm_connections: 1.5 } } }
+    )EOF";
+
+    EXPECT_THROW_WITH_MESSAGE(
+        StrictDnsClusterImpl(parseClusterFromV2Yaml(yaml), runtime, stats, ssl_context_manager,
+                             dns_resolver, cm, dispatcher, false),
+        EnvoyException, "cluster: warm_connections must be an integer >= 0, got 1.5");
+  }
+
+  {
+    // No more warm connections than the circuit breaker allows.
+    const std::string yaml = R"EOF(
+      name: name
+      connect_timeout: 0.25s
+      type: STRICT_DNS
+      lb_policy: ROUND_ROBIN
+      hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+      circuit_breakers: { thresholds: [{ max_connections: 3 }] }
+      metadata: { filter_metadata: { envoy.conn_pool: { warm_connections: 1e12 } } }
+    )EOF";
+
+    StrictDnsClusterImpl cluster(parseClusterFromV2Yaml(yaml), runtime, stats,
+                                 ssl_context_manager, dns_resolver, cm, dispatcher, false);
+    EXPECT_EQ(3U, cluster.info()->warmConnections());
+  }
+}
+
 // Validate empty singleton for HostsPerLocalityImpl.
 TEST(HostsPerLocalityImpl, Empty) {
   EXPECT_FALSE(HostsPerLocalityImpl::empty()->hasLocalLocality());
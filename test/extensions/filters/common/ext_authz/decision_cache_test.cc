@@ -0,0 +1,369 @@
+#include "common/stats/stats_impl.h"
+
+#include "extensions/filters/common/ext_authz/decision_cache.h"
+
+#include "test/extensions/filters/common/ext_authz/mocks.h"
+#include "test/extensions/filters/common/ext_authz/test_common.h"
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/tracing/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Invoke;
+using testing::NiceMock;
+using testing::ReturnPointee;
+using testing::WhenDynamicCastTo;
+using testing::_;
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace ExtAuthz {
+namespace {
+
+envoy::service::auth::v2alpha::CheckRequest makeRequest(const std::string& method,
+                                                        const std::string& path,
+                                                        const std::string& principal) {
+  envoy::service::auth::v2alpha::CheckRequest request;
+  auto* attributes = request.mutable_attributes();
+  attributes->mutable_source()->set_principal(principal);
+  attributes->mutable_request()->mutable_http()->set_method(method);
+  attributes->mutable_request()->mutable_http()->set_path(path);
+  return request;
+}
+
+envoy::service::auth::v2alpha::CheckRequest makeRequest(const std::string& path,
+                                                        const std::string& header,
+                                                        const std::string& header_value,
+                                                        const std::string& principal) {
+  envoy::service::auth::v2alpha::CheckRequest request = makeRequest("GET", path, principal);
+  (*request.mutable_attributes()->mutable_request()->mutable_http()->mutable_headers())[header] =
+      header_value;
+  return request;
+}
+
+ResponsePtr makeResponse(CheckStatus status) {
+  ResponsePtr response = std::make_unique<Response>(Response{});
+  response->status = status;
+  if (status == CheckStatus::OK) {
+    response->headers_to_add.emplace_back(Http::LowerCaseString("x-authz"), "ok");
+  }
+  return response;
+}
+
+TEST(CacheConfigTest, Key) {
+  Stats::IsolatedStoreImpl stats_store;
+  CacheConfig config(1, std::chrono::milliseconds(1000), DefaultCacheKeyAttributes, "",
+                     stats_store);
+
+  auto request = makeRequest("GET", "/foo", "spiffe://foo");
+  const std::string key = config.key(request);
+  // Attributes that are not part of the key don't change it.
+  request.mutable_attributes()->mutable_request()->mutable_http()->set_host("example.com");
+  EXPECT_EQ(key, config.key(request));
+  EXPECT_NE(key, config.key(makeRequest("GET", "/bar", "spiffe://foo")));
+  EXPECT_NE(key, config.key(makeRequest("POST", "/foo", "spiffe://foo")));
+  EXPECT_NE(key, config.key(makeRequest("GET", "/foo", "spiffe://bar")));
+  // The values are not merely concatenated.
+  EXPECT_NE(config.key(makeRequest("GET", "/foo", "")), config.key(makeRequest("GET", "", "/foo")));
+}
+
+// Without a principal, the credential headers keep the decisions of different clients apart.
+TEST(CacheConfigTest, DefaultKeyCredentials) {
+  Stats::IsolatedStoreImpl stats_store;
+  CacheConfig config(1, std::chrono::milliseconds(1000), DefaultCacheKeyAttributes, "",
+                     stats_store);
+
+  for (const std::string header : {"authorization", "cookie"}) {
+    EXPECT_NE(config.key(makeRequest("/foo", header, "a", "")),
+              config.key(makeRequest("/foo", header, "b", "")));
+    EXPECT_NE(config.key(makeRequest("GET", "/foo", "")),
+              config.key(makeRequest("/foo", header, "a", "")));
+  }
+  EXPECT_EQ(config.key(makeRequest("/foo", "authorization", "a", "")),
+            config.key(makeRequest("/foo", "authorization", "a", "")));
+}
+
+TEST(CacheConfigTest, HeaderKey) {
+  Stats::IsolatedStoreImpl stats_store;
+  CacheConfig config(1, std::chrono::milliseconds(1000),
+                     "request.http.host, request.http.headers.x-tenant", "", stats_store);
+
+  auto request = makeRequest("GET", "/foo", "");
+  const std::string missing = config.key(request);
+  auto& headers = *request.mutable_attributes()->mutable_request()->mutable_http()->mutable_headers();
+  headers["x-tenant"] = "";
+  const std::string empty = config.key(request);
+  headers["x-tenant"] = "a";
+  const std::string tenant = config.key(request);
+  EXPECT_NE(missing, empty);
+  EXPECT_NE(missing, tenant);
+  EXPECT_NE(empty, tenant);
+
+  // The path is not part of the key.
+  request.mutable_attributes()->mutable_request()->mutable_http()->set_path("/bar");
+  EXPECT_EQ(tenant, config.key(request));
+}
+
+TEST(CacheConfigTest, UnknownAttribute) {
+  Stats::IsolatedStoreImpl stats_store;
+  EXPECT_THROW_WITH_MESSAGE(CacheConfig(1, std::chrono::milliseconds(1000),
+                                        "request.http.path,request.http.body", "", stats_store),
+                            EnvoyException,
+                            "ext_authz: unknown cache key attribute 'request.http.body'");
+  EXPECT_THROW_WITH_MESSAGE(CacheConfig(1, std::chrono::milliseconds(1000),
+                                        "request.http.headers.", "", stats_store),
+                            EnvoyException,
+                            "ext_authz: unknown cache key attribute 'request.http.headers.'");
+}
+
+class DecisionCacheTest : public testing::Test {
+public:
+  DecisionCacheTest()
+      : config_(std::make_shared<const CacheConfig>(2, std::chrono::milliseconds(1000),
+                                                     DefaultCacheKeyAttributes, "test.",
+                                                     stats_store_)),
+        cache_(config_, [this]() { return createClient(); }, dispatcher_, time_source_) {
+    ON_CALL(time_source_, currentTime()).WillByDefault(ReturnPointee(&now_));
+  }
+
+  // Every check that is sent gets a new client, whose callbacks are kept in checks_.
+  ClientPtr createClient() {
+    auto client = std::make_unique<MockClient>();
+    EXPECT_CALL(*client, check(_, _, _))
+        .WillOnce(Invoke([this](RequestCallbacks& callbacks,
+                                const envoy::service::auth::v2alpha::CheckRequest&,
+                                Tracing::Span&) { checks_.push_back(&callbacks); }));
+    clients_.push_back(client.get());
+    return std::move(client);
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counter("test.ext_authz." + name).value();
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  NiceMock<MockMonotonicTimeSource> time_source_;
+  MonotonicTime now_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  CacheConfigConstSharedPtr config_;
+  DecisionCache cache_;
+  std::vector<MockClient*> clients_;
+  std::vector<RequestCallbacks*> checks_;
+  MockRequestCallbacks request_callbacks_;
+  Tracing::MockSpan span_;
+};
+
+TEST_F(DecisionCacheTest, CachesDecisions) {
+  CachingClientImpl client(cache_);
+  client.check(request_callbacks_, makeRequest("GET", "/foo", "a"), span_);
+  ASSERT_EQ(1, checks_.size());
+  EXPECT_CALL(request_callbacks_, onComplete_(WhenDynamicCastTo<ResponsePtr&>(AuthzOkResponse(
+                                      *makeResponse(CheckStatus::OK)))));
+  checks_[0]->onComplete(makeResponse(CheckStatus::OK));
+  EXPECT_EQ(1, cache_.size());
+
+  // The cached decision completes the check right away.
+  EXPECT_CALL(request_callbacks_, onComplete_(WhenDynamicCastTo<ResponsePtr&>(AuthzOkResponse(
+                                      *makeResponse(CheckStatus::OK)))));
+  client.check(request_callbacks_, makeRequest("GET", "/foo", "a"), span_);
+
+  // Denied decisions are cached too.
+  client.check(request_callbacks_, makeRequest("GET", "/bar", "a"), span_);
+  ASSERT_EQ(2, checks_.size());
+  EXPECT_CALL(request_callbacks_, onComplete_(WhenDynamicCastTo<ResponsePtr&>(
+                                      AuthzErrorResponse(CheckStatus::Denied))))
+      .Times(2);
+  checks_[1]->onComplete(makeResponse(CheckStatus::Denied));
+  client.check(request_callbacks_, makeRequest("GET", "/bar", "a"), span_);
+
+  EXPECT_EQ(2, checks_.size());
+  EXPECT_EQ(2, counter("cache_hit"));
+  EXPECT_EQ(2, counter("cache_miss"));
+  EXPECT_EQ(0, counter("coalesced"));
+}
+
+TEST_F(DecisionCacheTest, Expiry) {
+  CachingClientImpl client(cache_);
+  client.check(request_callbacks_, makeRequest("GET", "/foo", "a"), span_);
+  EXPECT_CALL(request_callbacks_, onComplete_(_)).Times(3);
+  checks_[0]->onComplete(makeResponse(CheckStatus::OK));
+
+  now_ += std::chrono::milliseconds(999);
+  client.check(request_callbacks_, makeRequest("GET", "/foo", "a"), span_);
+  EXPECT_EQ(1, checks_.size());
+
+  now_ += std::chrono::milliseconds(1);
+  client.check(request_callbacks_, makeRequest("GET", "/foo", "a"), span_);
+  ASSERT_EQ(2, checks_.size());
+  EXPECT_EQ(0, cache_.size());
+  checks_[1]->onComplete(makeResponse(CheckStatus::OK));
+  EXPECT_EQ(1, cache_.size());
+}
+
+TEST_F(DecisionCacheTest, EvictsLeastRecentlyUsed) {
+  CachingClientImpl client(cache_);
+  EXPECT_CALL(request_callbacks_, onComplete_(_)).Times(5);
+  for (const std::string path : {"/a", "/b"}) {
+    client.check(request_callbacks_, makeRequest("GET", path, ""), span_);
+    checks_.back()->onComplete(makeResponse(CheckStatus::OK));
+  }
+  // Use /a, so that /b is evicted by /c.
+  client.check(request_callbacks_, makeRequest("GET", "/a", ""), span_);
+  client.check(request_callbacks_, makeRequest("GET", "/c", ""), span_);
+  checks_.back()->onComplete(makeResponse(CheckStatus::OK));
+  EXPECT_EQ(2, cache_.size());
+  EXPECT_EQ(3, checks_.size());
+
+  client.check(request_callbacks_, makeRequest("GET", "/b", ""), span_);
+  EXPECT_EQ(4, checks_.size());
+  checks_.back()->onComplete(makeResponse(CheckStatus::OK));
+}
+
+TEST_F(DecisionCacheTest, CoalescesChecksInFlight) {
+  CachingClientImpl client1(cache_);
+  CachingClientImpl client2(cache_);
+  CachingClientImpl client3(cache_);
+  MockRequestCallbacks request_callbacks2;
+  MockRequestCallbacks request_callbacks3;
+  client1.check(request_callbacks_, makeRequest("GET", "/foo", "a"), span_);
+  client2.check(request_callbacks2, makeRequest("GET", "/foo", "a"), span_);
+  client3.check(request_callbacks3, makeRequest("GET", "/foo", "b"), span_);
+  EXPECT_EQ(2, checks_.size());
+  EXPECT_EQ(1, counter("coalesced"));
+
+  const Response expected = *makeResponse(CheckStatus::OK);
+  EXPECT_CALL(request_callbacks_,
+              onComplete_(WhenDynamicCastTo<ResponsePtr&>(AuthzOkResponse(expected))));
+  EXPECT_CALL(request_callbacks2,
+              onComplete_(WhenDynamicCastTo<ResponsePtr&>(AuthzOkResponse(expected))));
+  checks_[0]->onComplete(makeResponse(CheckStatus::OK));
+
+  EXPECT_CALL(request_callbacks3, onComplete_(WhenDynamicCastTo<ResponsePtr&>(
+                                      AuthzErrorResponse(CheckStatus::Denied))));
+  checks_[1]->onComplete(makeResponse(CheckStatus::Denied));
+}
+
+// Requests with different credentials neither wait for each other's check nor get each other's
+// cached decision.
+TEST_F(DecisionCacheTest, CredentialsAreNotMerged) {
+  CachingClientImpl client1(cache_);
+  CachingClientImpl client2(cache_);
+  MockRequestCallbacks request_callbacks2;
+  client1.check(request_callbacks_, makeRequest("/foo", "authorization", "Bearer a", ""), span_);
+  client2.check(request_callbacks2, makeRequest("/foo", "authorization", "Bearer b", ""), span_);
+  ASSERT_EQ(2, checks_.size());
+  EXPECT_EQ(0, counter("coalesced"));
+
+  EXPECT_CALL(request_callbacks_, onComplete_(WhenDynamicCastTo<ResponsePtr&>(AuthzOkResponse(
+                                      *makeResponse(CheckStatus::OK)))));
+  checks_[0]->onComplete(makeResponse(CheckStatus::OK));
+  EXPECT_CALL(request_callbacks2, onComplete_(WhenDynamicCastTo<ResponsePtr&>(
+                                      AuthzErrorResponse(CheckStatus::Denied))));
+  checks_[1]->onComplete(makeResponse(CheckStatus::Denied));
+
+  // The decision cached for one credential is not served for another.
+  client2.check(request_callbacks2, makeRequest("/foo", "authorization", "Bearer c", ""), span_);
+  EXPECT_EQ(3, checks_.size());
+  EXPECT_EQ(0, counter("cache_hit"));
+  EXPECT_CALL(request_callbacks2, onComplete_(_));
+  checks_[2]->onComplete(makeResponse(CheckStatus::Denied));
+}
+
+TEST_F(DecisionCacheTest, ErrorsAreNotCached) {
+  CachingClientImpl client1(cache_);
+  CachingClientImpl client2(cache_);
+  MockRequestCallbacks request_callbacks2;
+  client1.check(request_callbacks_, makeRequest("GET", "/foo", "a"), span_);
+  client2.check(request_callbacks2, makeRequest("GET", "/foo", "a"), span_);
+
+  // The checks that were waiting share the error.
+  EXPECT_CALL(request_callbacks_, onComplete_(WhenDynamicCastTo<ResponsePtr&>(
+                                      AuthzErrorResponse(CheckStatus::Error))));
+  EXPECT_CALL(request_callbacks2, onComplete_(WhenDynamicCastTo<ResponsePtr&>(
+                                      AuthzErrorResponse(CheckStatus::Error))));
+  checks_[0]->onComplete(makeResponse(CheckStatus::Error));
+  EXPECT_EQ(0, cache_.size());
+
+  client1.check(request_callbacks_, makeRequest("GET", "/foo", "a"), span_);
+  EXPECT_EQ(2, checks_.size());
+  EXPECT_CALL(request_callbacks_, onComplete_(_));
+  checks_[1]->onComplete(makeResponse(CheckStatus::OK));
+}
+
+TEST_F(DecisionCacheTest, Cancel) {
+  CachingClientImpl client1(cache_);
+  CachingClientImpl client2(cache_);
+  MockRequestCallbacks request_callbacks2;
+  client1.check(request_callbacks_, makeRequest("GET", "/foo", "a"), span_);
+  client2.check(request_callbacks2, makeRequest("GET", "/foo", "a"), span_);
+  ASSERT_EQ(1, clients_.size());
+
+  // The check goes on for the other client.
+  client1.cancel();
+  EXPECT_CALL(request_callbacks2, onComplete_(_));
+  checks_[0]->onComplete(makeResponse(CheckStatus::OK));
+
+  // The check is cancelled once nothing waits for it.
+  client1.check(request_callbacks_, makeRequest("GET", "/bar", "a"), span_);
+  client2.check(request_callbacks2, makeRequest("GET", "/bar", "a"), span_);
+  ASSERT_EQ(2, clients_.size());
+  client2.cancel();
+  EXPECT_CALL(*clients_[1], cancel());
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  client1.cancel();
+
+  // A new check is sent for the same key.
+  client1.check(request_callbacks_, makeRequest("GET", "/bar", "a"), span_);
+  EXPECT_EQ(3, clients_.size());
+  EXPECT_CALL(request_callbacks_, onComplete_(_));
+  checks_[2]->onComplete(makeResponse(CheckStatus::OK));
+}
+
+// A waiter may be cancelled while the decision is delivered to the checks that wait for it.
+TEST_F(DecisionCacheTest, CancelFromCallbacks) {
+  CachingClientImpl client1(cache_);
+  CachingClientImpl client2(cache_);
+  MockRequestCallbacks request_callbacks2;
+  client1.check(request_callbacks_, makeRequest("GET", "/foo", "a"), span_);
+  client2.check(request_callbacks2, makeRequest("GET", "/foo", "a"), span_);
+
+  EXPECT_CALL(request_callbacks_, onComplete_(_)).WillOnce(Invoke([&](ResponsePtr&) {
+    client2.cancel();
+  }));
+  EXPECT_CALL(request_callbacks2, onComplete_(_)).Times(0);
+  EXPECT_CALL(*clients_[0], cancel()).Times(0);
+  checks_[0]->onComplete(makeResponse(CheckStatus::OK));
+}
+
+// The client may fail the check within the call.
+TEST_F(DecisionCacheTest, InlineFailure) {
+  DecisionCache cache(config_,
+                      []() {
+                        auto client = std::make_unique<MockClient>();
+                        EXPECT_CALL(*client, check(_, _, _))
+                            .WillOnce(Invoke([](RequestCallbacks& callbacks,
+                                                const envoy::service::auth::v2alpha::CheckRequest&,
+                                                Tracing::Span&) {
+                              callbacks.onComplete(makeResponse(CheckStatus::Error));
+                            }));
+                        return std::move(client);
+                      },
+                      dispatcher_, time_source_);
+  CachingClientImpl client(cache);
+  EXPECT_CALL(request_callbacks_, onComplete_(WhenDynamicCastTo<ResponsePtr&>(
+                                      AuthzErrorResponse(CheckStatus::Error))));
+  client.check(request_callbacks_, makeRequest("GET", "/foo", "a"), span_);
+  EXPECT_EQ(0, cache.size());
+}
+
+} // namespace
+} // namespace ExtAuthz
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,137 @@
+#include "common/network/utility.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/common/rbac/compiled_policies.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Const;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+namespace {
+
+envoy::config::rbac::v2alpha::Policy policyFromYaml(const std::string& yaml) {
+  envoy::config::rbac::v2alpha::Policy policy;
+  MessageUtil::loadFromYaml(yaml, policy);
+  return policy;
+}
+
+// Identical rules are merged, and a rule shared by policies is evaluated once, cheapest first.
+TEST(CompiledPolicies, SharedRules) {
+  Protobuf::Map<ProtobufTypes::String, envoy::config::rbac::v2alpha::Policy> policies;
+  policies["a"] = policyFromYaml(R"EOF(
+permissions:
+  - destination_port: 80
+  - header: {name: foo, present_match: true}
+principals:
+  - authenticated: {name: admin}
+)EOF");
+  policies["b"] = policyFromYaml(R"EOF(
+permissions:
+  - destination_port: 443
+  - header: {name: foo, present_match: true}
+principals:
+  - authenticated: {name: admin}
+)EOF");
+  const CompiledPolicies compiled(policies);
+  // 2 ports, the header, the principal, 2 sets of permissions, 2 policies and the root.
+  EXPECT_EQ(9, compiled.size());
+
+  NiceMock<Network::MockConnection> conn;
+  Ssl::MockConnection ssl;
+  EXPECT_CALL(Const(conn), ssl()).WillOnce(Return(&ssl));
+  EXPECT_CALL(ssl, uriSanPeerCertificate()).WillOnce(Return("user"));
+  EXPECT_CALL(conn, localAddress()).Times(0);
+  Http::TestHeaderMapImpl headers{{"foo", "bar"}};
+  EXPECT_FALSE(compiled.matches(conn, headers, envoy::api::v2::core::Metadata()));
+}
+
+// Agrees with matching each policy in turn.
+TEST(CompiledPolicies, SameAsPolicyMatchers) {
+  Protobuf::Map<ProtobufTypes::String, envoy::config::rbac::v2alpha::Policy> policies;
+  policies["ports"] = policyFromYaml(R"EOF(
+permissions:
+  - and_rules:
+      rules:
+        - destination_port: 80
+        - not_rule: {header: {name: ":path", prefix_match: "/admin"}}
+principals:
+  - source_ip: {address_prefix: 10.0.0.0, prefix_len: 8}
+  - source_ip: {address_prefix: 192.168.0.0, prefix_len: 16}
+  - header: {name: x-internal, exact_match: "true"}
+)EOF");
+  policies["admin"] = policyFromYaml(R"EOF(
+permissions:
+  - header: {name: ":path", prefix_match: "/admin"}
+principals:
+  - and_ids:
+      ids:
+        - any: true
+        - source_ip: {address_prefix: 10.1.0.0, prefix_len: 16}
+)EOF");
+  policies["any"] = policyFromYaml(R"EOF(
+permissions:
+  - destination_ip: {address_prefix: 127.0.0.1, prefix_len: 32}
+principals:
+  - not_id: {any: true}
+  - any: true
+)EOF");
+  const CompiledPolicies compiled(policies);
+  std::vector<PolicyMatcher> matchers;
+  for (const auto& policy : policies) {
+    matchers.emplace_back(policy.second);
+  }
+
+  for (const std::string& local : {"127.0.0.1", "10.2.3.4"}) {
+    for (const uint32_t port : {80, 443}) {
+      for (const std::string& remote : {"10.1.2.3", "10.2.3.4", "192.168.1.1", "172.16.0.1"}) {
+        for (const std::string& path : {"/", "/admin/stats"}) {
+          for (const std::string& internal : {"true", "false"}) {
+            NiceMock<Network::MockConnection> conn;
+            const Network::Address::InstanceConstSharedPtr local_address =
+                Network::Utility::parseInternetAddress(local, port, false);
+            const Network::Address::InstanceConstSharedPtr remote_address =
+                Network::Utility::parseInternetAddress(remote, 1234, false);
+            ON_CALL(conn, localAddress()).WillByDefault(ReturnRef(local_address));
+            ON_CALL(conn, remoteAddress()).WillByDefault(ReturnRef(remote_address));
+            Http::TestHeaderMapImpl headers{{":path", path}, {"x-internal", internal}};
+            const envoy::api::v2::core::Metadata metadata;
+
+            bool expected = false;
+            for (const auto& matcher : matchers) {
+              expected = expected || matcher.matches(conn, headers, metadata);
+            }
+            EXPECT_EQ(expected, compiled.matches(conn, headers, metadata))
+                << local << ":" << port << " " << remote << " " << path << " " << internal;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(CompiledPolicies, Empty) {
+  const CompiledPolicies compiled(
+      Protobuf::Map<ProtobufTypes::String, envoy::config::rbac::v2alpha::Policy>());
+  EXPECT_FALSE(compiled.matches(Network::MockConnection(), Http::HeaderMapImpl(),
+                                envoy::api::v2::core::Metadata()));
+}
+
+} // namespace
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,164 @@
+#include "common/common/fmt.h"
+#include "common/http/header_map_impl.h"
+#include "common/network/utility.h"
+
+#include "extensions/filters/common/rbac/compiled_policies.h"
+#include "extensions/filters/common/rbac/matchers.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "testing/base/public/benchmark.h"
+
+using testing::Const;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+
+// A source_ip principal for each of the first `count` /24 ranges under 10.0.0.0/8.
+static envoy::config::rbac::v2alpha::Principal_Set sourceIpPrincipals(int64_t count) {
+  envoy::config::rbac::v2alpha::Principal_Set set;
+  for (int64_t i = 0; i < count; i++) {
+    auto* cidr = set.add_ids()->mutable_source_ip();
+    cidr->set_address_prefix(fmt::format("10.{}.{}.0", i / 256 % 256, i % 256));
+    cidr->mutable_prefix_len()->set_value(24);
+  }
+  return set;
+}
+
+// Evaluates a principal set of state.range(0) source IP ranges against an address in none of them,
+// which is the worst case for a policy that lists the ranges to allow.
+static void BM_OrMatcherSourceIp(benchmark::State& state) {
+  const OrMatcher matcher(sourceIpPrincipals(state.range(0)));
+  NiceMock<Network::MockConnection> connection;
+  const Network::Address::InstanceConstSharedPtr address =
+      Network::Utility::parseInternetAddress("192.0.2.1", 443, false);
+  ON_CALL(connection, remoteAddress()).WillByDefault(ReturnRef(address));
+  const Http::HeaderMapImpl headers;
+  const envoy::api::v2::core::Metadata metadata;
+
+  size_t matched = 0;
+  for (auto _ : state) {
+    matched += matcher.matches(connection, headers, metadata);
+  }
+  benchmark::DoNotOptimize(matched);
+}
+BENCHMARK(BM_OrMatcherSourceIp)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+
+// The same evaluation with a matcher per range, checked in turn.
+static void BM_IPMatcherPerRange(benchmark::State& state) {
+  std::vector<MatcherConstSharedPtr> matchers;
+  for (const auto& id : sourceIpPrincipals(state.range(0)).ids()) {
+    matchers.push_back(std::make_shared<const IPMatcher>(id.source_ip(), false));
+  }
+  NiceMock<Network::MockConnection> connection;
+  const Network::Address::InstanceConstSharedPtr address =
+      Network::Utility::parseInternetAddress("192.0.2.1", 443, false);
+  ON_CALL(connection, remoteAddress()).WillByDefault(ReturnRef(address));
+  const Http::HeaderMapImpl headers;
+  const envoy::api::v2::core::Metadata metadata;
+
+  size_t matched = 0;
+  for (auto _ : state) {
+    for (const auto& matcher : matchers) {
+      if (matcher->matches(connection, headers, metadata)) {
+        matched++;
+        break;
+      }
+    }
+  }
+  benchmark::DoNotOptimize(matched);
+}
+BENCHMARK(BM_IPMatcherPerRange)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+
+// state.range(0) policies, which share the handful of distinct paths, ports, services and tenants
+// that they allow between them.
+static Protobuf::Map<ProtobufTypes::String, envoy::config::rbac::v2alpha::Policy>
+policies(int64_t count) {
+  Protobuf::Map<ProtobufTypes::String, envoy::config::rbac::v2alpha::Policy> policies;
+  for (int64_t i = 0; i < count; i++) {
+    envoy::config::rbac::v2alpha::Policy& policy = policies[fmt::format("policy_{}", i)];
+    auto* path = policy.add_permissions()->mutable_header();
+    path->set_name(":path");
+    path->set_prefix_match(fmt::format("/api/v{}/", i % 10));
+    policy.add_permissions()->set_destination_port(8000 + i % 50);
+    policy.add_principals()->mutable_authenticated()->set_name(fmt::format("service-{}", i % 100));
+    auto* tenant = policy.add_principals()->mutable_header();
+    tenant->set_name("x-tenant");
+    tenant->set_exact_match(fmt::format("tenant-{}", i % 20));
+  }
+  return policies;
+}
+
+// Evaluates a request that none of the policies allow, so that all of them are evaluated.
+template <class Evaluate>
+static void evaluatePolicies(benchmark::State& state, const Evaluate& evaluate) {
+  NiceMock<Network::MockConnection> connection;
+  NiceMock<Ssl::MockConnection> ssl;
+  const Network::Address::InstanceConstSharedPtr address =
+      Network::Utility::parseInternetAddress("10.0.0.1", 9000, false);
+  ON_CALL(connection, localAddress()).WillByDefault(ReturnRef(address));
+  ON_CALL(Const(connection), ssl()).WillByDefault(Return(&ssl));
+  ON_CALL(ssl, uriSanPeerCertificate()).WillByDefault(Return("service-other"));
+  const Http::TestHeaderMapImpl headers{{":path", "/static/index.html"},
+                                        {"x-tenant", "tenant-other"}};
+  const envoy::api::v2::core::Metadata metadata;
+
+  size_t matched = 0;
+  for (auto _ : state) {
+    matched += evaluate(connection, headers, metadata);
+  }
+  benchmark::DoNotOptimize(matched);
+}
+
+static void BM_CompiledPolicies(benchmark::State& state) {
+  const CompiledPolicies compiled(policies(state.range(0)));
+  evaluatePolicies(state, [&](const Network::Connection& connection,
+                              const Http::HeaderMap& headers,
+                              const envoy::api::v2::core::Metadata& metadata) {
+    return compiled.matches(connection, headers, metadata);
+  });
+}
+BENCHMARK(BM_CompiledPolicies)->Arg(10)->Arg(100)->Arg(1000);
+
+// The same evaluation with a PolicyMatcher per policy, matched in turn.
+static void BM_PolicyMatchers(benchmark::State& state) {
+  std::vector<PolicyMatcher> matchers;
+  for (const auto& policy : policies(state.range(0))) {
+    matchers.emplace_back(policy.second);
+  }
+  evaluatePolicies(state, [&](const Network::Connection& connection,
+                              const Http::HeaderMap& headers,
+                              const envoy::api::v2::core::Metadata& metadata) {
+    for (const auto& matcher : matchers) {
+      if (matcher.matches(connection, headers, metadata)) {
+        return true;
+      }
+    }
+    return false;
+  });
+}
+BENCHMARK(BM_PolicyMatchers)->Arg(10)->Arg(100)->Arg(1000);
+
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
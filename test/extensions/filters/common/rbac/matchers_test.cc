@@ -1,9 +1,11 @@
+#include "common/common/fmt.h"
 #include "common/network/utility.h"
 
 #include "extensions/filters/common/rbac/matchers.h"
 
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/ssl/mocks.h"
+#include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -116,6 +118,41 @@ TEST(OrMatcher, Principal_Set) {
   checkMatcher(RBAC::OrMatcher(set), true, conn);
 }
 
+TEST(OrMatcher, IPRanges) {
+  envoy::config::rbac::v2alpha::Principal_Set set;
+  for (int i = 0; i < 1000; i++) {
+    auto* cidr = set.add_ids()->mutable_source_ip();
+    cidr->set_address_prefix(fmt::format("10.{}.{}.0", i / 256, i % 256));
+    cidr->mutable_prefix_len()->set_value(24);
+  }
+  set.add_ids()->mutable_header()->set_name("foo");
+  auto* cidr = set.add_ids()->mutable_source_ip();
+  cidr->set_address_prefix("2001:db8::");
+  cidr->mutable_prefix_len()->set_value(32);
+  // Not valid for IPv4, so never matches.
+  cidr = set.add_ids()->mutable_source_ip();
+  cidr->set_address_prefix("192.168.0.0");
+  cidr->mutable_prefix_len()->set_value(33);
+  const RBAC::OrMatcher matcher(set);
+
+  Envoy::Network::MockConnection conn;
+  Envoy::Network::Address::InstanceConstSharedPtr addr;
+  EXPECT_CALL(conn, remoteAddress()).WillRepeatedly(ReturnRef(addr));
+
+  addr = Envoy::Network::Utility::parseInternetAddress("10.3.231.7", 123, false);
+  checkMatcher(matcher, true, conn);
+  addr = Envoy::Network::Utility::parseInternetAddress("10.3.232.7", 123, false);
+  checkMatcher(matcher, false, conn);
+  addr = Envoy::Network::Utility::parseInternetAddress("2001:db8::1", 123, false);
+  checkMatcher(matcher, true, conn);
+  addr = Envoy::Network::Utility::parseInternetAddress("192.168.0.1", 123, false);
+  checkMatcher(matcher, false, conn);
+
+  // The other rules still apply.
+  Envoy::Http::TestHeaderMapImpl headers{{"foo", "bar"}};
+  checkMatcher(matcher, true, conn, headers);
+}
+
 TEST(NotMatcher, Permission) {
   envoy::config::rbac::v2alpha::Permission perm;
   perm.set_any(true);
@@ -8,6 +8,9 @@
 #include "gtest/gtest.h"
 
 using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
 using testing::_;
 
 namespace Envoy {
@@ -43,6 +46,34 @@ TEST(HttpExtAuthzConfigTest, CorrectProtoGrpc) {
   cb(filter_callback);
 }
 
+TEST(HttpExtAuthzConfigTest, CorrectProtoGrpcWithCache) {
+  std::string yaml = R"EOF(
+  grpc_service:
+    envoy_grpc:
+      cluster_name: ext_authz_server
+  )EOF";
+
+  ExtAuthzFilterConfig factory;
+  ProtobufTypes::MessagePtr proto_config = factory.createEmptyConfigProto();
+  MessageUtil::loadFromYaml(yaml, *proto_config);
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  const std::string key_attributes = "request.http.path";
+  EXPECT_CALL(context.runtime_loader_.snapshot_, getInteger("ext_authz.cache.max_entries", 0))
+      .WillOnce(Return(100));
+  EXPECT_CALL(context.runtime_loader_.snapshot_, get("ext_authz.cache.key_attributes"))
+      .WillOnce(ReturnRef(key_attributes));
+  EXPECT_CALL(context.thread_local_, allocateSlot());
+  // The gRPC clients are only created for the checks that are sent.
+  EXPECT_CALL(context.cluster_manager_.async_client_manager_, factoryForGrpcService(_, _, _))
+      .Times(0);
+  Http::FilterFactoryCb cb = factory.createFilterFactoryFromProto(*proto_config, "stats", context);
+  Http::MockFilterChainFactoryCallbacks filter_callback;
+  EXPECT_CALL(filter_callback, addStreamDecoderFilter(_)).Times(2);
+  cb(filter_callback);
+  cb(filter_callback);
+}
+
 TEST(HttpExtAuthzConfigTest, CorrectProtoHttp) {
   std::string yaml = R"EOF(
   http_service:
@@ -0,0 +1,66 @@
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/http/jwt_authn/authenticator.h"
+
+#include "test/extensions/filters/http/jwt_authn/test_common.h"
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "testing/base/public/benchmark.h"
+
+using ::google::jwt_verify::Status;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+
+class CountingCallbacks : public Authenticator::Callbacks {
+public:
+  void onComplete(const Status& status) override { ok_ += status == Status::Ok; }
+
+  size_t ok_{};
+};
+
+// Authenticates requests that all carry the same RS256 token, verified with a local JWKS. The token
+// cache holds state.range(0) tokens, so 0 verifies the signature of every request.
+static void BM_AuthenticateRs256(benchmark::State& state) {
+  ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication proto_config;
+  MessageUtil::loadFromYaml(ExampleConfig, proto_config);
+  auto& provider = (*proto_config.mutable_providers())[std::string(ProviderName)];
+  provider.mutable_local_jwks()->set_inline_string(PublicKey);
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  ON_CALL(context.runtime_loader_.snapshot_,
+          getInteger("jwt_authn.token_cache_size", DefaultTokenCacheSize))
+      .WillByDefault(Return(state.range(0)));
+  auto filter_config = std::make_shared<FilterConfig>(proto_config, "", context);
+
+  CountingCallbacks callbacks;
+  for (auto _ : state) {
+    Http::TestHeaderMapImpl headers{{"Authorization", "Bearer " + std::string(GoodToken)}};
+    AuthenticatorPtr authenticator = Authenticator::create(filter_config);
+    authenticator->verify(headers, &callbacks);
+  }
+  if (callbacks.ok_ != state.iterations()) {
+    state.SkipWithError("authentication failed");
+  }
+}
+BENCHMARK(BM_AuthenticateRs256)->Arg(0)->Arg(DefaultTokenCacheSize);
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
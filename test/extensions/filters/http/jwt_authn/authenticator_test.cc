@@ -15,6 +15,7 @@ using ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication;
 using ::google::jwt_verify::Status;
 using ::testing::Invoke;
 using ::testing::NiceMock;
+using ::testing::Return;
 using ::testing::_;
 
 namespace Envoy {
@@ -89,6 +90,57 @@ TEST_F(AuthenticatorTest, TestOkJWTandCache) {
   }
 
   EXPECT_EQ(mock_pubkey.called_count(), 1);
+  // Only the first request verifies the token.
+  EXPECT_EQ(1U, filter_config_->stats().token_cache_miss_.value());
+  EXPECT_EQ(9U, filter_config_->stats().token_cache_hit_.value());
+}
+
+// This test verifies that every request verifies the token when the token cache is disabled.
+TEST_F(AuthenticatorTest, TestTokenCacheDisabled) {
+  ON_CALL(mock_factory_ctx_.runtime_loader_.snapshot_,
+          getInteger("jwt_authn.token_cache_size", DefaultTokenCacheSize))
+      .WillByDefault(Return(0));
+  CreateAuthenticator();
+  MockUpstream mock_pubkey(mock_factory_ctx_.cluster_manager_, PublicKey);
+
+  for (int i = 0; i < 2; i++) {
+    auto headers = Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(GoodToken)}};
+    MockAuthenticatorCallbacks mock_cb;
+    EXPECT_CALL(mock_cb, onComplete(_)).WillOnce(Invoke([](const Status& status) {
+      ASSERT_EQ(status, Status::Ok);
+    }));
+    auth_->verify(headers, &mock_cb);
+    EXPECT_EQ(headers.get_("sec-istio-auth-userinfo"), ExpectedPayloadValue);
+  }
+
+  EXPECT_EQ(2U, filter_config_->stats().token_cache_miss_.value());
+  EXPECT_EQ(0U, filter_config_->stats().token_cache_hit_.value());
+}
+
+// This test verifies that a cached token is still only accepted from the locations specified for
+// its issuer.
+TEST_F(AuthenticatorTest, TestTokenCacheChecksLocation) {
+  auto& provider = (*proto_config_.mutable_providers())[std::string(ProviderName)];
+  provider.add_from_params("jwt_token");
+  // Only another issuer accepts tokens from the default locations.
+  (*proto_config_.mutable_providers())["other_provider"].set_issuer("other_issuer");
+  CreateAuthenticator();
+  MockUpstream mock_pubkey(mock_factory_ctx_.cluster_manager_, PublicKey);
+
+  auto headers = Http::TestHeaderMapImpl{{":path", "/path?jwt_token=" + std::string(GoodToken)}};
+  MockAuthenticatorCallbacks mock_cb;
+  EXPECT_CALL(mock_cb, onComplete(_)).WillOnce(Invoke([](const Status& status) {
+    ASSERT_EQ(status, Status::Ok);
+  }));
+  auth_->verify(headers, &mock_cb);
+
+  // The issuer of the token only accepts it from the query parameter.
+  headers = Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(GoodToken)}};
+  EXPECT_CALL(mock_cb, onComplete(_)).WillOnce(Invoke([](const Status& status) {
+    ASSERT_EQ(status, Status::JwtUnknownIssuer);
+  }));
+  auth_->verify(headers, &mock_cb);
+  EXPECT_EQ(0U, filter_config_->stats().token_cache_hit_.value());
 }
 
 // This test verifies the Jwt is forwarded if "forward" flag is set.
@@ -0,0 +1,58 @@
+#include "extensions/filters/http/jwt_authn/token_cache.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+namespace {
+
+TEST(TokenCacheTest, FindAndExpire) {
+  TokenCache cache(10);
+  EXPECT_EQ(nullptr, cache.find("token", 100));
+
+  cache.insert("token", {"issuer", "payload", 200});
+  const TokenCache::VerifiedToken* verified = cache.find("token", 100);
+  ASSERT_NE(nullptr, verified);
+  EXPECT_EQ("issuer", verified->issuer_);
+  EXPECT_EQ("payload", verified->payload_str_base64url_);
+  EXPECT_NE(nullptr, cache.find("token", 200));
+  EXPECT_EQ(nullptr, cache.find("other_token", 100));
+
+  // Expired tokens are removed.
+  EXPECT_EQ(nullptr, cache.find("token", 201));
+  EXPECT_EQ(0U, cache.size());
+}
+
+TEST(TokenCacheTest, EvictsLeastRecentlyUsed) {
+  TokenCache cache(2);
+  cache.insert("a", {"issuer", "payload_a", 200});
+  cache.insert("b", {"issuer", "payload_b", 200});
+  EXPECT_NE(nullptr, cache.find("a", 100));
+
+  cache.insert("c", {"issuer", "payload_c", 200});
+  EXPECT_EQ(2U, cache.size());
+  EXPECT_EQ(nullptr, cache.find("b", 100));
+  EXPECT_NE(nullptr, cache.find("a", 100));
+  EXPECT_NE(nullptr, cache.find("c", 100));
+
+  // Inserting a cached token again replaces it, without evicting anything.
+  cache.insert("a", {"issuer", "new_payload_a", 300});
+  EXPECT_EQ(2U, cache.size());
+  EXPECT_EQ("new_payload_a", cache.find("a", 250)->payload_str_base64url_);
+  EXPECT_NE(nullptr, cache.find("c", 100));
+}
+
+TEST(TokenCacheTest, Disabled) {
+  TokenCache cache(0);
+  cache.insert("token", {"issuer", "payload", 200});
+  EXPECT_EQ(nullptr, cache.find("token", 100));
+  EXPECT_EQ(0U, cache.size());
+}
+
+} // namespace
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
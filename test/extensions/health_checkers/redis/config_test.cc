@@ -61,7 +61,7 @@ TEST(HealthCheckerFactoryTest, createRedisViaUpstreamHealthCheckerFactory) {
   EXPECT_NE(nullptr, dynamic_cast<CustomRedisHealthChecker*>(
                          Upstream::HealthCheckerFactory::create(
                              Upstream::parseHealthCheckFromV2Yaml(yaml), cluster, runtime, random,
-                             dispatcher, log_manager)
+                             dispatcher, log_manager, nullptr)
                              .get()));
 }
 
@@ -88,7 +88,7 @@ TEST(HealthCheckerFactoryTest, createRedisWithDeprecatedConfig) {
                          // deprecated config.
                          Upstream::HealthCheckerFactory::create(
                              Upstream::parseHealthCheckFromV2Yaml(yaml), cluster, runtime, random,
-                             dispatcher, log_manager)
+                             dispatcher, log_manager, nullptr)
                              .get()));
 }
 
@@ -113,7 +113,7 @@ TEST(HealthCheckerFactoryTest, createRedisWithDeprecatedV1JsonConfig) {
                          // deprecated config.
                          Upstream::HealthCheckerFactory::create(
                              Upstream::parseHealthCheckFromV1Json(json), cluster, runtime, random,
-                             dispatcher, log_manager)
+                             dispatcher, log_manager, nullptr)
                              .get()));
 }
 
@@ -139,7 +139,7 @@ TEST(HealthCheckerFactoryTest, createRedisWithDeprecatedV1JsonConfigWithKey) {
                          // deprecated config.
                          Upstream::HealthCheckerFactory::create(
                              Upstream::parseHealthCheckFromV1Json(json), cluster, runtime, random,
-                             dispatcher, log_manager)
+                             dispatcher, log_manager, nullptr)
                              .get()));
 }
 
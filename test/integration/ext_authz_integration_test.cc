@@ -0,0 +1,164 @@
+#include "envoy/config/filter/http/ext_authz/v2alpha/ext_authz.pb.h"
+#include "envoy/service/auth/v2alpha/external_auth.pb.h"
+
+#include "common/protobuf/utility.h"
+
+#include "test/common/grpc/grpc_client_integration.h"
+#include "test/integration/http_integration.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace {
+
+// Runs the ext_authz filter with the decision cache enabled, against a fake authorization server.
+class ExtAuthzCacheIntegrationTest : public HttpIntegrationTest,
+                                     public Grpc::GrpcClientIntegrationParamTest {
+public:
+  ExtAuthzCacheIntegrationTest()
+      : HttpIntegrationTest(Http::CodecClient::Type::HTTP2, ipVersion()) {}
+
+  void SetUp() override {
+    setUpstreamProtocol(FakeHttpConnection::Type::HTTP2);
+    initialize();
+  }
+
+  void createUpstreams() override {
+    HttpIntegrationTest::createUpstreams();
+    fake_upstreams_.emplace_back(new FakeUpstream(0, FakeHttpConnection::Type::HTTP2, version_));
+  }
+
+  void initialize() override {
+    // Write the runtime file to turn the decision cache on.
+    TestEnvironment::writeStringToFileForTest("runtime/ext_authz.cache.max_entries", "100");
+    config_helper_.addConfigModifier([this](envoy::config::bootstrap::v2::Bootstrap& bootstrap) {
+      bootstrap.mutable_runtime()->set_symlink_root(TestEnvironment::temporaryPath("runtime"));
+      auto* ext_authz_cluster = bootstrap.mutable_static_resources()->add_clusters();
+      ext_authz_cluster->MergeFrom(bootstrap.static_resources().clusters()[0]);
+      ext_authz_cluster->set_name("ext_authz");
+      ext_authz_cluster->mutable_http2_protocol_options();
+    });
+    config_helper_.addConfigModifier(
+        [this](envoy::config::filter::network::http_connection_manager::v2::HttpConnectionManager&
+                   hcm) {
+          envoy::config::filter::http::ext_authz::v2alpha::ExtAuthz proto_config;
+          setGrpcService(*proto_config.mutable_grpc_service(), "ext_authz",
+                         fake_upstreams_.back()->localAddress());
+          auto* ext_authz_filter = hcm.add_http_filters();
+          ext_authz_filter->set_name("envoy.ext_authz");
+          MessageUtil::jsonConvert(proto_config, *ext_authz_filter->mutable_config());
+          // Move it in front of the router.
+          for (int i = hcm.http_filters_size() - 1; i > 0; --i) {
+            hcm.mutable_http_filters()->SwapElements(i, i - 1);
+          }
+        });
+    HttpIntegrationTest::initialize();
+    codec_client_ = makeHttpConnection(lookupPort("http"));
+  }
+
+  IntegrationStreamDecoderPtr sendRequest(const std::string& path) {
+    return codec_client_->makeHeaderOnlyRequest(Http::TestHeaderMapImpl{
+        {":method", "GET"}, {":path", path}, {":scheme", "http"}, {":authority", "host"}});
+  }
+
+  void waitForExtAuthzRequest(const std::string& expected_path) {
+    fake_ext_authz_connection_ = fake_upstreams_.back()->waitForHttpConnection(*dispatcher_);
+    ext_authz_request_ = fake_ext_authz_connection_->waitForNewStream(*dispatcher_);
+    envoy::service::auth::v2alpha::CheckRequest check_request;
+    ext_authz_request_->waitForGrpcMessage(*dispatcher_, check_request);
+    ext_authz_request_->waitForEndStream(*dispatcher_);
+    EXPECT_STREQ("/envoy.service.auth.v2alpha.Authorization/Check",
+                 ext_authz_request_->headers().Path()->value().c_str());
+    EXPECT_EQ(expected_path, check_request.attributes().request().http().path());
+  }
+
+  void sendExtAuthzResponse(Grpc::Status::GrpcStatus code) {
+    ext_authz_request_->startGrpcStream();
+    envoy::service::auth::v2alpha::CheckResponse check_response;
+    check_response.mutable_status()->set_code(code);
+    ext_authz_request_->sendGrpcMessage(check_response);
+    ext_authz_request_->finishGrpcStream(Grpc::Status::Ok);
+  }
+
+  void waitForUpstreamResponse(IntegrationStreamDecoder& response) {
+    if (fake_upstream_connection_ == nullptr) {
+      fake_upstream_connection_ = fake_upstreams_[0]->waitForHttpConnection(*dispatcher_);
+    }
+    upstream_request_ = fake_upstream_connection_->waitForNewStream(*dispatcher_);
+    upstream_request_->waitForEndStream(*dispatcher_);
+    upstream_request_->encodeHeaders(Http::TestHeaderMapImpl{{":status", "200"}}, true);
+    response.waitForEndStream();
+    EXPECT_TRUE(response.complete());
+    EXPECT_STREQ("200", response.headers().Status()->value().c_str());
+  }
+
+  void cleanup() {
+    if (fake_ext_authz_connection_ != nullptr) {
+      fake_ext_authz_connection_->close();
+      fake_ext_authz_connection_->waitForDisconnect();
+    }
+    cleanupUpstreamAndDownstream();
+  }
+
+  uint64_t counter(const std::string& name) {
+    return test_server_->counter("http.config_test.ext_authz." + name)->value();
+  }
+
+  FakeHttpConnectionPtr fake_ext_authz_connection_;
+  FakeStreamPtr ext_authz_request_;
+};
+
+INSTANTIATE_TEST_CASE_P(IpVersionsClientType, ExtAuthzCacheIntegrationTest,
+                        GRPC_CLIENT_INTEGRATION_PARAMS);
+
+// The second request is allowed by the cached decision of the first.
+TEST_P(ExtAuthzCacheIntegrationTest, CachedOk) {
+  auto response = sendRequest("/allowed");
+  waitForExtAuthzRequest("/allowed");
+  sendExtAuthzResponse(Grpc::Status::Ok);
+  waitForUpstreamResponse(*response);
+
+  response = sendRequest("/allowed");
+  waitForUpstreamResponse(*response);
+  cleanup();
+
+  EXPECT_EQ(1, counter("cache_hit"));
+  EXPECT_EQ(1, counter("cache_miss"));
+  EXPECT_EQ(0, counter("coalesced"));
+}
+
+// The second request is denied by the cached decision of the first.
+TEST_P(ExtAuthzCacheIntegrationTest, CachedDenied) {
+  auto response = sendRequest("/denied");
+  waitForExtAuthzRequest("/denied");
+  sendExtAuthzResponse(Grpc::Status::PermissionDenied);
+  response->waitForEndStream();
+  EXPECT_STREQ("403", response->headers().Status()->value().c_str());
+
+  response = sendRequest("/denied");
+  response->waitForEndStream();
+  EXPECT_STREQ("403", response->headers().Status()->value().c_str());
+  cleanup();
+
+  EXPECT_EQ(1, counter("cache_hit"));
+  EXPECT_EQ(1, counter("cache_miss"));
+}
+
+// Requests that arrive while the check of the same attributes is in flight wait for its decision.
+TEST_P(ExtAuthzCacheIntegrationTest, CoalescedInFlight) {
+  auto response1 = sendRequest("/allowed");
+  waitForExtAuthzRequest("/allowed");
+  auto response2 = sendRequest("/allowed");
+  test_server_->waitForCounterGe("http.config_test.ext_authz.coalesced", 1);
+  sendExtAuthzResponse(Grpc::Status::Ok);
+  waitForUpstreamResponse(*response1);
+  waitForUpstreamResponse(*response2);
+  cleanup();
+
+  EXPECT_EQ(0, counter("cache_hit"));
+  EXPECT_EQ(2, counter("cache_miss"));
+  EXPECT_EQ(1, counter("coalesced"));
+}
+
+} // namespace
+} // namespace Envoy
@@ -227,5 +227,84 @@ TEST_P(RatelimitIntegrationTest, FailedConnect) {
   cleanup();
 }
 
+// Runs the rate limit filter with local quotas, which report their usage to the fake rate limit
+// service instead of asking it for each request.
+class RatelimitLocalQuotaIntegrationTest : public RatelimitIntegrationTest {
+public:
+  void initialize() override {
+    // Write the runtime files to turn the local quotas on.
+    TestEnvironment::writeStringToFileForTest("runtime/ratelimit.local_quota.max_tokens", "1");
+    TestEnvironment::writeStringToFileForTest("runtime/ratelimit.local_quota.tokens_per_second",
+                                              "1000");
+    config_helper_.addConfigModifier([](envoy::config::bootstrap::v2::Bootstrap& bootstrap) {
+      bootstrap.mutable_runtime()->set_symlink_root(TestEnvironment::temporaryPath("runtime"));
+    });
+    RatelimitIntegrationTest::initialize();
+    codec_client_ = makeHttpConnection(lookupPort("http"));
+  }
+
+  void sendRequest() {
+    // Header only, so that the connection is kept open when the request is rejected.
+    response_ = codec_client_->makeHeaderOnlyRequest(Http::TestHeaderMapImpl{
+        {":method", "GET"}, {":path", "/test/url"}, {":scheme", "http"}, {":authority", "host"}});
+  }
+
+  void waitForReport(uint32_t hits) {
+    if (fake_ratelimit_connection_ == nullptr) {
+      fake_ratelimit_connection_ = fake_upstreams_[1]->waitForHttpConnection(*dispatcher_);
+    }
+    ratelimit_request_ = fake_ratelimit_connection_->waitForNewStream(*dispatcher_);
+    envoy::service::ratelimit::v2::RateLimitRequest request_msg;
+    ratelimit_request_->waitForGrpcMessage(*dispatcher_, request_msg);
+    ratelimit_request_->waitForEndStream(*dispatcher_);
+    EXPECT_STREQ("/envoy.service.ratelimit.v2.RateLimitService/ShouldRateLimit",
+                 ratelimit_request_->headers().Path()->value().c_str());
+    EXPECT_EQ("some_domain", request_msg.domain());
+    EXPECT_EQ(hits, request_msg.hits_addend());
+  }
+
+  void waitForUpstreamResponse() {
+    if (fake_upstream_connection_ == nullptr) {
+      fake_upstream_connection_ = fake_upstreams_[0]->waitForHttpConnection(*dispatcher_);
+    }
+    upstream_request_ = fake_upstream_connection_->waitForNewStream(*dispatcher_);
+    upstream_request_->waitForEndStream(*dispatcher_);
+    upstream_request_->encodeHeaders(Http::TestHeaderMapImpl{{":status", "200"}}, true);
+    response_->waitForEndStream();
+    EXPECT_TRUE(response_->complete());
+    EXPECT_STREQ("200", response_->headers().Status()->value().c_str());
+  }
+};
+
+// Local quotas need the hits_addend of the data-plane-api defined rate limit service.
+INSTANTIATE_TEST_CASE_P(IpVersionsClientType, RatelimitLocalQuotaIntegrationTest,
+                        testing::Combine(testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
+                                         testing::Values(Grpc::ClientType::EnvoyGrpc),
+                                         testing::Values(true)));
+
+// Requests are admitted without waiting for the service, whose verdicts on the reported usage
+// close and reopen the quota.
+TEST_P(RatelimitLocalQuotaIntegrationTest, ReportAndVerdict) {
+  sendRequest();
+  waitForUpstreamResponse();
+  waitForReport(1);
+  sendRateLimitResponse(envoy::service::ratelimit::v2::RateLimitResponse_Code_OVER_LIMIT);
+  test_server_->waitForCounterGe("ratelimit.local_quota.report_over_limit", 1);
+
+  sendRequest();
+  waitForFailedUpstreamResponse(429);
+  waitForReport(1);
+  sendRateLimitResponse(envoy::service::ratelimit::v2::RateLimitResponse_Code_OK);
+  test_server_->waitForCounterGe("ratelimit.local_quota.report_ok", 1);
+
+  sendRequest();
+  waitForUpstreamResponse();
+  cleanup();
+
+  EXPECT_EQ(2, test_server_->counter("cluster.cluster_0.ratelimit.ok")->value());
+  EXPECT_EQ(1, test_server_->counter("cluster.cluster_0.ratelimit.over_limit")->value());
+  EXPECT_EQ(nullptr, test_server_->counter("cluster.cluster_0.ratelimit.error"));
+}
+
 } // namespace
 } // namespace Envoy
@@ -42,6 +42,8 @@ public:
   // Server::Options
   uint64_t baseId() const override { return 0; }
   uint32_t concurrency() const override { return 1; }
+  uint32_t privateKeyThreads() const override { return 0; }
+  uint32_t healthCheckThreads() const override { return 0; }
   const std::string& configPath() const override { return config_path_; }
   const std::string& configYaml() const override { return config_yaml_; }
   bool v2ConfigOnly() const override { return false; }
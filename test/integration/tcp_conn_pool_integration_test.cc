@@ -68,6 +68,10 @@ private:
       upstream_->release();
     }
 
+    void onEvent(Network::ConnectionEvent) override {}
+    void onAboveWriteBufferHighWatermark() override {}
+    void onBelowWriteBufferLowWatermark() override {}
+
     TestFilter& parent_;
     Buffer::OwnedImpl data_;
     Tcp::ConnectionPool::ConnectionData* upstream_;
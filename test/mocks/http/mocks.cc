@@ -145,7 +145,9 @@ MockAsyncClientRequest::~MockAsyncClientRequest() { client_->onRequestDestroy();
 MockAsyncClientStream::MockAsyncClientStream() {}
 MockAsyncClientStream::~MockAsyncClientStream() {}
 
-MockFilterChainFactoryCallbacks::MockFilterChainFactoryCallbacks() {}
+MockFilterChainFactoryCallbacks::MockFilterChainFactoryCallbacks() {
+  ON_CALL(*this, arena()).WillByDefault(ReturnRef(arena_));
+}
 MockFilterChainFactoryCallbacks::~MockFilterChainFactoryCallbacks() {}
 
 } // namespace Http
@@ -51,6 +51,8 @@ public:
 
   MOCK_CONST_METHOD0(baseId, uint64_t());
   MOCK_CONST_METHOD0(concurrency, uint32_t());
+  MOCK_CONST_METHOD0(privateKeyThreads, uint32_t());
+  MOCK_CONST_METHOD0(healthCheckThreads, uint32_t());
   MOCK_CONST_METHOD0(configPath, const std::string&());
   MOCK_CONST_METHOD0(configYaml, const std::string&());
   MOCK_CONST_METHOD0(v2ConfigOnly, bool());
@@ -13,6 +13,9 @@ MockCancellable::~MockCancellable() {}
 MockUpstreamCallbacks::MockUpstreamCallbacks() {}
 MockUpstreamCallbacks::~MockUpstreamCallbacks() {}
 
+MockConnectionData::MockConnectionData() {}
+MockConnectionData::~MockConnectionData() {}
+
 MockInstance::MockInstance() {}
 MockInstance::~MockInstance() {}
 
@@ -28,6 +28,22 @@ public:
 
   // Tcp::ConnectionPool::UpstreamCallbacks
   MOCK_METHOD2(onUpstreamData, void(Buffer::Instance& data, bool end_stream));
+
+  // Network::ConnectionCallbacks
+  MOCK_METHOD1(onEvent, void(Network::ConnectionEvent event));
+  MOCK_METHOD0(onAboveWriteBufferHighWatermark, void());
+  MOCK_METHOD0(onBelowWriteBufferLowWatermark, void());
+};
+
+class MockConnectionData : public ConnectionData {
+public:
+  MockConnectionData();
+  ~MockConnectionData();
+
+  // Tcp::ConnectionPool::ConnectionData
+  MOCK_METHOD0(connection, Network::ClientConnection&());
+  MOCK_METHOD1(addUpstreamCallbacks, void(ConnectionPool::UpstreamCallbacks& callbacks));
+  MOCK_METHOD0(release, void());
 };
 
 class MockInstance : public Instance {
@@ -39,6 +55,7 @@ public:
   MOCK_METHOD1(addDrainedCallback, void(DrainedCb cb));
   MOCK_METHOD0(drainConnections, void());
   MOCK_METHOD1(newConnection, Cancellable*(Tcp::ConnectionPool::Callbacks& callbacks));
+  MOCK_METHOD1(preconnect, void(uint32_t count));
 
   std::shared_ptr<testing::NiceMock<Upstream::MockHostDescription>> host_{
       new testing::NiceMock<Upstream::MockHostDescription>()};
@@ -22,6 +22,7 @@ public:
   // Server::ThreadLocal
   MOCK_METHOD0(allocateSlot, SlotPtr());
   MOCK_METHOD2(registerThread, void(Event::Dispatcher& dispatcher, bool main_thread));
+  MOCK_METHOD1(registerRestrictedThread, void(Event::Dispatcher& dispatcher));
   MOCK_METHOD0(shutdownGlobalThreading, void());
   MOCK_METHOD0(shutdownThread, void());
   MOCK_METHOD0(dispatcher, Event::Dispatcher&());
@@ -57,6 +58,7 @@ public:
 
     // ThreadLocal::Slot
     ThreadLocalObjectSharedPtr get() override { return parent_.data_[index_]; }
+    void includeRestrictedThreads() override {}
     void runOnAllThreads(Event::PostCb cb) override { parent_.runOnAllThreads(cb); }
     void runOnAllThreads(Event::PostCb cb, Event::PostCb main_callback) override {
       parent_.runOnAllThreads(cb, main_callback);
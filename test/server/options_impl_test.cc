@@ -76,9 +76,12 @@ TEST(OptionsImplTest, All) {
       "envoy --mode validate --concurrency 2 -c hello --admin-address-path path --restart-epoch 1 "
       "--local-address-ip-version v6 -l info --service-cluster cluster --service-node node "
       "--service-zone zone --file-flush-interval-msec 9000 --drain-time-s 60 --log-format [%v] "
-      "--parent-shutdown-time-s 90 --log-path /foo/bar --v2-config-only --disable-hot-restart");
+      "--parent-shutdown-time-s 90 --log-path /foo/bar --v2-config-only --disable-hot-restart "
+      "--private-key-threads 3 --health-check-threads 4");
   EXPECT_EQ(Server::Mode::Validate, options->mode());
   EXPECT_EQ(2U, options->concurrency());
+  EXPECT_EQ(3U, options->privateKeyThreads());
+  EXPECT_EQ(4U, options->healthCheckThreads());
   EXPECT_EQ("hello", options->configPath());
   EXPECT_TRUE(options->v2ConfigOnly());
   EXPECT_EQ("path", options->adminAddressPath());
@@ -109,6 +112,8 @@ TEST(OptionsImplTest, SetAll) {
 
   options->setBaseId(109876);
   options->setConcurrency(42);
+  options->setPrivateKeyThreads(7);
+  options->setHealthCheckThreads(5);
   options->setConfigPath("foo");
   options->setConfigYaml("bogus:");
   options->setV2ConfigOnly(!options->v2ConfigOnly());
@@ -131,6 +136,8 @@ TEST(OptionsImplTest, SetAll) {
 
   EXPECT_EQ(109876, options->baseId());
   EXPECT_EQ(42U, options->concurrency());
+  EXPECT_EQ(7U, options->privateKeyThreads());
+  EXPECT_EQ(5U, options->healthCheckThreads());
   EXPECT_EQ("foo", options->configPath());
   EXPECT_EQ("bogus:", options->configYaml());
   EXPECT_EQ(!v2_config_only, options->v2ConfigOnly());
@@ -161,6 +168,8 @@ TEST(OptionsImplTest, DefaultParams) {
   EXPECT_EQ(Network::Address::IpVersion::v4, options->localAddressIpVersion());
   EXPECT_EQ(Server::Mode::Serve, options->mode());
   EXPECT_EQ(false, options->hotRestartDisabled());
+  EXPECT_EQ(0U, options->privateKeyThreads());
+  EXPECT_EQ(0U, options->healthCheckThreads());
 }
 
 TEST(OptionsImplTest, BadCliOption) {